@@ -15,8 +15,6 @@ KOKKOSKERNELS_ADD_OPTION(
   "Whether to build supernodal SPTRSV support")
 KOKKOSKERNELS_FEATURE_DEPENDS_ON_TPLS(
   SUPERNODAL_SPTRSV
-    CHOLMOD
-    SUPERLU
     LAPACKE
     CBLAS
 )
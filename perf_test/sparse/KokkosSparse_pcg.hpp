@@ -56,6 +56,7 @@
 #include <iostream>
 #include "KokkosKernels_Handle.hpp"
 #include <KokkosSparse_spmv.hpp>
+#include <KokkosSparse_spmv_fused.hpp>
 #include <KokkosBlas.hpp>
 #include <KokkosSparse_gauss_seidel.hpp>
 #include <KokkosSparse_sor_sequential_impl.hpp>
@@ -444,17 +445,13 @@ void pcgsolve(
 
 
     timer.reset();
-    /* Ap = A * p   */  KokkosSparse::spmv("N", 1, crsMat, pAll, 0, Ap);
+    /* Ap = A * p, pAp_dot = dot(Ap , p ) in one pass */
+    const double pAp_dot = KokkosSparse::spmv_dot("N", 1.0, crsMat, pAll, 0.0, Ap);
 
 
     Space().fence();
     matvec_time += timer.seconds();
 
-    //const double pAp_dot = Kokkos::Example::all_reduce( dot( count_owned , p , Ap ) , import.comm );
-    //const double pAp_dot = dot<y_vector_t,y_vector_t, Space>( count_total , p , Ap ) ;
-
-    /* pAp_dot = dot(Ap , p ) */ const double pAp_dot = KokkosBlas::dot( p , Ap ) ;
-
     double alpha  = 0;
     if (use_sgs){
       alpha = precond_old_rdot / pAp_dot ;
@@ -56,6 +56,7 @@
 #include <KokkosSparse_CrsMatrix.hpp>
 #include <KokkosKernels_IOUtils.hpp>
 #include <KokkosSparse_spmv.hpp>
+#include <KokkosSparse_SellCSigmaMatrix.hpp>
 #include "KokkosKernels_default_types.hpp"
 #include <spmv/Kokkos_SPMV.hpp>
 #include <spmv/Kokkos_SPMV_Inspector.hpp>
@@ -74,7 +75,7 @@
 #include <OpenMPSmartStatic_SPMV.hpp>
 #endif
 
-enum {KOKKOS, MKL, CUSPARSE, KK_KERNELS, KK_KERNELS_INSP, KK_INSP, OMP_STATIC, OMP_DYNAMIC, OMP_INSP};
+enum {KOKKOS, MKL, CUSPARSE, KK_KERNELS, KK_KERNELS_INSP, KK_INSP, OMP_STATIC, OMP_DYNAMIC, OMP_INSP, KK_SELLCS};
 enum {AUTO, DYNAMIC, STATIC};
 
 typedef default_scalar Scalar;
@@ -82,8 +83,8 @@ typedef default_lno_t Ordinal;
 typedef default_size_type Offset;
 typedef default_layout Layout;
 
-template<typename AType, typename XType, typename YType>
-void matvec(AType& A, XType x, YType y, Ordinal rows_per_thread, int team_size, int vector_length, int test, int schedule) {
+template<typename AType, typename SellType, typename XType, typename YType>
+void matvec(AType& A, const SellType& A_sell, XType x, YType y, Ordinal rows_per_thread, int team_size, int vector_length, int test, int schedule) {
 
         switch(test) {
 
@@ -137,13 +138,17 @@ void matvec(AType& A, XType x, YType y, Ordinal rows_per_thread, int team_size,
                 }
                 KokkosSparse::spmv (KokkosSparse::NoTranspose,1.0,A,x,0.0,y);
                 break;
+        case KK_SELLCS:
+                KokkosSparse::spmv (KokkosSparse::NoTranspose,1.0,A_sell,x,0.0,y);
+                break;
         default:
           fprintf(stderr, "Selected test is not available.\n");
       }
 }
 
-int test_crs_matrix_singlevec(Ordinal numRows, Ordinal numCols, int test, const char* filename, Ordinal rows_per_thread, int team_size, int vector_length, int schedule, int loop) {
+int test_crs_matrix_singlevec(Ordinal numRows, Ordinal numCols, int test, const char* filename, Ordinal rows_per_thread, int team_size, int vector_length, int schedule, int loop, Ordinal chunk_height, Ordinal sigma) {
   typedef KokkosSparse::CrsMatrix<Scalar, Ordinal, Kokkos::DefaultExecutionSpace, void, Offset> matrix_type;
+  typedef KokkosSparse::Experimental::SellCSigmaMatrix<Scalar, Ordinal, Kokkos::DefaultExecutionSpace, void, Offset> sell_matrix_type;
   typedef typename Kokkos::View<Scalar*, Layout> mv_type;
   typedef typename mv_type::HostMirror h_mv_type;
 
@@ -200,8 +205,19 @@ int test_crs_matrix_singlevec(Ordinal numRows, Ordinal numCols, int test, const
   Kokkos::deep_copy(x1,h_x);
   mv_type y1("Y1",numRows);
 
+  // The conversion to SELL-C-sigma is timed on its own, it is not
+  // part of the SpMV timings below.
+  sell_matrix_type A_sell;
+  if(test == KK_SELLCS) {
+    if(chunk_height <= 0) chunk_height = sell_matrix_type::default_chunk_height();
+    A_sell = sell_matrix_type("A_sell", A, chunk_height, sigma);
+    printf("SELL-C-sigma C=%i sigma=%i StoredEntries=%lu ConversionTime(ms)=%6.3lf\n",
+           int(A_sell.chunkHeight()), int(A_sell.sigma()),
+           static_cast<unsigned long>(A_sell.numStoredEntries()), A_sell.conversionTime()*1000);
+  }
+
   //int nnz_per_row = A.nnz()/A.numRows();
-  matvec(A,x1,y1,rows_per_thread,team_size,vector_length,test,schedule);
+  matvec(A,A_sell,x1,y1,rows_per_thread,team_size,vector_length,test,schedule);
 
   // Error Check
   Kokkos::deep_copy(h_y,y1);
@@ -226,7 +242,7 @@ int test_crs_matrix_singlevec(Ordinal numRows, Ordinal numCols, int test, const
   double ave_time = 0.0;
   for(int i=0;i<loop;i++) {
     Kokkos::Timer timer;
-    matvec(A,x1,y1,rows_per_thread,team_size,vector_length,test,schedule);
+    matvec(A,A_sell,x1,y1,rows_per_thread,team_size,vector_length,test,schedule);
     Kokkos::fence();
     double time = timer.seconds();
     ave_time += time;
@@ -259,6 +275,7 @@ void print_help() {
   printf("                    Options:\n");
   printf("                      kk,kk-kernels          (Kokkos/Trilinos)\n");
   printf("                      kk-insp                (Kokkos Structure Inspection)\n");
+  printf("                      kk-sellcs              (KokkosKernels SELL-C-sigma format)\n");
 #ifdef KOKKOS_ENABLE_OPENMP
   printf("                      omp-dynamic,omp-static (Standard OpenMP)\n");
   printf("                      omp-insp               (OpenMP Structure Inspection)\n");
@@ -274,6 +291,8 @@ void print_help() {
   printf("  -ts [T]         : Number of threads per team.\n");
   printf("  -vl [V]         : Vector-length (i.e. how many Cuda threads are a Kokkos 'thread').\n");
   printf("  -l [LOOP]       : How many spmv to run to aggregate average time. \n");
+  printf("  -C [C]          : Chunk height for kk-sellcs (default: SIMD width).\n");
+  printf("  -sigma [S]      : Sorting window for kk-sellcs (default: 8*C).\n");
 }
 
 int main(int argc, char **argv)
@@ -289,6 +308,8 @@ int main(int argc, char **argv)
  int team_size = -1;
  int schedule=AUTO;
  int loop = 100;
+ int chunk_height = -1;
+ int sigma = 0;
 
  if(argc == 1) {
    print_help();
@@ -318,6 +339,8 @@ int main(int argc, char **argv)
       test = KK_KERNELS_INSP;
     if((strcmp(argv[i],"kk-insp")==0))
       test = KK_INSP;
+    if((strcmp(argv[i],"kk-sellcs")==0))
+      test = KK_SELLCS;
 #ifdef KOKKOS_ENABLE_OPENMP
     if((strcmp(argv[i],"omp-static") == 0))
       test = OMP_STATIC;
@@ -335,6 +358,8 @@ int main(int argc, char **argv)
   if((strcmp(argv[i],"-ts")==0)) {team_size=atoi(argv[++i]); continue;}
   if((strcmp(argv[i],"-vl")==0)) {vector_length=atoi(argv[++i]); continue;}
   if((strcmp(argv[i],"-l")==0)) {loop=atoi(argv[++i]); continue;}
+  if((strcmp(argv[i],"-C")==0)) {chunk_height=atoi(argv[++i]); continue;}
+  if((strcmp(argv[i],"-sigma")==0)) {sigma=atoi(argv[++i]); continue;}
   if((strcmp(argv[i],"--schedule")==0)) {
     i++;
     if((strcmp(argv[i],"auto")==0))
@@ -353,7 +378,7 @@ int main(int argc, char **argv)
 
  Kokkos::initialize(argc,argv);
 
- int total_errors = test_crs_matrix_singlevec(size,size,test,filename,rows_per_thread,team_size,vector_length,schedule,loop);
+ int total_errors = test_crs_matrix_singlevec(size,size,test,filename,rows_per_thread,team_size,vector_length,schedule,loop,chunk_height,sigma);
 
  if(total_errors == 0)
    printf("Kokkos::MultiVector Test: Passed\n");
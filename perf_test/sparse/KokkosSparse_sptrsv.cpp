@@ -77,7 +77,7 @@ using namespace KokkosKernels::Experimental;
 //#define PRINT_HLEVEL_FREQ_PLOT
 //#define PRINT_LEVEL_LIST
 
-enum {DEFAULT, CUSPARSE, LVLSCHED_RP, LVLSCHED_TP1, /*LVLSCHED_TP2,*/ LVLSCHED_TP1CHAIN, CUSPARSE_K};
+enum {DEFAULT, CUSPARSE, LVLSCHED_RP, LVLSCHED_TP1, /*LVLSCHED_TP2,*/ LVLSCHED_TP1CHAIN, SYNCFREE, JACOBI_SWEEPS, CUSPARSE_K};
 
 #ifdef PRINTVIEWSSPTRSVPERF
 template <class ViewType>
@@ -116,7 +116,7 @@ void check_entries_sorted(const RowMapType drow_map, const EntriesType dentries)
 
 }
 
-int test_sptrsv_perf(std::vector<int> tests, const std::string& lfilename, const std::string& ufilename, const int team_size, const int vector_length, const int idx_offset, const int loop, const int chain_threshold = 0, const float dense_row_percent = -1.0) {
+int test_sptrsv_perf(std::vector<int> tests, const std::string& lfilename, const std::string& ufilename, const int team_size, const int vector_length, const int idx_offset, const int loop, const int chain_threshold = 0, const float dense_row_percent = -1.0, const int num_jacobi_sweeps = 1) {
   typedef default_scalar scalar_t;
   typedef default_lno_t lno_t;
   typedef default_size_type size_type;
@@ -259,6 +259,16 @@ int test_sptrsv_perf(std::vector<int> tests, const std::string& lfilename, const
         if (vector_length != -1) kh.get_sptrsv_handle()->set_vector_size(vector_length);
         kh.get_sptrsv_handle()->print_algorithm();
         break;
+      case SYNCFREE:
+        kh.create_sptrsv_handle(SPTRSVAlgorithm::SYNCFREE, nrows, is_lower_tri);
+        kh.get_sptrsv_handle()->print_algorithm();
+        break;
+      case JACOBI_SWEEPS:
+        printf("num_jacobi_sweeps %d\n", num_jacobi_sweeps);
+        kh.create_sptrsv_handle(SPTRSVAlgorithm::JACOBI_SWEEPS, nrows, is_lower_tri);
+        kh.get_sptrsv_handle()->set_num_jacobi_sweeps(num_jacobi_sweeps);
+        kh.get_sptrsv_handle()->print_algorithm();
+        break;
 /*
       case LVLSCHED_TP2:
         kh.create_sptrsv_handle(SPTRSVAlgorithm::SEQLVLSCHED_TP2, nrows, is_lower_tri);
@@ -637,6 +647,16 @@ int test_sptrsv_perf(std::vector<int> tests, const std::string& lfilename, const
         if (vector_length != -1) kh.get_sptrsv_handle()->set_vector_size(vector_length);
         kh.get_sptrsv_handle()->print_algorithm();
         break;
+      case SYNCFREE:
+        kh.create_sptrsv_handle(SPTRSVAlgorithm::SYNCFREE, nrows, is_lower_tri);
+        kh.get_sptrsv_handle()->print_algorithm();
+        break;
+      case JACOBI_SWEEPS:
+        printf("num_jacobi_sweeps %d\n", num_jacobi_sweeps);
+        kh.create_sptrsv_handle(SPTRSVAlgorithm::JACOBI_SWEEPS, nrows, is_lower_tri);
+        kh.get_sptrsv_handle()->set_num_jacobi_sweeps(num_jacobi_sweeps);
+        kh.get_sptrsv_handle()->print_algorithm();
+        break;
 /*
       case LVLSCHED_TP2:
         kh.create_sptrsv_handle(SPTRSVAlgorithm::SEQLVLSCHED_TP2, nrows, is_lower_tri);
@@ -891,7 +911,9 @@ void print_help_sptrsv() {
   printf("Options:\n");
   printf("  --test [OPTION] : Use different kernel implementations\n");
   printf("                    Options:\n");
-  printf("                      lvlrp, lvltp1, lvltp2, lvltp1chain, lvldensetp1, lvldensetp2\n\n");
+  printf("                      lvlrp, lvltp1, lvltp2, lvltp1chain, lvldensetp1, lvldensetp2\n");
+  printf("                      syncfree           (host only, no level barriers)\n");
+  printf("                      jacobi             (approximate, see -js)\n\n");
   printf("                      cusparse           (Vendor Libraries)\n\n");
   printf("  -lf [file]      : Read in Matrix Market formatted text file 'file'.\n");
   printf("  -uf [file]      : Read in Matrix Market formatted text file 'file'.\n");
@@ -901,6 +923,7 @@ void print_help_sptrsv() {
   printf("  -vl [V]         : Vector-length (i.e. how many Cuda threads are a Kokkos 'thread').\n");
   printf("  -ct [V]         : Chain threshold: Only has effect of lvltp1chain algorithm.\n");
   printf("  -dr [V]         : Dense row percent (as float): Only has effect of lvldensetp1 algorithm.\n");
+  printf("  -js [V]         : Number of Jacobi sweeps: Only has effect of jacobi algorithm.\n");
   printf("  --loop [LOOP]   : How many spmv to run to aggregate average time. \n");
 //  printf("  --write-lvl-freq: Write output files with number of nodes per level for each matrix and algorithm.\n");
 //  printf("  -s [N]          : generate a semi-random banded (band size 0.01xN) NxN matrix\n");
@@ -924,6 +947,7 @@ int main(int argc, char **argv)
  int loop = 1;
  int chain_threshold = 0;
  float dense_row_percent = -1.0;
+ int num_jacobi_sweeps = 1;
 // int schedule=AUTO;
 
  if(argc == 1) {
@@ -944,6 +968,12 @@ int main(int argc, char **argv)
     if((strcmp(argv[i],"lvltp1chain")==0)) {
       tests.push_back( LVLSCHED_TP1CHAIN );
     }
+    if((strcmp(argv[i],"syncfree")==0)) {
+      tests.push_back( SYNCFREE );
+    }
+    if((strcmp(argv[i],"jacobi")==0)) {
+      tests.push_back( JACOBI_SWEEPS );
+    }
     /*
     if((strcmp(argv[i],"lvltp2")==0)) {
       tests.push_back( LVLSCHED_TP2 );
@@ -963,6 +993,7 @@ int main(int argc, char **argv)
   if((strcmp(argv[i],"-vl")==0)) {vector_length=atoi(argv[++i]); continue;}
   if((strcmp(argv[i],"-ct")==0)) {chain_threshold=atoi(argv[++i]); continue;}
   if((strcmp(argv[i],"-dr")==0)) {dense_row_percent=atof(argv[++i]); continue;}
+  if((strcmp(argv[i],"-js")==0)) {num_jacobi_sweeps=atoi(argv[++i]); continue;}
   if((strcmp(argv[i],"-l")==0)) {loop=atoi(argv[++i]); continue;}
   if((strcmp(argv[i],"--offset")==0)) {idx_offset=atoi(argv[++i]); continue;}
   if((strcmp(argv[i],"--loop")==0)) {loop=atoi(argv[++i]); continue;}
@@ -996,7 +1027,7 @@ int main(int argc, char **argv)
 
  Kokkos::initialize(argc,argv);
  {
-   int total_errors = test_sptrsv_perf(tests, lfilename, ufilename, team_size, vector_length, idx_offset, loop, chain_threshold, dense_row_percent);
+   int total_errors = test_sptrsv_perf(tests, lfilename, ufilename, team_size, vector_length, idx_offset, loop, chain_threshold, dense_row_percent, num_jacobi_sweeps);
 
    if(total_errors == 0)
    printf("Kokkos::SPTRSV Test: Passed\n");
@@ -69,7 +69,8 @@ enum {CUSPARSE, SUPERNODAL_NAIVE, SUPERNODAL_ETREE, SUPERNODAL_DAG, SUPERNODAL_S
 /* ========================================================================================= */
 template<typename scalar_type>
 int test_sptrsv_perf (std::vector<int> tests, bool verbose, std::string& lower_filename, std::string& upper_filename, std::string& supernode_filename,
-                      bool merge, bool invert_offdiag, bool u_in_csr, int loop) {
+                      bool merge, bool invert_offdiag, bool u_in_csr, int loop,
+                      int relax_size, double relax_ratio) {
 
   using ordinal_type = int;
   using size_type    = int;
@@ -107,7 +108,8 @@ int test_sptrsv_perf (std::vector<int> tests, bool verbose, std::string& lower_f
   std::cout << "Execution space: " << execution_space::name () << std::endl;
   std::cout << "Memory space   : " << memory_space::name () << std::endl;
   std::cout << std::endl;
-  if ((!lower_filename.empty() || !upper_filename.empty()) && !supernode_filename.empty())
+  if ((!lower_filename.empty() || !upper_filename.empty()) &&
+      (!supernode_filename.empty() || !lower_filename.empty()))
   {
     // ==============================================
     // read the CRS matrix ** on host **
@@ -165,23 +167,35 @@ int test_sptrsv_perf (std::vector<int> tests, bool verbose, std::string& lower_f
       A = T; // original L was in CSC, so transposed L in CSR
       L = M; // original L in CSC
     }
-    // read supernode sizes from a file
-    // first entry in the file specifies the number of supernode
-    // the rest of the entries specifies the column offsets to the beginning of supernodes
-    std::cout << " > Read a supernode filename " << supernode_filename << std::endl;
-    std::ifstream fp(supernode_filename.c_str(), std::ios::in);
-    if (!fp.is_open()) {
-      std::cout << std::endl << " failed to open " << supernode_filename << std::endl <<std::endl;
-      return 0;
-    }
     int nsuper;
-    fp >> nsuper;
-    Kokkos::View<int*, Kokkos::HostSpace> supercols ("supercols", 1+nsuper);
+    Kokkos::View<int*, Kokkos::HostSpace> supercols;
+    Kokkos::View<int*, Kokkos::HostSpace> etree_view;
     int *etree = NULL;
-    for (int i = 0; i <= nsuper; i++) {
-      fp >> supercols (i);
+    if (!supernode_filename.empty()) {
+      // read supernode sizes from a file
+      // first entry in the file specifies the number of supernode
+      // the rest of the entries specifies the column offsets to the beginning of supernodes
+      std::cout << " > Read a supernode filename " << supernode_filename << std::endl;
+      std::ifstream fp(supernode_filename.c_str(), std::ios::in);
+      if (!fp.is_open()) {
+        std::cout << std::endl << " failed to open " << supernode_filename << std::endl <<std::endl;
+        return 0;
+      }
+      fp >> nsuper;
+      supercols = Kokkos::View<int*, Kokkos::HostSpace> ("supercols", 1+nsuper);
+      for (int i = 0; i <= nsuper; i++) {
+        fp >> supercols (i);
+      }
+      fp.close();
+    } else {
+      // detect supernodes and etree of L (in CSR), and store L by supernodal blocks in CSC
+      Kokkos::Timer tic;
+      L = detect_supernodes (A, nsuper, supercols, etree_view, relax_size, relax_ratio);
+      etree = etree_view.data ();
+      std::cout << " > Detect supernodes: " << nsuper << " supernodes, "
+                << A.nnz () << " -> " << L.nnz () << " nonzeros (" << tic.seconds () << " seconds)"
+                << std::endl;
     }
-    fp.close();
 
     Kokkos::Timer timer;
     // ==============================================
@@ -204,10 +218,18 @@ int test_sptrsv_perf (std::vector<int> tests, bool verbose, std::string& lower_f
             std::cout << " > create handle for SUPERNODAL_NAIVE" << std::endl << std::endl;
             khL.create_sptrsv_handle (SPTRSVAlgorithm::SUPERNODAL_NAIVE, nrows, true);
             khU.create_sptrsv_handle (SPTRSVAlgorithm::SUPERNODAL_NAIVE, nrows, true);
+          } else if (test == SUPERNODAL_ETREE) {
+            std::cout << " > create handle for SUPERNODAL_ETREE" << std::endl << std::endl;
+            khL.create_sptrsv_handle (SPTRSVAlgorithm::SUPERNODAL_ETREE, nrows, true);
+            khU.create_sptrsv_handle (SPTRSVAlgorithm::SUPERNODAL_ETREE, nrows, true);
           } else if (test == SUPERNODAL_DAG) {
             std::cout << " > create handle for SUPERNODAL_DAG" << std::endl << std::endl;
             khL.create_sptrsv_handle (SPTRSVAlgorithm::SUPERNODAL_DAG, nrows, true);
             khU.create_sptrsv_handle (SPTRSVAlgorithm::SUPERNODAL_DAG, nrows, true);
+          } else if (test == SUPERNODAL_SPMV) {
+            std::cout << " > create handle for SUPERNODAL_SPMV" << std::endl << std::endl;
+            khL.create_sptrsv_handle (SPTRSVAlgorithm::SUPERNODAL_SPMV, nrows, true);
+            khU.create_sptrsv_handle (SPTRSVAlgorithm::SUPERNODAL_SPMV, nrows, true);
           } else if (test == SUPERNODAL_SPMV_DAG) {
             std::cout << " > create handle for SUPERNODAL_SPMV_DAG" << std::endl << std::endl;
             khL.create_sptrsv_handle (SPTRSVAlgorithm::SUPERNODAL_SPMV_DAG, nrows, true);
@@ -312,10 +334,14 @@ void print_help_sptrsv() {
   printf("Options:\n");
   printf("  --test [OPTION] : Use different kernel implementations\n");
   printf("                    Options:\n");
-  printf("                    superlu-naive, superlu-dag, superlu-spmv-dag\n\n");
+  printf("                    superlu-naive, superlu-dag, superlu-spmv-dag\n");
+  printf("                    superlu-etree, superlu-spmv (need the etree, i.e., no -sf)\n\n");
   printf("  -lf [file]      : Read in Lower-triangular matrix in Matrix Market formatted text file 'file'.\n");
   printf("  -uf [file]      : Read in Upper-triangular matrix in Matrix Market formatted text file 'file'.\n");
   printf("  -sf [file]      : Read in Supernode sizes from 'file'.\n");
+  printf("                    Without it, supernodes and etree are detected from the -lf matrix.\n");
+  printf("  --relax-size [S]: Supernodes of up to S columns are always amalgamated (default 4).\n");
+  printf("  --relax-ratio [R]: Otherwise, allow up to R explicit zeros per nonzero (default 0.2).\n");
   printf("  --loop [LOOP]   : How many spmv to run to aggregate average time. \n");
 }
 
@@ -327,6 +353,9 @@ int main(int argc, char **argv) {
   std::string supernode_filename;
 
   int loop = 1;
+  // relaxed amalgamation, when supernodes are detected
+  int relax_size = 4;
+  double relax_ratio = 0.2;
   // merge supernodes
   bool merge = false;
   // invert off-diagonal of L-factor
@@ -348,9 +377,15 @@ int main(int argc, char **argv) {
       if((strcmp(argv[i],"superlu-naive")==0)) {
         tests.push_back( SUPERNODAL_NAIVE );
       }
+      if((strcmp(argv[i],"superlu-etree")==0)) {
+        tests.push_back( SUPERNODAL_ETREE );
+      }
       if((strcmp(argv[i],"superlu-dag")==0)) {
         tests.push_back( SUPERNODAL_DAG );
       }
+      if((strcmp(argv[i],"superlu-spmv")==0)) {
+        tests.push_back( SUPERNODAL_SPMV );
+      }
       if((strcmp(argv[i],"superlu-spmv-dag")==0)) {
         tests.push_back( SUPERNODAL_SPMV_DAG );
       }
@@ -379,6 +414,14 @@ int main(int argc, char **argv) {
       loop = atoi(argv[++i]);
       continue;
     }
+    if((strcmp(argv[i],"--relax-size")==0)) {
+      relax_size = atoi(argv[++i]);
+      continue;
+    }
+    if((strcmp(argv[i],"--relax-ratio")==0)) {
+      relax_ratio = atof(argv[++i]);
+      continue;
+    }
     /* not supported through this interface, yet
      *  if((strcmp(argv[i],"--merge")==0)) {
       merge = true;
@@ -408,7 +451,8 @@ int main(int argc, char **argv) {
     //using scalar_t = Kokkos::complex<double>;
     Kokkos::ScopeGuard kokkosScope (argc, argv);
     int total_errors = test_sptrsv_perf<scalar_t> (tests, verbose, lower_filename, upper_filename, supernode_filename,
-                                                   merge, invert_offdiag, u_in_csr, loop);
+                                                   merge, invert_offdiag, u_in_csr, loop,
+                                                   relax_size, relax_ratio);
     if(total_errors == 0)
       std::cout << "Kokkos::SPTRSV Test: Passed"
                 << std::endl << std::endl;
@@ -49,6 +49,7 @@
 #include "KokkosSparse_spadd_handle.hpp"
 #include "KokkosSparse_sptrsv_handle.hpp"
 #include "KokkosSparse_spiluk_handle.hpp"
+#include "KokkosSparse_spmv_handle.hpp"
 
 #ifndef _KOKKOSKERNELHANDLE_HPP
 #define _KOKKOSKERNELHANDLE_HPP
@@ -147,6 +148,7 @@ public:
 
     this->sptrsvHandle = right_side_handle.get_sptrsv_handle();
     this->spilukHandle = right_side_handle.get_spiluk_handle();
+    this->spmvHandle = right_side_handle.get_spmv_handle();
 
     this->team_work_size = right_side_handle.get_set_team_work_size();
     this->shared_memory_size = right_side_handle.get_shmem_size();
@@ -169,6 +171,7 @@ public:
     is_owner_of_the_spadd_handle = false;
     is_owner_of_the_sptrsv_handle = false;
     is_owner_of_the_spiluk_handle = false;
+    is_owner_of_the_spmv_handle = false;
     //return *this;
   }
 
@@ -238,6 +241,10 @@ public:
     typename KokkosSparse::Experimental::SPILUKHandle<const_size_type, const_nnz_lno_t, const_nnz_scalar_t, HandleExecSpace, HandleTempMemorySpace, HandlePersistentMemorySpace>
       SPILUKHandleType;
 
+  typedef
+    typename KokkosSparse::SPMVHandle<const_size_type, const_nnz_lno_t, const_nnz_scalar_t, HandleExecSpace, HandleTempMemorySpace, HandlePersistentMemorySpace>
+      SPMVHandleType;
+
 private:
 
   GraphColoringHandleType *gcHandle;
@@ -254,6 +261,7 @@ private:
   SPADDHandleType *spaddHandle;
   SPTRSVHandleType *sptrsvHandle;
   SPILUKHandleType *spilukHandle;
+  SPMVHandleType *spmvHandle;
 
   int team_work_size;
   size_t shared_memory_size;
@@ -276,6 +284,7 @@ private:
   bool is_owner_of_the_spadd_handle;
   bool is_owner_of_the_sptrsv_handle;
   bool is_owner_of_the_spiluk_handle;
+  bool is_owner_of_the_spmv_handle;
 
 public:
 
@@ -291,6 +300,7 @@ public:
     , spaddHandle(NULL)
     , sptrsvHandle(NULL)
     , spilukHandle(NULL)
+    , spmvHandle(NULL)
     , team_work_size(-1)
     , shared_memory_size(16128)
     , suggested_team_size(-1)
@@ -309,6 +319,7 @@ public:
     , is_owner_of_the_spadd_handle(true)
     , is_owner_of_the_sptrsv_handle(true)
     , is_owner_of_the_spiluk_handle(true)
+    , is_owner_of_the_spmv_handle(true)
   {}
 
   ~KokkosKernelsHandle(){
@@ -324,6 +335,7 @@ public:
     this->destroy_spadd_handle();
     this->destroy_sptrsv_handle();
     this->destroy_spiluk_handle();
+    this->destroy_spmv_handle();
   }
 
 
@@ -787,6 +799,25 @@ public:
       this->spilukHandle = nullptr;
     }
   }
+
+  SPMVHandleType *get_spmv_handle(){
+    return this->spmvHandle;
+  }
+  void create_spmv_handle(KokkosSparse::SPMVAlgorithm algm = KokkosSparse::SPMVAlgorithm::SPMV_DEFAULT) {
+    this->destroy_spmv_handle();
+    this->is_owner_of_the_spmv_handle = true;
+    this->spmvHandle = new SPMVHandleType(algm);
+    this->spmvHandle->set_team_size(this->suggested_team_size);
+    this->spmvHandle->set_vector_size(this->vector_size);
+    this->spmvHandle->set_verbose(this->KKVERBOSE);
+  }
+  void destroy_spmv_handle(){
+    if (is_owner_of_the_spmv_handle && this->spmvHandle != nullptr)
+    {
+      delete this->spmvHandle;
+      this->spmvHandle = nullptr;
+    }
+  }
   
 };    // end class KokkosKernelsHandle
 
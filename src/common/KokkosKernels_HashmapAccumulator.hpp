@@ -45,6 +45,7 @@
 #define _KOKKOSKERNELS_HASHMAPACCUMULATOR_HPP
 #include <Kokkos_Atomic.hpp>
 #include <atomic>
+#include "KokkosKernels_Semiring.hpp"
 
 namespace KokkosKernels {
 
@@ -301,6 +302,8 @@ struct HashmapAccumulator
   //function to be called from device.
   //Insertion is sequential, no race condition for the insertion.
   //the mergeadd used in the numeric of KKMEM.
+  //values of the same key are merged with Semiring::add.
+  template <typename Semiring = PlusTimesSemiring<value_type> >
   KOKKOS_INLINE_FUNCTION
   int sequential_insert_into_hash_mergeAdd_TrackHashes (
       size_type hash,
@@ -316,7 +319,7 @@ struct HashmapAccumulator
     size_type i = hash_begins[hash];
     for (; i != -1; i = hash_nexts[i]) {
       if (keys[i] == key) {
-        values[i] = values[i] + value;
+        values[i] = Semiring::add(values[i], value);
         return INSERT_SUCCESS;
       }
     }
@@ -377,7 +380,8 @@ struct HashmapAccumulator
   //insertions will have the same key.
   //Insertion is simulteanous for the vector lanes of a thread.
   //used_size should be a shared pointer among the thread vectors
-  template <typename team_member_t>
+  //values of the same key are merged with Semiring::add.
+  template <typename Semiring = PlusTimesSemiring<value_type>, typename team_member_t>
   KOKKOS_INLINE_FUNCTION
   int vector_atomic_insert_into_hash_mergeAdd_TrackHashes (
       const team_member_t & /* teamMember */,
@@ -398,7 +402,7 @@ struct HashmapAccumulator
 
       for (; i != -1; i = hash_nexts[i]) {
         if (keys[i] == key) {
-          values[i] = values[i] + value;
+          values[i] = Semiring::add(values[i], value);
           return INSERT_SUCCESS;
         }
       }
@@ -446,7 +450,8 @@ struct HashmapAccumulator
   //insertions will have the same key.
   //Insertion is simulteanous for the vector lanes of a thread.
   //used_size should be a shared pointer among the thread vectors
-  template <typename team_member_t>
+  //values of the same key are merged with Semiring::add.
+  template <typename Semiring = PlusTimesSemiring<value_type>, typename team_member_t>
   KOKKOS_INLINE_FUNCTION
   int vector_atomic_insert_into_hash_mergeAdd (
       const team_member_t & /* teamMember */,
@@ -461,7 +466,7 @@ struct HashmapAccumulator
       size_type i = hash_begins[hash];
       for (; i != -1; i = hash_nexts[i]) {
         if (keys[i] == key) {
-          values[i] = values[i] + value;
+          values[i] = Semiring::add(values[i], value);
           return INSERT_SUCCESS;
         }
       }
@@ -0,0 +1,221 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef _KOKKOSKERNELS_SEMIRING_HPP
+#define _KOKKOSKERNELS_SEMIRING_HPP
+
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+
+namespace KokkosKernels {
+
+namespace Experimental {
+
+/**
+ * Semirings for the sparse kernels that take one.
+ * A semiring provides the additive identity zero(), the multiplicative
+ * identity one(), and the two operations add and multiply.
+ * The kernels compute sum_k add(multiply(A(i,k), x(k))), starting from zero().
+ * Kernels that take one: spmv_semiring, the masked SpGEMM (spgemm_masked)
+ * and the KKMEM numeric kernels (spgemm_semiring).
+ */
+
+//the usual arithmetic; what the kernels do without a semiring.
+template <typename scalar_t>
+struct PlusTimesSemiring
+{
+  typedef scalar_t value_type;
+
+  KOKKOS_INLINE_FUNCTION
+  static value_type zero() { return Kokkos::Details::ArithTraits<value_type>::zero(); }
+  KOKKOS_INLINE_FUNCTION
+  static value_type one() { return Kokkos::Details::ArithTraits<value_type>::one(); }
+  KOKKOS_INLINE_FUNCTION
+  static value_type add(const value_type &a, const value_type &b) { return a + b; }
+  KOKKOS_INLINE_FUNCTION
+  static value_type multiply(const value_type &a, const value_type &b) { return a * b; }
+};
+
+//tropical semiring; shortest paths. zero() is the largest value of the type.
+template <typename scalar_t>
+struct MinPlusSemiring
+{
+  typedef scalar_t value_type;
+
+  KOKKOS_INLINE_FUNCTION
+  static value_type zero() { return Kokkos::Details::ArithTraits<value_type>::max(); }
+  KOKKOS_INLINE_FUNCTION
+  static value_type one() { return Kokkos::Details::ArithTraits<value_type>::zero(); }
+  KOKKOS_INLINE_FUNCTION
+  static value_type add(const value_type &a, const value_type &b) { return b < a ? b : a; }
+  KOKKOS_INLINE_FUNCTION
+  static value_type multiply(const value_type &a, const value_type &b) {
+    //keep the unreachable value from overflowing.
+    const value_type inf = zero();
+    return (a == inf || b == inf) ? inf : value_type(a + b);
+  }
+};
+
+//max-times on nonnegative values; Viterbi, most reliable paths.
+template <typename scalar_t>
+struct MaxTimesSemiring
+{
+  typedef scalar_t value_type;
+
+  KOKKOS_INLINE_FUNCTION
+  static value_type zero() { return Kokkos::Details::ArithTraits<value_type>::zero(); }
+  KOKKOS_INLINE_FUNCTION
+  static value_type one() { return Kokkos::Details::ArithTraits<value_type>::one(); }
+  KOKKOS_INLINE_FUNCTION
+  static value_type add(const value_type &a, const value_type &b) { return a < b ? b : a; }
+  KOKKOS_INLINE_FUNCTION
+  static value_type multiply(const value_type &a, const value_type &b) { return a * b; }
+};
+
+//boolean semiring; BFS frontiers, reachability. Any nonzero value is true,
+//results are zero or one.
+template <typename scalar_t>
+struct OrAndSemiring
+{
+  typedef scalar_t value_type;
+
+  KOKKOS_INLINE_FUNCTION
+  static value_type zero() { return Kokkos::Details::ArithTraits<value_type>::zero(); }
+  KOKKOS_INLINE_FUNCTION
+  static value_type one() { return Kokkos::Details::ArithTraits<value_type>::one(); }
+  KOKKOS_INLINE_FUNCTION
+  static value_type add(const value_type &a, const value_type &b) {
+    return (a != zero() || b != zero()) ? one() : zero();
+  }
+  KOKKOS_INLINE_FUNCTION
+  static value_type multiply(const value_type &a, const value_type &b) {
+    return (a != zero() && b != zero()) ? one() : zero();
+  }
+};
+
+/**
+ * Atomic dest = Semiring::add(dest, val), for kernels whose threads merge
+ * into the same accumulator. Plus-times is an atomic_add, the others a
+ * compare-and-exchange loop.
+ */
+template <typename Semiring>
+struct SemiringAtomic
+{
+  typedef typename Semiring::value_type value_type;
+
+  KOKKOS_INLINE_FUNCTION
+  static void add(value_type *dest, const value_type &val) {
+    value_type old = *dest, assumed;
+    do {
+      assumed = old;
+      old = Kokkos::atomic_compare_exchange(dest, assumed, Semiring::add(assumed, val));
+    } while (!(old == assumed));
+  }
+};
+
+template <typename scalar_t>
+struct SemiringAtomic<PlusTimesSemiring<scalar_t> >
+{
+  KOKKOS_INLINE_FUNCTION
+  static void add(scalar_t *dest, const scalar_t &val) {
+    Kokkos::atomic_add(dest, val);
+  }
+};
+
+/**
+ * Kokkos reducer that joins with Semiring::add and starts from Semiring::zero(),
+ * so nested parallel_reduce calls work for any semiring. The result lives in
+ * the memory space of ExecSpace.
+ */
+template <typename Semiring, typename ExecSpace>
+struct SemiringReducer
+{
+public:
+  typedef SemiringReducer reducer;
+  typedef typename std::remove_cv<typename Semiring::value_type>::type value_type;
+  typedef Kokkos::View<value_type, typename ExecSpace::memory_space, Kokkos::MemoryUnmanaged> result_view_type;
+
+private:
+  value_type &value;
+
+public:
+  KOKKOS_INLINE_FUNCTION
+  SemiringReducer(value_type &value_): value(value_) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void join(value_type &dest, const value_type &src) const {
+    dest = Semiring::add(dest, src);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void join(volatile value_type &dest, const volatile value_type &src) const {
+    const value_type d = dest, s = src;
+    dest = Semiring::add(d, s);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void init(value_type &val) const {
+    val = Semiring::zero();
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  value_type &reference() const {
+    return value;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  result_view_type view() const {
+    return result_view_type(&value);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  bool references_scalar() const {
+    return true;
+  }
+};
+
+}
+}
+
+#endif
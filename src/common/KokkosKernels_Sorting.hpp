@@ -235,6 +235,72 @@ SerialRadixSort2(ValueType* values, ValueType* valuesAux, PermType* perm, PermTy
   }
 }
 
+//In-place sort of keys, carrying values along (values may be NULL), on a single thread.
+//Insertion sort for short arrays, heapsort otherwise.
+//Pros: no auxiliary storage, O(n log n) worst case, so it can sort a row of a sparse matrix where it is written.
+//Con: not stable; heapsort is not cache friendly on long arrays.
+template<typename Ordinal, typename KeyType, typename ValueType>
+KOKKOS_INLINE_FUNCTION void
+SerialSortKeysValues(KeyType* keys, ValueType* values, Ordinal n)
+{
+  if(n <= 16)
+  {
+    for(Ordinal i = 1; i < n; i++)
+    {
+      const KeyType key = keys[i];
+      const ValueType val = values ? values[i] : ValueType();
+      Ordinal j = i;
+      for(; j > 0 && key < keys[j - 1]; j--)
+      {
+        keys[j] = keys[j - 1];
+        if(values) values[j] = values[j - 1];
+      }
+      keys[j] = key;
+      if(values) values[j] = val;
+    }
+    return;
+  }
+  //heapsort: build a max-heap, then move the max to the end n-1 times.
+  for(Ordinal start = n / 2; start > 0; )
+  {
+    start--;
+    for(Ordinal root = start; 2 * root + 1 < n; )
+    {
+      Ordinal child = 2 * root + 1;
+      if(child + 1 < n && keys[child] < keys[child + 1]) child++;
+      if(!(keys[root] < keys[child])) break;
+      const KeyType tk = keys[root]; keys[root] = keys[child]; keys[child] = tk;
+      if(values)
+      {
+        const ValueType tv = values[root]; values[root] = values[child]; values[child] = tv;
+      }
+      root = child;
+    }
+  }
+  for(Ordinal end = n - 1; end > 0; end--)
+  {
+    {
+      const KeyType tk = keys[0]; keys[0] = keys[end]; keys[end] = tk;
+      if(values)
+      {
+        const ValueType tv = values[0]; values[0] = values[end]; values[end] = tv;
+      }
+    }
+    for(Ordinal root = 0; 2 * root + 1 < end; )
+    {
+      Ordinal child = 2 * root + 1;
+      if(child + 1 < end && keys[child] < keys[child + 1]) child++;
+      if(!(keys[root] < keys[child])) break;
+      const KeyType tk = keys[root]; keys[root] = keys[child]; keys[child] = tk;
+      if(values)
+      {
+        const ValueType tv = values[root]; values[root] = values[child]; values[child] = tv;
+      }
+      root = child;
+    }
+  }
+}
+
 template<typename Value>
 struct DefaultComparator
 {
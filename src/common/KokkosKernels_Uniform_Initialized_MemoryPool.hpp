@@ -52,7 +52,37 @@ namespace KokkosKernels{
 
 namespace Impl{
 
+/**
+ * \brief Initializes a pool chunk by chunk so that each chunk is first touched
+ * by the thread (and so the NUMA domain) that OneThread2OneChunk later gives it
+ * to. It runs num_set_chunks iterations with a static schedule, so iteration t
+ * lands on thread t and touches chunk t. The chunks past num_set_chunks,
+ * which only exist to round the pool to a power of two, are touched by
+ * iteration t in steps of num_set_chunks.
+ */
+template <typename data_type>
+struct PoolFirstTouchFunctor{
+  data_type *data;
+  size_t chunk_size;
+  size_t num_set_chunks;
+  size_t num_chunks;
+  data_type value;
 
+  PoolFirstTouchFunctor(data_type *data_, size_t chunk_size_, size_t num_set_chunks_,
+                        size_t num_chunks_, data_type value_):
+    data(data_), chunk_size(chunk_size_), num_set_chunks(num_set_chunks_),
+    num_chunks(num_chunks_), value(value_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const size_t t) const {
+    for (size_t chunk = t; chunk < num_chunks; chunk += num_set_chunks){
+      data_type *chunk_data = data + chunk * chunk_size;
+      for (size_t i = 0; i < chunk_size; ++i){
+        chunk_data[i] = value;
+      }
+    }
+  }
+};
 
 enum PoolType {OneThread2OneChunk, ManyThread2OneChunk};
 
@@ -175,12 +205,17 @@ public:
    * \param chunk_size_: chunk size, the size of each allocation.
    * \param initialized_value: the value to initialize
    * \param pool_type_: whether ManyThread2OneChunk or OneThread2OneChunk
+   * \param initialize: whether to set the pool to initialized_value.
+   * \param first_touch: initialize chunk i from the thread that runs iteration i
+   * of a static schedule over num_chunks_ iterations, instead of a flat deep_copy. On multi-socket hosts this
+   * places each chunk in the NUMA domain of the thread that uses it.
    */
   UniformMemoryPool(const size_t num_chunks_,
                     const size_t set_chunk_size_,
                     const data_type initialized_value = 0,
                     const PoolType pool_type_ = OneThread2OneChunk,
-					bool initialize = true):
+					bool initialize = true,
+                    bool first_touch = false):
                       num_chunks(1),
                     num_set_chunks(num_chunks_), modular_num_chunks(0),
                     chunk_size(set_chunk_size_),
@@ -209,7 +244,16 @@ public:
     this->set_pool_type(pool_type_);
 
     if (initialize){
+      if (first_touch && num_set_chunks > 0){
+        typedef typename data_view_t::execution_space pool_exec_space;
+        Kokkos::parallel_for("KokkosKernels::UniformMemoryPool::FirstTouch",
+            Kokkos::RangePolicy<pool_exec_space, Kokkos::Schedule<Kokkos::Static> >(0, num_set_chunks),
+            PoolFirstTouchFunctor<data_type>(data, chunk_size, num_set_chunks, num_chunks, initialized_value));
+        pool_exec_space().fence();
+      }
+      else {
     	Kokkos::deep_copy(data_view, initialized_value);
+      }
     }
 
   }
@@ -170,7 +170,8 @@ namespace Impl {
 									\
     using coefficient_type = typename YVector::non_const_value_type;	\
 									\
-    static void spmv (const char mode[],				\
+    static void spmv (const SPMVPlan& /* plan */,			\
+		      const char mode[],				\
 		      const coefficient_type& alpha,			\
 		      const AMatrix& A,					\
 		      const XVector& x,					\
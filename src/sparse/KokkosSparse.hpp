@@ -53,10 +53,16 @@
 /// transpose).  If beta == 0, ignore and overwrite the initial
 /// entries of y; if alpha == 0, ignore the entries of A and x.
 ///
+/// KokkosSparse::spmv_dot and KokkosSparse::spmv_axpby_nrm2 fuse
+/// spmv with a dot product or a 2-norm of the result.
+/// KokkosSparse::spmv_powers computes [x, A*x, ..., A^s*x].
+///
 /// KokkosSparse::trsv implements local sparse triangular solve.
 /// It solves Ax=b, where A is either upper or lower triangular.
 #include "KokkosSparse_CrsMatrix.hpp"
 #include "KokkosSparse_spmv.hpp"
+#include "KokkosSparse_spmv_fused.hpp"
+#include "KokkosSparse_spmv_powers.hpp"
 #include "KokkosSparse_trsv.hpp"
 #include "KokkosSparse_spgemm.hpp"
 #include "KokkosSparse_gauss_seidel.hpp"
@@ -0,0 +1,364 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+/// \file KokkosSparse_CompressedCrsMatrix.hpp
+/// \brief Local sparse matrix with reduced-precision values and
+///   16-bit column indices
+///
+/// This file provides KokkosSparse::Experimental::CompressedCrsMatrix.
+/// It stores the same entries as a KokkosSparse::CrsMatrix, but with
+/// fewer bytes per entry, for memory-bound sparse matrix-vector
+/// multiply (see KokkosSparse::spmv).
+
+#ifndef KOKKOS_SPARSE_COMPRESSEDCRSMATRIX_HPP_
+#define KOKKOS_SPARSE_COMPRESSEDCRSMATRIX_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace KokkosSparse {
+
+namespace Experimental {
+
+/// \class CompressedRowViewConst
+/// \brief Const view of a row of a CompressedCrsMatrix.
+///
+/// Provides the same interface as SparseRowViewConst (\c length,
+/// \c value(i), \c colidx(i)), so that the row-based SpMV kernels can
+/// be used with a CompressedCrsMatrix.  Values and column indices are
+/// decompressed on access and returned by value.
+template<class MatrixType>
+struct CompressedRowViewConst {
+  typedef typename MatrixType::non_const_value_type value_type;
+  typedef typename MatrixType::non_const_ordinal_type ordinal_type;
+  typedef typename MatrixType::storage_value_type storage_value_type;
+
+private:
+  const storage_value_type* values_;
+  const uint16_t* offsets_;
+  const ordinal_type* colidx_;
+  const ordinal_type base_;
+
+public:
+  KOKKOS_INLINE_FUNCTION
+  CompressedRowViewConst (const storage_value_type* values,
+                          const uint16_t* offsets,
+                          const ordinal_type* colidx__,
+                          const ordinal_type base,
+                          const ordinal_type count) :
+    values_ (values), offsets_ (offsets), colidx_ (colidx__),
+    base_ (base), length (count)
+  {}
+
+  //! Number of entries in the row.
+  const ordinal_type length;
+
+  //! Value of entry i in this row, in the full precision type.
+  KOKKOS_INLINE_FUNCTION
+  value_type value (const ordinal_type& i) const {
+    return static_cast<value_type> (values_[i]);
+  }
+
+  //! Column index of entry i in this row.
+  KOKKOS_INLINE_FUNCTION
+  ordinal_type colidx (const ordinal_type& i) const {
+    return colidx_ == nullptr ?
+      base_ + static_cast<ordinal_type> (offsets_[i]) :
+      colidx_[i];
+  }
+};
+
+/// \class CompressedCrsMatrix
+/// \brief CRS matrix with compressed values and column indices.
+/// \tparam ScalarType The type of the entries of the matrix as seen by
+///   users and kernels; products are accumulated in this type.
+/// \tparam OrdinalType The type of column indices.
+/// \tparam Device The Kokkos Device type.
+/// \tparam MemoryTraits Traits describing how Kokkos manages and
+///   accesses data.  The default parameter suffices for most users.
+/// \tparam SizeType The type of row offsets.
+/// \tparam StorageType The type in which the values are stored.  The
+///   default is ArithTraits<ScalarType>::halfPrecision, e.g. float
+///   for double.
+///
+/// Each row stores its column indices as 16-bit offsets from the
+/// smallest column index of the row (\c row_base) when they fit.
+/// Rows that span more than 2^16 columns keep full column indices in
+/// \c wide_entries instead; \c wide_offsets gives their position.
+/// For a double matrix with int indices, this cuts the bytes per
+/// entry from 12 to 6 when all rows compress.
+template<class ScalarType,
+         class OrdinalType,
+         class Device,
+         class MemoryTraits = void,
+         class SizeType = typename Kokkos::ViewTraits<OrdinalType*, Device, void, void>::size_type,
+         class StorageType = typename Kokkos::Details::ArithTraits<ScalarType>::halfPrecision>
+class CompressedCrsMatrix {
+public:
+  //! Type of the matrix's execution space.
+  typedef typename Device::execution_space execution_space;
+  //! Type of the matrix's memory space.
+  typedef typename Device::memory_space memory_space;
+  //! Type of the matrix's device type.
+  typedef Kokkos::Device<execution_space, memory_space> device_type;
+
+  //! Type of each value in the matrix, as returned by row views.
+  typedef ScalarType value_type;
+  //! Type in which the values are stored.
+  typedef StorageType storage_value_type;
+  //! Type of each (column) index in the matrix.
+  typedef OrdinalType ordinal_type;
+  typedef MemoryTraits memory_traits;
+  //! Type of each entry of the "row map."
+  typedef SizeType size_type;
+
+  typedef typename std::remove_const<value_type>::type non_const_value_type;
+  typedef typename std::add_const<non_const_value_type>::type const_value_type;
+  typedef typename std::remove_const<ordinal_type>::type non_const_ordinal_type;
+  typedef typename std::add_const<non_const_ordinal_type>::type const_ordinal_type;
+  typedef typename std::remove_const<size_type>::type non_const_size_type;
+  typedef typename std::add_const<non_const_size_type>::type const_size_type;
+
+  //! Type of the "row map" (offset of each row's data).
+  typedef Kokkos::View<const_size_type*, Kokkos::LayoutLeft, device_type, MemoryTraits> row_map_type;
+  //! Type of the stored values.
+  typedef Kokkos::View<storage_value_type*, Kokkos::LayoutLeft, device_type, MemoryTraits> values_type;
+  //! Type of the 16-bit column offsets.
+  typedef Kokkos::View<uint16_t*, Kokkos::LayoutLeft, device_type, MemoryTraits> offsets_type;
+  //! Type of full column indices and of the per-row base.
+  typedef Kokkos::View<non_const_ordinal_type*, Kokkos::LayoutLeft, device_type, MemoryTraits> index_type;
+  //! Type of the offsets into \c wide_entries.
+  typedef Kokkos::View<non_const_size_type*, Kokkos::LayoutLeft, device_type, MemoryTraits> wide_map_type;
+
+  //! Value of \c row_base for rows that store full column indices.
+  static constexpr non_const_ordinal_type wide_row = static_cast<non_const_ordinal_type> (-1);
+
+  /// \name Storage
+  //@{
+  row_map_type row_map;
+  values_type values;
+  offsets_type entry_offsets;
+  index_type row_base;
+  wide_map_type wide_offsets;
+  index_type wide_entries;
+  //@}
+
+  //! Default constructor; constructs an empty sparse matrix.
+  CompressedCrsMatrix () :
+    numRows_ (0), numCols_ (0), nnz_ (0)
+  {}
+
+  /// \brief Compress a CrsMatrix.
+  ///
+  /// \param label [in] The sparse matrix's label.
+  /// \param A [in] The CrsMatrix to compress.  It must live in the
+  ///   same memory space as this matrix.  Its row offsets are shared,
+  ///   not copied.
+  template<class CrsMatrixType>
+  CompressedCrsMatrix (const std::string& label, const CrsMatrixType& A) :
+    row_map (A.graph.row_map),
+    numRows_ (A.numRows ()),
+    numCols_ (A.numCols ()),
+    nnz_ (A.nnz ())
+  {
+    compress (label, A);
+  }
+
+  //! The number of rows in the sparse matrix.
+  KOKKOS_INLINE_FUNCTION ordinal_type numRows () const {
+    return numRows_;
+  }
+  //! The number of columns in the sparse matrix.
+  KOKKOS_INLINE_FUNCTION ordinal_type numCols () const {
+    return numCols_;
+  }
+  //! The number of stored entries in the sparse matrix.
+  KOKKOS_INLINE_FUNCTION size_type nnz () const {
+    return nnz_;
+  }
+  //! The number of entries that keep full column indices.
+  size_type numWideEntries () const {
+    return wide_entries.extent (0);
+  }
+
+  //! Return a const view of row i of the matrix.
+  KOKKOS_INLINE_FUNCTION
+  CompressedRowViewConst<CompressedCrsMatrix> rowConst (const ordinal_type i) const {
+    const size_type start = row_map(i);
+    const ordinal_type count = static_cast<ordinal_type> (row_map(i+1) - start);
+    const ordinal_type base = row_base(i);
+    if (count == 0) {
+      return CompressedRowViewConst<CompressedCrsMatrix> (nullptr, nullptr, nullptr, 0, 0);
+    }
+    if (base == wide_row) {
+      return CompressedRowViewConst<CompressedCrsMatrix>
+        (&values(start), nullptr, &wide_entries(wide_offsets(i)), 0, count);
+    }
+    return CompressedRowViewConst<CompressedCrsMatrix>
+      (&values(start), &entry_offsets(start), nullptr, base, count);
+  }
+
+private:
+  template<class CrsMatrixType>
+  void compress (const std::string& label, const CrsMatrixType& A);
+
+  ordinal_type numRows_;
+  ordinal_type numCols_;
+  size_type nnz_;
+};
+
+template<class ScalarType, class OrdinalType, class Device, class MemoryTraits, class SizeType, class StorageType>
+constexpr typename CompressedCrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType, StorageType>::non_const_ordinal_type
+CompressedCrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType, StorageType>::wide_row;
+
+namespace Impl {
+
+/// \brief Picks the base of every row and counts the entries of the
+///   rows whose column span does not fit in 16 bits.
+template<class CompressedMatrixType, class CrsMatrixType>
+struct CompressedCrsBaseFunctor {
+  typedef typename CompressedMatrixType::non_const_ordinal_type ordinal_type;
+  typedef typename CompressedMatrixType::non_const_size_type size_type;
+
+  CompressedMatrixType m_comp;
+  CrsMatrixType m_crs;
+
+  CompressedCrsBaseFunctor (const CompressedMatrixType& comp, const CrsMatrixType& crs) :
+    m_comp (comp), m_crs (crs)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ordinal_type i, size_type& update, const bool final) const
+  {
+    const size_type begin = m_crs.graph.row_map(i);
+    const size_type end = m_crs.graph.row_map(i + 1);
+    ordinal_type min_col = 0, max_col = 0;
+    if (begin < end) {
+      min_col = max_col = m_crs.graph.entries(begin);
+    }
+    for (size_type k = begin + 1; k < end; ++k) {
+      const ordinal_type col = m_crs.graph.entries(k);
+      if (col < min_col) min_col = col;
+      if (col > max_col) max_col = col;
+    }
+    const bool wide = static_cast<int64_t> (max_col) - static_cast<int64_t> (min_col) > 65535;
+    if (final) {
+      m_comp.wide_offsets(i) = update;
+      m_comp.row_base(i) = wide ? CompressedMatrixType::wide_row : min_col;
+      if (i + 1 == m_comp.numRows ()) {
+        m_comp.wide_offsets(i + 1) = update + (wide ? end - begin : 0);
+      }
+    }
+    if (wide) {
+      update += end - begin;
+    }
+  }
+};
+
+/// \brief Copies values and column indices into compressed storage.
+template<class CompressedMatrixType, class CrsMatrixType>
+struct CompressedCrsFillFunctor {
+  typedef typename CompressedMatrixType::non_const_ordinal_type ordinal_type;
+  typedef typename CompressedMatrixType::non_const_size_type size_type;
+  typedef typename CompressedMatrixType::storage_value_type storage_value_type;
+
+  CompressedMatrixType m_comp;
+  CrsMatrixType m_crs;
+
+  CompressedCrsFillFunctor (const CompressedMatrixType& comp, const CrsMatrixType& crs) :
+    m_comp (comp), m_crs (crs)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ordinal_type i) const
+  {
+    const size_type begin = m_crs.graph.row_map(i);
+    const size_type end = m_crs.graph.row_map(i + 1);
+    const ordinal_type base = m_comp.row_base(i);
+    for (size_type k = begin; k < end; ++k) {
+      m_comp.values(k) = static_cast<storage_value_type> (m_crs.values(k));
+      const ordinal_type col = m_crs.graph.entries(k);
+      if (base == CompressedMatrixType::wide_row) {
+        m_comp.entry_offsets(k) = 0;
+        m_comp.wide_entries(m_comp.wide_offsets(i) + (k - begin)) = col;
+      } else {
+        m_comp.entry_offsets(k) = static_cast<uint16_t> (col - base);
+      }
+    }
+  }
+};
+
+} // namespace Impl
+
+template<class ScalarType, class OrdinalType, class Device, class MemoryTraits, class SizeType, class StorageType>
+template<class CrsMatrixType>
+void
+CompressedCrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType, StorageType>::
+compress (const std::string& label, const CrsMatrixType& A)
+{
+  typedef Kokkos::RangePolicy<execution_space> range_policy_type;
+
+  row_base = index_type (Kokkos::ViewAllocateWithoutInitializing (label + "_row_base"), numRows_);
+  wide_offsets = wide_map_type (label + "_wide_offsets", numRows_ + 1);
+  values = values_type (Kokkos::ViewAllocateWithoutInitializing (label), nnz_);
+  entry_offsets = offsets_type (Kokkos::ViewAllocateWithoutInitializing (label + "_entry_offsets"), nnz_);
+
+  non_const_size_type num_wide = 0;
+  Kokkos::parallel_scan ("KokkosSparse::CompressedCrsMatrix::RowBase",
+                         range_policy_type (0, numRows_),
+                         Impl::CompressedCrsBaseFunctor<CompressedCrsMatrix, CrsMatrixType> (*this, A),
+                         num_wide);
+  wide_entries = index_type (Kokkos::ViewAllocateWithoutInitializing (label + "_wide_entries"), num_wide);
+
+  Kokkos::parallel_for ("KokkosSparse::CompressedCrsMatrix::Fill",
+                        range_policy_type (0, numRows_),
+                        Impl::CompressedCrsFillFunctor<CompressedCrsMatrix, CrsMatrixType> (*this, A));
+  execution_space ().fence ();
+}
+
+}} // namespace KokkosSparse::Experimental
+#endif
@@ -0,0 +1,402 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+/// \file KokkosSparse_SellCSigmaMatrix.hpp
+/// \brief Local sparse matrix in SELL-C-sigma format
+///
+/// This file provides KokkosSparse::Experimental::SellCSigmaMatrix.
+/// This implements a local (no MPI) sparse matrix stored in the
+/// "sliced ELLPACK" SELL-C-sigma format of Kreutzer et al.  It is
+/// built from a KokkosSparse::CrsMatrix and is meant for sparse
+/// matrix-vector multiply, see KokkosSparse::spmv.
+
+#ifndef KOKKOS_SPARSE_SELLCSIGMAMATRIX_HPP_
+#define KOKKOS_SPARSE_SELLCSIGMAMATRIX_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+#include <impl/Kokkos_Timer.hpp>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "KokkosKernels_ExecSpaceUtils.hpp"
+
+namespace KokkosSparse {
+
+namespace Experimental {
+
+/// \class SellCSigmaMatrix
+/// \brief Sparse matrix stored in SELL-C-sigma format.
+/// \tparam ScalarType The type of entries in the sparse matrix.
+/// \tparam OrdinalType The type of column indices in the sparse matrix.
+/// \tparam Device The Kokkos Device type.
+/// \tparam MemoryTraits Traits describing how Kokkos manages and
+///   accesses data.  The default parameter suffices for most users.
+/// \tparam SizeType The type of offsets into the entries.
+///
+/// The rows are cut into chunks of C consecutive rows.  Each chunk is
+/// padded with explicit zeros to the length of its longest row and
+/// stored column by column, so that entry j of all C rows of a chunk
+/// is contiguous in memory.  A SpMV then processes the C rows of a
+/// chunk in lockstep, which maps onto SIMD lanes on CPUs and onto
+/// coalesced loads on GPUs.
+///
+/// To limit the padding, rows are sorted by decreasing length within
+/// windows of sigma consecutive rows before they are cut into
+/// chunks.  The permutation is stored in \c row_permutation, and the
+/// SpMV scatters results back to the original row order, so x and y
+/// keep the same ordering as for the original CrsMatrix.
+template<class ScalarType,
+         class OrdinalType,
+         class Device,
+         class MemoryTraits = void,
+         class SizeType = typename Kokkos::ViewTraits<OrdinalType*, Device, void, void>::size_type>
+class SellCSigmaMatrix {
+public:
+  //! Type of the matrix's execution space.
+  typedef typename Device::execution_space execution_space;
+  //! Type of the matrix's memory space.
+  typedef typename Device::memory_space memory_space;
+  //! Type of the matrix's device type.
+  typedef Kokkos::Device<execution_space, memory_space> device_type;
+
+  //! Type of each value in the matrix.
+  typedef ScalarType value_type;
+  //! Type of each (column) index in the matrix.
+  typedef OrdinalType ordinal_type;
+  typedef MemoryTraits memory_traits;
+  //! Type of the offsets of the chunks into \c values and \c entries.
+  typedef SizeType size_type;
+
+  //! Kokkos Array type of the entries (values) in the sparse matrix.
+  typedef Kokkos::View<value_type*, Kokkos::LayoutRight, device_type, MemoryTraits> values_type;
+  //! Kokkos Array type of the column indices of the sparse matrix.
+  typedef Kokkos::View<ordinal_type*, Kokkos::LayoutRight, device_type, MemoryTraits> index_type;
+  //! Kokkos Array type of the chunk offsets.
+  typedef Kokkos::View<size_type*, Kokkos::LayoutRight, device_type, MemoryTraits> chunk_map_type;
+  //! Const version of the type of the entries in the sparse matrix.
+  typedef typename values_type::const_value_type const_value_type;
+  //! Nonconst version of the type of the entries in the sparse matrix.
+  typedef typename values_type::non_const_value_type non_const_value_type;
+  //! Const version of the type of column indices in the sparse matrix.
+  typedef typename index_type::const_value_type const_ordinal_type;
+  //! Nonconst version of the type of column indices in the sparse matrix.
+  typedef typename index_type::non_const_value_type non_const_ordinal_type;
+  //! Const version of the type of the chunk offsets.
+  typedef typename chunk_map_type::const_value_type const_size_type;
+  //! Nonconst version of the type of the chunk offsets.
+  typedef typename chunk_map_type::non_const_value_type non_const_size_type;
+
+  /// \name Storage of the sparsity structure and values.
+  ///
+  /// Entry j of row r (0 <= r < C) of chunk c is stored at
+  /// chunk_offsets(c) + j * C + r in \c values and \c entries, for
+  /// 0 <= j < chunk_lengths(c).  Row r of chunk c is row
+  /// row_permutation(c * C + r) of the original matrix; padding rows
+  /// in the last chunk have row_permutation == numRows ().
+  //@{
+  values_type values;
+  index_type entries;
+  chunk_map_type chunk_offsets;
+  index_type chunk_lengths;
+  index_type row_permutation;
+  //@}
+
+  //! Default constructor; constructs an empty sparse matrix.
+  SellCSigmaMatrix () :
+    numRows_ (0), numCols_ (0), nnz_ (0),
+    chunkHeight_ (default_chunk_height ()), sigma_ (1),
+    conversionTime_ (0.0)
+  {}
+
+  //! Copy constructor (shallow copy).
+  template<typename SType,
+           typename OType,
+           class DType,
+           class MTType,
+           typename IType>
+  SellCSigmaMatrix (const SellCSigmaMatrix<SType,OType,DType,MTType,IType> & B) :
+    values (B.values),
+    entries (B.entries),
+    chunk_offsets (B.chunk_offsets),
+    chunk_lengths (B.chunk_lengths),
+    row_permutation (B.row_permutation),
+    numRows_ (B.numRows ()),
+    numCols_ (B.numCols ()),
+    nnz_ (B.nnz ()),
+    chunkHeight_ (B.chunkHeight ()),
+    sigma_ (B.sigma ()),
+    conversionTime_ (B.conversionTime ())
+  {}
+
+  /// \brief Convert a CrsMatrix to SELL-C-sigma format.
+  ///
+  /// The time spent in the conversion is available through
+  /// conversionTime (), so that it can be reported separately from
+  /// the time spent in SpMV.
+  ///
+  /// \param label [in] The sparse matrix's label.
+  /// \param A [in] The CrsMatrix to convert.  It must live in the same
+  ///   memory space as this matrix.
+  /// \param chunkHeight [in] C, the number of rows per chunk.  The
+  ///   default matches the SIMD width of the host, or the warp size
+  ///   on CUDA.
+  /// \param sigma [in] Size of the window in which rows are sorted by
+  ///   length.  1 means no sorting; the default is 8 * C.
+  template<class CrsMatrixType>
+  SellCSigmaMatrix (const std::string& label,
+                    const CrsMatrixType& A,
+                    const ordinal_type chunkHeight = default_chunk_height (),
+                    const ordinal_type sigma = 0) :
+    numRows_ (A.numRows ()),
+    numCols_ (A.numCols ()),
+    nnz_ (A.nnz ()),
+    chunkHeight_ (chunkHeight),
+    sigma_ (sigma > 0 ? sigma : 8 * chunkHeight),
+    conversionTime_ (0.0)
+  {
+    if (chunkHeight_ < 1 || chunkHeight_ > max_chunk_height) {
+      std::ostringstream os;
+      os << "KokkosSparse::Experimental::SellCSigmaMatrix: chunk height "
+         << chunkHeight_ << " must be between 1 and " << max_chunk_height;
+      throw std::runtime_error (os.str ());
+    }
+    Kokkos::Impl::Timer timer;
+    convert (label, A);
+    conversionTime_ = timer.seconds ();
+  }
+
+  /// \brief Largest supported chunk height.
+  ///
+  /// The SpMV kernel keeps one accumulator per row of a chunk, so C
+  /// is bounded.
+  static constexpr ordinal_type max_chunk_height = 32;
+
+  //! Default chunk height C for this value type and execution space.
+  static ordinal_type default_chunk_height () {
+    if (KokkosKernels::Impl::kk_get_exec_space_type<execution_space> () ==
+        KokkosKernels::Impl::Exec_CUDA) {
+      return 32;
+    }
+#if defined(__AVX512F__)
+    const int simd_bytes = 64;
+#elif defined(__AVX__) || defined(__AVX2__)
+    const int simd_bytes = 32;
+#else
+    const int simd_bytes = 16;
+#endif
+    const int width = simd_bytes / static_cast<int> (sizeof (value_type));
+    return width < 1 ? 1 : std::min<ordinal_type> (width, max_chunk_height);
+  }
+
+  //! The number of rows in the sparse matrix.
+  KOKKOS_INLINE_FUNCTION ordinal_type numRows () const {
+    return numRows_;
+  }
+  //! The number of columns in the sparse matrix.
+  KOKKOS_INLINE_FUNCTION ordinal_type numCols () const {
+    return numCols_;
+  }
+  //! The number of stored entries of the original matrix (no padding).
+  KOKKOS_INLINE_FUNCTION size_type nnz () const {
+    return nnz_;
+  }
+  //! The number of stored entries, including padding.
+  KOKKOS_INLINE_FUNCTION size_type numStoredEntries () const {
+    return values.extent (0);
+  }
+  //! The number of rows per chunk (C).
+  KOKKOS_INLINE_FUNCTION ordinal_type chunkHeight () const {
+    return chunkHeight_;
+  }
+  //! The number of chunks.
+  KOKKOS_INLINE_FUNCTION ordinal_type numChunks () const {
+    return static_cast<ordinal_type> (chunk_lengths.extent (0));
+  }
+  //! The size of the row sorting window (sigma).
+  KOKKOS_INLINE_FUNCTION ordinal_type sigma () const {
+    return sigma_;
+  }
+  //! Seconds spent converting from CrsMatrix in the constructor.
+  double conversionTime () const {
+    return conversionTime_;
+  }
+
+private:
+  template<class CrsMatrixType>
+  void convert (const std::string& label, const CrsMatrixType& A);
+
+  ordinal_type numRows_;
+  ordinal_type numCols_;
+  size_type nnz_;
+  ordinal_type chunkHeight_;
+  ordinal_type sigma_;
+  double conversionTime_;
+};
+
+template<class ScalarType, class OrdinalType, class Device, class MemoryTraits, class SizeType>
+constexpr OrdinalType
+SellCSigmaMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType>::max_chunk_height;
+
+namespace Impl {
+
+/// \brief Copies the rows of a CrsMatrix into the chunks of a
+///   SellCSigmaMatrix, one work item per (padded) row.
+template<class SellMatrixType, class CrsMatrixType>
+struct SellCSigmaFillFunctor {
+  typedef typename SellMatrixType::ordinal_type ordinal_type;
+  typedef typename SellMatrixType::size_type size_type;
+  typedef typename SellMatrixType::value_type value_type;
+
+  SellMatrixType m_sell;
+  CrsMatrixType m_crs;
+
+  SellCSigmaFillFunctor (const SellMatrixType& sell, const CrsMatrixType& crs) :
+    m_sell (sell), m_crs (crs)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ordinal_type sorted_row) const
+  {
+    const ordinal_type C = m_sell.chunkHeight ();
+    const ordinal_type chunk = sorted_row / C;
+    const ordinal_type lane = sorted_row % C;
+    const ordinal_type row = m_sell.row_permutation(sorted_row);
+
+    size_type row_begin = 0;
+    ordinal_type row_length = 0;
+    if (row < m_sell.numRows ()) {
+      row_begin = m_crs.graph.row_map(row);
+      row_length = static_cast<ordinal_type> (m_crs.graph.row_map(row + 1) - row_begin);
+    }
+    // Padding repeats the last column of the row so that the padded
+    // loads of x stay in cache.
+    const ordinal_type pad_column = row_length > 0 ?
+      static_cast<ordinal_type> (m_crs.graph.entries(row_begin + row_length - 1)) : 0;
+
+    const size_type offset = m_sell.chunk_offsets(chunk) + lane;
+    const ordinal_type chunk_length = m_sell.chunk_lengths(chunk);
+    for (ordinal_type j = 0; j < chunk_length; ++j) {
+      const size_type k = offset + static_cast<size_type> (j) * C;
+      if (j < row_length) {
+        m_sell.values(k) = m_crs.values(row_begin + j);
+        m_sell.entries(k) = m_crs.graph.entries(row_begin + j);
+      } else {
+        m_sell.values(k) = Kokkos::Details::ArithTraits<value_type>::zero ();
+        m_sell.entries(k) = pad_column;
+      }
+    }
+  }
+};
+
+} // namespace Impl
+
+template<class ScalarType, class OrdinalType, class Device, class MemoryTraits, class SizeType>
+template<class CrsMatrixType>
+void
+SellCSigmaMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType>::
+convert (const std::string& label, const CrsMatrixType& A)
+{
+  const ordinal_type C = chunkHeight_;
+  const ordinal_type num_chunks = (numRows_ + C - 1) / C;
+  const ordinal_type num_padded_rows = num_chunks * C;
+
+  // The permutation and the chunk shapes only depend on the row
+  // lengths, and sorting is cheap compared to moving the entries, so
+  // they are computed on the host.
+  auto row_map = Kokkos::create_mirror_view (A.graph.row_map);
+  Kokkos::deep_copy (row_map, A.graph.row_map);
+
+  std::vector<ordinal_type> perm (numRows_);
+  for (ordinal_type i = 0; i < numRows_; ++i) perm[i] = i;
+  auto row_length = [&] (const ordinal_type i) {
+    return row_map(i + 1) - row_map(i);
+  };
+  for (ordinal_type begin = 0; begin < numRows_; begin += sigma_) {
+    const ordinal_type end = std::min (numRows_, begin + sigma_);
+    std::stable_sort (perm.begin () + begin, perm.begin () + end,
+                      [&] (const ordinal_type a, const ordinal_type b) {
+                        return row_length (a) > row_length (b);
+                      });
+  }
+
+  row_permutation = index_type (Kokkos::ViewAllocateWithoutInitializing (label + "_row_permutation"), num_padded_rows);
+  chunk_lengths = index_type (Kokkos::ViewAllocateWithoutInitializing (label + "_chunk_lengths"), num_chunks);
+  chunk_offsets = chunk_map_type (Kokkos::ViewAllocateWithoutInitializing (label + "_chunk_offsets"), num_chunks + 1);
+  auto h_row_permutation = Kokkos::create_mirror_view (row_permutation);
+  auto h_chunk_lengths = Kokkos::create_mirror_view (chunk_lengths);
+  auto h_chunk_offsets = Kokkos::create_mirror_view (chunk_offsets);
+
+  h_chunk_offsets(0) = 0;
+  for (ordinal_type c = 0; c < num_chunks; ++c) {
+    ordinal_type length = 0;
+    for (ordinal_type lane = 0; lane < C; ++lane) {
+      const ordinal_type s = c * C + lane;
+      if (s < numRows_) {
+        h_row_permutation(s) = perm[s];
+        length = std::max (length, static_cast<ordinal_type> (row_length (perm[s])));
+      } else {
+        h_row_permutation(s) = numRows_;
+      }
+    }
+    h_chunk_lengths(c) = length;
+    h_chunk_offsets(c + 1) = h_chunk_offsets(c) + static_cast<size_type> (length) * C;
+  }
+  Kokkos::deep_copy (row_permutation, h_row_permutation);
+  Kokkos::deep_copy (chunk_lengths, h_chunk_lengths);
+  Kokkos::deep_copy (chunk_offsets, h_chunk_offsets);
+
+  const size_type num_stored = h_chunk_offsets(num_chunks);
+  values = values_type (Kokkos::ViewAllocateWithoutInitializing (label), num_stored);
+  entries = index_type (Kokkos::ViewAllocateWithoutInitializing (label + "_entries"), num_stored);
+
+  Kokkos::parallel_for ("KokkosSparse::SellCSigmaMatrix::convert",
+                        Kokkos::RangePolicy<execution_space> (0, num_padded_rows),
+                        Impl::SellCSigmaFillFunctor<SellCSigmaMatrix, CrsMatrixType> (*this, A));
+  execution_space ().fence ();
+}
+
+}} // namespace KokkosSparse::Experimental
+#endif
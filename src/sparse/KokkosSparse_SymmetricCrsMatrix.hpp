@@ -0,0 +1,387 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+/// \file KokkosSparse_SymmetricCrsMatrix.hpp
+/// \brief Local sparse matrix that stores one triangle of a symmetric
+///   or Hermitian matrix
+///
+/// This file provides KokkosSparse::Experimental::SymmetricCrsMatrix.
+/// Only the strictly lower triangle and the diagonal are stored, which
+/// halves the memory and the bytes read by sparse matrix-vector
+/// multiply (see KokkosSparse::spmv).
+
+#ifndef KOKKOS_SPARSE_SYMMETRICCRSMATRIX_HPP_
+#define KOKKOS_SPARSE_SYMMETRICCRSMATRIX_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+#include "KokkosSparse_CrsMatrix.hpp"
+#include "KokkosSparse_spmv_coloring_impl.hpp"
+#include <string>
+#include <type_traits>
+
+namespace KokkosSparse {
+
+namespace Experimental {
+
+/// \class SymmetricCrsMatrix
+/// \brief Symmetric or Hermitian CRS matrix that stores its lower
+///   triangle.
+/// \tparam ScalarType The type of the entries of the matrix.
+/// \tparam OrdinalType The type of column indices.
+/// \tparam Device The Kokkos Device type.
+/// \tparam MemoryTraits Traits describing how Kokkos manages and
+///   accesses data.  The default parameter suffices for most users.
+/// \tparam SizeType The type of row offsets.
+///
+/// The matrix is A = L + D + L^T (symmetric) or A = L + D + L^H
+/// (Hermitian), where \c lower holds the strictly lower triangle L
+/// and \c diagonal holds D.
+///
+/// In SpMV, row i of L contributes both to y(i) and, through the upper
+/// triangle, to y(j) for every column j of the row.  To avoid atomic
+/// updates, the rows are colored so that no two rows of the same color
+/// write the same entry of y: rows that share a column of L + I get
+/// different colors.  \c color_rows lists the rows grouped by color,
+/// and \c color_offsets (on the host) delimits the groups.  The
+/// coloring is computed once, when the matrix is constructed.  SpMV
+/// launches one kernel per color, so when the coloring needs many
+/// colors (more than Impl::spmv_symmetric_max_colors, e.g. for an
+/// arrow matrix) it processes all rows in one launch with atomic
+/// updates instead.
+template<class ScalarType,
+         class OrdinalType,
+         class Device,
+         class MemoryTraits = void,
+         class SizeType = typename Kokkos::ViewTraits<OrdinalType*, Device, void, void>::size_type>
+class SymmetricCrsMatrix {
+public:
+  //! Type of the matrix's execution space.
+  typedef typename Device::execution_space execution_space;
+  //! Type of the matrix's memory space.
+  typedef typename Device::memory_space memory_space;
+  //! Type of the matrix's device type.
+  typedef Kokkos::Device<execution_space, memory_space> device_type;
+
+  //! Type of each value in the matrix.
+  typedef ScalarType value_type;
+  //! Type of each (column) index in the matrix.
+  typedef OrdinalType ordinal_type;
+  typedef MemoryTraits memory_traits;
+  //! Type of each entry of the "row map."
+  typedef SizeType size_type;
+
+  typedef typename std::remove_const<value_type>::type non_const_value_type;
+  typedef typename std::add_const<non_const_value_type>::type const_value_type;
+  typedef typename std::remove_const<ordinal_type>::type non_const_ordinal_type;
+  typedef typename std::add_const<non_const_ordinal_type>::type const_ordinal_type;
+  typedef typename std::remove_const<size_type>::type non_const_size_type;
+  typedef typename std::add_const<non_const_size_type>::type const_size_type;
+
+  //! Type of the stored (strictly lower) triangle.
+  typedef CrsMatrix<non_const_value_type, non_const_ordinal_type, device_type,
+                    MemoryTraits, non_const_size_type> lower_matrix_type;
+  //! Type of the diagonal.
+  typedef Kokkos::View<non_const_value_type*, Kokkos::LayoutLeft, device_type, MemoryTraits> diagonal_type;
+  //! Type of the list of rows grouped by color.
+  typedef Kokkos::View<non_const_ordinal_type*, Kokkos::LayoutLeft, device_type, MemoryTraits> color_rows_type;
+  //! Type of the offsets of each color in \c color_rows.
+  typedef Kokkos::View<non_const_size_type*, Kokkos::HostSpace> color_offsets_type;
+
+  /// \name Storage
+  //@{
+  lower_matrix_type lower;
+  diagonal_type diagonal;
+  color_rows_type color_rows;
+  color_offsets_type color_offsets;
+  //@}
+
+  //! Default constructor; constructs an empty sparse matrix.
+  SymmetricCrsMatrix () :
+    hermitian_ (false)
+  {}
+
+  /// \brief Keep the lower triangle of a full symmetric or Hermitian
+  ///   matrix.
+  ///
+  /// \param label [in] The sparse matrix's label.
+  /// \param A [in] The full (both triangles) matrix.  It must be square
+  ///   and live in the same memory space as this matrix.  Its upper
+  ///   triangle is ignored, and duplicate diagonal entries are summed.
+  /// \param hermitian [in] Whether A is Hermitian (A = A^H) rather than
+  ///   symmetric (A = A^T).  For real types the two are the same.
+  template<class CrsMatrixType>
+  SymmetricCrsMatrix (const std::string& label, const CrsMatrixType& A, const bool hermitian = false) :
+    hermitian_ (hermitian)
+  {
+    if (A.numRows () != A.numCols ()) {
+      Kokkos::Impl::throw_runtime_exception
+        ("KokkosSparse::Experimental::SymmetricCrsMatrix: the matrix must be square.");
+    }
+    extract (label, A);
+    color ();
+  }
+
+  /// \brief Wrap an already split lower triangle and diagonal.
+  ///
+  /// \param lower_ [in] The strictly lower triangle L.  Entries on or
+  ///   above the diagonal are not allowed.
+  /// \param diagonal_ [in] The diagonal D, of length lower_.numRows().
+  /// \param hermitian [in] Whether A = L + D + L^H rather than
+  ///   L + D + L^T.
+  SymmetricCrsMatrix (const lower_matrix_type& lower_,
+                      const diagonal_type& diagonal_,
+                      const bool hermitian = false) :
+    lower (lower_), diagonal (diagonal_), hermitian_ (hermitian)
+  {
+    if (lower.numRows () != lower.numCols () ||
+        static_cast<size_t> (lower.numRows ()) != diagonal.extent (0)) {
+      Kokkos::Impl::throw_runtime_exception
+        ("KokkosSparse::Experimental::SymmetricCrsMatrix: the lower triangle must be square "
+         "and match the length of the diagonal.");
+    }
+    color ();
+  }
+
+  //! The number of rows in the sparse matrix.
+  KOKKOS_INLINE_FUNCTION ordinal_type numRows () const {
+    return lower.numRows ();
+  }
+  //! The number of columns in the sparse matrix.
+  KOKKOS_INLINE_FUNCTION ordinal_type numCols () const {
+    return lower.numCols ();
+  }
+  //! The number of entries of the full matrix (both triangles).
+  size_type nnz () const {
+    return 2 * lower.nnz () + diagonal.extent (0);
+  }
+  //! Whether the upper triangle is L^H (true) or L^T (false).
+  bool isHermitian () const {
+    return hermitian_;
+  }
+  //! The number of colors used to order the rows.
+  ordinal_type numColors () const {
+    return color_offsets.extent (0) > 0 ?
+      static_cast<ordinal_type> (color_offsets.extent (0) - 1) : 0;
+  }
+
+private:
+  template<class CrsMatrixType>
+  void extract (const std::string& label, const CrsMatrixType& A);
+  void color ();
+
+  bool hermitian_;
+};
+
+namespace Impl {
+
+/// \brief Counts the strictly lower entries of every row, and writes
+///   the row offsets of the lower triangle.
+template<class RowMapType, class CrsMatrixType>
+struct SymmetricCrsCountFunctor {
+  typedef typename CrsMatrixType::non_const_ordinal_type ordinal_type;
+  typedef typename RowMapType::non_const_value_type size_type;
+
+  RowMapType m_row_map;
+  CrsMatrixType m_A;
+
+  SymmetricCrsCountFunctor (const RowMapType& row_map, const CrsMatrixType& A) :
+    m_row_map (row_map), m_A (A)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ordinal_type i, size_type& update, const bool final) const
+  {
+    if (final) {
+      m_row_map(i) = update;
+    }
+    for (auto k = m_A.graph.row_map(i); k < m_A.graph.row_map(i + 1); ++k) {
+      if (m_A.graph.entries(k) < i) {
+        ++update;
+      }
+    }
+    if (final && i + 1 == m_A.numRows ()) {
+      m_row_map(i + 1) = update;
+    }
+  }
+};
+
+/// \brief Copies the strictly lower entries and the diagonal.
+template<class SymmetricMatrixType, class CrsMatrixType>
+struct SymmetricCrsFillFunctor {
+  typedef typename SymmetricMatrixType::non_const_ordinal_type ordinal_type;
+  typedef typename SymmetricMatrixType::non_const_value_type value_type;
+  typedef typename SymmetricMatrixType::lower_matrix_type::row_map_type::non_const_type row_map_type;
+  typedef typename SymmetricMatrixType::lower_matrix_type::index_type::non_const_type entries_type;
+  typedef typename SymmetricMatrixType::lower_matrix_type::values_type::non_const_type values_type;
+
+  row_map_type m_row_map;
+  entries_type m_entries;
+  values_type m_values;
+  typename SymmetricMatrixType::diagonal_type m_diag;
+  CrsMatrixType m_A;
+
+  SymmetricCrsFillFunctor (const row_map_type& row_map, const entries_type& entries,
+                           const values_type& values,
+                           const typename SymmetricMatrixType::diagonal_type& diag,
+                           const CrsMatrixType& A) :
+    m_row_map (row_map), m_entries (entries), m_values (values), m_diag (diag), m_A (A)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ordinal_type i) const
+  {
+    auto pos = m_row_map(i);
+    value_type d = Kokkos::Details::ArithTraits<value_type>::zero ();
+    for (auto k = m_A.graph.row_map(i); k < m_A.graph.row_map(i + 1); ++k) {
+      const ordinal_type col = m_A.graph.entries(k);
+      if (col < i) {
+        m_entries(pos) = col;
+        m_values(pos) = m_A.values(k);
+        ++pos;
+      } else if (col == i) {
+        d += m_A.values(k);
+      }
+    }
+    m_diag(i) = d;
+  }
+};
+
+/// \brief Builds the pattern of L + I, whose rows are the sets of
+///   entries of y written by each row in SpMV.
+template<class RowMapType, class EntriesType, class LowerMatrixType>
+struct SymmetricCrsColorGraphFunctor {
+  typedef typename LowerMatrixType::non_const_ordinal_type ordinal_type;
+
+  RowMapType m_row_map;
+  EntriesType m_entries;
+  LowerMatrixType m_L;
+
+  SymmetricCrsColorGraphFunctor (const RowMapType& row_map, const EntriesType& entries,
+                                 const LowerMatrixType& L) :
+    m_row_map (row_map), m_entries (entries), m_L (L)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ordinal_type i) const
+  {
+    const auto begin = m_L.graph.row_map(i);
+    const auto end = m_L.graph.row_map(i + 1);
+    auto pos = begin + i;
+    m_row_map(i) = pos;
+    for (auto k = begin; k < end; ++k) {
+      m_entries(pos++) = m_L.graph.entries(k);
+    }
+    m_entries(pos) = i;
+    if (i + 1 == m_L.numRows ()) {
+      m_row_map(i + 1) = pos + 1;
+    }
+  }
+};
+
+} // namespace Impl
+
+template<class ScalarType, class OrdinalType, class Device, class MemoryTraits, class SizeType>
+template<class CrsMatrixType>
+void
+SymmetricCrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType>::
+extract (const std::string& label, const CrsMatrixType& A)
+{
+  typedef Kokkos::RangePolicy<execution_space> range_policy_type;
+  typedef typename lower_matrix_type::row_map_type::non_const_type row_map_type;
+  typedef typename lower_matrix_type::index_type::non_const_type entries_type;
+  typedef typename lower_matrix_type::values_type::non_const_type values_type;
+  typedef typename lower_matrix_type::staticcrsgraph_type graph_type;
+
+  const non_const_ordinal_type n = A.numRows ();
+  row_map_type row_map (Kokkos::ViewAllocateWithoutInitializing (label + "_row_map"), n + 1);
+  non_const_size_type lower_nnz = 0;
+  if (n > 0) {
+    Kokkos::parallel_scan ("KokkosSparse::SymmetricCrsMatrix::Count",
+                           range_policy_type (0, n),
+                           Impl::SymmetricCrsCountFunctor<row_map_type, CrsMatrixType> (row_map, A),
+                           lower_nnz);
+  } else {
+    Kokkos::deep_copy (row_map, 0);
+  }
+
+  entries_type entries (Kokkos::ViewAllocateWithoutInitializing (label + "_entries"), lower_nnz);
+  values_type values (Kokkos::ViewAllocateWithoutInitializing (label), lower_nnz);
+  diagonal = diagonal_type (Kokkos::ViewAllocateWithoutInitializing (label + "_diagonal"), n);
+  Kokkos::parallel_for ("KokkosSparse::SymmetricCrsMatrix::Fill",
+                        range_policy_type (0, n),
+                        Impl::SymmetricCrsFillFunctor<SymmetricCrsMatrix, CrsMatrixType>
+                          (row_map, entries, values, diagonal, A));
+  execution_space ().fence ();
+
+  lower = lower_matrix_type (label, n, values, graph_type (entries, row_map));
+}
+
+template<class ScalarType, class OrdinalType, class Device, class MemoryTraits, class SizeType>
+void
+SymmetricCrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType>::
+color ()
+{
+  typedef Kokkos::RangePolicy<execution_space> range_policy_type;
+  typedef Kokkos::View<non_const_size_type*, device_type> row_map_type;
+  typedef Kokkos::View<non_const_ordinal_type*, device_type> entries_type;
+
+  const non_const_ordinal_type n = numRows ();
+
+  // Color the rows of L + I, so that rows of the same color write
+  // disjoint entries of y.
+  row_map_type row_map (Kokkos::ViewAllocateWithoutInitializing ("SymmetricCrsMatrix::color_row_map"), n + 1);
+  entries_type entries (Kokkos::ViewAllocateWithoutInitializing ("SymmetricCrsMatrix::color_entries"),
+                        lower.nnz () + n);
+  Kokkos::parallel_for ("KokkosSparse::SymmetricCrsMatrix::ColorGraph",
+                        range_policy_type (0, n),
+                        Impl::SymmetricCrsColorGraphFunctor<row_map_type, entries_type, lower_matrix_type>
+                          (row_map, entries, lower));
+  execution_space ().fence ();
+
+  Impl::spmv_scatter_coloring<execution_space> (n, n, row_map, entries, color_rows, color_offsets);
+}
+
+}} // namespace KokkosSparse::Experimental
+#endif
@@ -48,6 +48,10 @@
 #include "KokkosSparse_spgemm_numeric.hpp"
 #include "KokkosSparse_spgemm_symbolic.hpp"
 #include "KokkosSparse_spgemm_jacobi.hpp"
+#include "KokkosSparse_spgemm_rap.hpp"
+#include "KokkosSparse_spgemm_streaming.hpp"
+#include "KokkosSparse_spgemm_masked.hpp"
+#include "KokkosSparse_spgemm_add.hpp"
 
 
 #endif
@@ -0,0 +1,181 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+/// \file KokkosSparse_spgemm_add.hpp
+/// \brief Fused product and sum C = alpha*A*B + beta*D.
+///
+/// Each row of C goes to a thread of a team and the rows it combines to
+/// the vector lanes, on the host and on CUDA.  The symbolic phase writes
+/// the sorted structure of C, so the numeric phase does not hash.
+
+#ifndef KOKKOSSPARSE_SPGEMM_ADD_HPP_
+#define KOKKOSSPARSE_SPGEMM_ADD_HPP_
+
+#include "KokkosSparse_CrsMatrix.hpp"
+#include "KokkosSparse_spgemm_add_impl.hpp"
+#include <sstream>
+
+namespace KokkosSparse {
+
+namespace Impl {
+
+template <class AMatrix, class BMatrix, class DMatrix>
+void spgemm_add_check_dimensions (const char* name, const AMatrix& A, const BMatrix& B, const DMatrix& D)
+{
+  if (static_cast<size_t> (A.numCols ()) != static_cast<size_t> (B.numRows ()) ||
+      static_cast<size_t> (D.numRows ()) != static_cast<size_t> (A.numRows ()) ||
+      static_cast<size_t> (D.numCols ()) != static_cast<size_t> (B.numCols ())) {
+    std::ostringstream os;
+    os << "KokkosSparse::" << name << ": Dimensions do not match: "
+       << "A: " << A.numRows () << " x " << A.numCols ()
+       << ", B: " << B.numRows () << " x " << B.numCols ()
+       << ", D: " << D.numRows () << " x " << D.numCols ();
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+}
+
+} // namespace Impl
+
+/// \brief Symbolic phase of C = alpha*A*B + beta*D.
+///
+/// Allocates C with the union of the structures of A*B and D, with
+/// entries sorted within each row; its values are filled by
+/// spgemm_add_numeric.  The number of entries of C is kept on the spgemm
+/// handle, so later numeric calls with new values of A, B and D skip
+/// this phase.
+/// They are kept apart from the state of spgemm_symbolic and
+/// spgemm_rap_symbolic, which may share the handle.
+/// The spgemm handle must have been created with
+/// handle->create_spgemm_handle().
+///
+/// \param handle [in/out] KokkosKernelsHandle holding a spgemm handle.
+/// \param A [in] KokkosSparse::CrsMatrix instance.
+/// \param B [in] KokkosSparse::CrsMatrix instance.
+/// \param D [in] KokkosSparse::CrsMatrix instance, A.numRows() x B.numCols().
+/// \param C [out] KokkosSparse::CrsMatrix instance.
+template <class KernelHandle, class AMatrix, class BMatrix, class DMatrix, class CMatrix>
+void
+spgemm_add_symbolic (KernelHandle* handle,
+                     const AMatrix& A,
+                     const BMatrix& B,
+                     const DMatrix& D,
+                     CMatrix& C)
+{
+  typedef typename CMatrix::row_map_type::non_const_type c_row_view_t;
+  typedef typename CMatrix::index_type::non_const_type c_nnz_view_t;
+  typedef typename CMatrix::values_type::non_const_type c_scalar_view_t;
+
+  Impl::spgemm_add_check_dimensions ("spgemm_add_symbolic", A, B, D);
+  auto sh = handle->get_spgemm_handle ();
+  if (sh == NULL) {
+    Kokkos::Impl::throw_runtime_exception (
+      "KokkosSparse::spgemm_add_symbolic: call create_spgemm_handle() first.");
+  }
+
+  c_row_view_t rowmapC ("SpGEMM add rowmap", A.numRows () + 1);
+  c_nnz_view_t entriesC ("SpGEMM add entries", 0);
+  Impl::spgemm_add_symbolic_impl (sh, A, B, D, rowmapC, entriesC);
+
+  const size_t c_nnz = entriesC.extent (0);
+  c_scalar_view_t valuesC (Kokkos::ViewAllocateWithoutInitializing ("SpGEMM add values"), c_nnz);
+  C = CMatrix ("SpGEMM add", A.numRows (), B.numCols (), c_nnz, valuesC, rowmapC, entriesC);
+}
+
+/// \brief Numeric phase of C = alpha*A*B + beta*D.
+///
+/// Fills the values of C, which must come from spgemm_add_symbolic with
+/// the same handle and operands of the same structure.  The row of D
+/// scaled by beta and the products of A and B are added in the same pass
+/// at the positions of their columns in the sorted row of C, so neither
+/// A*B nor a second sum pass is needed.
+template <class KernelHandle, class AMatrix, class BMatrix, class DMatrix, class CMatrix>
+void
+spgemm_add_numeric (KernelHandle* handle,
+                    const typename AMatrix::non_const_value_type alpha,
+                    const AMatrix& A,
+                    const BMatrix& B,
+                    const typename AMatrix::non_const_value_type beta,
+                    const DMatrix& D,
+                    CMatrix& C)
+{
+  Impl::spgemm_add_check_dimensions ("spgemm_add_numeric", A, B, D);
+  auto sh = handle->get_spgemm_handle ();
+  if (sh == NULL || !sh->is_add_symbolic_called ()) {
+    Kokkos::Impl::throw_runtime_exception (
+      "KokkosSparse::spgemm_add_numeric: call spgemm_add_symbolic() first.");
+  }
+  if (static_cast<size_t> (C.numRows ()) != static_cast<size_t> (A.numRows ()) ||
+      static_cast<size_t> (C.nnz ()) != static_cast<size_t> (sh->get_add_c_nnz ())) {
+    Kokkos::Impl::throw_runtime_exception (
+      "KokkosSparse::spgemm_add_numeric: C does not match the symbolic phase.");
+  }
+  Impl::spgemm_add_numeric_impl (sh, alpha, A, B, beta, D, C.graph.row_map, C.graph.entries, C.values);
+}
+
+/// \brief C = alpha*A*B + beta*D.
+///
+/// Runs spgemm_add_symbolic the first time it is called with a handle,
+/// and only spgemm_add_numeric afterwards.  Call
+/// handle->get_spgemm_handle()->reset_add_symbolic() when the structure
+/// of A, B or D changes.
+template <class KernelHandle, class AMatrix, class BMatrix, class DMatrix, class CMatrix>
+void
+spgemm_add (KernelHandle* handle,
+            const typename AMatrix::non_const_value_type alpha,
+            const AMatrix& A,
+            const BMatrix& B,
+            const typename AMatrix::non_const_value_type beta,
+            const DMatrix& D,
+            CMatrix& C)
+{
+  auto sh = handle->get_spgemm_handle ();
+  if (sh == NULL || !sh->is_add_symbolic_called ()) {
+    spgemm_add_symbolic (handle, A, B, D, C);
+  }
+  spgemm_add_numeric (handle, alpha, A, B, beta, D, C);
+}
+
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_SPGEMM_ADD_HPP_
@@ -83,7 +83,8 @@ enum SPGEMMAlgorithm{
 		SPGEMM_KK_MEMORY_SPREADTEAM,
 		SPGEMM_KK_MEMORY_BIGSPREADTEAM,
 		SPGEMM_KK_MEMORY2,
-		SPGEMM_KK_MEMSPEED};
+		SPGEMM_KK_MEMSPEED,
+		SPGEMM_KK_AUTO}; //chosen in symbolic phase from the row flops, see choose_auto_algorithm
 
 enum SPGEMMAccumulator{
   SPGEMM_ACC_DEFAULT, SPGEMM_ACC_DENSE, SPGEMM_ACC_SPARSE,
@@ -210,6 +211,48 @@ private:
 
   row_lno_temp_work_view_t tranpose_a_xadj, tranpose_b_xadj, tranpose_c_xadj;
   nnz_lno_temp_work_view_t tranpose_a_adj, tranpose_b_adj, tranpose_c_adj;
+  //sorted entries of C from the symbolic phase of a product with a
+  //transposed operand, see set_transposed_product.
+  nnz_lno_temp_work_view_t transposed_c_entries;
+  bool transposed_product;
+
+  /**
+   * \brief what the symbolic phase of a row-wise kernel (spgemm_rap,
+   * spgemm_add) leaves for its numeric phase, besides the structure of C.
+   * Each kernel has its own, so they do not overwrite the result size of
+   * spgemm_symbolic.
+   */
+  struct RowwiseSymbolicState{
+    bool called_symbolic;
+    size_type c_nnz;
+
+    RowwiseSymbolicState(): called_symbolic(false), c_nnz(0){}
+  };
+
+  RowwiseSymbolicState rap_state;
+  RowwiseSymbolicState add_state;
+  //A*P of spgemm_rap, with the structure of its symbolic phase.
+  row_lno_temp_work_view_t rap_ap_rowmap;
+  nnz_lno_temp_work_view_t rap_ap_entries;
+  scalar_temp_work_view_t rap_ap_values;
+
+  size_t memory_budget;
+  //B compressed by the first KKMEM symbolic call, kept for the next ones.
+  bool reuse_compressed_b, compressed_b_cached, compressed_b_applied;
+
+  bool numeric_reuse, numeric_reuse_built;
+  row_lno_temp_work_view_t numeric_reuse_offsets, numeric_reuse_positions;
+  //entries of C the map was recorded for.
+  const void *numeric_reuse_c_entries;
+  size_t numeric_reuse_c_nnz;
+
+  bool auto_algorithm, auto_selected;
+  int auto_team_size, auto_vector_size;
+  size_t auto_cache_size;
+  size_t auto_max_row_flops, auto_overall_flops, auto_accumulator_size;
+
+  bool sort_output;
+  bool numa_first_touch;
 
   bool transpose_a,transpose_b, transpose_c_symbolic;
 
@@ -373,6 +416,306 @@ private:
   //TODO: store transpose here.
   void get_c_transpose_symbolic(){}
 
+  /**
+   * \brief stores the sorted entries of C = op(A)*op(B) computed by the
+   * symbolic phase when A or B is used transposed. The numeric phase copies
+   * them into entriesC and combines the values into them. No transposed
+   * operand is kept.
+   */
+  void set_transposed_product(nnz_lno_temp_work_view_t transposed_c_entries_){
+    this->transposed_c_entries = transposed_c_entries_;
+    this->transposed_product = true;
+  }
+  bool is_transposed_product(){
+    return this->transposed_product;
+  }
+  nnz_lno_temp_work_view_t get_transposed_c_entries(){
+    return this->transposed_c_entries;
+  }
+  void reset_transposed_product(){
+    this->transposed_c_entries = nnz_lno_temp_work_view_t();
+    this->transposed_product = false;
+  }
+
+  /**
+   * \brief when set, the first spgemm_numeric after spgemm_symbolic records
+   * the position in C of every product term (one size_type per multiplication),
+   * and later spgemm_numeric calls only gather-multiply-scatter the values.
+   * The structures of A and B must not change between these calls. The map
+   * is only applied to the entriesC it was recorded for (same data pointer
+   * and extent, with valuesC of the same extent); any other C goes through
+   * the regular numeric phase, which records the map again.
+   */
+  void set_numeric_reuse(bool numeric_reuse_){
+    this->numeric_reuse = numeric_reuse_;
+    if (!numeric_reuse_) this->reset_numeric_reuse();
+  }
+  bool get_numeric_reuse(){
+    return this->numeric_reuse;
+  }
+  bool is_numeric_reuse_built(){
+    return this->numeric_reuse_built;
+  }
+  bool is_numeric_reuse_built_for(const void *c_entries_, size_t c_nnz_, size_t c_values_size_){
+    return this->numeric_reuse_built &&
+           this->numeric_reuse_c_entries == c_entries_ &&
+           this->numeric_reuse_c_nnz == c_nnz_ && c_values_size_ == c_nnz_;
+  }
+  void set_numeric_reuse_map(
+      row_lno_temp_work_view_t numeric_reuse_offsets_,
+      row_lno_temp_work_view_t numeric_reuse_positions_,
+      const void *c_entries_, size_t c_nnz_){
+    this->numeric_reuse_offsets = numeric_reuse_offsets_;
+    this->numeric_reuse_positions = numeric_reuse_positions_;
+    this->numeric_reuse_c_entries = c_entries_;
+    this->numeric_reuse_c_nnz = c_nnz_;
+    this->numeric_reuse_built = true;
+  }
+  void get_numeric_reuse_map(
+      row_lno_temp_work_view_t &numeric_reuse_offsets_,
+      row_lno_temp_work_view_t &numeric_reuse_positions_){
+    numeric_reuse_offsets_ = this->numeric_reuse_offsets;
+    numeric_reuse_positions_ = this->numeric_reuse_positions;
+  }
+  void reset_numeric_reuse(){
+    this->numeric_reuse_offsets = row_lno_temp_work_view_t();
+    this->numeric_reuse_positions = row_lno_temp_work_view_t();
+    this->numeric_reuse_c_entries = NULL;
+    this->numeric_reuse_c_nnz = 0;
+    this->numeric_reuse_built = false;
+  }
+
+  /**
+   * \brief bytes of cache a thread can keep its accumulator in (per core L2).
+   * Used by SPGEMM_KK_AUTO on host execution spaces. Default is 1MB.
+   */
+  void set_auto_cache_size(size_t auto_cache_size_){
+    this->auto_cache_size = auto_cache_size_;
+  }
+  size_t get_auto_cache_size(){
+    return this->auto_cache_size;
+  }
+  bool is_auto_algorithm(){
+    return this->auto_algorithm;
+  }
+  bool is_auto_selected(){
+    return this->auto_selected;
+  }
+  int get_auto_team_size(){
+    return this->auto_team_size;
+  }
+  int get_auto_vector_size(){
+    return this->auto_vector_size;
+  }
+
+  /**
+   * \brief SPGEMM_KK_AUTO: picks algorithm, accumulator, team and vector size
+   * from the row flops of the (compressed, if applied) product, called by
+   * the symbolic phase. Per thread (or per team on cuda), a dense accumulator
+   * needs b_col_cnt scalars and markers, a hash accumulator needs about the
+   * next power of two of the max row flops keys, nexts, begins and scalars.
+   * Host: dense (KK_SPEED) when it stays within the cache size, otherwise
+   * hash (KK_MEMORY). Cuda: thread level hashes (KK_MEMORY) for light rows
+   * whose hash fits the shared memory of a thread, team level hashes
+   * (KK_MEMORY_SPREADTEAM) when it fits the team, else KK_MEMORY_BIGSPREADTEAM.
+   * The decision stays in the handle, algorithm_type is set to the choice.
+   */
+  void choose_auto_algorithm(
+      size_t max_row_flops, size_t overall_flops,
+      size_t a_row_cnt, size_t b_col_cnt,
+      bool is_cuda, size_t shmem_size, int vector_size){
+
+    const size_t hash_unit = 3 * sizeof(nnz_lno_t) + sizeof(nnz_scalar_t);
+    size_t hash_keys = 1;
+    while (hash_keys < max_row_flops) hash_keys *= 2;
+    const size_t hash_size = hash_keys * hash_unit;
+    const size_t dense_size = b_col_cnt * (sizeof(nnz_scalar_t) + 1);
+    const size_t average_row_flops = a_row_cnt ? overall_flops / a_row_cnt : 0;
+
+    if (!is_cuda){
+      this->auto_vector_size = 1;
+      this->auto_team_size = 1;
+      if (dense_size <= this->auto_cache_size || dense_size <= hash_size){
+        this->algorithm_type = SPGEMM_KK_SPEED;
+        this->accumulator_type = SPGEMM_ACC_DENSE;
+        this->auto_accumulator_size = dense_size;
+      }
+      else {
+        this->algorithm_type = SPGEMM_KK_MEMORY;
+        this->accumulator_type = SPGEMM_ACC_SPARSE;
+        this->auto_accumulator_size = hash_size;
+      }
+    }
+    else {
+      this->accumulator_type = SPGEMM_ACC_SPARSE;
+      this->auto_accumulator_size = hash_size;
+      //threads of a vector share a row.
+      this->auto_vector_size = vector_size;
+      this->auto_team_size = vector_size > 0 ? 256 / vector_size : 8;
+      if (average_row_flops < 256 && hash_size <= shmem_size / this->auto_team_size){
+        this->algorithm_type = SPGEMM_KK_MEMORY;
+      }
+      else if (hash_size <= shmem_size){
+        this->algorithm_type = SPGEMM_KK_MEMORY_SPREADTEAM;
+      }
+      else {
+        this->algorithm_type = SPGEMM_KK_MEMORY_BIGSPREADTEAM;
+      }
+    }
+    this->auto_max_row_flops = max_row_flops;
+    this->auto_overall_flops = overall_flops;
+    this->auto_selected = true;
+  }
+
+  /**
+   * \brief prints the decision of SPGEMM_KK_AUTO.
+   */
+  void print_auto_selection(std::ostream &os){
+    if (!this->auto_selected){
+      os << "SPGEMM_KK_AUTO: no selection made" << std::endl;
+      return;
+    }
+    os << "SPGEMM_KK_AUTO: algorithm:" << this->algorithm_type
+       << " accumulator:" << (this->accumulator_type == SPGEMM_ACC_DENSE ? "dense" : "sparse")
+       << " team_size:" << this->auto_team_size
+       << " vector_size:" << this->auto_vector_size
+       << " max_row_flops:" << this->auto_max_row_flops
+       << " overall_flops:" << this->auto_overall_flops
+       << " accumulator_bytes:" << this->auto_accumulator_size
+       << std::endl;
+  }
+
+  /**
+   * \brief if true, spgemm_numeric writes each row of C with increasing
+   * column indices. The KKMEM multicore kernels sort each row as they write
+   * it; the other paths sort C after the numeric phase.
+   */
+  void set_sort_output(bool sort_output_){
+    this->sort_output = sort_output_;
+  }
+  bool get_sort_output(){
+    return this->sort_output;
+  }
+
+  /**
+   * \brief NUMA-aware host numeric phase. Rows of C are split in contiguous
+   * blocks over the threads with a static schedule; each thread first-touches
+   * the entries and values of its rows and its memory pool chunk before the
+   * numeric kernel runs on the same rows. For the pages of C to land on the
+   * right socket, allocate entriesC and valuesC with
+   * Kokkos::ViewAllocateWithoutInitializing. Ignored on CUDA.
+   */
+  void set_numa_first_touch(bool numa_first_touch_){
+    this->numa_first_touch = numa_first_touch_;
+  }
+  bool get_numa_first_touch(){
+    return this->numa_first_touch;
+  }
+
+  /**
+   * \brief sets the number of bytes spgemm_streaming may use for a batch
+   * of rows of C. 0 (default) computes C in a single batch.
+   */
+  void set_memory_budget(size_t memory_budget_){
+    this->memory_budget = memory_budget_;
+  }
+  size_t get_memory_budget(){
+    return this->memory_budget;
+  }
+
+  /**
+   * \brief If set, the KKMEM symbolic phase compresses B only on its first
+   * call; later calls reuse that compression, and the first call's decision
+   * whether to apply it, so they must pass the same B. spgemm_streaming
+   * sets it for its batches.
+   */
+  void set_reuse_compressed_b(bool reuse_compressed_b_){
+    this->reuse_compressed_b = reuse_compressed_b_;
+    this->reset_compressed_b();
+  }
+  bool get_reuse_compressed_b(){
+    return this->reuse_compressed_b;
+  }
+  bool is_compressed_b_cached(){
+    return this->compressed_b_cached;
+  }
+  //whether the symbolic phase decided to use the cached compression.
+  bool is_compressed_b_applied(){
+    return this->compressed_b_applied;
+  }
+  void set_compressed_b_cached(bool compressed_b_applied_){
+    this->compressed_b_cached = true;
+    this->compressed_b_applied = compressed_b_applied_;
+  }
+  void reset_compressed_b(){
+    this->compressed_b_cached = false;
+    this->compressed_b_applied = false;
+    this->compressed_b_rowmap = row_lno_temp_work_view_t();
+    this->compressed_b_set_indices = nnz_lno_temp_work_view_t();
+    this->compressed_b_sets = nnz_lno_temp_work_view_t();
+  }
+
+  /**
+   * \brief records that spgemm_rap_symbolic was called, together with the
+   * number of entries of R*A*P.
+   */
+  void set_rap_symbolic(size_type rap_c_nnz_){
+    this->rap_state.c_nnz = rap_c_nnz_;
+    this->rap_state.called_symbolic = true;
+  }
+  bool is_rap_symbolic_called(){
+    return this->rap_state.called_symbolic;
+  }
+  size_type get_rap_c_nnz(){
+    return this->rap_state.c_nnz;
+  }
+
+  /**
+   * \brief stores the intermediate product A*P of spgemm_rap: the sorted
+   * structure from its symbolic phase, and the values that each numeric
+   * phase overwrites.
+   */
+  void set_rap_ap(row_lno_temp_work_view_t rap_ap_rowmap_,
+                  nnz_lno_temp_work_view_t rap_ap_entries_,
+                  scalar_temp_work_view_t rap_ap_values_){
+    this->rap_ap_rowmap = rap_ap_rowmap_;
+    this->rap_ap_entries = rap_ap_entries_;
+    this->rap_ap_values = rap_ap_values_;
+  }
+  row_lno_temp_work_view_t get_rap_ap_rowmap(){
+    return this->rap_ap_rowmap;
+  }
+  nnz_lno_temp_work_view_t get_rap_ap_entries(){
+    return this->rap_ap_entries;
+  }
+  scalar_temp_work_view_t get_rap_ap_values(){
+    return this->rap_ap_values;
+  }
+  void reset_rap_symbolic(){
+    this->rap_state = RowwiseSymbolicState();
+    this->rap_ap_rowmap = row_lno_temp_work_view_t();
+    this->rap_ap_entries = nnz_lno_temp_work_view_t();
+    this->rap_ap_values = scalar_temp_work_view_t();
+  }
+
+  /**
+   * \brief records that spgemm_add_symbolic was called, together with the
+   * number of entries of A*B + D.
+   */
+  void set_add_symbolic(size_type add_c_nnz_){
+    this->add_state.c_nnz = add_c_nnz_;
+    this->add_state.called_symbolic = true;
+  }
+  bool is_add_symbolic_called(){
+    return this->add_state.called_symbolic;
+  }
+  size_type get_add_c_nnz(){
+    return this->add_state.c_nnz;
+  }
+  void reset_add_symbolic(){
+    this->add_state = RowwiseSymbolicState();
+  }
+
   
   void set_sort_lower_triangular(int option){
     this->sort_lower_triangular = option;
@@ -450,6 +793,18 @@ private:
     c_column_indices(),
     tranpose_a_xadj(), tranpose_b_xadj(), tranpose_c_xadj(),
     tranpose_a_adj(), tranpose_b_adj(), tranpose_c_adj(),
+    transposed_c_entries(), transposed_product(false),
+    rap_state(), add_state(), rap_ap_rowmap(), rap_ap_entries(), rap_ap_values(),
+    memory_budget(0),
+    reuse_compressed_b(false), compressed_b_cached(false), compressed_b_applied(false),
+    numeric_reuse(false), numeric_reuse_built(false),
+    numeric_reuse_offsets(), numeric_reuse_positions(),
+    numeric_reuse_c_entries(NULL), numeric_reuse_c_nnz(0),
+    auto_algorithm(gs == SPGEMM_KK_AUTO), auto_selected(false),
+    auto_team_size(-1), auto_vector_size(-1),
+    auto_cache_size(1024 * 1024),
+    auto_max_row_flops(0), auto_overall_flops(0), auto_accumulator_size(0),
+    sort_output(false), numa_first_touch(false),
     transpose_a(false),transpose_b(false), transpose_c_symbolic(false),
     num_colors(0),
     color_xadj(), color_adj(), vertex_colors(), num_multi_colors(0),num_used_colors(0),
@@ -692,6 +1047,7 @@ private:
     else if(name=="SPGEMM_KK_DENSE")       return SPGEMM_KK_DENSE;
     else if(name=="SPGEMM_KK_LP")  		   return SPGEMM_KK_LP;
     else if(name=="SPGEMM_KK_MEMSPEED")    return SPGEMM_KK;
+    else if(name=="SPGEMM_KK_AUTO")        return SPGEMM_KK_AUTO;
 
     else if(name=="SPGEMM_DEBUG")          return SPGEMM_SERIAL;
     else if(name=="SPGEMM_SERIAL")         return SPGEMM_SERIAL;
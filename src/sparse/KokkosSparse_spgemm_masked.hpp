@@ -0,0 +1,253 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+/// \file KokkosSparse_spgemm_masked.hpp
+/// \brief Masked sparse matrix-matrix multiply C<M> = A*B.
+///
+/// Each row of C goes to a thread of a team and the rows of B it
+/// combines to the vector lanes, on the host and on CUDA.  The symbolic
+/// phase writes the sorted structure of C, so the numeric phase does not
+/// hash.
+/// spgemm_semiring, the unmasked product over a semiring, runs the KKMEM
+/// kernels instead.
+
+#ifndef KOKKOSSPARSE_SPGEMM_MASKED_HPP_
+#define KOKKOSSPARSE_SPGEMM_MASKED_HPP_
+
+#include "KokkosSparse_CrsMatrix.hpp"
+#include "KokkosKernels_Handle.hpp"
+#include "KokkosSparse_spgemm_symbolic.hpp"
+#include "KokkosSparse_spgemm_impl.hpp"
+#include "KokkosSparse_spgemm_masked_impl.hpp"
+#include <sstream>
+
+namespace KokkosSparse {
+
+namespace Impl {
+
+template <class MMatrix, class AMatrix, class BMatrix>
+void spgemm_masked_check_dimensions (const char* name, const MMatrix& M, const AMatrix& A, const BMatrix& B)
+{
+  if (static_cast<size_t> (A.numCols ()) != static_cast<size_t> (B.numRows ()) ||
+      static_cast<size_t> (M.numRows ()) != static_cast<size_t> (A.numRows ()) ||
+      static_cast<size_t> (M.numCols ()) != static_cast<size_t> (B.numCols ())) {
+    std::ostringstream os;
+    os << "KokkosSparse::" << name << ": Dimensions do not match: "
+       << "M: " << M.numRows () << " x " << M.numCols ()
+       << ", A: " << A.numRows () << " x " << A.numCols ()
+       << ", B: " << B.numRows () << " x " << B.numCols ();
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+}
+
+} // namespace Impl
+
+/// \brief Symbolic phase of C<M> = A*B.
+///
+/// Allocates C with the structure of A*B restricted to the structure of
+/// the mask M, or, if complement is true, to the entries that are not in
+/// M.  Only the structure of M is used; its values are ignored.  The
+/// products of A and B are looked up in a sorted copy of the rows of M,
+/// and the entries of each row of C are sorted.
+///
+/// \param M [in] The mask; KokkosSparse::CrsMatrix instance.
+/// \param A [in] KokkosSparse::CrsMatrix instance.
+/// \param B [in] KokkosSparse::CrsMatrix instance.
+/// \param C [out] KokkosSparse::CrsMatrix instance.
+/// \param complement [in] If true, compute C<!M> = A*B.
+template <class MMatrix, class AMatrix, class BMatrix, class CMatrix>
+void
+spgemm_masked_symbolic (const MMatrix& M,
+                        const AMatrix& A,
+                        const BMatrix& B,
+                        CMatrix& C,
+                        const bool complement = false)
+{
+  typedef typename CMatrix::row_map_type::non_const_type c_row_view_t;
+  typedef typename CMatrix::index_type::non_const_type c_nnz_view_t;
+  typedef typename CMatrix::values_type::non_const_type c_scalar_view_t;
+
+  Impl::spgemm_masked_check_dimensions ("spgemm_masked_symbolic", M, A, B);
+
+  c_row_view_t rowmapC ("Masked rowmap", A.numRows () + 1);
+  c_nnz_view_t entriesC ("Masked entries", 0);
+  Impl::spgemm_masked_symbolic_impl (A, B, M, complement, rowmapC, entriesC);
+
+  const size_t c_nnz = entriesC.extent (0);
+  c_scalar_view_t valuesC (Kokkos::ViewAllocateWithoutInitializing ("Masked values"), c_nnz);
+  C = CMatrix ("Masked", A.numRows (), B.numCols (), c_nnz, valuesC, rowmapC, entriesC);
+}
+
+/// \brief Numeric phase of C<M> = A*B over a semiring.
+///
+/// Fills the values of C, which must come from spgemm_masked_symbolic
+/// with the same mask, complement flag and operands of the same
+/// structure.  The structure of C already applies the mask, so M itself
+/// is only checked for its dimensions.  Products and sums are taken with
+/// Semiring::multiply and Semiring::add; see KokkosKernels_Semiring.hpp
+/// for the predefined semirings.
+template <class MMatrix, class AMatrix, class BMatrix, class CMatrix, class Semiring>
+void
+spgemm_masked_numeric (const MMatrix& M,
+                       const AMatrix& A,
+                       const BMatrix& B,
+                       CMatrix& C,
+                       const bool /* complement */,
+                       const Semiring& /* semiring */)
+{
+  Impl::spgemm_masked_check_dimensions ("spgemm_masked_numeric", M, A, B);
+  if (static_cast<size_t> (C.numRows ()) != static_cast<size_t> (A.numRows ()) ||
+      static_cast<size_t> (C.numCols ()) != static_cast<size_t> (B.numCols ())) {
+    Kokkos::Impl::throw_runtime_exception (
+      "KokkosSparse::spgemm_masked_numeric: C does not match the symbolic phase.");
+  }
+  Impl::spgemm_masked_numeric_impl<Semiring> (A, B, C.graph.row_map, C.graph.entries, C.values);
+}
+
+/// \brief Numeric phase of C<M> = A*B with the usual arithmetic.
+template <class MMatrix, class AMatrix, class BMatrix, class CMatrix>
+void
+spgemm_masked_numeric (const MMatrix& M,
+                       const AMatrix& A,
+                       const BMatrix& B,
+                       CMatrix& C,
+                       const bool complement = false)
+{
+  spgemm_masked_numeric (M, A, B, C, complement,
+    KokkosKernels::Experimental::PlusTimesSemiring<typename AMatrix::non_const_value_type> ());
+}
+
+/// \brief C<M> = A*B, or C<!M> = A*B if complement is true, over a semiring.
+///
+/// Runs spgemm_masked_symbolic followed by spgemm_masked_numeric.
+template <class MMatrix, class AMatrix, class BMatrix, class CMatrix, class Semiring>
+void
+spgemm_masked (const MMatrix& M,
+               const AMatrix& A,
+               const BMatrix& B,
+               CMatrix& C,
+               const bool complement,
+               const Semiring& semiring)
+{
+  spgemm_masked_symbolic (M, A, B, C, complement);
+  spgemm_masked_numeric (M, A, B, C, complement, semiring);
+}
+
+/// \brief C<M> = A*B, or C<!M> = A*B if complement is true.
+template <class MMatrix, class AMatrix, class BMatrix, class CMatrix>
+void
+spgemm_masked (const MMatrix& M,
+               const AMatrix& A,
+               const BMatrix& B,
+               CMatrix& C,
+               const bool complement = false)
+{
+  spgemm_masked (M, A, B, C, complement,
+    KokkosKernels::Experimental::PlusTimesSemiring<typename AMatrix::non_const_value_type> ());
+}
+
+/// \brief C = A*B over a semiring, e.g. one step of all-pairs shortest
+/// paths with MinPlusSemiring.
+///
+/// Entries of C are the pairs (i,j) with at least one k such that A(i,k)
+/// and B(k,j) are stored; their values are the Semiring::add of the
+/// Semiring::multiply(A(i,k), B(k,j)).  The structure of C comes from
+/// spgemm_symbolic and the values from the KKMEM numeric kernels, run
+/// with the semiring.  The entries of each row of C are sorted.
+template <class AMatrix, class BMatrix, class CMatrix, class Semiring>
+void
+spgemm_semiring (const AMatrix& A,
+                 const BMatrix& B,
+                 CMatrix& C,
+                 const Semiring& /* semiring */)
+{
+  typedef typename CMatrix::non_const_size_type size_type;
+  typedef typename CMatrix::non_const_ordinal_type lno_t;
+  typedef typename CMatrix::non_const_value_type scalar_t;
+  typedef typename CMatrix::execution_space execution_space;
+  typedef typename CMatrix::memory_space memory_space;
+  typedef KokkosKernels::Experimental::KokkosKernelsHandle
+    <size_type, lno_t, scalar_t, execution_space, memory_space, memory_space> KernelHandle;
+  typedef typename CMatrix::row_map_type::non_const_type c_row_view_t;
+  typedef typename CMatrix::index_type::non_const_type c_nnz_view_t;
+  typedef typename CMatrix::values_type::non_const_type c_scalar_view_t;
+
+  if (static_cast<size_t> (A.numCols ()) != static_cast<size_t> (B.numRows ())) {
+    std::ostringstream os;
+    os << "KokkosSparse::spgemm_semiring: Dimensions do not match: "
+       << "A: " << A.numRows () << " x " << A.numCols ()
+       << ", B: " << B.numRows () << " x " << B.numCols ();
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+
+  KernelHandle kh;
+  kh.create_spgemm_handle (SPGEMM_KK_MEMORY);
+  kh.get_spgemm_handle ()->set_sort_output (true);
+
+  c_row_view_t rowmapC ("Semiring rowmap", A.numRows () + 1);
+  Experimental::spgemm_symbolic (&kh, A.numRows (), B.numRows (), B.numCols (),
+                                 A.graph.row_map, A.graph.entries, false,
+                                 B.graph.row_map, B.graph.entries, false,
+                                 rowmapC);
+  const size_type c_nnz = kh.get_spgemm_handle ()->get_c_nnz ();
+  c_nnz_view_t entriesC (Kokkos::ViewAllocateWithoutInitializing ("Semiring entries"), c_nnz);
+  c_scalar_view_t valuesC (Kokkos::ViewAllocateWithoutInitializing ("Semiring values"), c_nnz);
+
+  Impl::KokkosSPGEMM
+    <KernelHandle,
+     typename AMatrix::row_map_type, typename AMatrix::index_type, typename AMatrix::values_type,
+     typename BMatrix::row_map_type, typename BMatrix::index_type, typename BMatrix::values_type>
+    kspgemm (&kh, A.numRows (), B.numRows (), B.numCols (),
+             A.graph.row_map, A.graph.entries, A.values, false,
+             B.graph.row_map, B.graph.entries, B.values, false);
+  kspgemm.template KokkosSPGEMM_numeric<c_row_view_t, c_nnz_view_t, c_scalar_view_t, Semiring> (
+    rowmapC, entriesC, valuesC);
+  kh.destroy_spgemm_handle ();
+
+  C = CMatrix ("Semiring", A.numRows (), B.numCols (), c_nnz, valuesC, rowmapC, entriesC);
+}
+
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_SPGEMM_MASKED_HPP_
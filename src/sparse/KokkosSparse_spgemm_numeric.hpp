@@ -46,6 +46,8 @@
 
 #include "KokkosKernels_helpers.hpp"
 #include "KokkosSparse_spgemm_numeric_spec.hpp"
+#include "KokkosSparse_spgemm_transpose_impl.hpp"
+#include "KokkosSparse_spgemm_numeric_reuse_impl.hpp"
 
 
 namespace KokkosSparse{
@@ -134,12 +136,6 @@ void spgemm_numeric(
       "KokkosSparse::spgemm_symbolic: scalar type of output matrix should be same as kernelHandle scalar.");
 
 
-  if (transposeA || transposeB){
-    throw std::runtime_error ("SpGEMM is not implemented for Transposes yet. "
-        "If you need this case please let kokkos-kernels developers know.\n");
-  }
-
-
     typedef typename KernelHandle::const_size_type c_size_t;
     typedef typename KernelHandle::const_nnz_lno_t c_lno_t;
     typedef typename KernelHandle::const_nnz_scalar_t c_scalar_t;
@@ -221,6 +217,31 @@ void spgemm_numeric(
   Internal_clno_nnz_view_t_ nonconst_c_l  ( entriesC.data(), entriesC.extent(0));
   Internal_cscalar_nnz_view_t_ nonconst_c_s ( valuesC.data(), valuesC.extent(0));
 
+  typedef typename KernelHandle::SPGEMMHandleType spgemm_handle_t;
+  spgemm_handle_t *sh = handle->get_spgemm_handle();
+
+  //transposed operands: the values are combined into the structure of the
+  //symbolic phase, reading A and B as stored.
+  if (transposeA || transposeB){
+    KokkosSparse::Impl::spgemm_transposed_numeric(
+        sh, m, const_a_r, const_a_l, const_a_s, transposeA, const_b_r, const_b_l, const_b_s, transposeB,
+        nonconst_c_r, nonconst_c_l, nonconst_c_s);
+    return;
+  }
+
+  //numeric reuse: values only, through the recorded term to position map,
+  //if it was recorded for this C.
+  if (sh->get_numeric_reuse() &&
+      sh->is_numeric_reuse_built_for(entriesC.data(), entriesC.extent(0), valuesC.extent(0))){
+    KokkosSparse::Impl::spgemm_numeric_reuse_apply(
+        sh, m, const_a_r, const_a_l, const_a_s, const_b_r, const_b_s, nonconst_c_r, nonconst_c_s);
+    return;
+  }
+
+  //SPGEMM_KK_AUTO records the team size it chose for numeric phase.
+  if (sh->is_auto_selected() && tmp_handle.get_set_suggested_team_size() == -1){
+    tmp_handle.set_suggested_team_size(sh->get_auto_team_size());
+  }
 
   KokkosSparse::Impl::SPGEMM_NUMERIC<
   const_handle_type, //KernelHandle,
@@ -235,14 +256,20 @@ void spgemm_numeric(
       const_a_r,
       const_a_l,
       const_a_s,
-      transposeA,
+      false,
       const_b_r,
       const_b_l,
       const_b_s,
-      transposeB,
+      false,
       nonconst_c_r,
       nonconst_c_l,
       nonconst_c_s);
+
+  if (sh->get_numeric_reuse()){
+    KokkosSparse::Impl::spgemm_numeric_reuse_build(
+        sh, m, const_a_r, const_a_l, const_b_r, const_b_l, nonconst_c_r,
+        Internal_clno_nnz_view_t_(entriesC.data(), entriesC.extent(0)));
+  }
 }
 
 
@@ -0,0 +1,176 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+/// \file KokkosSparse_spgemm_rap.hpp
+/// \brief Fused Galerkin triple product C = R*A*P.
+///
+/// C is computed as R*(A*P).  Each row of a product goes to a thread
+/// of a team and the rows it combines to the vector lanes, on the host
+/// and on CUDA.  The symbolic phase keeps the sorted structure of A*P on
+/// the handle and of C in C, so the numeric phase does not hash.
+
+#ifndef KOKKOSSPARSE_SPGEMM_RAP_HPP_
+#define KOKKOSSPARSE_SPGEMM_RAP_HPP_
+
+#include "KokkosSparse_CrsMatrix.hpp"
+#include "KokkosSparse_spgemm_rap_impl.hpp"
+#include <sstream>
+
+namespace KokkosSparse {
+
+namespace Impl {
+
+template <class RMatrix, class AMatrix, class PMatrix>
+void spgemm_rap_check_dimensions (const char* name, const RMatrix& R, const AMatrix& A, const PMatrix& P)
+{
+  if (static_cast<size_t> (R.numCols ()) != static_cast<size_t> (A.numRows ()) ||
+      static_cast<size_t> (A.numCols ()) != static_cast<size_t> (P.numRows ())) {
+    std::ostringstream os;
+    os << "KokkosSparse::" << name << ": Dimensions do not match: "
+       << "R: " << R.numRows () << " x " << R.numCols ()
+       << ", A: " << A.numRows () << " x " << A.numCols ()
+       << ", P: " << P.numRows () << " x " << P.numCols ();
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+}
+
+} // namespace Impl
+
+/// \brief Symbolic phase of C = R*A*P.
+///
+/// Allocates C with the structure of R*A*P, with entries sorted within
+/// each row; its values are filled by spgemm_rap_numeric.  The structure
+/// of A*P and the number of entries of C are kept on the spgemm handle,
+/// so that later numeric calls with new values (but the same structure)
+/// of R, A and P skip this phase.  They are kept apart from the state of
+/// spgemm_symbolic and spgemm_add_symbolic, which may share the handle.
+/// The spgemm handle must have been created with
+/// handle->create_spgemm_handle().
+///
+/// \param handle [in/out] KokkosKernelsHandle holding a spgemm handle.
+/// \param R [in] The restriction; KokkosSparse::CrsMatrix instance.
+/// \param A [in] The fine operator; KokkosSparse::CrsMatrix instance.
+/// \param P [in] The prolongation; KokkosSparse::CrsMatrix instance.
+/// \param C [out] The coarse operator; KokkosSparse::CrsMatrix instance.
+template <class KernelHandle, class RMatrix, class AMatrix, class PMatrix, class CMatrix>
+void
+spgemm_rap_symbolic (KernelHandle* handle,
+                     const RMatrix& R,
+                     const AMatrix& A,
+                     const PMatrix& P,
+                     CMatrix& C)
+{
+  typedef typename CMatrix::row_map_type::non_const_type c_row_view_t;
+  typedef typename CMatrix::index_type::non_const_type c_nnz_view_t;
+  typedef typename CMatrix::values_type::non_const_type c_scalar_view_t;
+
+  Impl::spgemm_rap_check_dimensions ("spgemm_rap_symbolic", R, A, P);
+  auto sh = handle->get_spgemm_handle ();
+  if (sh == NULL) {
+    Kokkos::Impl::throw_runtime_exception (
+      "KokkosSparse::spgemm_rap_symbolic: call create_spgemm_handle() first.");
+  }
+
+  c_row_view_t rowmapC ("RAP rowmap", R.numRows () + 1);
+  c_nnz_view_t entriesC ("RAP entries", 0);
+  Impl::spgemm_rap_symbolic_impl (sh, R, A, P, rowmapC, entriesC);
+
+  const size_t c_nnz = entriesC.extent (0);
+  c_scalar_view_t valuesC (Kokkos::ViewAllocateWithoutInitializing ("RAP values"), c_nnz);
+  C = CMatrix ("RAP", R.numRows (), P.numCols (), c_nnz, valuesC, rowmapC, entriesC);
+}
+
+/// \brief Numeric phase of C = R*A*P.
+///
+/// Fills the values of C, which must come from spgemm_rap_symbolic with
+/// the same handle and operands of the same structure.  The values of
+/// A*P are computed once into the structure kept on the handle, then
+/// each term of a row of C is added at the position of its column,
+/// found by binary search in the sorted row.
+template <class KernelHandle, class RMatrix, class AMatrix, class PMatrix, class CMatrix>
+void
+spgemm_rap_numeric (KernelHandle* handle,
+                    const RMatrix& R,
+                    const AMatrix& A,
+                    const PMatrix& P,
+                    CMatrix& C)
+{
+  Impl::spgemm_rap_check_dimensions ("spgemm_rap_numeric", R, A, P);
+  auto sh = handle->get_spgemm_handle ();
+  if (sh == NULL || !sh->is_rap_symbolic_called ()) {
+    Kokkos::Impl::throw_runtime_exception (
+      "KokkosSparse::spgemm_rap_numeric: call spgemm_rap_symbolic() first.");
+  }
+  if (static_cast<size_t> (C.numRows ()) != static_cast<size_t> (R.numRows ()) ||
+      static_cast<size_t> (C.nnz ()) != static_cast<size_t> (sh->get_rap_c_nnz ())) {
+    Kokkos::Impl::throw_runtime_exception (
+      "KokkosSparse::spgemm_rap_numeric: C does not match the symbolic phase.");
+  }
+  Impl::spgemm_rap_numeric_impl (sh, R, A, P, C.graph.row_map, C.graph.entries, C.values);
+}
+
+/// \brief C = R*A*P.
+///
+/// Runs spgemm_rap_symbolic the first time it is called with a handle,
+/// and only spgemm_rap_numeric afterwards.  Call
+/// handle->get_spgemm_handle()->reset_rap_symbolic() when the structure
+/// of R, A or P changes.
+template <class KernelHandle, class RMatrix, class AMatrix, class PMatrix, class CMatrix>
+void
+spgemm_rap (KernelHandle* handle,
+            const RMatrix& R,
+            const AMatrix& A,
+            const PMatrix& P,
+            CMatrix& C)
+{
+  auto sh = handle->get_spgemm_handle ();
+  if (sh == NULL || !sh->is_rap_symbolic_called ()) {
+    spgemm_rap_symbolic (handle, R, A, P, C);
+  }
+  spgemm_rap_numeric (handle, R, A, P, C);
+}
+
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_SPGEMM_RAP_HPP_
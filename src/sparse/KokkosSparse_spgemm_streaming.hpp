@@ -0,0 +1,240 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+/// \file KokkosSparse_spgemm_streaming.hpp
+/// \brief Sparse matrix-matrix multiply C = A*B computed in row batches
+///   under a memory budget.
+
+#ifndef KOKKOSSPARSE_SPGEMM_STREAMING_HPP_
+#define KOKKOSSPARSE_SPGEMM_STREAMING_HPP_
+
+#include "KokkosSparse_CrsMatrix.hpp"
+#include "KokkosSparse_spgemm_symbolic.hpp"
+#include "KokkosSparse_spgemm_numeric.hpp"
+#include "KokkosSparse_spgemm_streaming_impl.hpp"
+#include <sstream>
+#include <vector>
+
+namespace KokkosSparse {
+
+namespace Impl {
+
+/// Runs spgemm_symbolic for each batch of rows of A (see
+/// spgemm_streaming), followed by spgemm_numeric if numeric is true, and
+/// passes the batch to
+///
+///   batch(row_begin, row_end, row_mapC, entriesC, valuesC)
+///
+/// entriesC and valuesC are empty if numeric is false.  All batches run on
+/// the spgemm handle of handle, which compresses B on the first batch and
+/// reuses it for the others.
+template <class KernelHandle, class AMatrix, class BMatrix, class Callback>
+void
+spgemm_streaming_apply (KernelHandle* handle,
+                        const AMatrix& A,
+                        const BMatrix& B,
+                        const bool numeric,
+                        Callback&& batch)
+{
+  typedef typename KernelHandle::HandleExecSpace execution_space;
+  typedef typename AMatrix::non_const_ordinal_type ordinal_type;
+  typedef typename AMatrix::non_const_size_type size_type;
+  typedef typename AMatrix::non_const_value_type scalar_type;
+  typedef typename AMatrix::row_map_type::non_const_type row_map_type;
+  typedef typename AMatrix::index_type::non_const_type entries_type;
+  typedef typename AMatrix::values_type::non_const_type values_type;
+
+  if (static_cast<size_t> (A.numCols ()) != static_cast<size_t> (B.numRows ())) {
+    std::ostringstream os;
+    os << "KokkosSparse::spgemm_streaming: Dimensions do not match: "
+       << "A: " << A.numRows () << " x " << A.numCols ()
+       << ", B: " << B.numRows () << " x " << B.numCols ();
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+  auto sh = handle->get_spgemm_handle ();
+  if (sh == NULL) {
+    Kokkos::Impl::throw_runtime_exception (
+      "KokkosSparse::spgemm_streaming: call create_spgemm_handle() first.");
+  }
+
+  const ordinal_type num_rows = A.numRows ();
+  std::vector<ordinal_type> batch_offsets;
+  spgemm_streaming_batches<execution_space, size_type, ordinal_type, scalar_type> (
+    sh->get_memory_budget (), num_rows, B.numCols (),
+    A.graph.row_map, A.graph.entries, B.graph.row_map, batch_offsets);
+
+  auto h_row_mapA = Kokkos::create_mirror_view (A.graph.row_map);
+  Kokkos::deep_copy (h_row_mapA, A.graph.row_map);
+
+  const bool reuse_compressed_b = sh->get_reuse_compressed_b ();
+  sh->set_reuse_compressed_b (true);
+
+  for (size_t b = 0; b + 1 < batch_offsets.size (); ++b) {
+    const ordinal_type row_begin = batch_offsets[b];
+    const ordinal_type row_end = batch_offsets[b + 1];
+    const ordinal_type batch_rows = row_end - row_begin;
+    const Kokkos::pair<size_type, size_type> a_range (h_row_mapA(row_begin), h_row_mapA(row_end));
+
+    row_map_type row_mapA_batch (Kokkos::ViewAllocateWithoutInitializing ("A batch rowmap"), batch_rows + 1);
+    spgemm_shift_rowmap<execution_space> (A.graph.row_map, row_begin, batch_rows, row_mapA_batch, 0, 0);
+    auto entriesA_batch = Kokkos::subview (A.graph.entries, a_range);
+    auto valuesA_batch = Kokkos::subview (A.values, a_range);
+
+    row_map_type row_mapC ("C batch rowmap", batch_rows + 1);
+    Experimental::spgemm_symbolic (handle, batch_rows, B.numRows (), B.numCols (),
+                                   row_mapA_batch, entriesA_batch, false,
+                                   B.graph.row_map, B.graph.entries, false,
+                                   row_mapC);
+    entries_type entriesC;
+    values_type valuesC;
+    if (numeric) {
+      const size_type c_nnz = sh->get_c_nnz ();
+      entriesC = entries_type (Kokkos::ViewAllocateWithoutInitializing ("C batch entries"), c_nnz);
+      valuesC = values_type (Kokkos::ViewAllocateWithoutInitializing ("C batch values"), c_nnz);
+      Experimental::spgemm_numeric (handle, batch_rows, B.numRows (), B.numCols (),
+                                    row_mapA_batch, entriesA_batch, valuesA_batch, false,
+                                    B.graph.row_map, B.graph.entries, B.values, false,
+                                    row_mapC, entriesC, valuesC);
+    }
+
+    batch (row_begin, row_end, row_mapC, entriesC, valuesC);
+  }
+
+  sh->set_reuse_compressed_b (reuse_compressed_b);
+}
+
+} // namespace Impl
+
+/// \brief C = A*B, computed and emitted in batches of rows.
+///
+/// The rows of A are split into batches whose estimated footprint
+/// (entries and values of the rows of C, and the accumulators of their
+/// largest row) fits in the byte budget set with
+/// handle->get_spgemm_handle()->set_memory_budget().  Each batch runs
+/// spgemm_symbolic and spgemm_numeric on the spgemm handle, with all of
+/// its settings, and is then passed to
+///
+///   emit(row_begin, row_end, row_mapC, entriesC, valuesC)
+///
+/// where row_mapC has row_end - row_begin + 1 entries and starts at 0.
+/// The batch views are released after emit returns, so peak memory does
+/// not depend on the total number of entries of C.  A budget of 0 (the
+/// default) computes C in one batch.  B is compressed once for all
+/// batches.  Afterwards the handle holds the symbolic state of the last
+/// batch.
+///
+/// \param handle [in/out] KokkosKernelsHandle holding a spgemm handle.
+/// \param A [in] KokkosSparse::CrsMatrix instance.
+/// \param B [in] KokkosSparse::CrsMatrix instance.
+/// \param emit [in] Called once per batch, in row order.
+template <class KernelHandle, class AMatrix, class BMatrix, class Callback>
+void
+spgemm_streaming (KernelHandle* handle,
+                  const AMatrix& A,
+                  const BMatrix& B,
+                  Callback&& emit)
+{
+  Impl::spgemm_streaming_apply (handle, A, B, true, emit);
+}
+
+/// \brief C = A*B, computed in batches of rows (see spgemm_streaming) and
+///   appended into C.
+///
+/// A first pass runs only the symbolic phase of each batch, which gives
+/// the rowmap and the number of entries of C, so C is allocated once at
+/// its final size.  The second pass computes each batch and copies it
+/// into its rows of C.  Peak memory is C and one batch, at the cost of
+/// running the symbolic phase of each batch twice.
+template <class KernelHandle, class AMatrix, class BMatrix, class CMatrix>
+void
+spgemm_streaming_append (KernelHandle* handle,
+                         const AMatrix& A,
+                         const BMatrix& B,
+                         CMatrix& C)
+{
+  typedef typename KernelHandle::HandleExecSpace execution_space;
+  typedef typename CMatrix::non_const_size_type size_type;
+  typedef typename CMatrix::row_map_type::non_const_type row_map_type;
+  typedef typename CMatrix::index_type::non_const_type entries_type;
+  typedef typename CMatrix::values_type::non_const_type values_type;
+  typedef typename AMatrix::non_const_ordinal_type ordinal_type;
+
+  row_map_type row_mapC (Kokkos::ViewAllocateWithoutInitializing ("C rowmap"), A.numRows () + 1);
+  Kokkos::deep_copy (Kokkos::subview (row_mapC, 0), size_type (0));
+  size_type c_nnz = 0;
+  Impl::spgemm_streaming_apply (handle, A, B, false,
+    [&] (const ordinal_type row_begin,
+         const ordinal_type row_end,
+         const typename AMatrix::row_map_type::non_const_type& batch_row_map,
+         const typename AMatrix::index_type::non_const_type& /* batch_entries */,
+         const typename AMatrix::values_type::non_const_type& /* batch_values */)
+    {
+      Impl::spgemm_shift_rowmap<execution_space> (batch_row_map, 0, row_end - row_begin,
+                                                  row_mapC, row_begin, c_nnz);
+      c_nnz += handle->get_spgemm_handle ()->get_c_nnz ();
+    });
+
+  entries_type entriesC (Kokkos::ViewAllocateWithoutInitializing ("C entries"), c_nnz);
+  values_type valuesC (Kokkos::ViewAllocateWithoutInitializing ("C values"), c_nnz);
+  size_type offset = 0;
+  Impl::spgemm_streaming_apply (handle, A, B, true,
+    [&] (const ordinal_type /* row_begin */,
+         const ordinal_type /* row_end */,
+         const typename AMatrix::row_map_type::non_const_type& /* batch_row_map */,
+         const typename AMatrix::index_type::non_const_type& batch_entries,
+         const typename AMatrix::values_type::non_const_type& batch_values)
+    {
+      const size_type batch_nnz = batch_entries.extent (0);
+      const Kokkos::pair<size_type, size_type> range (offset, offset + batch_nnz);
+      Kokkos::deep_copy (Kokkos::subview (entriesC, range), batch_entries);
+      Kokkos::deep_copy (Kokkos::subview (valuesC, range), batch_values);
+      offset += batch_nnz;
+    });
+
+  C = CMatrix ("C", A.numRows (), B.numCols (), c_nnz, valuesC, row_mapC, entriesC);
+}
+
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_SPGEMM_STREAMING_HPP_
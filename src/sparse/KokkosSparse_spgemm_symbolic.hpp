@@ -47,6 +47,7 @@
 #include "KokkosKernels_helpers.hpp"
 
 #include "KokkosSparse_spgemm_symbolic_spec.hpp"
+#include "KokkosSparse_spgemm_transpose_impl.hpp"
 
 
 namespace KokkosSparse{
@@ -98,12 +99,6 @@ void spgemm_symbolic(
       typename blno_nnz_view_t_::const_value_type>::value,
       "KokkosSparse::spgemm_symbolic: lno type of right handside matrix should be same as kernelHandle lno_t.");
 
-  if (transposeA || transposeB){
-    throw std::runtime_error ("SpGEMM is not implemented for Transposes yet. "
-        "If you need this case please let kokkos-kernels developers know.\n");
-  }
-
-
   typedef typename KernelHandle::const_size_type c_size_t;
   typedef typename KernelHandle::const_nnz_lno_t c_lno_t;
   typedef typename KernelHandle::const_nnz_scalar_t c_scalar_t;
@@ -157,6 +152,21 @@ void spgemm_symbolic(
   Internal_blno_nnz_view_t_ const_b_l  (entriesB.data(), entriesB.extent(0));
   Internal_clno_row_view_t_ const_c_r  ( row_mapC.data(), row_mapC.extent(0));
 
+  typedef typename KernelHandle::SPGEMMHandleType spgemm_handle_t;
+  spgemm_handle_t *sh = handle->get_spgemm_handle();
+  //a new symbolic phase invalidates a recorded numeric reuse map, and the
+  //structure of a product with transposed operands.
+  sh->reset_numeric_reuse();
+  sh->reset_transposed_product();
+
+  //op(A) is m x n and op(B) is n x k. Transposed operands do not go
+  //through the algorithm of the handle; A and B are read as stored.
+  if (transposeA || transposeB){
+    KokkosSparse::Impl::spgemm_transposed_symbolic(
+        sh, m, n, k, const_a_r, const_a_l, transposeA, const_b_r, const_b_l, transposeB, const_c_r);
+    return;
+  }
+
   using namespace KokkosSparse::Impl;
   SPGEMM_SYMBOLIC<
   	  const_handle_type, //KernelHandle,
@@ -169,10 +179,10 @@ void spgemm_symbolic(
           k,
           const_a_r,
           const_a_l,
-          transposeA,
+          false,
           const_b_r,
           const_b_l,
-          transposeB,
+          false,
           const_c_r);
 
 
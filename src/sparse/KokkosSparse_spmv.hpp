@@ -49,22 +49,30 @@
 #define KOKKOSSPARSE_SPMV_HPP_
 
 #include "KokkosKernels_helpers.hpp"
+#include "KokkosSparse_RankTags.hpp"
 #include "KokkosSparse_spmv_spec.hpp"
 #include "KokkosSparse_spmv_struct_spec.hpp"
 #include <type_traits>
 #include "KokkosSparse_CrsMatrix.hpp"
+#include "KokkosSparse_spmv_handle.hpp"
+#include "KokkosSparse_SellCSigmaMatrix.hpp"
+#include "KokkosSparse_spmv_sellcs_impl.hpp"
+#include "KokkosSparse_CompressedCrsMatrix.hpp"
+#include "KokkosSparse_spmv_compressed_impl.hpp"
+#include "KokkosSparse_BlockCrsMatrix.hpp"
+#include "KokkosSparse_spmv_bsr_impl.hpp"
+#include "KokkosSparse_SymmetricCrsMatrix.hpp"
+#include "KokkosSparse_spmv_symmetric_impl.hpp"
+#include "KokkosSparse_spmv_symbolic_impl.hpp"
+#include "KokkosSparse_spmv_transpose_impl.hpp"
 
 
 namespace KokkosSparse {
 
-namespace {
-  struct RANK_ONE{};
-  struct RANK_TWO{};
-}
-
 template <class AlphaType, class AMatrix, class XVector, class BetaType, class YVector>
 void
-spmv (const char mode[],
+spmv (const SPMVPlan& plan,
+      const char mode[],
       const AlphaType& alpha,
       const AMatrix& A,
       const XVector& x,
@@ -149,14 +157,15 @@ spmv (const char mode[],
               typename YVector_Internal::value_type*,
               typename YVector_Internal::array_layout,
               typename YVector_Internal::device_type,
-              typename YVector_Internal::memory_traits>::spmv (mode, alpha, A_i, x_i, beta, y_i);
+              typename YVector_Internal::memory_traits>::spmv (plan, mode, alpha, A_i, x_i, beta, y_i);
 }
 
 
 template<class AlphaType, class AMatrix, class XVector, class BetaType, class YVector ,
          class XLayout = typename XVector::array_layout>
 struct SPMV2D1D {
-  static bool spmv2d1d (const char mode[],
+  static bool spmv2d1d (const SPMVPlan& plan,
+        const char mode[],
         const AlphaType& alpha,
         const AMatrix& A,
         const XVector& x,
@@ -167,7 +176,8 @@ struct SPMV2D1D {
 
 template<class AlphaType, class AMatrix, class XVector, class BetaType, class YVector>
 struct SPMV2D1D<AlphaType, AMatrix, XVector, BetaType, YVector, Kokkos::LayoutStride>{
-  static bool spmv2d1d (const char mode[],
+  static bool spmv2d1d (const SPMVPlan& plan,
+        const char mode[],
         const AlphaType& alpha,
         const AMatrix& A,
         const XVector& x,
@@ -175,7 +185,7 @@ struct SPMV2D1D<AlphaType, AMatrix, XVector, BetaType, YVector, Kokkos::LayoutSt
         const YVector& y)
   {
 #if defined (KOKKOSKERNELS_INST_LAYOUTSTRIDE) || !defined(KOKKOSKERNELS_ETI_ONLY)
-    spmv (mode, alpha, A, x, beta, y);
+    spmv (plan, mode, alpha, A, x, beta, y, RANK_ONE ());
     return true;
 #else
     return false;
@@ -185,7 +195,8 @@ struct SPMV2D1D<AlphaType, AMatrix, XVector, BetaType, YVector, Kokkos::LayoutSt
 
 template<class AlphaType, class AMatrix, class XVector, class BetaType, class YVector>
 struct SPMV2D1D<AlphaType, AMatrix, XVector, BetaType, YVector, Kokkos::LayoutLeft>{
-  static bool spmv2d1d (const char mode[],
+  static bool spmv2d1d (const SPMVPlan& plan,
+        const char mode[],
         const AlphaType& alpha,
         const AMatrix& A,
         const XVector& x,
@@ -193,7 +204,7 @@ struct SPMV2D1D<AlphaType, AMatrix, XVector, BetaType, YVector, Kokkos::LayoutLe
         const YVector& y)
   {
 #if defined (KOKKOSKERNELS_INST_LAYOUTLEFT) || !defined(KOKKOSKERNELS_ETI_ONLY)
-    spmv (mode, alpha, A, x, beta, y);
+    spmv (plan, mode, alpha, A, x, beta, y, RANK_ONE ());
     return true;
 #else
     return false;
@@ -204,7 +215,8 @@ struct SPMV2D1D<AlphaType, AMatrix, XVector, BetaType, YVector, Kokkos::LayoutLe
 
 template<class AlphaType, class AMatrix, class XVector, class BetaType, class YVector>
 struct SPMV2D1D<AlphaType, AMatrix, XVector, BetaType, YVector, Kokkos::LayoutRight>{
-  static bool spmv2d1d (const char mode[],
+  static bool spmv2d1d (const SPMVPlan& plan,
+        const char mode[],
         const AlphaType& alpha,
         const AMatrix& A,
         const XVector& x,
@@ -212,7 +224,7 @@ struct SPMV2D1D<AlphaType, AMatrix, XVector, BetaType, YVector, Kokkos::LayoutRi
         const YVector& y)
   {
 #if defined (KOKKOSKERNELS_INST_LAYOUTLEFT) || !defined(KOKKOSKERNELS_ETI_ONLY)
-    spmv (mode, alpha, A, x, beta, y);
+    spmv (plan, mode, alpha, A, x, beta, y, RANK_ONE ());
     return true;
 #else
     return false;
@@ -222,7 +234,8 @@ struct SPMV2D1D<AlphaType, AMatrix, XVector, BetaType, YVector, Kokkos::LayoutRi
 
 template<class AlphaType, class AMatrix, class XVector, class BetaType, class YVector>
 void
-spmv (const char mode[],
+spmv (const SPMVPlan& plan,
+      const char mode[],
       const AlphaType& alpha,
       const AMatrix& A,
       const XVector& x,
@@ -293,7 +306,7 @@ spmv (const char mode[],
     using impl_type = SPMV2D1D<AlphaType, AMatrix_Internal,
       XVector_SubInternal, BetaType, YVector_SubInternal,
       typename XVector_SubInternal::array_layout>;
-    if (impl_type::spmv2d1d (mode, alpha, A, x_i, beta, y_i)) {
+    if (impl_type::spmv2d1d (plan, mode, alpha, A, x_i, beta, y_i)) {
       return;
     }
   }
@@ -325,7 +338,7 @@ spmv (const char mode[],
                          typename YVector_Internal::value_type**,
                          typename YVector_Internal::array_layout,
                          typename YVector_Internal::device_type,
-                         typename YVector_Internal::memory_traits>::spmv_mv (mode, alpha, A_i, x_i, beta, y_i);
+                         typename YVector_Internal::memory_traits>::spmv_mv (plan, mode, alpha, A_i, x_i, beta, y_i);
   }
 }
 
@@ -358,9 +371,630 @@ spmv(const char mode[],
   using RANK_SPECIALISE =
     typename std::conditional<static_cast<int> (XVector::rank) == 2,
                               RANK_TWO, RANK_ONE>::type;
-  spmv (mode, alpha, A, x, beta, y, RANK_SPECIALISE ());
+  spmv (SPMVAlgorithm::SPMV_DEFAULT, mode, alpha, A, x, beta, y, RANK_SPECIALISE ());
+}
+
+/// \brief Local sparse matrix-vector multiply with an explicit
+///   choice of algorithm.
+///
+/// Same as above, but \c algo selects the kernel.  SPMV_MERGE_PATH
+/// splits rows and nonzeros evenly across threads, which pays off for
+/// matrices with a few very long rows (e.g. power-law graphs).  It is
+/// only used for the non-transposed modes ("N" and "C"); the
+/// transposed modes always use the native kernels.
+///
+/// \param algo [in] Algorithm to use; see KokkosSparse::SPMVAlgorithm.
+template <class AlphaType, class AMatrix, class XVector, class BetaType, class YVector>
+void
+spmv(const SPMVAlgorithm algo,
+     const char mode[],
+     const AlphaType& alpha,
+     const AMatrix& A,
+     const XVector& x,
+     const BetaType& beta,
+     const YVector& y) {
+  using RANK_SPECIALISE =
+    typename std::conditional<static_cast<int> (XVector::rank) == 2,
+                              RANK_TWO, RANK_ONE>::type;
+  spmv (algo, mode, alpha, A, x, beta, y, RANK_SPECIALISE ());
+}
+
+/// \brief Inspect A once and store an SpMV plan in the handle.
+///
+/// Records the row length range and histogram, the bandwidth and the
+/// dense block size of A, picks the algorithm (if the SPMVHandle was
+/// created with SPMV_DEFAULT) and the launch configuration, and
+/// caches the row partitioning of the OpenMP kernel.  Calling this is
+/// optional: spmv with a handle does it on first use.
+///
+/// \param handle [in/out] KokkosKernelsHandle; create_spmv_handle ()
+///   must have been called on it.
+/// \param A [in] The sparse matrix; KokkosSparse::CrsMatrix instance.
+template <class KernelHandle, class AMatrix>
+void
+spmv_symbolic (KernelHandle* handle, const AMatrix& A) {
+  if (handle->get_spmv_handle () == nullptr) {
+    Kokkos::Impl::throw_runtime_exception
+      ("KokkosSparse::spmv_symbolic: call create_spmv_handle () on the KokkosKernelsHandle first.");
+  }
+  Impl::spmv_symbolic (handle, A);
 }
 
+namespace Impl {
+
+template <class KernelHandle, class AlphaType, class AMatrix, class XVector, class BetaType, class YVector>
+void
+spmv_with_handle (KernelHandle* handle,
+                  const SPMVTransposeAlgorithm transpose_algo,
+                  const char mode[],
+                  const AlphaType& alpha,
+                  const AMatrix& A,
+                  const XVector& x,
+                  const BetaType& beta,
+                  const YVector& y)
+{
+  typedef typename KernelHandle::SPMVHandleType spmv_handle_type;
+
+  auto sh = handle->get_spmv_handle ();
+  if (sh == nullptr) {
+    Kokkos::Impl::throw_runtime_exception
+      ("KokkosSparse::spmv: call create_spmv_handle () on the KokkosKernelsHandle first.");
+  }
+  if (!sh->is_valid_for (A.numRows (), A.numCols (), A.nnz ())) {
+    Impl::spmv_symbolic (handle, A);
+  }
+
+  const bool transposed = (mode[0] == 'T' || mode[0] == 't' ||
+                           mode[0] == 'H' || mode[0] == 'h');
+  if (transposed && transpose_algo == SPMVTransposeAlgorithm::SPMV_TRANSPOSE_EXPLICIT) {
+    typedef CrsMatrix<typename spmv_handle_type::nnz_scalar_t,
+                      typename spmv_handle_type::nnz_lno_t,
+                      Kokkos::Device<typename AMatrix::execution_space,
+                                     typename spmv_handle_type::HandlePersistentMemorySpace>,
+                      void,
+                      typename spmv_handle_type::size_type> transpose_matrix_type;
+
+    // Op(A) x = A^T x ("T") or conj(A^T) x ("H").
+    spmv_transpose_build_explicit (sh, A);
+    transpose_matrix_type AT ("A^T", A.numCols (), A.numRows (), A.nnz (),
+                              sh->get_transpose_values (),
+                              sh->get_transpose_row_map (),
+                              sh->get_transpose_entries ());
+    const bool conjugate = (mode[0] == 'H' || mode[0] == 'h');
+    KokkosSparse::spmv (SPMVAlgorithm::SPMV_DEFAULT, conjugate ? "C" : "N", alpha, AT, x, beta, y);
+    return;
+  }
+  if (transposed && transpose_algo == SPMVTransposeAlgorithm::SPMV_TRANSPOSE_COLORED) {
+    if ((static_cast<size_t> (A.numRows ()) > static_cast<size_t> (x.extent(0))) ||
+        (static_cast<size_t> (A.numCols ()) > static_cast<size_t> (y.extent(0))) ||
+        (x.extent(1) != y.extent(1))) {
+      std::ostringstream os;
+      os << "KokkosSparse::spmv: Dimensions do not match: "
+         << ", A: " << A.numRows () << " x " << A.numCols ()
+         << ", x: " << x.extent(0) << " x " << x.extent(1)
+         << ", y: " << y.extent(0) << " x " << y.extent(1)
+         ;
+      Kokkos::Impl::throw_runtime_exception (os.str ());
+    }
+    spmv_transpose_build_colors (sh, A);
+    spmv_transpose_colored (mode, alpha, A,
+                            sh->get_transpose_color_rows (),
+                            sh->get_transpose_color_offsets (),
+                            x, beta, y);
+    return;
+  }
+
+  if (!transposed && sh->has_block_graph ()) {
+    // A is made of dense blocks and its values are already in
+    // BlockCrsMatrix order: apply it as a BlockCrsMatrix that shares
+    // the values of A.
+    typedef Experimental::BlockCrsMatrix<typename AMatrix::value_type,
+                                         typename AMatrix::non_const_ordinal_type,
+                                         typename AMatrix::device_type,
+                                         void,
+                                         typename AMatrix::non_const_size_type> block_matrix_type;
+    const auto block_size = sh->get_block_size ();
+    typename block_matrix_type::staticcrsgraph_type block_graph (sh->get_block_entries (), sh->get_block_row_map ());
+    block_matrix_type A_block ("A (blocks)", A.numCols () / block_size, A.values, block_graph, block_size);
+    KokkosSparse::spmv (mode, alpha, A_block, x, beta, y);
+    return;
+  }
+
+  // The row partitioning of the raw OpenMP kernel belongs to the graph
+  // (StaticCrsGraph::row_block_offsets), so it is set on a shallow copy
+  // of A.  The launch configuration is passed with the plan.
+  AMatrix A_partitioned = A;
+  if (sh->get_row_block_offsets ().extent (0) > 0) {
+    A_partitioned.graph.row_block_offsets = sh->get_row_block_offsets ();
+  }
+  const int team_size = sh->get_launch_team_size ();
+  const SPMVPlan plan (sh->get_chosen_algorithm (),
+                       sh->get_launch_num_teams (),
+                       team_size > 0 ? team_size : -1,
+                       sh->get_launch_vector_size ());
+  using RANK_SPECIALISE =
+    typename std::conditional<static_cast<int> (XVector::rank) == 2,
+                              RANK_TWO, RANK_ONE>::type;
+  KokkosSparse::spmv (plan, mode, alpha, A_partitioned, x, beta, y, RANK_SPECIALISE ());
+}
+
+} // namespace Impl
+
+/// \brief Local sparse matrix-vector multiply reusing the plan stored
+///   in a handle.
+///
+/// Same as spmv (mode, alpha, A, x, beta, y), but the kernel, launch
+/// configuration and row partitioning come from the SPMVHandle of \c
+/// handle.  The matrix is inspected (see spmv_symbolic) on the first
+/// call, and again only if its dimensions or number of entries change.
+/// Call reset_inspected () on the SPMVHandle after changing the
+/// structure of A in place.
+///
+/// The transposed modes use the SPMVTransposeAlgorithm of the
+/// SPMVHandle (see set_transpose_algorithm).  Only the structure of A
+/// is cached, so the values of A may change between calls.
+///
+/// \param handle [in/out] KokkosKernelsHandle; create_spmv_handle ()
+///   must have been called on it.
+template <class KernelHandle, class AlphaType, class AMatrix, class XVector, class BetaType, class YVector>
+void
+spmv(KernelHandle* handle,
+     const char mode[],
+     const AlphaType& alpha,
+     const AMatrix& A,
+     const XVector& x,
+     const BetaType& beta,
+     const YVector& y) {
+  if (handle->get_spmv_handle () == nullptr) {
+    Kokkos::Impl::throw_runtime_exception
+      ("KokkosSparse::spmv: call create_spmv_handle () on the KokkosKernelsHandle first.");
+  }
+  Impl::spmv_with_handle (handle, handle->get_spmv_handle ()->get_transpose_algorithm (),
+                          mode, alpha, A, x, beta, y);
+}
+
+/// \brief Local sparse matrix-vector multiply reusing the plan stored
+///   in a handle, with the transpose algorithm chosen for this call.
+///
+/// Same as spmv (handle, mode, alpha, A, x, beta, y), but the
+/// transposed modes use \c transpose_algo instead of the
+/// SPMVTransposeAlgorithm of the SPMVHandle.  The explicit transpose
+/// and the coloring are cached separately, so calls may alternate
+/// between them.
+template <class KernelHandle, class AlphaType, class AMatrix, class XVector, class BetaType, class YVector>
+void
+spmv(KernelHandle* handle,
+     const SPMVTransposeAlgorithm transpose_algo,
+     const char mode[],
+     const AlphaType& alpha,
+     const AMatrix& A,
+     const XVector& x,
+     const BetaType& beta,
+     const YVector& y) {
+  Impl::spmv_with_handle (handle, transpose_algo, mode, alpha, A, x, beta, y);
+}
+
+/// \brief Local sparse matrix-vector multiply with a matrix in
+///   SELL-C-sigma format.
+///
+/// Computes y := beta*y + alpha*Op(A)*x, where Op(A) is A ("N") or
+/// conj(A) ("C").  The transposed modes are not supported for this
+/// format.  x and y are in the row order of the CrsMatrix that A was
+/// built from.
+///
+/// \param mode [in] "N" for no transpose or "C" for conjugate.
+/// \param alpha [in] Scalar multiplier for the matrix A.
+/// \param A [in] The sparse matrix; KokkosSparse::Experimental::SellCSigmaMatrix instance.
+/// \param x [in] A single vector (rank-1 Kokkos::View).
+/// \param beta [in] Scalar multiplier for the vector y.
+/// \param y [in/out] A single vector (rank-1 Kokkos::View).
+template <class AlphaType, class ScalarType, class OrdinalType, class Device,
+          class MemoryTraits, class SizeType, class XVector, class BetaType, class YVector>
+void
+spmv(const char mode[],
+     const AlphaType& alpha,
+     const Experimental::SellCSigmaMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType>& A,
+     const XVector& x,
+     const BetaType& beta,
+     const YVector& y) {
+  static_assert (static_cast<int> (XVector::rank) == 1 &&
+                 static_cast<int> (YVector::rank) == 1,
+    "KokkosSparse::spmv: SellCSigmaMatrix requires rank 1 Vector inputs.");
+  static_assert (std::is_same<typename YVector::value_type,
+                   typename YVector::non_const_value_type>::value,
+    "KokkosSparse::spmv: Output Vector must be non-const.");
+
+  if ((static_cast<size_t> (A.numCols ()) > static_cast<size_t> (x.extent(0))) ||
+      (static_cast<size_t> (A.numRows ()) > static_cast<size_t> (y.extent(0)))) {
+    std::ostringstream os;
+    os << "KokkosSparse::spmv: Dimensions do not match: "
+       << ", A: " << A.numRows () << " x " << A.numCols()
+       << ", x: " << x.extent(0)
+       << ", y: " << y.extent(0)
+       ;
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+
+  typedef Kokkos::View<
+            typename XVector::const_value_type*,
+            typename KokkosKernels::Impl::GetUnifiedLayout<XVector>::array_layout,
+            typename XVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > XVector_Internal;
+
+  typedef Kokkos::View<
+            typename YVector::non_const_value_type*,
+            typename KokkosKernels::Impl::GetUnifiedLayout<YVector>::array_layout,
+            typename YVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged> > YVector_Internal;
+
+  XVector_Internal x_i = x;
+  YVector_Internal y_i = y;
+
+  Impl::spmv_sellcs (mode, alpha, A, x_i, beta, y_i);
+}
+
+/// \brief Local sparse matrix-vector multiply with a matrix in
+///   compressed (mixed precision) CRS format.
+///
+/// Computes y := beta*y + alpha*Op(A)*x, where Op(A) is A ("N") or
+/// conj(A) ("C").  The values of A are stored in reduced precision,
+/// but every product is formed and summed in ScalarType.  The
+/// transposed modes are not supported for this format.
+///
+/// \param mode [in] "N" for no transpose or "C" for conjugate.
+/// \param alpha [in] Scalar multiplier for the matrix A.
+/// \param A [in] The sparse matrix; KokkosSparse::Experimental::CompressedCrsMatrix instance.
+/// \param x [in] A single vector (rank-1 Kokkos::View).
+/// \param beta [in] Scalar multiplier for the vector y.
+/// \param y [in/out] A single vector (rank-1 Kokkos::View).
+template <class AlphaType, class ScalarType, class OrdinalType, class Device,
+          class MemoryTraits, class SizeType, class StorageType,
+          class XVector, class BetaType, class YVector>
+void
+spmv(const char mode[],
+     const AlphaType& alpha,
+     const Experimental::CompressedCrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType, StorageType>& A,
+     const XVector& x,
+     const BetaType& beta,
+     const YVector& y) {
+  static_assert (static_cast<int> (XVector::rank) == 1 &&
+                 static_cast<int> (YVector::rank) == 1,
+    "KokkosSparse::spmv: CompressedCrsMatrix requires rank 1 Vector inputs.");
+  static_assert (std::is_same<typename YVector::value_type,
+                   typename YVector::non_const_value_type>::value,
+    "KokkosSparse::spmv: Output Vector must be non-const.");
+
+  if ((static_cast<size_t> (A.numCols ()) > static_cast<size_t> (x.extent(0))) ||
+      (static_cast<size_t> (A.numRows ()) > static_cast<size_t> (y.extent(0)))) {
+    std::ostringstream os;
+    os << "KokkosSparse::spmv: Dimensions do not match: "
+       << ", A: " << A.numRows () << " x " << A.numCols()
+       << ", x: " << x.extent(0)
+       << ", y: " << y.extent(0)
+       ;
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+
+  typedef Kokkos::View<
+            typename XVector::const_value_type*,
+            typename KokkosKernels::Impl::GetUnifiedLayout<XVector>::array_layout,
+            typename XVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > XVector_Internal;
+
+  typedef Kokkos::View<
+            typename YVector::non_const_value_type*,
+            typename KokkosKernels::Impl::GetUnifiedLayout<YVector>::array_layout,
+            typename YVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged> > YVector_Internal;
+
+  XVector_Internal x_i = x;
+  YVector_Internal y_i = y;
+
+  Impl::spmv_compressed (mode, alpha, A, x_i, beta, y_i);
+}
+
+namespace Impl {
+
+template <class AMatrix, class XVector, class BetaType, class YVector, class AlphaType>
+void
+spmv_bsr_unified (const char mode[],
+                  const AlphaType& alpha,
+                  const AMatrix& A,
+                  const XVector& x,
+                  const BetaType& beta,
+                  const YVector& y,
+                  const RANK_ONE)
+{
+  typedef Kokkos::View<
+            typename XVector::const_value_type*,
+            typename KokkosKernels::Impl::GetUnifiedLayout<XVector>::array_layout,
+            typename XVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > XVector_Internal;
+
+  typedef Kokkos::View<
+            typename YVector::non_const_value_type*,
+            typename KokkosKernels::Impl::GetUnifiedLayout<YVector>::array_layout,
+            typename YVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged> > YVector_Internal;
+
+  XVector_Internal x_i = x;
+  YVector_Internal y_i = y;
+  spmv_bsr (mode, alpha, A, x_i, beta, y_i);
+}
+
+template <class AMatrix, class XVector, class BetaType, class YVector, class AlphaType>
+void
+spmv_bsr_unified (const char mode[],
+                  const AlphaType& alpha,
+                  const AMatrix& A,
+                  const XVector& x,
+                  const BetaType& beta,
+                  const YVector& y,
+                  const RANK_TWO)
+{
+  typedef Kokkos::View<
+            typename XVector::const_value_type**,
+            typename KokkosKernels::Impl::GetUnifiedLayout<XVector>::array_layout,
+            typename XVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > XVector_Internal;
+
+  typedef Kokkos::View<
+            typename YVector::non_const_value_type**,
+            typename KokkosKernels::Impl::GetUnifiedLayout<YVector>::array_layout,
+            typename YVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged> > YVector_Internal;
+
+  XVector_Internal x_i = x;
+  YVector_Internal y_i = y;
+  spmv_bsr (mode, alpha, A, x_i, beta, y_i);
+}
+
+} // namespace Impl
+
+/// \brief Local sparse matrix-vector multiply with a matrix in block
+///   compressed row (BSR) format.
+///
+/// Computes y := beta*y + alpha*Op(A)*x, where Op(A) is A ("N") or
+/// conj(A) ("C"), without expanding A to point CRS.  Block sizes 2 to
+/// 8 use kernels that unroll the dense block products; other block
+/// sizes use a generic kernel.  The transposed modes are not
+/// supported for this format.
+///
+/// \param mode [in] "N" for no transpose or "C" for conjugate.
+/// \param alpha [in] Scalar multiplier for the matrix A.
+/// \param A [in] The sparse matrix; KokkosSparse::Experimental::BlockCrsMatrix instance.
+/// \param x [in] Either a single vector (rank-1 Kokkos::View) or
+///   multivector (rank-2 Kokkos::View), with A.numCols()*A.blockDim() rows.
+/// \param beta [in] Scalar multiplier for the (multi)vector y.
+/// \param y [in/out] Either a single vector (rank-1 Kokkos::View) or
+///   multivector (rank-2 Kokkos::View).  It must have the same number
+///   of columns as x, and A.numRows()*A.blockDim() rows.
+template <class AlphaType, class ScalarType, class OrdinalType, class Device,
+          class MemoryTraits, class SizeType, class XVector, class BetaType, class YVector>
+void
+spmv(const char mode[],
+     const AlphaType& alpha,
+     const Experimental::BlockCrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType>& A,
+     const XVector& x,
+     const BetaType& beta,
+     const YVector& y) {
+  static_assert (static_cast<int> (XVector::rank) ==
+                 static_cast<int> (YVector::rank),
+    "KokkosSparse::spmv: Vector ranks do not match.");
+  static_assert (static_cast<int> (XVector::rank) == 1 ||
+                 static_cast<int> (XVector::rank) == 2,
+    "KokkosSparse::spmv: BlockCrsMatrix requires rank 1 or rank 2 Vector inputs.");
+  static_assert (std::is_same<typename YVector::value_type,
+                   typename YVector::non_const_value_type>::value,
+    "KokkosSparse::spmv: Output Vector must be non-const.");
+
+  const int64_t numPointRows = static_cast<int64_t> (A.numRows ()) * A.blockDim ();
+  const int64_t numPointCols = static_cast<int64_t> (A.numCols ()) * A.blockDim ();
+  if ((numPointCols > static_cast<int64_t> (x.extent(0))) ||
+      (numPointRows > static_cast<int64_t> (y.extent(0))) ||
+      (x.extent(1) != y.extent(1))) {
+    std::ostringstream os;
+    os << "KokkosSparse::spmv: Dimensions do not match: "
+       << ", A: " << numPointRows << " x " << numPointCols
+       << " (block size " << A.blockDim () << ")"
+       << ", x: " << x.extent(0) << " x " << x.extent(1)
+       << ", y: " << y.extent(0) << " x " << y.extent(1)
+       ;
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+
+  using RANK_SPECIALISE =
+    typename std::conditional<static_cast<int> (XVector::rank) == 2,
+                              RANK_TWO, RANK_ONE>::type;
+  Impl::spmv_bsr_unified (mode, alpha, A, x, beta, y, RANK_SPECIALISE ());
+}
+
+namespace Impl {
+
+template <class AMatrix, class XVector, class BetaType, class YVector, class AlphaType>
+void
+spmv_symmetric_unified (const char mode[],
+                        const AlphaType& alpha,
+                        const AMatrix& A,
+                        const XVector& x,
+                        const BetaType& beta,
+                        const YVector& y,
+                        const RANK_ONE)
+{
+  typedef Kokkos::View<
+            typename XVector::const_value_type*,
+            typename KokkosKernels::Impl::GetUnifiedLayout<XVector>::array_layout,
+            typename XVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > XVector_Internal;
+
+  typedef Kokkos::View<
+            typename YVector::non_const_value_type*,
+            typename KokkosKernels::Impl::GetUnifiedLayout<YVector>::array_layout,
+            typename YVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged> > YVector_Internal;
+
+  XVector_Internal x_i = x;
+  YVector_Internal y_i = y;
+  spmv_symmetric (mode, alpha, A, x_i, beta, y_i);
+}
+
+template <class AMatrix, class XVector, class BetaType, class YVector, class AlphaType>
+void
+spmv_symmetric_unified (const char mode[],
+                        const AlphaType& alpha,
+                        const AMatrix& A,
+                        const XVector& x,
+                        const BetaType& beta,
+                        const YVector& y,
+                        const RANK_TWO)
+{
+  typedef Kokkos::View<
+            typename XVector::const_value_type**,
+            typename KokkosKernels::Impl::GetUnifiedLayout<XVector>::array_layout,
+            typename XVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > XVector_Internal;
+
+  typedef Kokkos::View<
+            typename YVector::non_const_value_type**,
+            typename KokkosKernels::Impl::GetUnifiedLayout<YVector>::array_layout,
+            typename YVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged> > YVector_Internal;
+
+  XVector_Internal x_i = x;
+  YVector_Internal y_i = y;
+  spmv_symmetric (mode, alpha, A, x_i, beta, y_i);
+}
+
+} // namespace Impl
+
+/// \brief Local sparse matrix-vector multiply with a symmetric or
+///   Hermitian matrix that stores only its lower triangle.
+///
+/// Computes y := beta*y + alpha*Op(A)*x, reading each stored entry of
+/// A once for both triangles.  The rows are processed color by color
+/// (see KokkosSparse::Experimental::SymmetricCrsMatrix), so the
+/// updates of y through the upper triangle need no atomics.  All
+/// modes ("N", "T", "C", "H") are supported.
+///
+/// \param mode [in] "N", "T", "C" or "H".
+/// \param alpha [in] Scalar multiplier for the matrix A.
+/// \param A [in] The sparse matrix; KokkosSparse::Experimental::SymmetricCrsMatrix instance.
+/// \param x [in] Either a single vector (rank-1 Kokkos::View) or
+///   multivector (rank-2 Kokkos::View).
+/// \param beta [in] Scalar multiplier for the (multi)vector y.
+/// \param y [in/out] Either a single vector (rank-1 Kokkos::View) or
+///   multivector (rank-2 Kokkos::View).  It must have the same number
+///   of columns as x.
+template <class AlphaType, class ScalarType, class OrdinalType, class Device,
+          class MemoryTraits, class SizeType, class XVector, class BetaType, class YVector>
+void
+spmv(const char mode[],
+     const AlphaType& alpha,
+     const Experimental::SymmetricCrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType>& A,
+     const XVector& x,
+     const BetaType& beta,
+     const YVector& y) {
+  static_assert (static_cast<int> (XVector::rank) ==
+                 static_cast<int> (YVector::rank),
+    "KokkosSparse::spmv: Vector ranks do not match.");
+  static_assert (static_cast<int> (XVector::rank) == 1 ||
+                 static_cast<int> (XVector::rank) == 2,
+    "KokkosSparse::spmv: SymmetricCrsMatrix requires rank 1 or rank 2 Vector inputs.");
+  static_assert (std::is_same<typename YVector::value_type,
+                   typename YVector::non_const_value_type>::value,
+    "KokkosSparse::spmv: Output Vector must be non-const.");
+
+  if ((static_cast<size_t> (A.numCols ()) > static_cast<size_t> (x.extent(0))) ||
+      (static_cast<size_t> (A.numRows ()) > static_cast<size_t> (y.extent(0))) ||
+      (x.extent(1) != y.extent(1))) {
+    std::ostringstream os;
+    os << "KokkosSparse::spmv: Dimensions do not match: "
+       << ", A: " << A.numRows () << " x " << A.numCols ()
+       << ", x: " << x.extent(0) << " x " << x.extent(1)
+       << ", y: " << y.extent(0) << " x " << y.extent(1)
+       ;
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+
+  using RANK_SPECIALISE =
+    typename std::conditional<static_cast<int> (XVector::rank) == 2,
+                              RANK_TWO, RANK_ONE>::type;
+  Impl::spmv_symmetric_unified (mode, alpha, A, x, beta, y, RANK_SPECIALISE ());
+}
+
+namespace Experimental {
+
+/// \brief Local sparse matrix-vector multiply over a semiring.
+///
+/// Computes y := A*x, or y := y + A*x if accumulate is true, where the
+/// sums and products are Semiring::add and Semiring::multiply.  For
+/// example, with MinPlusSemiring one call is a Bellman-Ford relaxation
+/// step, and with OrAndSemiring it expands a BFS frontier.  See
+/// KokkosKernels_Semiring.hpp for the predefined semirings.  The
+/// Semiring's value_type must be the value type of y.
+///
+/// \param semiring [in] The semiring; only its type is used.
+/// \param A [in] The sparse matrix; KokkosSparse::CrsMatrix instance.
+/// \param x [in] A single vector (rank-1 Kokkos::View).
+/// \param y [in/out] A single vector (rank-1 Kokkos::View).
+/// \param accumulate [in] If true, add A*x to y in the semiring.
+template <class Semiring, class AMatrix, class XVector, class YVector>
+void
+spmv_semiring (const Semiring& /* semiring */,
+               const AMatrix& A,
+               const XVector& x,
+               const YVector& y,
+               const bool accumulate = false)
+{
+  static_assert (static_cast<int> (XVector::rank) == 1 &&
+                 static_cast<int> (YVector::rank) == 1,
+    "KokkosSparse::spmv_semiring: requires rank 1 Vector inputs.");
+  static_assert (std::is_same<typename YVector::value_type,
+                   typename YVector::non_const_value_type>::value,
+    "KokkosSparse::spmv_semiring: Output Vector must be non-const.");
+  static_assert (std::is_same<typename std::remove_cv<typename Semiring::value_type>::type,
+                   typename YVector::non_const_value_type>::value,
+    "KokkosSparse::spmv_semiring: Semiring::value_type must be the value type of y.");
+
+  if ((static_cast<size_t> (A.numCols ()) > static_cast<size_t> (x.extent(0))) ||
+      (static_cast<size_t> (A.numRows ()) > static_cast<size_t> (y.extent(0)))) {
+    std::ostringstream os;
+    os << "KokkosSparse::spmv_semiring: Dimensions do not match: "
+       << ", A: " << A.numRows () << " x " << A.numCols()
+       << ", x: " << x.extent(0)
+       << ", y: " << y.extent(0)
+       ;
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+
+  typedef KokkosSparse::CrsMatrix<
+            typename AMatrix::const_value_type,
+            typename AMatrix::const_ordinal_type,
+            typename AMatrix::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged>,
+            typename AMatrix::const_size_type> AMatrix_Internal;
+
+  typedef Kokkos::View<
+            typename XVector::const_value_type*,
+            typename KokkosKernels::Impl::GetUnifiedLayout<XVector>::array_layout,
+            typename XVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > XVector_Internal;
+
+  typedef Kokkos::View<
+            typename YVector::non_const_value_type*,
+            typename KokkosKernels::Impl::GetUnifiedLayout<YVector>::array_layout,
+            typename YVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged> > YVector_Internal;
+
+  AMatrix_Internal A_i = A;
+  XVector_Internal x_i = x;
+  YVector_Internal y_i = y;
+
+  Impl::spmv_semiring_no_transpose<Semiring> (A_i, x_i, y_i, accumulate);
+}
+
+} // namespace Experimental
+
   namespace Experimental {
 
     template <class AlphaType, class AMatrix, class XVector, class BetaType, class YVector>
@@ -639,7 +1273,7 @@ spmv(const char mode[],
                              typename YVector_Internal::value_type**,
                              typename YVector_Internal::array_layout,
                              typename YVector_Internal::device_type,
-                             typename YVector_Internal::memory_traits>::spmv_mv (mode, alpha, A_i, x_i, beta, y_i);
+                             typename YVector_Internal::memory_traits>::spmv_mv (SPMVAlgorithm::SPMV_DEFAULT, mode, alpha, A_i, x_i, beta, y_i);
       }
     }
 
@@ -0,0 +1,237 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+/// \file KokkosSparse_spmv_fused.hpp
+/// \brief Sparse matrix-vector multiply fused with a reduction
+///
+/// Krylov solvers follow most sparse matrix-vector multiplies with a
+/// dot product or a norm of the result.  The kernels in this file do
+/// both in one pass, so that the output vector is streamed from
+/// memory once instead of twice.
+
+#ifndef KOKKOSSPARSE_SPMV_FUSED_HPP_
+#define KOKKOSSPARSE_SPMV_FUSED_HPP_
+
+#include "KokkosKernels_helpers.hpp"
+#include "KokkosSparse_CrsMatrix.hpp"
+#include "KokkosSparse_BlockCrsMatrix.hpp"
+#include "KokkosSparse_spmv_fused_impl.hpp"
+#include <sstream>
+#include <type_traits>
+
+namespace KokkosSparse {
+
+namespace Impl {
+
+template<class AMatrix, class XVector, class YVector>
+void
+spmv_fused_check_arguments (const char name[],
+                            const AMatrix& /* A */,
+                            const XVector& x,
+                            const YVector& y,
+                            const int64_t numPointRows,
+                            const int64_t numPointCols)
+{
+  static_assert (static_cast<int> (XVector::rank) == 1 &&
+                 static_cast<int> (YVector::rank) == 1,
+    "KokkosSparse::spmv_dot/spmv_axpby_nrm2: x and y must be rank 1 Views.");
+  static_assert (std::is_same<typename YVector::value_type,
+                   typename YVector::non_const_value_type>::value,
+    "KokkosSparse::spmv_dot/spmv_axpby_nrm2: Output Vector must be non-const.");
+
+  // The reduction pairs x(i) with y(i), so x and y must have the
+  // same length, which requires a square A.
+  if ((numPointRows != numPointCols) ||
+      (numPointCols > static_cast<int64_t> (x.extent(0))) ||
+      (numPointRows > static_cast<int64_t> (y.extent(0)))) {
+    std::ostringstream os;
+    os << "KokkosSparse::" << name << ": Dimensions do not match "
+       << "or A is not square"
+       << ", A: " << numPointRows << " x " << numPointCols
+       << ", x: " << x.extent(0)
+       << ", y: " << y.extent(0)
+       ;
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+}
+
+template<class XVector>
+struct SPMV_Fused_XVector {
+  typedef Kokkos::View<
+            typename XVector::const_value_type*,
+            typename KokkosKernels::Impl::GetUnifiedLayout<XVector>::array_layout,
+            typename XVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > type;
+};
+
+template<class YVector>
+struct SPMV_Fused_YVector {
+  typedef Kokkos::View<
+            typename YVector::non_const_value_type*,
+            typename KokkosKernels::Impl::GetUnifiedLayout<YVector>::array_layout,
+            typename YVector::device_type,
+            Kokkos::MemoryTraits<Kokkos::Unmanaged> > type;
+};
+
+} // namespace Impl
+
+/// \brief y := beta*y + alpha*Op(A)*x, and return dot(x, y) of the
+///   new y.
+///
+/// This is spmv followed by KokkosBlas::dot(x, y), in one pass over
+/// y.  A must be square.  A conjugated dot product conj(x)^T y is
+/// used for complex types.
+///
+/// \param mode [in] "N" for no transpose or "C" for conjugate.
+/// \param alpha [in] Scalar multiplier for the matrix A.
+/// \param A [in] The sparse matrix; KokkosSparse::CrsMatrix instance.
+/// \param x [in] A single vector (rank-1 Kokkos::View).
+/// \param beta [in] Scalar multiplier for the vector y.
+/// \param y [in/out] A single vector (rank-1 Kokkos::View).
+template <class AlphaType, class ScalarType, class OrdinalType, class Device,
+          class MemoryTraits, class SizeType, class XVector, class BetaType, class YVector>
+typename YVector::non_const_value_type
+spmv_dot (const char mode[],
+          const AlphaType& alpha,
+          const CrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType>& A,
+          const XVector& x,
+          const BetaType& beta,
+          const YVector& y)
+{
+  typedef CrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType> AMatrix;
+  Impl::spmv_fused_check_arguments ("spmv_dot", A, x, y, A.numRows (), A.numCols ());
+  typename Impl::SPMV_Fused_XVector<XVector>::type x_i = x;
+  typename Impl::SPMV_Fused_YVector<YVector>::type y_i = y;
+  return Impl::spmv_fused<AMatrix, decltype (x_i), decltype (y_i), false> (mode, alpha, A, x_i, beta, y_i);
+}
+
+/// \brief y := beta*y + alpha*Op(A)*x, and return dot(x, y) of the
+///   new y, for a BlockCrsMatrix A.
+///
+/// x and y are indexed by point rows, i.e. they have
+/// A.numRows()*A.blockDim() entries.
+template <class AlphaType, class ScalarType, class OrdinalType, class Device,
+          class MemoryTraits, class SizeType, class XVector, class BetaType, class YVector>
+typename YVector::non_const_value_type
+spmv_dot (const char mode[],
+          const AlphaType& alpha,
+          const Experimental::BlockCrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType>& A,
+          const XVector& x,
+          const BetaType& beta,
+          const YVector& y)
+{
+  typedef Experimental::BlockCrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType> AMatrix;
+  Impl::spmv_fused_check_arguments ("spmv_dot", A, x, y,
+                                    static_cast<int64_t> (A.numRows ()) * A.blockDim (),
+                                    static_cast<int64_t> (A.numCols ()) * A.blockDim ());
+  typename Impl::SPMV_Fused_XVector<XVector>::type x_i = x;
+  typename Impl::SPMV_Fused_YVector<YVector>::type y_i = y;
+  return Impl::spmv_block_fused<AMatrix, decltype (x_i), decltype (y_i), false> (mode, alpha, A, x_i, beta, y_i);
+}
+
+/// \brief y := A*x, and return dot(x, y).
+///
+/// This is the p^T A p step of conjugate gradients.
+template <class AMatrix, class XVector, class YVector>
+typename YVector::non_const_value_type
+spmv_dot (const AMatrix& A, const XVector& x, const YVector& y)
+{
+  typedef Kokkos::Details::ArithTraits<typename YVector::non_const_value_type> KAT;
+  return spmv_dot ("N", KAT::one (), A, x, KAT::zero (), y);
+}
+
+/// \brief y := beta*y + alpha*Op(A)*x, and return the 2-norm of the
+///   new y.
+///
+/// This is spmv followed by KokkosBlas::nrm2(y), in one pass over y;
+/// e.g. the residual update r := r - alpha*A*p and ||r|| of
+/// conjugate gradients.  A must be square.
+///
+/// \param mode [in] "N" for no transpose or "C" for conjugate.
+/// \param alpha [in] Scalar multiplier for the matrix A.
+/// \param A [in] The sparse matrix; KokkosSparse::CrsMatrix instance.
+/// \param x [in] A single vector (rank-1 Kokkos::View).
+/// \param beta [in] Scalar multiplier for the vector y.
+/// \param y [in/out] A single vector (rank-1 Kokkos::View).
+template <class AlphaType, class ScalarType, class OrdinalType, class Device,
+          class MemoryTraits, class SizeType, class XVector, class BetaType, class YVector>
+typename Kokkos::Details::ArithTraits<typename YVector::non_const_value_type>::mag_type
+spmv_axpby_nrm2 (const char mode[],
+                 const AlphaType& alpha,
+                 const CrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType>& A,
+                 const XVector& x,
+                 const BetaType& beta,
+                 const YVector& y)
+{
+  typedef CrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType> AMatrix;
+  Impl::spmv_fused_check_arguments ("spmv_axpby_nrm2", A, x, y, A.numRows (), A.numCols ());
+  typename Impl::SPMV_Fused_XVector<XVector>::type x_i = x;
+  typename Impl::SPMV_Fused_YVector<YVector>::type y_i = y;
+  return Impl::spmv_fused<AMatrix, decltype (x_i), decltype (y_i), true> (mode, alpha, A, x_i, beta, y_i);
+}
+
+/// \brief y := beta*y + alpha*Op(A)*x, and return the 2-norm of the
+///   new y, for a BlockCrsMatrix A.
+template <class AlphaType, class ScalarType, class OrdinalType, class Device,
+          class MemoryTraits, class SizeType, class XVector, class BetaType, class YVector>
+typename Kokkos::Details::ArithTraits<typename YVector::non_const_value_type>::mag_type
+spmv_axpby_nrm2 (const char mode[],
+                 const AlphaType& alpha,
+                 const Experimental::BlockCrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType>& A,
+                 const XVector& x,
+                 const BetaType& beta,
+                 const YVector& y)
+{
+  typedef Experimental::BlockCrsMatrix<ScalarType, OrdinalType, Device, MemoryTraits, SizeType> AMatrix;
+  Impl::spmv_fused_check_arguments ("spmv_axpby_nrm2", A, x, y,
+                                    static_cast<int64_t> (A.numRows ()) * A.blockDim (),
+                                    static_cast<int64_t> (A.numCols ()) * A.blockDim ());
+  typename Impl::SPMV_Fused_XVector<XVector>::type x_i = x;
+  typename Impl::SPMV_Fused_YVector<YVector>::type y_i = y;
+  return Impl::spmv_block_fused<AMatrix, decltype (x_i), decltype (y_i), true> (mode, alpha, A, x_i, beta, y_i);
+}
+
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_SPMV_FUSED_HPP_
@@ -0,0 +1,398 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+
+#include <Kokkos_Core.hpp>
+#include <iostream>
+#include <string>
+#include <stdexcept>
+
+#ifndef _SPMVHANDLE_HPP
+#define _SPMVHANDLE_HPP
+
+namespace KokkosSparse {
+
+/// \brief Algorithms available for KokkosSparse::spmv.
+///
+/// SPMV_DEFAULT:    let the library choose.  This uses the merge-path
+///                  kernel on host execution spaces when the row lengths
+///                  of the matrix are very unbalanced, and the native
+///                  row-based kernels otherwise.  Plain spmv calls
+///                  estimate the longest row from a few samples; an
+///                  SPMVHandle measures it once in spmv_symbolic.
+/// SPMV_NATIVE:     the row-based kernels (one team per block of rows).
+/// SPMV_MERGE_PATH: merge-path kernel; the work (rows + nonzeros) is
+///                  split evenly across threads, so a few very long
+///                  rows no longer serialize the product.
+/// SPMV_MV_PANEL:   for multivectors, pack the columns of X into
+///                  LayoutRight panels of up to 16 columns and read A
+///                  once per panel.  Single vectors use SPMV_NATIVE.
+enum class SPMVAlgorithm { SPMV_DEFAULT, SPMV_NATIVE, SPMV_MERGE_PATH, SPMV_MV_PANEL };
+
+/// \brief How spmv with a handle applies A^T and A^H.
+///
+/// SPMV_TRANSPOSE_ATOMIC:   scatter each row of A into y with atomic
+///                          updates.  This is what spmv without a
+///                          handle does.
+/// SPMV_TRANSPOSE_EXPLICIT: build the pattern of A^T once, together
+///                          with the position in A of each of its
+///                          entries, and keep them in the handle.  Each
+///                          call gathers the current values of A into
+///                          A^T and applies it with the no-transpose
+///                          kernels.
+/// SPMV_TRANSPOSE_COLORED:  color the rows of A once so that the rows
+///                          of a color share no column, keep the
+///                          coloring in the handle, and scatter one
+///                          color at a time without atomics.  Only the
+///                          pattern of A is cached.
+enum class SPMVTransposeAlgorithm { SPMV_TRANSPOSE_ATOMIC, SPMV_TRANSPOSE_EXPLICIT, SPMV_TRANSPOSE_COLORED };
+
+/// \brief What spmv passes down to its kernels: the algorithm and,
+///   when spmv is called with an SPMVHandle, the launch configuration
+///   of the native kernel chosen by spmv_symbolic.
+///
+/// Converts implicitly from SPMVAlgorithm.  The launch configuration
+/// is then left unset and the kernels compute their own, which is what
+/// spmv without a handle does.
+struct SPMVPlan {
+  SPMVAlgorithm algo;
+  int64_t num_teams;  //0 if unset
+  int team_size;      //-1 for Kokkos::AUTO
+  int vector_size;    //-1 if unset
+
+  SPMVPlan (const SPMVAlgorithm algo_ = SPMVAlgorithm::SPMV_DEFAULT) :
+    algo (algo_), num_teams (0), team_size (-1), vector_size (-1)
+  {}
+
+  SPMVPlan (const SPMVAlgorithm algo_, const int64_t num_teams_,
+            const int team_size_, const int vector_size_) :
+    algo (algo_), num_teams (num_teams_), team_size (team_size_), vector_size (vector_size_)
+  {}
+
+  bool has_launch_config () const { return num_teams > 0 && vector_size > 0; }
+};
+
+inline SPMVAlgorithm StringToSPMVAlgorithm(std::string & name) {
+  if(name=="SPMV_DEFAULT")           return SPMVAlgorithm::SPMV_DEFAULT;
+  else if(name=="SPMV_NATIVE")       return SPMVAlgorithm::SPMV_NATIVE;
+  else if(name=="SPMV_MERGE_PATH")   return SPMVAlgorithm::SPMV_MERGE_PATH;
+  else if(name=="SPMV_MV_PANEL")     return SPMVAlgorithm::SPMV_MV_PANEL;
+  else
+    throw std::runtime_error("Invalid SPMVAlgorithm name");
+}
+
+/// \brief Persistent state for repeated KokkosSparse::spmv calls with
+///   the same matrix.
+///
+/// spmv_symbolic inspects the matrix once (row length statistics and
+/// histogram, bandwidth, block structure), picks the kernel and the
+/// launch configuration, and stores them here together with the row
+/// partitioning used by the OpenMP kernel.  A matrix made of dense
+/// square blocks is applied with the BlockCrsMatrix kernel, using the
+/// graph of the blocks stored here.  spmv with a handle reuses
+/// this plan on every call, and only inspects again if the dimensions
+/// or the number of entries of the matrix change.
+template <class size_type_, class lno_t_, class scalar_t_,
+          class ExecutionSpace,
+          class TemporaryMemorySpace,
+          class PersistentMemorySpace>
+class SPMVHandle {
+public:
+
+  typedef ExecutionSpace HandleExecSpace;
+  typedef TemporaryMemorySpace HandleTempMemorySpace;
+  typedef PersistentMemorySpace HandlePersistentMemorySpace;
+
+  typedef ExecutionSpace execution_space;
+  typedef HandlePersistentMemorySpace memory_space;
+
+  typedef typename std::remove_const<size_type_>::type  size_type;
+  typedef const size_type const_size_type;
+
+  typedef typename std::remove_const<lno_t_>::type  nnz_lno_t;
+  typedef const nnz_lno_t const_nnz_lno_t;
+
+  typedef typename std::remove_const<scalar_t_>::type  nnz_scalar_t;
+  typedef const nnz_scalar_t const_nnz_scalar_t;
+
+  //! Row partitioning, as in StaticCrsGraph::row_block_offsets.
+  typedef typename Kokkos::View<const size_type *, HandlePersistentMemorySpace> row_block_offsets_t;
+  //! Row length histogram, kept on the host.
+  typedef typename Kokkos::View<size_type *, Kokkos::HostSpace> row_length_histogram_t;
+  //! Graph of the dense blocks of A, in BlockCrsMatrix form.
+  typedef typename Kokkos::View<size_type *, HandlePersistentMemorySpace> block_row_map_t;
+  typedef typename Kokkos::View<nnz_lno_t *, HandlePersistentMemorySpace> block_entries_t;
+
+  //! Cached pattern of the explicit transpose, in CRS form, and the
+  //! position in A of each of its entries.
+  typedef typename Kokkos::View<size_type *, HandlePersistentMemorySpace> transpose_row_map_t;
+  typedef typename Kokkos::View<nnz_lno_t *, HandlePersistentMemorySpace> transpose_entries_t;
+  typedef typename Kokkos::View<size_type *, HandlePersistentMemorySpace> transpose_perm_t;
+  //! Values of the explicit transpose, gathered from A on every call.
+  typedef typename Kokkos::View<nnz_scalar_t *, HandlePersistentMemorySpace> transpose_values_t;
+  //! Rows of A grouped by color, for the colored transpose.
+  typedef typename Kokkos::View<nnz_lno_t *, HandlePersistentMemorySpace> color_rows_t;
+  //! Offsets of each color in the grouped rows, kept on the host.
+  typedef typename Kokkos::View<size_type *, Kokkos::HostSpace> color_offsets_t;
+
+  //! Number of buckets of the row length histogram.
+  static constexpr int num_histogram_buckets = 32;
+
+private:
+
+  SPMVAlgorithm algm;          //requested algorithm
+  SPMVAlgorithm chosen_algm;   //algorithm picked by spmv_symbolic
+
+  bool inspected;
+
+  nnz_lno_t num_rows;
+  nnz_lno_t num_cols;
+  size_type nnz;
+
+  nnz_lno_t min_row_length;
+  nnz_lno_t max_row_length;
+  nnz_lno_t bandwidth;         //max |col - row| over all entries
+  nnz_lno_t block_size;        //detected dense block size, 1 if none
+
+  // Set when A is applied as a BlockCrsMatrix of block_size blocks.
+  block_row_map_t block_row_map;
+  block_entries_t block_entries;
+
+  // Bucket 0 counts empty rows, bucket b > 0 counts rows with
+  // 2^(b-1) <= length < 2^b.
+  row_length_histogram_t row_length_histogram;
+
+  row_block_offsets_t row_block_offsets;
+
+  // Requested team and vector sizes, -1 to let spmv_symbolic choose.
+  int team_size;
+  int vector_size;
+
+  // Cached launch configuration of the native kernel.  A team size
+  // of -1 lets Kokkos choose.
+  int launch_team_size;
+  int launch_vector_size;
+  int64_t launch_num_teams;
+
+  bool verbose;
+
+  SPMVTransposeAlgorithm transpose_algm;
+
+  // Built on the first transposed product that needs them; cleared
+  // by spmv_symbolic.
+  bool transpose_built;
+  transpose_row_map_t transpose_row_map;
+  transpose_entries_t transpose_entries;
+  transpose_perm_t transpose_perm;
+  transpose_values_t transpose_values;
+
+  bool transpose_colors_built;
+  color_rows_t transpose_color_rows;
+  color_offsets_t transpose_color_offsets;
+
+public:
+
+  SPMVHandle (SPMVAlgorithm choice = SPMVAlgorithm::SPMV_DEFAULT) :
+    algm (choice),
+    chosen_algm (choice),
+    inspected (false),
+    num_rows (0),
+    num_cols (0),
+    nnz (0),
+    min_row_length (0),
+    max_row_length (0),
+    bandwidth (0),
+    block_size (1),
+    block_row_map (),
+    block_entries (),
+    row_length_histogram (),
+    row_block_offsets (),
+    team_size (-1),
+    vector_size (-1),
+    launch_team_size (-1),
+    launch_vector_size (-1),
+    launch_num_teams (0),
+    verbose (false),
+    transpose_algm (SPMVTransposeAlgorithm::SPMV_TRANSPOSE_ATOMIC),
+    transpose_built (false),
+    transpose_colors_built (false)
+  {}
+
+  virtual ~SPMVHandle () {};
+
+  void set_algorithm (SPMVAlgorithm choice) {
+    algm = choice;
+    reset_inspected ();
+  }
+  SPMVAlgorithm get_algorithm () const { return algm; }
+
+  void set_chosen_algorithm (SPMVAlgorithm choice) { chosen_algm = choice; }
+  SPMVAlgorithm get_chosen_algorithm () const { return chosen_algm; }
+
+  bool is_inspected () const { return inspected; }
+  void set_inspected () { inspected = true; }
+  void reset_inspected () { inspected = false; }
+
+  //! Whether the stored plan was made for a matrix of this shape.
+  bool is_valid_for (const nnz_lno_t num_rows_, const nnz_lno_t num_cols_, const size_type nnz_) const {
+    return inspected && num_rows == num_rows_ && num_cols == num_cols_ && nnz == nnz_;
+  }
+
+  void set_matrix_dimensions (const nnz_lno_t num_rows_, const nnz_lno_t num_cols_, const size_type nnz_) {
+    num_rows = num_rows_;
+    num_cols = num_cols_;
+    nnz = nnz_;
+  }
+  nnz_lno_t get_num_rows () const { return num_rows; }
+  nnz_lno_t get_num_cols () const { return num_cols; }
+  size_type get_nnz () const { return nnz; }
+
+  void set_row_length_range (const nnz_lno_t min_, const nnz_lno_t max_) {
+    min_row_length = min_;
+    max_row_length = max_;
+  }
+  nnz_lno_t get_min_row_length () const { return min_row_length; }
+  nnz_lno_t get_max_row_length () const { return max_row_length; }
+
+  void set_bandwidth (const nnz_lno_t bw) { bandwidth = bw; }
+  nnz_lno_t get_bandwidth () const { return bandwidth; }
+
+  void set_block_size (const nnz_lno_t bs) { block_size = bs; }
+  nnz_lno_t get_block_size () const { return block_size; }
+
+  void set_block_graph (const block_row_map_t& row_map_, const block_entries_t& entries_) {
+    block_row_map = row_map_;
+    block_entries = entries_;
+  }
+  bool has_block_graph () const { return block_row_map.extent (0) > 0; }
+  block_row_map_t get_block_row_map () const { return block_row_map; }
+  block_entries_t get_block_entries () const { return block_entries; }
+
+  void set_row_length_histogram (const row_length_histogram_t& hist) { row_length_histogram = hist; }
+  row_length_histogram_t get_row_length_histogram () const { return row_length_histogram; }
+
+  void set_row_block_offsets (const row_block_offsets_t& offsets) { row_block_offsets = offsets; }
+  row_block_offsets_t get_row_block_offsets () const { return row_block_offsets; }
+
+  void set_team_size (const int ts) { team_size = ts; reset_inspected (); }
+  int get_team_size () const { return team_size; }
+
+  void set_vector_size (const int vs) { vector_size = vs; reset_inspected (); }
+  int get_vector_size () const { return vector_size; }
+
+  void set_launch_parameters (const int64_t num_teams_, const int team_size_, const int vector_size_) {
+    launch_num_teams = num_teams_;
+    launch_team_size = team_size_;
+    launch_vector_size = vector_size_;
+  }
+  int64_t get_launch_num_teams () const { return launch_num_teams; }
+  int get_launch_team_size () const { return launch_team_size; }
+  int get_launch_vector_size () const { return launch_vector_size; }
+
+  void set_transpose_algorithm (SPMVTransposeAlgorithm choice) { transpose_algm = choice; }
+  SPMVTransposeAlgorithm get_transpose_algorithm () const { return transpose_algm; }
+
+  bool is_transpose_built () const { return transpose_built; }
+  void set_transpose (const transpose_row_map_t& row_map_,
+                      const transpose_entries_t& entries_,
+                      const transpose_perm_t& perm_,
+                      const transpose_values_t& values_) {
+    transpose_row_map = row_map_;
+    transpose_entries = entries_;
+    transpose_perm = perm_;
+    transpose_values = values_;
+    transpose_built = true;
+  }
+  transpose_row_map_t get_transpose_row_map () const { return transpose_row_map; }
+  transpose_entries_t get_transpose_entries () const { return transpose_entries; }
+  transpose_perm_t get_transpose_perm () const { return transpose_perm; }
+  transpose_values_t get_transpose_values () const { return transpose_values; }
+
+  bool are_transpose_colors_built () const { return transpose_colors_built; }
+  void set_transpose_colors (const color_rows_t& rows_, const color_offsets_t& offsets_) {
+    transpose_color_rows = rows_;
+    transpose_color_offsets = offsets_;
+    transpose_colors_built = true;
+  }
+  color_rows_t get_transpose_color_rows () const { return transpose_color_rows; }
+  color_offsets_t get_transpose_color_offsets () const { return transpose_color_offsets; }
+
+  //! Drop the cached transpose and coloring.
+  void reset_transpose () {
+    transpose_built = false;
+    transpose_row_map = transpose_row_map_t ();
+    transpose_entries = transpose_entries_t ();
+    transpose_perm = transpose_perm_t ();
+    transpose_values = transpose_values_t ();
+    transpose_colors_built = false;
+    transpose_color_rows = color_rows_t ();
+    transpose_color_offsets = color_offsets_t ();
+  }
+
+  void set_verbose (const bool verbose_) { verbose = verbose_; }
+  bool get_verbose () const { return verbose; }
+
+  void print_plan () const {
+    std::cout << "SPMVHandle: " << num_rows << " x " << num_cols
+              << ", nnz " << nnz
+              << ", row length [" << min_row_length << ", " << max_row_length << "]"
+              << ", bandwidth " << bandwidth
+              << ", block size " << block_size << std::endl;
+    std::cout << "  algorithm "
+              << (has_block_graph () ? "BlockCrsMatrix" :
+                  chosen_algm == SPMVAlgorithm::SPMV_MERGE_PATH ? "SPMV_MERGE_PATH" :
+                  chosen_algm == SPMVAlgorithm::SPMV_MV_PANEL ? "SPMV_MV_PANEL" : "SPMV_NATIVE")
+              << ", teams " << launch_num_teams
+              << ", team size " << launch_team_size
+              << ", vector size " << launch_vector_size
+              << ", row blocks " << (row_block_offsets.extent(0) > 0 ? row_block_offsets.extent(0) - 1 : 0)
+              << std::endl;
+  }
+};
+
+template <class size_type_, class lno_t_, class scalar_t_,
+          class ExecutionSpace, class TemporaryMemorySpace, class PersistentMemorySpace>
+constexpr int
+SPMVHandle<size_type_, lno_t_, scalar_t_, ExecutionSpace, TemporaryMemorySpace, PersistentMemorySpace>::num_histogram_buckets;
+
+}
+
+#endif
@@ -0,0 +1,213 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+/// \file KokkosSparse_spmv_powers.hpp
+/// \brief Matrix powers kernel: [x, A*x, A^2*x, ..., A^s*x]
+
+#ifndef KOKKOSSPARSE_SPMV_POWERS_HPP_
+#define KOKKOSSPARSE_SPMV_POWERS_HPP_
+
+#include "KokkosSparse_CrsMatrix.hpp"
+#include "KokkosSparse_spmv.hpp"
+#include "KokkosSparse_spmv_powers_impl.hpp"
+#include <sstream>
+#include <type_traits>
+
+namespace KokkosSparse {
+
+/// \brief Row blocking of a matrix for spmv_powers, built once by
+///   spmv_powers_plan and reused by every spmv_powers call with the
+///   same matrix.
+///
+/// Holds the row block offsets, the reach of the blocking (how many
+/// blocks away the furthest column of a block's rows lies) and the
+/// number of rows of the largest block.  Only the structure of the
+/// matrix is used, so its values may change between calls.
+template <class AMatrix>
+struct SPMVPowersPlan {
+  typedef typename AMatrix::staticcrsgraph_type::row_block_type offsets_type;
+  typedef typename AMatrix::non_const_ordinal_type ordinal_type;
+  typedef typename AMatrix::non_const_size_type size_type;
+
+  offsets_type offsets;
+  ordinal_type reach;
+  int64_t max_block_rows;
+  ordinal_type num_rows;
+  size_type nnz;
+
+  SPMVPowersPlan () :
+    offsets (), reach (0), max_block_rows (0), num_rows (0), nnz (0)
+  {}
+
+  int64_t num_blocks () const {
+    return offsets.extent (0) > 0 ? static_cast<int64_t> (offsets.extent (0)) - 1 : 0;
+  }
+
+  //! Whether the plan was made for a matrix of this shape.
+  bool is_valid_for (const AMatrix& A) const {
+    return num_rows == A.numRows () && nnz == A.nnz () && offsets.extent (0) > 0;
+  }
+};
+
+/// \brief Build the row blocking of A for spmv_powers.
+///
+/// The blocks are A.graph.row_block_offsets if it is set, otherwise
+/// blocks sized for a last-level cache.  Pass the result to
+/// spmv_powers (plan, A, x, s, V) to reuse it across calls.
+template <class AMatrix>
+SPMVPowersPlan<AMatrix>
+spmv_powers_plan (const AMatrix& A)
+{
+  SPMVPowersPlan<AMatrix> plan;
+  plan.num_rows = A.numRows ();
+  plan.nnz = A.nnz ();
+  if (A.numRows () > 0) {
+    plan.offsets = Impl::spmv_powers_blocking (A, plan.reach, plan.max_block_rows);
+  }
+  return plan;
+}
+
+/// \brief Compute V(:,k) = A^k*x for k = 0, 1, ..., s.
+///
+/// This is the basis computation of s-step (communication avoiding)
+/// Krylov methods.  Instead of s full sweeps over A, the rows of A
+/// are split into the blocks of plan, and the s products proceed in
+/// a skewed wavefront over the blocks, so that each block is reused
+/// for all s products while it is in cache.  This pays off when the
+/// columns of each block row stay within a few neighboring blocks,
+/// e.g. for banded or well-ordered matrices; otherwise s calls to
+/// spmv are made.
+///
+/// \param plan [in] The row blocking of A, from spmv_powers_plan (A).
+///   An exception is thrown if it was made for a matrix of another
+///   size or number of entries.
+/// \param A [in] The square sparse matrix; KokkosSparse::CrsMatrix instance.
+/// \param x [in] A single vector (rank-1 Kokkos::View).
+/// \param s [in] The highest power of A to apply.
+/// \param V [out] A multivector (rank-2 Kokkos::View) with at least
+///   s+1 columns.
+template <class AMatrix, class XVector, class VMultiVector>
+void
+spmv_powers (const SPMVPowersPlan<AMatrix>& plan,
+             const AMatrix& A,
+             const XVector& x,
+             const int s,
+             const VMultiVector& V)
+{
+  typedef typename VMultiVector::non_const_value_type v_value_type;
+  typedef Kokkos::Details::ArithTraits<v_value_type> KAT;
+
+  static_assert (static_cast<int> (XVector::rank) == 1,
+    "KokkosSparse::spmv_powers: x must be a rank 1 View.");
+  static_assert (static_cast<int> (VMultiVector::rank) == 2,
+    "KokkosSparse::spmv_powers: V must be a rank 2 View.");
+  static_assert (std::is_same<typename VMultiVector::value_type, v_value_type>::value,
+    "KokkosSparse::spmv_powers: V must be non-const.");
+
+  if ((s < 0) ||
+      (A.numRows () != A.numCols ()) ||
+      (static_cast<size_t> (A.numRows ()) > static_cast<size_t> (x.extent(0))) ||
+      (static_cast<size_t> (A.numRows ()) > static_cast<size_t> (V.extent(0))) ||
+      (static_cast<size_t> (s + 1) > static_cast<size_t> (V.extent(1)))) {
+    std::ostringstream os;
+    os << "KokkosSparse::spmv_powers: Dimensions do not match or A is not square: "
+       << "A: " << A.numRows () << " x " << A.numCols ()
+       << ", x: " << x.extent(0)
+       << ", V: " << V.extent(0) << " x " << V.extent(1)
+       << ", s: " << s
+       ;
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+
+  const std::pair<size_t, size_t> rows (0, A.numRows ());
+  Kokkos::deep_copy (Kokkos::subview (V, rows, 0), Kokkos::subview (x, rows));
+  if (s == 0 || A.numRows () == 0) {
+    return;
+  }
+
+  if (!plan.is_valid_for (A)) {
+    std::ostringstream os;
+    os << "KokkosSparse::spmv_powers: The plan was made for another matrix: "
+       << "plan: " << plan.num_rows << " rows, " << plan.nnz << " entries"
+       << ", A: " << A.numRows () << " rows, " << A.nnz () << " entries"
+       ;
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+
+  // The wavefront only helps if a block stays in use for fewer
+  // wavefronts than there are blocks.
+  const int64_t num_blocks = plan.num_blocks ();
+  if (s > 1 && num_blocks > 1 &&
+      static_cast<int64_t> (s) * (static_cast<int64_t> (plan.reach) + 1) < num_blocks) {
+    Impl::spmv_powers_wavefront (A, s, V, plan.offsets, plan.reach, plan.max_block_rows);
+    return;
+  }
+  for (int k = 1; k <= s; ++k) {
+    spmv ("N", KAT::one (), A, Kokkos::subview (V, rows, k - 1),
+          KAT::zero (), Kokkos::subview (V, rows, k));
+  }
+}
+
+/// \brief Compute V(:,k) = A^k*x for k = 0, 1, ..., s.
+///
+/// Same as spmv_powers (spmv_powers_plan (A), A, x, s, V).  The row
+/// blocking is built on every call; build it once with
+/// spmv_powers_plan when A is applied repeatedly.
+template <class AMatrix, class XVector, class VMultiVector>
+void
+spmv_powers (const AMatrix& A,
+             const XVector& x,
+             const int s,
+             const VMultiVector& V)
+{
+  SPMVPowersPlan<AMatrix> plan;
+  if (s > 0) {
+    plan = spmv_powers_plan (A);
+  }
+  spmv_powers (plan, A, x, s, V);
+}
+
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_SPMV_POWERS_HPP_
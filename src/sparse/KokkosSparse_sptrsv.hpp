@@ -53,9 +53,11 @@
 #define KOKKOSSPARSE_SPTRSV_HPP_
 
 #include <type_traits>
+#include <sstream>
 
 //#include "KokkosSparse_sptrsv_handle.hpp"
 #include "KokkosKernels_helpers.hpp"
+#include "KokkosSparse_RankTags.hpp"
 #include "KokkosSparse_sptrsv_symbolic_spec.hpp"
 #include "KokkosSparse_sptrsv_solve_spec.hpp"
 
@@ -204,7 +206,8 @@ namespace Experimental {
       lno_nnz_view_t_ entries,
       scalar_nnz_view_t_ values,
       BType b,
-      XType x)
+      XType x,
+      const RANK_ONE)
   {
     typedef typename KernelHandle::size_type size_type;
     typedef typename KernelHandle::nnz_lno_t ordinal_type;
@@ -224,7 +227,7 @@ namespace Experimental {
     static_assert ((int) BType::rank == (int) XType::rank,
         "sptrsv: The ranks of b and x do not match.");
     static_assert (BType::rank == 1,
-        "sptrsv: b and x must both either have rank 1.");
+        "sptrsv: b and x must both either have rank 1 or rank 2.");
     static_assert (std::is_same<typename XType::value_type,
         typename XType::non_const_value_type>::value,
         "sptrsv: The output x must be nonconst.");
@@ -310,9 +313,158 @@ namespace Experimental {
 
   } // sptrsv_solve
 
+  template <typename KernelHandle,
+            typename lno_row_view_t_,
+            typename lno_nnz_view_t_,
+            typename scalar_nnz_view_t_,
+            class BType,
+            class XType>
+  void sptrsv_solve(
+      KernelHandle *handle,
+      lno_row_view_t_ rowmap,
+      lno_nnz_view_t_ entries,
+      scalar_nnz_view_t_ values,
+      BType b,
+      XType x,
+      const RANK_TWO)
+  {
+    typedef typename KernelHandle::size_type size_type;
+    typedef typename KernelHandle::nnz_lno_t ordinal_type;
+    typedef typename KernelHandle::nnz_scalar_t scalar_type;
+
+    static_assert(KOKKOSKERNELS_SPTRSV_SAME_TYPE(typename lno_row_view_t_::non_const_value_type, size_type),
+        "sptrsv_solve: A size_type must match KernelHandle size_type (const doesn't matter)");
+    static_assert(KOKKOSKERNELS_SPTRSV_SAME_TYPE(typename lno_nnz_view_t_::non_const_value_type, ordinal_type),
+        "sptrsv_solve: A entry type must match KernelHandle entry type (aka nnz_lno_t, and const doesn't matter)");
+    static_assert(KOKKOSKERNELS_SPTRSV_SAME_TYPE(typename scalar_nnz_view_t_::value_type, scalar_type),
+        "sptrsv_solve: A scalar type must match KernelHandle entry type (aka nnz_lno_t, and const doesn't matter)");
+
+    static_assert (Kokkos::Impl::is_view<BType>::value,
+        "sptrsv: b is not a Kokkos::View.");
+    static_assert (Kokkos::Impl::is_view<XType>::value,
+        "sptrsv: x is not a Kokkos::View.");
+    static_assert ((int) BType::rank == (int) XType::rank,
+        "sptrsv: The ranks of b and x do not match.");
+    static_assert (BType::rank == 2,
+        "sptrsv: b and x must both either have rank 1 or rank 2.");
+    static_assert (std::is_same<typename XType::value_type,
+        typename XType::non_const_value_type>::value,
+        "sptrsv: The output x must be nonconst.");
+    static_assert (std::is_same<typename BType::device_type, typename XType::device_type>::value,
+        "sptrsv: Views BType and XType have different device_types.");
+    static_assert (std::is_same<typename BType::device_type::execution_space, typename KernelHandle::SPTRSVHandleType::execution_space>::value,
+        "sptrsv: KernelHandle and Views have different execution spaces.");
+    static_assert (std::is_same<typename lno_row_view_t_::device_type, typename lno_nnz_view_t_::device_type>::value,
+        "sptrsv: rowmap and entries have different device types.");
+    static_assert (std::is_same<typename lno_row_view_t_::device_type, typename scalar_nnz_view_t_::device_type>::value,
+        "sptrsv: rowmap and values have different device types.");
+
+    if ((b.extent(0) != x.extent(0)) || (b.extent(1) != x.extent(1))) {
+      std::ostringstream os;
+      os << "sptrsv: Dimensions of b and x do not match: "
+         << "b: " << b.extent(0) << " x " << b.extent(1)
+         << ", x: " << x.extent(0) << " x " << x.extent(1);
+      Kokkos::Impl::throw_runtime_exception (os.str ());
+    }
+
+    auto sptrsv_handle = handle->get_sptrsv_handle();
+    if (sptrsv_handle->get_algorithm() == KokkosSparse::Experimental::SPTRSVAlgorithm::SPTRSV_CUSPARSE) {
+      // cuSPARSE is called with one right-hand side at a time
+      for (size_t j = 0; j < x.extent(1); ++j) {
+        sptrsv_solve (handle, rowmap, entries, values,
+                      Kokkos::subview (b, Kokkos::ALL (), j),
+                      Kokkos::subview (x, Kokkos::ALL (), j), RANK_ONE ());
+      }
+      return;
+    }
+
+    typedef typename KernelHandle::const_size_type c_size_t;
+    typedef typename KernelHandle::const_nnz_lno_t c_lno_t;
+    typedef typename KernelHandle::const_nnz_scalar_t c_scalar_t;
+
+    typedef typename KernelHandle::HandleExecSpace c_exec_t;
+    typedef typename KernelHandle::HandleTempMemorySpace c_temp_t;
+    typedef typename KernelHandle::HandlePersistentMemorySpace c_persist_t;
+
+    typedef typename  KokkosKernels::Experimental::KokkosKernelsHandle<c_size_t, c_lno_t, c_scalar_t, c_exec_t, c_temp_t, c_persist_t> const_handle_type;
+    const_handle_type tmp_handle (*handle);
+
+    typedef Kokkos::View<
+          typename lno_row_view_t_::const_value_type*,
+          typename KokkosKernels::Impl::GetUnifiedLayout<lno_row_view_t_>::array_layout,
+          typename lno_row_view_t_::device_type,
+          Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > RowMap_Internal;
+
+    typedef Kokkos::View<
+          typename lno_nnz_view_t_::const_value_type*,
+          typename KokkosKernels::Impl::GetUnifiedLayout<lno_nnz_view_t_>::array_layout,
+          typename lno_nnz_view_t_::device_type,
+          Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > Entries_Internal;
+
+    typedef Kokkos::View<
+          typename scalar_nnz_view_t_::const_value_type*,
+          typename KokkosKernels::Impl::GetUnifiedLayout<scalar_nnz_view_t_>::array_layout,
+          typename scalar_nnz_view_t_::device_type,
+          Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > Values_Internal;
+
+
+    typedef Kokkos::View<
+          typename BType::const_value_type**,
+          typename BType::array_layout,
+          typename BType::device_type,
+          Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > BType_Internal;
+
+    typedef Kokkos::View<
+          typename XType::non_const_value_type**,
+          typename XType::array_layout,
+          typename XType::device_type,
+          Kokkos::MemoryTraits<Kokkos::Unmanaged> > XType_Internal;
+
+
+    RowMap_Internal rowmap_i = rowmap;
+    Entries_Internal entries_i = entries;
+    Values_Internal values_i = values;
+
+    BType_Internal b_i = b;
+    XType_Internal x_i = x;
+
+    KokkosSparse::Impl::SPTRSV_SOLVE_MV<const_handle_type, RowMap_Internal, Entries_Internal, Values_Internal, BType_Internal, XType_Internal>::sptrsv_solve (&tmp_handle, rowmap_i, entries_i, values_i, b_i, x_i);
+
+  } // sptrsv_solve
+
+  /// \brief Solve the triangular system for b and x given either as
+  ///   single vectors (rank-1 Kokkos::View) or as multivectors (rank-2
+  ///   Kokkos::View, one column per right-hand side).
+  ///
+  /// With SEQLVLSCHD_RP, SEQLVLSCHD_TP1, SEQLVLSCHD_TP1CHAIN and the
+  /// supernodal algorithms, all columns are solved in one pass over the
+  /// levels.  The sync-free, Jacobi, reordered and cuSPARSE solves have no
+  /// multivector kernel and solve the columns one after the other.
+  template <typename KernelHandle,
+            typename lno_row_view_t_,
+            typename lno_nnz_view_t_,
+            typename scalar_nnz_view_t_,
+            class BType,
+            class XType>
+  void sptrsv_solve(
+      KernelHandle *handle,
+      lno_row_view_t_ rowmap,
+      lno_nnz_view_t_ entries,
+      scalar_nnz_view_t_ values,
+      BType b,
+      XType x)
+  {
+    using RANK_SPECIALISE =
+      typename std::conditional<static_cast<int> (XType::rank) == 2,
+                                RANK_TWO, RANK_ONE>::type;
+    sptrsv_solve (handle, rowmap, entries, values, b, x, RANK_SPECIALISE ());
+  }
+
 
-#if defined(KOKKOSKERNELS_ENABLE_TPL_CHOLMOD) | defined(KOKKOSKERNELS_ENABLE_TPL_SUPERLU)
+#if defined(KOKKOSKERNELS_ENABLE_SUPERNODAL_SPTRSV)
   // ---------------------------------------------------------------------
+  // supernodal solve with the factor stored by sptrsv_compute, from SuperLU,
+  // CHOLMOD or detect_supernodes
   template <typename KernelHandle,
             class XType>
   void sptrsv_solve(
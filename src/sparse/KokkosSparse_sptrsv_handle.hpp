@@ -67,7 +67,7 @@ namespace KokkosSparse {
 namespace Experimental {
 
 // TODO TP2 algorithm had issues with some offset-ordinal combo to be addressed when compiled in Trilinos...
-enum class SPTRSVAlgorithm { SEQLVLSCHD_RP, SEQLVLSCHD_TP1/*, SEQLVLSCHED_TP2*/, SEQLVLSCHD_TP1CHAIN, SPTRSV_CUSPARSE, SUPERNODAL_NAIVE, SUPERNODAL_ETREE, SUPERNODAL_DAG, SUPERNODAL_SPMV, SUPERNODAL_SPMV_DAG };
+enum class SPTRSVAlgorithm { SEQLVLSCHD_RP, SEQLVLSCHD_TP1/*, SEQLVLSCHED_TP2*/, SEQLVLSCHD_TP1CHAIN, SYNCFREE, JACOBI_SWEEPS, SPTRSV_CUSPARSE, SUPERNODAL_NAIVE, SUPERNODAL_ETREE, SUPERNODAL_DAG, SUPERNODAL_SPMV, SUPERNODAL_SPMV_DAG };
 
 template <class size_type_, class lno_t_, class scalar_t_,
           class ExecutionSpace,
@@ -122,6 +122,9 @@ public:
 
   typedef typename Kokkos::View<scalar_t **, HandlePersistentMemorySpace> mtx_scalar_view_t;
 
+  // completion flags of the sync-free solve
+  typedef typename Kokkos::View<int *, HandlePersistentMemorySpace> int_view_t;
+
 
 #ifdef KOKKOSKERNELS_ENABLE_TPL_CUSPARSE
   struct cuSparseHandleType {
@@ -270,10 +273,40 @@ private:
   size_type num_chain_entries;
   signed_integral_t chain_threshold;
 
+  // Symbolic: Sync-free data, number of off-diagonal entries (rows the
+  // row waits for) per row, and a completion flag per row used by the solve
+  nnz_lno_view_t syncfree_dependencies;
+  int_view_t syncfree_ready;
+
+  // Symbolic: Level reordering data; rows of the reordered matrix are grouped
+  // by level, reorder_perm(k) is the original row of row k, and
+  // reorder_value_map(k) the original offset of the k-th entry
+  bool reorder_by_level;
+  nnz_lno_view_t reorder_perm;
+  nnz_row_view_t reorder_row_map;
+  nnz_lno_view_t reorder_entries;
+  nnz_row_view_t reorder_value_map;
+  nnz_scalar_view_t reorder_values;
+  // reorder_values holds the values at reorder_values_source, gathered by an
+  // earlier solve; cleared by set_values_changed
+  bool reorder_values_gathered;
+  const void *reorder_values_source;
+  nnz_scalar_view_t reorder_rhs;
+  nnz_scalar_view_t reorder_lhs;
+
+  // Symbolic: Jacobi sweeps data, offset of the diagonal entry of each row;
+  // the inverse diagonal and the second iterate are filled by the solve
+  int num_jacobi_sweeps;
+  nnz_row_view_t jacobi_diagonal_offsets;
+  nnz_scalar_view_t jacobi_inverse_diagonal;
+  nnz_scalar_view_t jacobi_work;
+
   bool symbolic_complete;
   bool numeric_complete;
   bool require_symbolic_lvlsched_phase;
   bool require_symbolic_chain_phase;
+  bool require_symbolic_syncfree_phase;
+  bool require_symbolic_jacobi_phase;
 
   void set_if_algm_require_symb_lvlsched () {
     if (algm == SPTRSVAlgorithm::SEQLVLSCHD_RP
@@ -296,6 +329,14 @@ private:
     }
   }
 
+  void set_if_algm_require_symb_syncfree () {
+    require_symbolic_syncfree_phase = (algm == SPTRSVAlgorithm::SYNCFREE);
+  }
+
+  void set_if_algm_require_symb_jacobi () {
+    require_symbolic_jacobi_phase = (algm == SPTRSVAlgorithm::JACOBI_SWEEPS);
+  }
+
   void set_if_algm_require_symb_chain () {
     if (algm == KokkosSparse::Experimental::SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN
        )
@@ -403,10 +444,28 @@ public:
     h_chain_ptr(),
     num_chain_entries(0),
     chain_threshold(-1),
+    syncfree_dependencies(),
+    syncfree_ready(),
+    reorder_by_level(false),
+    reorder_perm(),
+    reorder_row_map(),
+    reorder_entries(),
+    reorder_value_map(),
+    reorder_values(),
+    reorder_values_gathered(false),
+    reorder_values_source(nullptr),
+    reorder_rhs(),
+    reorder_lhs(),
+    num_jacobi_sweeps(1),
+    jacobi_diagonal_offsets(),
+    jacobi_inverse_diagonal(),
+    jacobi_work(),
     symbolic_complete(symbolic_complete_),
     numeric_complete( numeric_complete_ ),
     require_symbolic_lvlsched_phase(false),
-    require_symbolic_chain_phase(false)
+    require_symbolic_chain_phase(false),
+    require_symbolic_syncfree_phase(false),
+    require_symbolic_jacobi_phase(false)
 #ifdef KOKKOSKERNELS_ENABLE_TPL_CUSPARSE
     , cuSPARSEHandle(nullptr)
 #endif
@@ -424,6 +483,8 @@ public:
   {
     this->set_if_algm_require_symb_lvlsched();
     this->set_if_algm_require_symb_chain();
+    this->set_if_algm_require_symb_syncfree();
+    this->set_if_algm_require_symb_jacobi();
 
 #ifdef KOKKOSKERNELS_ENABLE_SUPERNODAL_SPTRSV
     if (lower_tri) {
@@ -751,6 +812,22 @@ public:
 #endif
     }
 
+    if ( this->require_symbolic_syncfree_phase == true )
+    {
+      syncfree_dependencies = nnz_lno_view_t(Kokkos::ViewAllocateWithoutInitializing("syncfree_dependencies"), nrows_);
+      syncfree_ready = int_view_t("syncfree_ready", nrows_);
+    }
+
+    if ( this->require_symbolic_jacobi_phase == true )
+    {
+      jacobi_diagonal_offsets = nnz_row_view_t(Kokkos::ViewAllocateWithoutInitializing("jacobi_diagonal_offsets"), nrows_);
+      jacobi_inverse_diagonal = nnz_scalar_view_t(Kokkos::ViewAllocateWithoutInitializing("jacobi_inverse_diagonal"), nrows_);
+      jacobi_work = nnz_scalar_view_t(Kokkos::ViewAllocateWithoutInitializing("jacobi_work"), nrows_);
+    }
+
+    // rebuilt by the symbolic phase if reorder_by_level is set
+    reorder_perm = nnz_lno_view_t();
+
     if (stored_diagonal) {
       diagonal_offsets = nnz_lno_view_t(Kokkos::ViewAllocateWithoutInitializing("diagonal_offsets"), nrows_);
       diagonal_values = nnz_scalar_view_t(Kokkos::ViewAllocateWithoutInitializing("diagonal_values"), nrows_); // inserted by rowid
@@ -834,6 +911,10 @@ public:
 
   bool algm_requires_symb_chain() const { return require_symbolic_chain_phase; }
 
+  bool algm_requires_symb_syncfree() const { return require_symbolic_syncfree_phase; }
+
+  bool algm_requires_symb_jacobi() const { return require_symbolic_jacobi_phase; }
+
   // Can change the algorithm to a "Compatible algorithms" - for ease in some testing cases
   void set_algorithm(SPTRSVAlgorithm choice) { 
     if (algm != choice) {
@@ -873,6 +954,63 @@ public:
   inline
   host_signed_nnz_lno_view_t get_host_chain_ptr() const { return h_chain_ptr; }
 
+  KOKKOS_INLINE_FUNCTION
+  nnz_lno_view_t get_syncfree_dependencies() const { return syncfree_dependencies; }
+
+  KOKKOS_INLINE_FUNCTION
+  int_view_t get_syncfree_ready() const { return syncfree_ready; }
+
+  // Number of Jacobi sweeps x = D^{-1}(b - (L-D)*x) of JACOBI_SWEEPS after
+  // the initial x = D^{-1}b; the solve is exact only for enough sweeps
+  void set_num_jacobi_sweeps(const int num_jacobi_sweeps_) {
+    if ( num_jacobi_sweeps_ < 0 )
+      throw std::runtime_error("set_num_jacobi_sweeps: the number of sweeps must not be negative");
+    this->num_jacobi_sweeps = num_jacobi_sweeps_;
+  }
+  int get_num_jacobi_sweeps() const { return this->num_jacobi_sweeps; }
+
+  nnz_row_view_t get_jacobi_diagonal_offsets() const { return jacobi_diagonal_offsets; }
+  nnz_scalar_view_t get_jacobi_inverse_diagonal() const { return jacobi_inverse_diagonal; }
+  nnz_scalar_view_t get_jacobi_work() const { return jacobi_work; }
+
+  // Reorder the rows so that each level is contiguous in memory; must be set
+  // before sptrsv_symbolic, used by the level scheduled algorithms
+  void set_reorder_by_level(const bool reorder_by_level_) { this->reorder_by_level = reorder_by_level_; }
+  bool is_reorder_by_level() const { return this->reorder_by_level; }
+
+  bool is_reordered() const { return this->reorder_perm.extent(0) != 0; }
+
+  void set_reordered_matrix(nnz_lno_view_t perm_, nnz_row_view_t row_map_, nnz_lno_view_t entries_, nnz_row_view_t value_map_) {
+    this->reorder_perm = perm_;
+    this->reorder_row_map = row_map_;
+    this->reorder_entries = entries_;
+    this->reorder_value_map = value_map_;
+    this->reorder_values = nnz_scalar_view_t(Kokkos::ViewAllocateWithoutInitializing("reorder_values"), entries_.extent(0));
+    this->reorder_values_gathered = false;
+    this->reorder_rhs = nnz_scalar_view_t(Kokkos::ViewAllocateWithoutInitializing("reorder_rhs"), perm_.extent(0));
+    this->reorder_lhs = nnz_scalar_view_t(Kokkos::ViewAllocateWithoutInitializing("reorder_lhs"), perm_.extent(0));
+  }
+
+  nnz_lno_view_t get_reorder_perm() const { return reorder_perm; }
+  nnz_row_view_t get_reorder_row_map() const { return reorder_row_map; }
+  nnz_lno_view_t get_reorder_entries() const { return reorder_entries; }
+  nnz_row_view_t get_reorder_value_map() const { return reorder_value_map; }
+  nnz_scalar_view_t get_reorder_values() const { return reorder_values; }
+
+  // The reordered solve gathers the values into the level ordering on its
+  // first call and reuses them afterwards, as long as it is given the same
+  // values array; call set_values_changed after changing the values in place
+  void set_values_changed() { this->reorder_values_gathered = false; }
+  bool is_reorder_values_gathered(const void *values_) const {
+    return this->reorder_values_gathered && this->reorder_values_source == values_;
+  }
+  void set_reorder_values_gathered(const void *values_) {
+    this->reorder_values_gathered = true;
+    this->reorder_values_source = values_;
+  }
+  nnz_scalar_view_t get_reorder_rhs() const { return reorder_rhs; }
+  nnz_scalar_view_t get_reorder_lhs() const { return reorder_lhs; }
+
   KOKKOS_INLINE_FUNCTION
   nnz_lno_view_t get_nodes_per_level() const { return nodes_per_level; }
 
@@ -962,6 +1100,12 @@ public:
     if ( algm == SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN )
       std::cout << "SEQLVLSCHD_TP1CHAIN" << std::endl;;
 
+    if ( algm == SPTRSVAlgorithm::SYNCFREE )
+      std::cout << "SYNCFREE" << std::endl;;
+
+    if ( algm == SPTRSVAlgorithm::JACOBI_SWEEPS )
+      std::cout << "JACOBI_SWEEPS" << std::endl;;
+
     if ( algm == SPTRSVAlgorithm::SPTRSV_CUSPARSE )
       std::cout << "SPTRSV_CUSPARSE" << std::endl;;
 
@@ -997,6 +1141,12 @@ public:
     if ( algm == SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN )
       ret_string = "SEQLVLSCHD_TP1CHAIN";
 
+    if ( algm == SPTRSVAlgorithm::SYNCFREE )
+      ret_string = "SYNCFREE";
+
+    if ( algm == SPTRSVAlgorithm::JACOBI_SWEEPS )
+      ret_string = "JACOBI_SWEEPS";
+
     if ( algm == SPTRSVAlgorithm::SPTRSV_CUSPARSE )
       ret_string = "SPTRSV_CUSPARSE";
 
@@ -1010,6 +1160,8 @@ public:
     else if(name=="SPTRSV_TEAMPOLICY1")       return SPTRSVAlgorithm::SEQLVLSCHD_TP1;
     /*else if(name=="SPTRSV_TEAMPOLICY2")       return SPTRSVAlgorithm::SEQLVLSCHED_TP2;*/
     else if(name=="SPTRSV_TEAMPOLICY1CHAIN")  return SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN;
+    else if(name=="SPTRSV_SYNCFREE")          return SPTRSVAlgorithm::SYNCFREE;
+    else if(name=="SPTRSV_JACOBI_SWEEPS")     return SPTRSVAlgorithm::JACOBI_SWEEPS;
     else if(name=="SPTRSV_CUSPARSE")          return SPTRSVAlgorithm::SPTRSV_CUSPARSE;
     else
       throw std::runtime_error("Invalid SPTRSVAlgorithm name");
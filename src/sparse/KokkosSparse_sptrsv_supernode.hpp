@@ -727,6 +727,249 @@ generate_merged_supernodal_graph(bool lower,
   return static_graph;
 }
 
+/* ========================================================================================= */
+// elimination tree of the symmetric pattern L+L^T, with L lower-triangular in CSR;
+// every nonzero L(i,j) has i as an ancestor of j, also for incomplete factors
+template <typename input_graph_t>
+void compute_etree_crs(input_graph_t &graph, int *parent) {
+
+  using integer_view_host_t = Kokkos::View<int*, Kokkos::HostSpace>;
+
+  auto row_map = graph.row_map;
+  auto entries = graph.entries;
+  int n = graph.numRows ();
+
+  integer_view_host_t ancestor ("ancestor", n);
+  for (int k = 0; k < n; k++) {
+    parent[k] = -1;
+    ancestor (k) = -1;
+    for (int p = row_map (k); p < row_map (k+1); p++) {
+      // follow the path from i to the root of its current subtree, with path compression
+      int i = entries (p);
+      while (i != -1 && i < k) {
+        int inext = ancestor (i);
+        ancestor (i) = k;
+        if (inext == -1) {
+          parent[i] = k;
+        }
+        i = inext;
+      }
+    }
+  }
+}
+
+
+/* ========================================================================================= */
+// native supernode detection on a lower-triangular factor L in CSR (e.g., from spiluk), without
+// an external SuperLU/CHOLMOD factorization:
+//  - consecutive columns j-1 and j, where j is the parent of j-1 in the elimination tree, are
+//    amalgamated if the supernode has at most relax_size columns, or if the explicit zeros
+//    needed to give all its columns the same row structure are at most relax_ratio of its
+//    nonzeros (relax_size = 1 and relax_ratio = 0 give the fundamental supernodes)
+//  - supercols (size 1+nsuper) and etree (size nsuper, -1 at the roots) are returned for
+//    sptrsv_supernodal_symbolic, and L is returned in CSC stored by supernodal blocks with
+//    explicit zeros, as expected by sptrsv_supernodal_symbolic and sptrsv_compute
+template <typename host_crsmat_t>
+host_crsmat_t
+detect_supernodes(host_crsmat_t &L, int &nsuper,
+                  Kokkos::View<int*, Kokkos::HostSpace> &supercols,
+                  Kokkos::View<int*, Kokkos::HostSpace> &etree,
+                  int relax_size = 4, double relax_ratio = 0.2) {
+
+  using integer_view_host_t = Kokkos::View<int*, Kokkos::HostSpace>;
+  using graph_t        = typename host_crsmat_t::StaticCrsGraphType;
+  using row_map_view_t = typename graph_t::row_map_type::non_const_type;
+  using cols_view_t    = typename graph_t::entries_type::non_const_type;
+  using values_view_t  = typename host_crsmat_t::values_type::non_const_type;
+  using scalar_t       = typename values_view_t::value_type;
+
+  const scalar_t zero (0.0);
+
+  auto graph   = L.graph;
+  auto row_map = graph.row_map;
+  auto entries = graph.entries;
+  auto values  = L.values;
+  int n = graph.numRows ();
+
+  // ----------------------------------------------------------
+  // column structure of L, rows in ascending order
+  integer_view_host_t colptr ("colptr", n+1);
+  integer_view_host_t rowind ("rowind", row_map (n));
+  values_view_t       colval ("colval", row_map (n));
+  Kokkos::deep_copy (colptr, 0);
+  for (int i = 0; i < n; i++) {
+    for (int k = row_map (i); k < row_map (i+1); k++) {
+      if (entries (k) > i) {
+        throw std::runtime_error ("detect_supernodes: L is not lower-triangular");
+      }
+      colptr (entries (k) + 1) ++;
+    }
+  }
+  for (int j = 0; j < n; j++) {
+    colptr (j+1) += colptr (j);
+  }
+  integer_view_host_t work1 ("work1", n);
+  Kokkos::deep_copy (work1, 0);
+  for (int i = 0; i < n; i++) {
+    for (int k = row_map (i); k < row_map (i+1); k++) {
+      int j = entries (k);
+      rowind (colptr (j) + work1 (j)) = i;
+      colval (colptr (j) + work1 (j)) = values (k);
+      work1 (j) ++;
+    }
+  }
+  for (int j = 0; j < n; j++) {
+    // the smallest row of each column must be the diagonal
+    if (colptr (j) == colptr (j+1) || rowind (colptr (j)) != j) {
+      throw std::runtime_error ("detect_supernodes: L has a missing diagonal entry");
+    }
+  }
+
+  // ----------------------------------------------------------
+  // elimination tree of columns
+  integer_view_host_t parent ("parent", n);
+  compute_etree_crs (graph, parent.data ());
+
+  // ----------------------------------------------------------
+  // relaxed supernodes
+  // > supnb(s) = first column of s-th supernode, and supptr/suprow = its off-diagonal rows
+  //   (rows below the diagonal block, collected without sorting)
+  integer_view_host_t supnb ("supnb", n+1);
+  integer_view_host_t supptr ("supptr", n+1);
+  integer_view_host_t suprow ("suprow", row_map (n)); // each row is added once per supernode
+  integer_view_host_t mark ("mark", n);
+  Kokkos::deep_copy (mark, -1);
+
+  nsuper = 0;
+  int nnzS = 0;
+  supptr (0) = 0;
+  for (int j1 = 0; j1 < n; ) {
+    // start a supernode with column j1
+    // (nlist rows collected so far, of which noff are below the current diagonal block)
+    int j2 = j1+1;
+    int nlist = 0;
+    long nnz_actual = colptr (j1+1) - colptr (j1);
+    for (int k = colptr (j1); k < colptr (j1+1); k++) {
+      if (rowind (k) > j1) {
+        mark (rowind (k)) = nsuper;
+        suprow (nnzS + nlist) = rowind (k);
+        nlist ++;
+      }
+    }
+    int noff = nlist;
+
+    // amalgamate the next columns
+    while (j2 < n && parent (j2-1) == j2) {
+      int noff_new = (mark (j2) == nsuper ? noff-1 : noff);
+      for (int k = colptr (j2); k < colptr (j2+1); k++) {
+        if (rowind (k) > j2 && mark (rowind (k)) != nsuper) {
+          noff_new ++;
+        }
+      }
+      long nscol_new = j2 - j1 + 1;
+      long nnz_padded = nscol_new*(nscol_new+1)/2 + nscol_new*noff_new;
+      long nnz_new = nnz_actual + (colptr (j2+1) - colptr (j2));
+      if (nscol_new > relax_size && double(nnz_padded - nnz_new) > relax_ratio * double(nnz_padded)) {
+        break;
+      }
+
+      // accept column j2
+      for (int k = colptr (j2); k < colptr (j2+1); k++) {
+        if (rowind (k) > j2 && mark (rowind (k)) != nsuper) {
+          mark (rowind (k)) = nsuper;
+          suprow (nnzS + nlist) = rowind (k);
+          nlist ++;
+        }
+      }
+      noff = noff_new;
+      nnz_actual = nnz_new;
+      j2 ++;
+    }
+
+    // keep rows below the diagonal block, in ascending order
+    int nnz = nnzS;
+    for (int k = nnzS; k < nnzS + nlist; k++) {
+      if (suprow (k) >= j2) {
+        suprow (nnz) = suprow (k);
+        nnz ++;
+      }
+    }
+    std::sort (suprow.data () + nnzS, suprow.data () + nnz);
+
+    supnb (nsuper) = j1;
+    nsuper ++;
+    supptr (nsuper) = nnz;
+    nnzS = nnz;
+    j1 = j2;
+  }
+  supnb (nsuper) = n;
+
+  // ----------------------------------------------------------
+  // supernodal etree, parent of the last column of each supernode
+  integer_view_host_t col2sup ("col2sup", n);
+  for (int s = 0; s < nsuper; s++) {
+    for (int j = supnb (s); j < supnb (s+1); j++) {
+      col2sup (j) = s;
+    }
+  }
+  supercols = integer_view_host_t ("supercols", 1+nsuper);
+  etree = integer_view_host_t ("etree", nsuper);
+  for (int s = 0; s < nsuper; s++) {
+    int p = parent (supnb (s+1) - 1);
+    supercols (s) = supnb (s);
+    etree (s) = (p >= 0 ? col2sup (p) : -1);
+  }
+  supercols (nsuper) = n;
+
+  // ----------------------------------------------------------
+  // L in CSC, each column of a supernode stores its diagonal block and
+  // the off-diagonal rows of the supernode, with explicit zeros
+  int nnzA = 0;
+  for (int s = 0; s < nsuper; s++) {
+    int nscol = supnb (s+1) - supnb (s);
+    nnzA += nscol * (nscol + supptr (s+1) - supptr (s));
+  }
+  row_map_view_t hr ("rowmap_view", n+1);
+  cols_view_t    hc ("colmap_view", nnzA);
+  values_view_t  hv ("values_view", nnzA);
+
+  Kokkos::View<scalar_t*, Kokkos::HostSpace> dwork ("dwork", n);
+  Kokkos::deep_copy (dwork, zero);
+
+  nnzA = 0;
+  hr (0) = 0;
+  for (int s = 0; s < nsuper; s++) {
+    int j1 = supnb (s);
+    int j2 = supnb (s+1);
+    for (int j = j1; j < j2; j++) {
+      // scatter values of j-th column
+      for (int k = colptr (j); k < colptr (j+1); k++) {
+        dwork (rowind (k)) = colval (k);
+      }
+      // diagonal block
+      for (int i = j1; i < j2; i++) {
+        hc (nnzA) = i;
+        hv (nnzA) = dwork (i);
+        nnzA ++;
+      }
+      // off-diagonal blocks
+      for (int k = supptr (s); k < supptr (s+1); k++) {
+        hc (nnzA) = suprow (k);
+        hv (nnzA) = dwork (suprow (k));
+        nnzA ++;
+      }
+      hr (j+1) = nnzA;
+      // reset workspace
+      for (int k = colptr (j); k < colptr (j+1); k++) {
+        dwork (rowind (k)) = zero;
+      }
+    }
+  }
+
+  graph_t static_graph (hc, hr);
+  return host_crsmat_t ("CrsMatrix", n, hv, static_graph);
+}
+
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 /* For symbolic analysis                                                                     */
 template <typename scalar_type,
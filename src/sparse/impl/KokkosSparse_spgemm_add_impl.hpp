@@ -0,0 +1,151 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_SPGEMM_ADD_IMPL_HPP_
+#define KOKKOSSPARSE_SPGEMM_ADD_IMPL_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "KokkosSparse_spgemm_rowwise_impl.hpp"
+
+namespace KokkosSparse{
+namespace Impl{
+
+/**
+ * \brief Terms of row i of alpha*A*B + beta*D for the row-wise kernels:
+ * the row of D scaled by beta, then the rows of B scaled by alpha*A(i,k),
+ * so the sum is formed in the same pass as the product. max_row_size(i)
+ * bounds the size of row i by min(entries of row i of D + number of A*B
+ * multiplications in row i, number of columns of B).
+ */
+template <typename AMatrix, typename BMatrix, typename DMatrix>
+struct SpgemmAddRowTerms{
+  typedef typename AMatrix::non_const_ordinal_type nnz_lno_t;
+  typedef typename AMatrix::non_const_size_type size_type;
+  typedef typename AMatrix::non_const_value_type scalar_t;
+
+  scalar_t alpha;
+  AMatrix A;
+  BMatrix B;
+  scalar_t beta;
+  DMatrix D;
+  size_type num_cols;
+  size_t inner_rows, inner_nnz;
+
+  SpgemmAddRowTerms(
+      const scalar_t alpha_, const AMatrix &A_, const BMatrix &B_,
+      const scalar_t beta_, const DMatrix &D_):
+        alpha(alpha_), A(A_), B(B_), beta(beta_), D(D_), num_cols(B_.numCols()),
+        inner_rows(B_.numRows()), inner_nnz(B_.nnz()){}
+
+  KOKKOS_INLINE_FUNCTION
+  size_type max_row_size(const nnz_lno_t i) const {
+    size_type flops = D.graph.row_map(i + 1) - D.graph.row_map(i);
+    for (size_type jj = A.graph.row_map(i); jj < A.graph.row_map(i + 1) && flops < num_cols; ++jj){
+      const nnz_lno_t k = A.graph.entries(jj);
+      flops += B.graph.row_map(k + 1) - B.graph.row_map(k);
+    }
+    return flops > num_cols ? num_cols : flops;
+  }
+
+  template <typename visitor_t>
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const nnz_lno_t i, visitor_t &visitor) const {
+    const bool numeric = visitor_t::is_numeric;
+    visitor.row(beta, D.graph.row_map(i), D.graph.row_map(i + 1), D.graph.entries, D.values);
+    for (size_type jj = A.graph.row_map(i); jj < A.graph.row_map(i + 1); ++jj){
+      const nnz_lno_t k = A.graph.entries(jj);
+      visitor.row(numeric ? scalar_t(alpha * A.values(jj)) : scalar_t(),
+                  B.graph.row_map(k), B.graph.row_map(k + 1), B.graph.entries, B.values);
+    }
+  }
+};
+
+/**
+ * \brief Symbolic phase of C = alpha*A*B + beta*D. Fills rowmapC and the
+ * sorted entriesC, and stores the number of entries of C on the spgemm
+ * handle.
+ */
+template <typename spgemm_handle_t,
+          typename AMatrix, typename BMatrix, typename DMatrix,
+          typename c_row_view_t, typename c_nnz_view_t>
+void spgemm_add_symbolic_impl(
+    spgemm_handle_t *sh,
+    const AMatrix &A, const BMatrix &B, const DMatrix &D,
+    c_row_view_t rowmapC, c_nnz_view_t &entriesC){
+
+  typedef typename spgemm_handle_t::HandleExecSpace MyExecSpace;
+  typedef typename spgemm_handle_t::HandleTempMemorySpace MyTempMemorySpace;
+  typedef typename AMatrix::non_const_value_type scalar_t;
+
+  sh->set_add_symbolic(spgemm_rowwise_symbolic<MyExecSpace, MyTempMemorySpace>(
+      "KokkosSparse::spgemm_add::Symbolic",
+      SpgemmAddRowTerms<AMatrix, BMatrix, DMatrix>(scalar_t(), A, B, scalar_t(), D),
+      A.numRows(), rowmapC, entriesC));
+}
+
+/**
+ * \brief Numeric phase of C = alpha*A*B + beta*D, on the structure of
+ * spgemm_add_symbolic_impl.
+ */
+template <typename spgemm_handle_t,
+          typename AMatrix, typename BMatrix, typename DMatrix,
+          typename c_row_view_t, typename c_nnz_view_t, typename c_scalar_view_t>
+void spgemm_add_numeric_impl(
+    spgemm_handle_t * /* sh */,
+    const typename AMatrix::non_const_value_type alpha, const AMatrix &A, const BMatrix &B,
+    const typename AMatrix::non_const_value_type beta, const DMatrix &D,
+    c_row_view_t rowmapC, c_nnz_view_t entriesC, c_scalar_view_t valuesC){
+
+  typedef typename spgemm_handle_t::HandleExecSpace MyExecSpace;
+  typedef KokkosKernels::Experimental::PlusTimesSemiring<typename AMatrix::non_const_value_type> semiring_t;
+
+  spgemm_rowwise_numeric<MyExecSpace, semiring_t>(
+      "KokkosSparse::spgemm_add::Numeric", SpgemmAddRowTerms<AMatrix, BMatrix, DMatrix>(alpha, A, B, beta, D),
+      A.numRows(), rowmapC, entriesC, valuesC);
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_SPGEMM_FIRST_TOUCH_IMPL_HPP_
+#define KOKKOSSPARSE_SPGEMM_FIRST_TOUCH_IMPL_HPP_
+
+#include "Kokkos_Core.hpp"
+
+namespace KokkosSparse{
+namespace Impl{
+
+/**
+ * \brief Writes zeros to the entries and values of row i of C.
+ */
+template <typename c_row_view_t, typename c_nnz_view_t, typename c_scalar_view_t>
+struct SpgemmFirstTouchFunctor{
+  typedef typename c_row_view_t::non_const_value_type size_type;
+  typedef typename c_nnz_view_t::non_const_value_type nnz_lno_t;
+  typedef typename c_scalar_view_t::non_const_value_type scalar_t;
+
+  c_row_view_t rowmapC;
+  c_nnz_view_t entriesC;
+  c_scalar_view_t valuesC;
+
+  SpgemmFirstTouchFunctor(c_row_view_t rowmapC_, c_nnz_view_t entriesC_, c_scalar_view_t valuesC_):
+    rowmapC(rowmapC_), entriesC(entriesC_), valuesC(valuesC_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const nnz_lno_t i) const {
+    for (size_type j = rowmapC(i); j < rowmapC(i + 1); ++j){
+      entriesC(j) = nnz_lno_t(0);
+      valuesC(j) = scalar_t(0);
+    }
+  }
+};
+
+/**
+ * \brief First-touches C row by row with a static schedule, so that on a
+ * multi-socket host the pages of each contiguous block of rows are placed
+ * in the NUMA domain of the thread that owns the block. The numeric kernels
+ * then run with a static schedule over the same blocks.
+ * Has no effect on pages that were already touched, e.g. by an initializing
+ * allocation.
+ */
+template <typename MyExecSpace, typename c_row_view_t, typename c_nnz_view_t, typename c_scalar_view_t>
+void spgemm_first_touch(size_t num_rows, c_row_view_t rowmapC, c_nnz_view_t entriesC, c_scalar_view_t valuesC){
+  if (num_rows == 0) return;
+  Kokkos::parallel_for("KokkosSparse::spgemm::FirstTouch",
+      Kokkos::RangePolicy<MyExecSpace, Kokkos::Schedule<Kokkos::Static> >(0, num_rows),
+      SpgemmFirstTouchFunctor<c_row_view_t, c_nnz_view_t, c_scalar_view_t>(rowmapC, entriesC, valuesC));
+  MyExecSpace().fence();
+}
+
+}
+}
+
+#endif
@@ -65,6 +65,7 @@
 #include "KokkosKernels_HashmapAccumulator.hpp"
 #include "KokkosKernels_Uniform_Initialized_MemoryPool.hpp"
 #include "KokkosSparse_spgemm_handle.hpp"
+#include "KokkosSparse_spgemm_first_touch_impl.hpp"
 #include "KokkosGraph_Distance1Color.hpp"
 
 namespace KokkosSparse{
@@ -436,7 +437,7 @@ public:
   template <typename a_row_view_t, typename a_nnz_view_t, typename a_scalar_view_t,
             typename b_row_view_t, typename b_nnz_view_t, typename b_scalar_view_t,
             typename c_row_view_t, typename c_nnz_view_t, typename c_scalar_view_t,
-            typename pool_memory_type>
+            typename pool_memory_type, typename Semiring>
   struct PortableNumericCHASH;
 private:
   //KKMEM only difference is work memory does not use output memory for 2nd level accumulator.
@@ -447,7 +448,10 @@ private:
         c_scalar_nnz_view_t valuesC_,
         KokkosKernels::Impl::ExecSpaceType my_exec_space);
 
-  template <typename c_row_view_t, typename c_lno_nnz_view_t, typename c_scalar_nnz_view_t>
+  //products and sums are taken with Semiring; the dense (speed) accumulator
+  //is only used for plus-times.
+  template <typename c_row_view_t, typename c_lno_nnz_view_t, typename c_scalar_nnz_view_t,
+            typename Semiring>
   void KokkosSPGEMM_numeric_hash(
         c_row_view_t rowmapC_,
         c_lno_nnz_view_t entriesC_,
@@ -569,7 +573,10 @@ public:
   /////BELOW CODE IS for public symbolic and numeric functions
   ////DECL IS AT _def.hpp
   //////////////////////////////////////////////////////////////////////////
-  template <typename c_row_view_t, typename c_lno_nnz_view_t, typename c_scalar_nnz_view_t>
+  //Semiring: see KokkosKernels_Semiring.hpp. Other semirings than plus-times
+  //always run the KKMEM hash kernels.
+  template <typename c_row_view_t, typename c_lno_nnz_view_t, typename c_scalar_nnz_view_t,
+            typename Semiring = KokkosKernels::Experimental::PlusTimesSemiring<scalar_t> >
   void KokkosSPGEMM_numeric(c_row_view_t &rowmapC_, c_lno_nnz_view_t &entriesC_, c_scalar_nnz_view_t &valuesC_);
   //TODO: These are references only for outer product algorithm.
   //If the algorithm is removed, then remove the references.
@@ -604,7 +611,7 @@ public:
           row_mapA(row_mapA_), entriesA(entriesA_), valsA(), transposeA(transposeA_),
           row_mapB(row_mapB_), entriesB(entriesB_), valsB(), transposeB(transposeB_),
           shmem_size(handle_->get_shmem_size()), concurrency(MyExecSpace::concurrency()),
-          use_dynamic_schedule(handle_->is_dynamic_scheduling()),
+          use_dynamic_schedule(handle_->is_dynamic_scheduling() && !handle_->get_spgemm_handle()->get_numa_first_touch()),
           KOKKOSKERNELS_VERBOSE(handle_->get_verbose()),
           MyEnumExecSpace(this->handle->get_handle_exec_space()),
           spgemm_algorithm(this->handle->get_spgemm_handle()->get_algorithm_type()),
@@ -628,7 +635,7 @@ public:
             row_mapA(row_mapA_), entriesA(entriesA_), valsA(valsA_), transposeA(transposeA_),
             row_mapB(row_mapB_), entriesB(entriesB_), valsB(valsB_), transposeB(transposeB_),
             shmem_size(handle_->get_shmem_size()), concurrency(MyExecSpace::concurrency()),
-            use_dynamic_schedule(handle_->is_dynamic_scheduling()),
+            use_dynamic_schedule(handle_->is_dynamic_scheduling() && !handle_->get_spgemm_handle()->get_numa_first_touch()),
             KOKKOSKERNELS_VERBOSE(handle_->get_verbose()),
             MyEnumExecSpace(this->handle->get_handle_exec_space()),
             spgemm_algorithm(this->handle->get_spgemm_handle()->get_algorithm_type()),
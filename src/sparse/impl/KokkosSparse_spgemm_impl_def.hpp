@@ -52,7 +52,8 @@ namespace Impl{
 template <typename HandleType,
 typename a_row_view_t_, typename a_lno_nnz_view_t_, typename a_scalar_nnz_view_t_,
 typename b_lno_row_view_t_, typename b_lno_nnz_view_t_, typename b_scalar_nnz_view_t_  >
-template <typename c_row_view_t, typename c_lno_nnz_view_t, typename c_scalar_nnz_view_t>
+template <typename c_row_view_t, typename c_lno_nnz_view_t, typename c_scalar_nnz_view_t,
+          typename Semiring>
 void KokkosSPGEMM
   <HandleType, a_row_view_t_, a_lno_nnz_view_t_, a_scalar_nnz_view_t_,
     b_lno_row_view_t_, b_lno_nnz_view_t_, b_scalar_nnz_view_t_>::
@@ -69,14 +70,30 @@ void KokkosSPGEMM
       std::cout << "Numeric PHASE" << std::endl;
     }
 
-    if (spgemm_algorithm == SPGEMM_KK_SPEED || spgemm_algorithm == SPGEMM_KK_DENSE)
+    //place the rows of C with the threads that will compute them; the numeric
+    //kernels run with a static schedule in this mode.
+    if (this->handle->get_spgemm_handle()->get_numa_first_touch() &&
+        my_exec_space_ != KokkosKernels::Impl::Exec_CUDA){
+      spgemm_first_touch<MyExecSpace>(a_row_cnt, rowmapC_, entriesC_, valuesC_);
+    }
+
+    //the dense accumulator of KK_SPEED only does plus-times.
+    if ((spgemm_algorithm == SPGEMM_KK_SPEED || spgemm_algorithm == SPGEMM_KK_DENSE) &&
+        std::is_same<Semiring, KokkosKernels::Experimental::PlusTimesSemiring<scalar_t> >::value)
     {
       this->KokkosSPGEMM_numeric_speed(rowmapC_, entriesC_, valuesC_, my_exec_space_);
     }
     else {
-      this->KokkosSPGEMM_numeric_hash(rowmapC_, entriesC_, valuesC_, my_exec_space_);
+      this->template KokkosSPGEMM_numeric_hash<c_row_view_t, c_lno_nnz_view_t, c_scalar_nnz_view_t, Semiring>(
+          rowmapC_, entriesC_, valuesC_, my_exec_space_);
     }
 
+    //the multicore kernels sort the rows as they write them; the GPU kernels
+    //write in hash order, so C is sorted here.
+    if (this->handle->get_spgemm_handle()->get_sort_output() &&
+        my_exec_space_ == KokkosKernels::Impl::Exec_CUDA){
+      KokkosKernels::Impl::sort_crs_matrix<MyExecSpace>(rowmapC_, entriesC_, valuesC_);
+    }
   }
 
 template <typename HandleType,
@@ -130,7 +147,7 @@ void KokkosSPGEMM
     }
 
     //compressed B fields.
-    row_lno_temp_work_view_t new_row_mapB(Kokkos::ViewAllocateWithoutInitializing("new row map"), n+1);
+    row_lno_temp_work_view_t new_row_mapB;
     row_lno_temp_work_view_t new_row_mapB_begins;
 
     nnz_lno_temp_work_view_t set_index_entries; //will be output of compress matrix.
@@ -143,11 +160,44 @@ void KokkosSPGEMM
       std::cout << "\tCOMPRESS MATRIX-B PHASE" << std::endl;
     }
 
-    //call compression.
-    //it might not go through to the end if ratio is not high.
-    bool compression_applied = this->compressMatrix(n, nnz, this->row_mapB, this->entriesB,
-    												new_row_mapB, set_index_entries, set_entries,
-													compress_in_single_step);
+    auto sh = this->handle->get_spgemm_handle();
+    bool compression_applied = false;
+    if (sh->get_reuse_compressed_b() && sh->is_compressed_b_cached()){
+      //B was compressed by an earlier call with the same B; only the flops
+      //of the rows of this A are new.
+      size_type compressed_b_nnz = 0;
+      sh->get_compressed_b(compressed_b_nnz, new_row_mapB, set_index_entries, set_entries);
+      compression_applied = sh->is_compressed_b_applied();
+      if (compression_applied){
+        row_lno_persistent_work_view_t compressed_flops_per_row(Kokkos::ViewAllocateWithoutInitializing("compressed row flops"), a_row_cnt);
+        size_t compressed_overall_flops = 0;
+        if (compress_in_single_step){
+          sh->compressed_max_row_flops = this->getMaxRoughRowNNZ(a_row_cnt, row_mapA, entriesA,
+              row_mapB, new_row_mapB, compressed_flops_per_row.data());
+        }
+        else {
+          sh->compressed_max_row_flops = this->getMaxRoughRowNNZ(a_row_cnt, row_mapA, entriesA,
+              Kokkos::subview (new_row_mapB, std::make_pair (nnz_lno_t(0), n)),
+              Kokkos::subview (new_row_mapB, std::make_pair (nnz_lno_t(1), n + 1)),
+              compressed_flops_per_row.data());
+        }
+        KokkosKernels::Impl::kk_reduce_view2<row_lno_persistent_work_view_t, MyExecSpace>(
+            a_row_cnt, compressed_flops_per_row, compressed_overall_flops);
+        sh->compressed_overall_flops = compressed_overall_flops;
+      }
+    }
+    else {
+      new_row_mapB = row_lno_temp_work_view_t(Kokkos::ViewAllocateWithoutInitializing("new row map"), n+1);
+      //call compression.
+      //it might not go through to the end if ratio is not high.
+      compression_applied = this->compressMatrix(n, nnz, this->row_mapB, this->entriesB,
+                                                 new_row_mapB, set_index_entries, set_entries,
+                                                 compress_in_single_step);
+      if (sh->get_reuse_compressed_b()){
+        sh->set_compressed_b(nnz, new_row_mapB, set_index_entries, set_entries);
+        sh->set_compressed_b_cached(compression_applied);
+      }
+    }
 
 
     if (KOKKOSKERNELS_VERBOSE){
@@ -156,6 +206,20 @@ void KokkosSPGEMM
 
     timer1.reset();
 
+    //SPGEMM_KK_AUTO: choose the numeric algorithm from the flops of the
+    //product after compression.
+    if (sh->is_auto_algorithm()){
+      sh->choose_auto_algorithm(
+          compression_applied ? sh->compressed_max_row_flops : sh->original_max_row_flops,
+          compression_applied ? sh->compressed_overall_flops : sh->original_overall_flops,
+          a_row_cnt, b_col_cnt,
+          my_exec_space_ == KokkosKernels::Impl::Exec_CUDA, shmem_size,
+          this->handle->get_suggested_vector_size(n, nnz));
+      if (KOKKOSKERNELS_VERBOSE){
+        sh->print_auto_selection(std::cout);
+      }
+    }
+
     //first get the max flops for a row, which will be used for max row size.
     //If we did compression in single step, row_mapB[i] points the begining of row i,
     //and new_row_mapB[i] points to the end of row i.
@@ -45,6 +45,7 @@
 #define HASHSCALAR 107
 
 #include "KokkosKernels_Utils.hpp"
+#include "KokkosKernels_Sorting.hpp"
 
 namespace KokkosSparse{
 
@@ -56,7 +57,7 @@ typename b_lno_row_view_t_, typename b_lno_nnz_view_t_, typename b_scalar_nnz_vi
 template <typename a_row_view_t, typename a_nnz_view_t, typename a_scalar_view_t,
           typename b_row_view_t, typename b_nnz_view_t, typename b_scalar_view_t,
           typename c_row_view_t, typename c_nnz_view_t, typename c_scalar_view_t,
-          typename pool_memory_type>
+          typename pool_memory_type, typename Semiring>
 struct KokkosSPGEMM
   <HandleType, a_row_view_t_, a_lno_nnz_view_t_, a_scalar_nnz_view_t_,
     b_lno_row_view_t_, b_lno_nnz_view_t_, b_scalar_nnz_view_t_>::
@@ -106,6 +107,8 @@ struct KokkosSPGEMM
 
   nnz_lno_t max_first_level_hash_size;
   row_lno_persistent_work_view_t flops_per_row;
+  //if true, the multicore kernels sort each row of C as they write it.
+  const bool sort_output;
 
   PortableNumericCHASH(
       nnz_lno_t m_,
@@ -128,7 +131,8 @@ struct KokkosSPGEMM
       const KokkosKernels::Impl::ExecSpaceType my_exec_space_,
       nnz_lno_t team_row_chunk_size, double first_level_cut_off,
 	  row_lno_persistent_work_view_t flops_per_row_,
-      bool KOKKOSKERNELS_VERBOSE_
+      bool KOKKOSKERNELS_VERBOSE_,
+      bool sort_output_ = false
       ):
         numrows(m_),
         row_mapA (row_mapA_),
@@ -164,7 +168,8 @@ struct KokkosSPGEMM
         team_cuckoo_key_size (1),
         team_cuckoo_hash_func(1),
         max_first_level_hash_size(1),
-        flops_per_row(flops_per_row_)
+        flops_per_row(flops_per_row_),
+        sort_output(sort_output_)
 
   {
     nnz_lno_t tmp_team_cuckoo_key_size = ((shared_memory_size - sizeof(nnz_lno_t) * 2) / (sizeof(nnz_lno_t) + sizeof(scalar_t )));
@@ -284,7 +289,7 @@ struct KokkosSPGEMM
         for ( nnz_lno_t i = 0; i < left_workB; ++i){
           const size_type adjind = i + rowBegin;
           nnz_lno_t b_col_ind = entriesB[adjind];
-          scalar_t b_val = valuesB[adjind] * valA;
+          scalar_t b_val = Semiring::multiply(valA, valuesB[adjind]);
           nnz_lno_t hash = (b_col_ind * HASHSCALAR) & pow2_hash_func;
 
           while (true){
@@ -295,7 +300,7 @@ struct KokkosSPGEMM
             	break;
             }
             else if (hash_ids[hash] == b_col_ind){
-            	hash_values[hash] += b_val;
+            	hash_values[hash] = Semiring::add(hash_values[hash], b_val);
             	break;
             }
             else {
@@ -311,6 +316,10 @@ struct KokkosSPGEMM
     	  pvaluesC [c_row_begin++] = hash_values[used_index];
     	  hash_ids[used_index] = -1;
       }
+      if (sort_output){
+        KokkosKernels::Impl::SerialSortKeysValues<nnz_lno_t>(
+            pEntriesC + rowmapC[row_index], pvaluesC + rowmapC[row_index], used_count);
+      }
     });
     memory_space.release_chunk(used_indices);
   }
@@ -365,13 +374,13 @@ struct KokkosSPGEMM
         for ( nnz_lno_t i = 0; i < left_workB; ++i){
           const size_type adjind = i + rowBegin;
           nnz_lno_t b_col_ind = entriesB[adjind];
-          scalar_t b_val = valuesB[adjind] * valA;
+          scalar_t b_val = Semiring::multiply(valA, valuesB[adjind]);
           //nnz_lno_t hash = (b_col_ind * 107) & pow2_hash_func;
           nnz_lno_t hash = b_col_ind & pow2_hash_func;
 
           //this has to be a success, we do not need to check for the success.
           //int insertion =
-          hm2.sequential_insert_into_hash_mergeAdd_TrackHashes(
+          hm2.template sequential_insert_into_hash_mergeAdd_TrackHashes<Semiring>(
               hash, b_col_ind, b_val,
               &used_hash_sizes, hm2.max_value_size
               ,&globally_used_hash_count,
@@ -383,6 +392,9 @@ struct KokkosSPGEMM
         nnz_lno_t dirty_hash = globally_used_hash_indices[i];
         hm2.hash_begins[dirty_hash] = -1;
       }
+      if (sort_output){
+        KokkosKernels::Impl::SerialSortKeysValues<nnz_lno_t>(hm2.keys, hm2.values, used_hash_sizes);
+      }
     });
     memory_space.release_chunk(globally_used_hash_indices);
   }
@@ -438,12 +450,12 @@ struct KokkosSPGEMM
         for ( nnz_lno_t i = 0; i < left_workB; ++i){
           const size_type adjind = i + rowBegin;
           nnz_lno_t b_col_ind = entriesB[adjind];
-          scalar_t b_val = valuesB[adjind] * valA;
+          scalar_t b_val = Semiring::multiply(valA, valuesB[adjind]);
           nnz_lno_t hash = b_col_ind & pow2_hash_func;
 
           //this has to be a success, we do not need to check for the success.
           //int insertion =
-          hm2.sequential_insert_into_hash_mergeAdd_TrackHashes(
+          hm2.template sequential_insert_into_hash_mergeAdd_TrackHashes<Semiring>(
               hash, b_col_ind, b_val,
               &used_hash_sizes, hm2.max_value_size
               ,&globally_used_hash_count,
@@ -459,6 +471,10 @@ struct KokkosSPGEMM
         pEntriesC [c_row_begin + i] = hm2.keys[i];
         pvaluesC [c_row_begin+i] =hm2.values[i];
       }
+      if (sort_output){
+        KokkosKernels::Impl::SerialSortKeysValues<nnz_lno_t>(
+            pEntriesC + c_row_begin, pvaluesC + c_row_begin, global_memory_hash_size);
+      }
 
     });
     memory_space.release_chunk(globally_used_hash_indices);
@@ -570,10 +586,10 @@ struct KokkosSPGEMM
             [&] (nnz_lno_t i) {
           const size_type adjind = i + rowBegin;
           nnz_lno_t b_col_ind = entriesB[adjind];
-          scalar_t b_val = valuesB[adjind] * valA;
+          scalar_t b_val = Semiring::multiply(valA, valuesB[adjind]);
           //hash = b_col_ind % shmem_key_size;
           nnz_lno_t hash = b_col_ind & thread_shared_memory_hash_func;
-          volatile int num_unsuccess = hm.vector_atomic_insert_into_hash_mergeAdd(
+          volatile int num_unsuccess = hm.template vector_atomic_insert_into_hash_mergeAdd<Semiring>(
               teamMember, vector_size,
               hash, b_col_ind, b_val,
               used_hash_sizes,
@@ -581,7 +597,7 @@ struct KokkosSPGEMM
           if (num_unsuccess){
 
         	  hash = b_col_ind & pow2_hash_func;
-        	  hm2.vector_atomic_insert_into_hash_mergeAdd_TrackHashes(
+        	  hm2.template vector_atomic_insert_into_hash_mergeAdd_TrackHashes<Semiring>(
         			  teamMember, vector_size,
 					  hash,b_col_ind,b_val,
 					  used_hash_sizes + 1, hm2.max_value_size
@@ -687,7 +703,7 @@ struct KokkosSPGEMM
         	  // not needed as team_cuckoo_key_size is always pow2. + (team_cuckoo_key_size & (vector_size - 1)) * 1;
         	  Kokkos::parallel_for( Kokkos::TeamThreadRange(teamMember, num_threads), [&] (nnz_lno_t teamind) {
         		  Kokkos::parallel_for( Kokkos::ThreadVectorRange(teamMember, vector_size ), [&] (nnz_lno_t i) {
-        			  global_acc_row_vals[teamind * vector_size + i] = 0;
+        			  global_acc_row_vals[teamind * vector_size + i] = Semiring::zero();
         		  });
         	  });
           }
@@ -699,7 +715,7 @@ struct KokkosSPGEMM
     	  // not needed as team_cuckoo_key_size is always pow2. + (team_cuckoo_key_size & (vector_size - 1)) * 1;
     	  Kokkos::parallel_for( Kokkos::TeamThreadRange(teamMember, num_threads), [&] (nnz_lno_t teamind) {
     		  Kokkos::parallel_for( Kokkos::ThreadVectorRange(teamMember, vector_size ), [&] (nnz_lno_t i) {
-    			  keys[teamind * vector_size + i] = init_value; vals[teamind * vector_size + i] = 0;
+    			  keys[teamind * vector_size + i] = init_value; vals[teamind * vector_size + i] = Semiring::zero();
     		  });
     	  });
       }
@@ -747,7 +763,7 @@ struct KokkosSPGEMM
 			  }
 
 			  my_b_col = entriesB[my_b_col_shift + current_b_read_offsett];
-			  my_b_val = valuesB[my_b_col_shift + current_b_read_offsett] * a_col_val;
+			  my_b_val = Semiring::multiply(a_col_val, valuesB[my_b_col_shift + current_b_read_offsett]);
 			  //now insert it to first level hashmap accumulator.
 			  hash = (my_b_col * HASHSCALAR) & team_cuckoo_hash_func;
 			  fail = 1;
@@ -757,7 +773,7 @@ struct KokkosSPGEMM
 			  nnz_lno_t search_end = team_cuckoo_key_size; //KOKKOSKERNELS_MACRO_MIN(team_cuckoo_key_size, hash + max_tries);
 			  for (nnz_lno_t trial = hash; trial < search_end; ){
 				  if (keys[trial] == my_b_col){
-					  Kokkos::atomic_add(vals + trial, my_b_val);
+					  KokkosKernels::Experimental::SemiringAtomic<Semiring>::add(vals + trial, my_b_val);
 					  fail = 0;
 					  break;
 				  }
@@ -767,7 +783,7 @@ struct KokkosSPGEMM
 						  break;
 					  }
 					  else if (Kokkos::atomic_compare_exchange_strong(keys + trial, init_value, my_b_col)){
-						  Kokkos::atomic_add(vals + trial, my_b_val);
+						  KokkosKernels::Experimental::SemiringAtomic<Semiring>::add(vals + trial, my_b_val);
 						  Kokkos::atomic_increment(used_hash_sizes);
 						  if (used_hash_sizes[0] > max_first_level_hash_size)  insert_is_on = false;
 						  fail = 0;
@@ -783,7 +799,7 @@ struct KokkosSPGEMM
 
 				  for (nnz_lno_t trial = 0; try_to_insert && trial < search_end; ){
 					  if (keys[trial] == my_b_col){
-						  Kokkos::atomic_add(vals + trial, my_b_val);
+						  KokkosKernels::Experimental::SemiringAtomic<Semiring>::add(vals + trial, my_b_val);
 						  fail = 0;
 						  break;
 					  }
@@ -792,7 +808,7 @@ struct KokkosSPGEMM
 							  break;
 						  }
 						  else if (Kokkos::atomic_compare_exchange_strong(keys + trial, init_value, my_b_col)){
-							  Kokkos::atomic_add(vals + trial, my_b_val);
+							  KokkosKernels::Experimental::SemiringAtomic<Semiring>::add(vals + trial, my_b_val);
 							  Kokkos::atomic_increment(used_hash_sizes);
 							  if (used_hash_sizes[0] > max_first_level_hash_size)  insert_is_on = false;
 							  fail = 0;
@@ -810,7 +826,7 @@ struct KokkosSPGEMM
 
 					  for (nnz_lno_t trial = new_hash; trial < pow2_hash_size; ){
 						  if (global_acc_row_keys[trial] == my_b_col){
-							  Kokkos::atomic_add(global_acc_row_vals + trial , my_b_val);
+							  KokkosKernels::Experimental::SemiringAtomic<Semiring>::add(global_acc_row_vals + trial , my_b_val);
 
 							  //c_row_vals[trial] += my_b_val;
 							  fail = 0;
@@ -818,7 +834,7 @@ struct KokkosSPGEMM
 						  }
 						  else if (global_acc_row_keys[trial ] == init_value){
 							  if (Kokkos::atomic_compare_exchange_strong(global_acc_row_keys + trial , init_value, my_b_col)){
-								  Kokkos::atomic_add(global_acc_row_vals + trial , my_b_val);
+								  KokkosKernels::Experimental::SemiringAtomic<Semiring>::add(global_acc_row_vals + trial , my_b_val);
 								  //Kokkos::atomic_increment(used_hash_sizes + 1);
 								  //c_row_vals[trial] = my_b_val;
 								  fail = 0;
@@ -833,14 +849,14 @@ struct KokkosSPGEMM
 						  for (nnz_lno_t trial = 0; trial < new_hash; ){
 							  if (global_acc_row_keys[trial ] == my_b_col){
 								  //c_row_vals[trial] += my_b_val;
-								  Kokkos::atomic_add(global_acc_row_vals + trial , my_b_val);
+								  KokkosKernels::Experimental::SemiringAtomic<Semiring>::add(global_acc_row_vals + trial , my_b_val);
 
 								  break;
 							  }
 							  else if (global_acc_row_keys[trial ] == init_value){
 								  if (Kokkos::atomic_compare_exchange_strong(global_acc_row_keys + trial , init_value, my_b_col)){
 									  //Kokkos::atomic_increment(used_hash_sizes + 1);
-									  Kokkos::atomic_add(global_acc_row_vals + trial , my_b_val);
+									  KokkosKernels::Experimental::SemiringAtomic<Semiring>::add(global_acc_row_vals + trial , my_b_val);
 									  //c_row_vals[trial] = my_b_val;
 									  break;
 								  }
@@ -873,7 +889,7 @@ struct KokkosSPGEMM
     				  nnz_lno_t search_end = team_cuckoo_key_size; //KOKKOSKERNELS_MACRO_MIN(team_cuckoo_key_size, hash + max_tries);
     				  for (nnz_lno_t trial = hash; trial < search_end;++trial){
     					  if (keys[trial] == my_b_col){
-    						  vals[trial] += my_b_val;
+    						  vals[trial] = Semiring::add(vals[trial], my_b_val);
     						  fail = 0;
     						  break;
     					  }
@@ -885,7 +901,7 @@ struct KokkosSPGEMM
 
     				  for (nnz_lno_t trial = 0; trial < search_end; ++trial){
     					  if (keys[trial] == my_b_col){
-    						  vals[trial] += my_b_val;
+    						  vals[trial] = Semiring::add(vals[trial], my_b_val);
     						  fail = 0;
     						  break;
     					  }
@@ -980,7 +996,7 @@ struct KokkosSPGEMM
     		  //nnz_lno_t team_shift = teamind * vector_size;
     		  //nnz_lno_t work_to_handle = KOKKOSKERNELS_MACRO_MIN(vector_size, team_shmem_hash_size - team_shift);
     		  Kokkos::parallel_for( Kokkos::ThreadVectorRange(teamMember, vector_size ), [&] (nnz_lno_t i) {
-    			  keys[teamind * vector_size + i] = init_value; vals[teamind * vector_size + i] = 0;
+    			  keys[teamind * vector_size + i] = init_value; vals[teamind * vector_size + i] = Semiring::zero();
     		  });
     	  });
       }
@@ -1060,7 +1076,7 @@ struct KokkosSPGEMM
 
 			  my_b_col = entriesB[my_b_col_shift + current_b_read_offsett];
 
-			  my_b_val = valuesB[my_b_col_shift + current_b_read_offsett] * a_col_val;
+			  my_b_val = Semiring::multiply(a_col_val, valuesB[my_b_col_shift + current_b_read_offsett]);
 
 			  //now insert it to first level hashmap accumulator.
 			  hash = (my_b_col * HASHSCALAR) & team_cuckoo_hash_func;
@@ -1069,13 +1085,13 @@ struct KokkosSPGEMM
 			  for (nnz_lno_t trial = hash; trial < team_cuckoo_key_size; ){
 
 				  if (keys[trial] == my_b_col){
-            Kokkos::atomic_add(vals + trial, my_b_val);
+            KokkosKernels::Experimental::SemiringAtomic<Semiring>::add(vals + trial, my_b_val);
 					  fail = 0;
 					  break;
 				  }
 				  else if (keys[trial] == init_value){
 					  if (Kokkos::atomic_compare_exchange_strong(keys + trial, init_value, my_b_col)){
-						  Kokkos::atomic_add(vals + trial, my_b_val);
+						  KokkosKernels::Experimental::SemiringAtomic<Semiring>::add(vals + trial, my_b_val);
 						  fail = 0;
 						  break;
 					  }
@@ -1088,13 +1104,13 @@ struct KokkosSPGEMM
 				  for (nnz_lno_t trial = 0; trial < hash; ){
 
 					  if (keys[trial] == my_b_col){
-						  Kokkos::atomic_add(vals + trial, my_b_val);
+						  KokkosKernels::Experimental::SemiringAtomic<Semiring>::add(vals + trial, my_b_val);
 						  fail = 0;
 						  break;
 					  }
 					  else if (keys[trial] == init_value){
 						  if (Kokkos::atomic_compare_exchange_strong(keys + trial, init_value, my_b_col)){
-							  Kokkos::atomic_add(vals + trial, my_b_val);
+							  KokkosKernels::Experimental::SemiringAtomic<Semiring>::add(vals + trial, my_b_val);
 							  fail = 0;
 							  break;
 						  }
@@ -1186,7 +1202,8 @@ struct KokkosSPGEMM
 template <typename HandleType,
 typename a_row_view_t_, typename a_lno_nnz_view_t_, typename a_scalar_nnz_view_t_,
 typename b_lno_row_view_t_, typename b_lno_nnz_view_t_, typename b_scalar_nnz_view_t_  >
-template <typename c_row_view_t, typename c_lno_nnz_view_t, typename c_scalar_nnz_view_t>
+template <typename c_row_view_t, typename c_lno_nnz_view_t, typename c_scalar_nnz_view_t,
+          typename Semiring>
 void
   KokkosSPGEMM
   <HandleType, a_row_view_t_, a_lno_nnz_view_t_, a_scalar_nnz_view_t_,
@@ -1375,7 +1392,9 @@ void
 			  }
 		  }
 
-		  if (run_dense){
+		  //the dense accumulator only adds and multiplies.
+		  if (run_dense &&
+		      std::is_same<Semiring, KokkosKernels::Experimental::PlusTimesSemiring<scalar_t> >::value){
 			  this->KokkosSPGEMM_numeric_speed(
 					  rowmapC_,
 					  entriesC_,
@@ -1480,7 +1499,9 @@ void
   }
 
   Kokkos::Impl::Timer timer1;
-  pool_memory_space m_space(num_chunks, chunksize, -1,  my_pool_type);
+  const bool numa_first_touch = this->handle->get_spgemm_handle()->get_numa_first_touch() &&
+                                lcl_my_exec_space != KokkosKernels::Impl::Exec_CUDA;
+  pool_memory_space m_space(num_chunks, chunksize, -1,  my_pool_type, true, numa_first_touch);
   MyExecSpace().fence();
 
   if (KOKKOSKERNELS_VERBOSE){
@@ -1494,7 +1515,7 @@ void
     const_a_lno_row_view_t, const_a_lno_nnz_view_t, const_a_scalar_nnz_view_t,
     const_b_lno_row_view_t, const_b_lno_nnz_view_t, const_b_scalar_nnz_view_t,
     c_row_view_t, c_lno_nnz_view_t, c_scalar_nnz_view_t,
-    pool_memory_space>
+    pool_memory_space, Semiring>
   sc(
       a_row_cnt,
       row_mapA,
@@ -1518,7 +1539,8 @@ void
       team_row_chunk_size,
       first_level_cut_off,
       flops_per_row,
-      KOKKOSKERNELS_VERBOSE);
+      KOKKOSKERNELS_VERBOSE,
+      this->handle->get_spgemm_handle()->get_sort_output());
 
   if (KOKKOSKERNELS_VERBOSE){
     std::cout << "\t\tvector_size:" << suggested_vector_size  << " chunk_size:" << team_row_chunk_size << " suggested_team_size:" << suggested_team_size<< std::endl;
@@ -1656,7 +1678,7 @@ void
     const_a_lno_row_view_t, const_a_lno_nnz_view_t, const_a_scalar_nnz_view_t,
     const_b_lno_row_view_t, const_b_lno_nnz_view_t, const_b_scalar_nnz_view_t,
     c_row_view_t, c_lno_nnz_view_t, c_scalar_nnz_view_t,
-    pool_memory_space>
+    pool_memory_space, KokkosKernels::Experimental::PlusTimesSemiring<scalar_t> >
   sc(
       a_row_cnt,
       row_mapA,
@@ -43,6 +43,7 @@
 */
 
 #include "KokkosKernels_Utils.hpp"
+#include "KokkosKernels_Sorting.hpp"
 
 namespace KokkosSparse{
 
@@ -80,6 +81,8 @@ struct KokkosSPGEMM
   scalar_t *pVals;
   const KokkosKernels::Impl::ExecSpaceType my_exec_space;
   const nnz_lno_t team_work_size;
+  //if true, the columns of each row are written in increasing order.
+  const bool sort_output;
 
 
   NumericCMEM_CPU(
@@ -98,7 +101,8 @@ struct KokkosSPGEMM
       c_scalar_view_t valuesC_,
       mpool_type memory_space_,
       const KokkosKernels::Impl::ExecSpaceType my_exec_space_,
-      nnz_lno_t team_row_chunk_size):
+      nnz_lno_t team_row_chunk_size,
+      bool sort_output_ = false):
         numrows(m_),
         numcols(k_),
         row_mapA (row_mapA_),
@@ -115,7 +119,8 @@ struct KokkosSPGEMM
         memory_space(memory_space_),
         pEntriesC(entriesC_.data()), pVals(valuesC.data()),
         my_exec_space(my_exec_space_),
-        team_work_size(team_row_chunk_size){
+        team_work_size(team_row_chunk_size),
+        sort_output(sort_output_){
         }
 
 
@@ -175,6 +180,7 @@ struct KokkosSPGEMM
       scalar_t *myvals = pVals + c_row_begin;
 
       nnz_lno_t current_col_index = 0;
+      nnz_lno_t min_col = numcols, max_col = 0;
       const size_type col_begin = row_mapA[row_index];
       const nnz_lno_t nnza = nnz_lno_t(row_mapA[row_index + 1] - col_begin);
 
@@ -192,10 +198,27 @@ struct KokkosSPGEMM
           if (marker[b_col_ind] == 0){
             marker[b_col_ind] = 1;
             myentries[current_col_index++] = b_col_ind;
+            if (b_col_ind < min_col) min_col = b_col_ind;
+            if (b_col_ind > max_col) max_col = b_col_ind;
           }
           dense_accum[b_col_ind] += b_val;
         }
       }
+      if (sort_output && current_col_index > 1){
+        //the values are gathered below, so only the columns need sorting.
+        //a row that covers a good part of its column range is read back
+        //from the marker in order; a sparse one is sorted in place.
+        if (max_col - min_col < 8 * current_col_index){
+          nnz_lno_t written = 0;
+          for (nnz_lno_t c = min_col; c <= max_col; ++c){
+            if (marker[c]) myentries[written++] = c;
+          }
+        }
+        else {
+          KokkosKernels::Impl::SerialSortKeysValues<nnz_lno_t, nnz_lno_t, scalar_t>(
+              myentries, (scalar_t *) NULL, current_col_index);
+        }
+      }
       for (nnz_lno_t i = 0; i < current_col_index; ++i){
         nnz_lno_t ind = myentries[i];
         myvals[i] = dense_accum[ind];
@@ -601,7 +624,8 @@ void
 
     Kokkos::Impl::Timer timer1;
     pool_memory_space m_space
-    (num_chunks, this->b_col_cnt + (this->b_col_cnt) / sizeof(scalar_t) + 1, 0,  my_pool_type);
+    (num_chunks, this->b_col_cnt + (this->b_col_cnt) / sizeof(scalar_t) + 1, 0,  my_pool_type,
+     true, this->handle->get_spgemm_handle()->get_numa_first_touch());
     MyExecSpace().fence();
 
     if (KOKKOSKERNELS_VERBOSE){
@@ -633,7 +657,8 @@ void
         valuesC_,
         m_space,
         my_exec_space_,
-        team_row_chunk_size);
+        team_row_chunk_size,
+        this->handle->get_spgemm_handle()->get_sort_output());
 
     MyExecSpace().fence();
     if (KOKKOSKERNELS_VERBOSE){
@@ -0,0 +1,170 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_SPGEMM_MASKED_IMPL_HPP_
+#define KOKKOSSPARSE_SPGEMM_MASKED_IMPL_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "KokkosKernels_SparseUtils.hpp"
+#include "KokkosKernels_Semiring.hpp"
+#include "KokkosSparse_findRelOffset.hpp"
+#include "KokkosSparse_spgemm_rowwise_impl.hpp"
+
+namespace KokkosSparse{
+namespace Impl{
+
+/**
+ * \brief Row filter of the mask: keeps the columns that are (or, with
+ * complement, are not) in a sorted row of M.
+ */
+template <typename nnz_lno_t>
+struct SpgemmMaskRow{
+  const nnz_lno_t *cols;
+  nnz_lno_t size;
+  bool complement;
+
+  KOKKOS_INLINE_FUNCTION
+  SpgemmMaskRow(const nnz_lno_t *cols_, const nnz_lno_t size_, const bool complement_):
+    cols(cols_), size(size_), complement(complement_){}
+
+  KOKKOS_INLINE_FUNCTION
+  bool operator()(const nnz_lno_t col) const {
+    return (KokkosSparse::findRelOffset<nnz_lno_t>(cols, size, col, 0, true) < size) != complement;
+  }
+};
+
+/**
+ * \brief Filter of SpgemmProductRowTerms for C<M> = A*B: the rows of M,
+ * with their entries sorted. Without complement, row i of C has no more
+ * entries than row i of M.
+ */
+template <typename m_row_view_t, typename m_nnz_view_t>
+struct SpgemmSortedMask{
+  typedef typename m_nnz_view_t::non_const_value_type nnz_lno_t;
+  typedef typename m_row_view_t::non_const_value_type size_type;
+  typedef SpgemmMaskRow<nnz_lno_t> row_filter_t;
+
+  m_row_view_t rowmapM;
+  m_nnz_view_t entriesM;
+  bool complement;
+
+  SpgemmSortedMask(const m_row_view_t &rowmapM_, const m_nnz_view_t &entriesM_, const bool complement_):
+    rowmapM(rowmapM_), entriesM(entriesM_), complement(complement_){}
+
+  KOKKOS_INLINE_FUNCTION
+  row_filter_t for_row(const nnz_lno_t i) const {
+    return row_filter_t(entriesM.data() + rowmapM(i), nnz_lno_t(rowmapM(i + 1) - rowmapM(i)), complement);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  size_type max_row_size(const nnz_lno_t i, const size_type bound) const {
+    const size_type mask_size = rowmapM(i + 1) - rowmapM(i);
+    return (complement || bound < mask_size) ? bound : mask_size;
+  }
+};
+
+/**
+ * \brief Symbolic phase of C<M> = A*B (or C<!M> = A*B if complement).
+ * The rows of a copy of the entries of M are sorted, so that the terms of
+ * A*B are filtered by binary search while the structure of C is hashed.
+ * Fills rowmapC and the sorted entriesC.
+ */
+template <typename AMatrix, typename BMatrix, typename MMatrix,
+          typename c_row_view_t, typename c_nnz_view_t>
+void spgemm_masked_symbolic_impl(
+    const AMatrix &A, const BMatrix &B, const MMatrix &M, bool complement,
+    c_row_view_t rowmapC, c_nnz_view_t &entriesC){
+
+  typedef typename AMatrix::execution_space MyExecSpace;
+  typedef typename AMatrix::memory_space MyTempMemorySpace;
+  typedef typename MMatrix::index_type::non_const_type m_nnz_view_t;
+  typedef SpgemmSortedMask<typename MMatrix::row_map_type, m_nnz_view_t> mask_t;
+  typedef SpgemmProductRowTerms<
+      typename AMatrix::row_map_type, typename AMatrix::index_type, typename AMatrix::values_type,
+      typename BMatrix::row_map_type, typename BMatrix::index_type, typename BMatrix::values_type,
+      mask_t> terms_t;
+
+  m_nnz_view_t sorted_mask(Kokkos::ViewAllocateWithoutInitializing("Masked sorted mask"), M.nnz());
+  Kokkos::deep_copy(sorted_mask, M.graph.entries);
+  if (M.numRows() > 0 && M.nnz() > 0){
+    KokkosKernels::Impl::sort_crs_graph<MyExecSpace>(M.graph.row_map, sorted_mask);
+    MyExecSpace().fence();
+  }
+
+  spgemm_rowwise_symbolic<MyExecSpace, MyTempMemorySpace>(
+      "KokkosSparse::spgemm_masked::Symbolic",
+      terms_t(A.graph.row_map, A.graph.entries, A.values,
+              B.graph.row_map, B.graph.entries, B.values, B.numCols(),
+              mask_t(M.graph.row_map, sorted_mask, complement)),
+      A.numRows(), rowmapC, entriesC);
+}
+
+/**
+ * \brief Numeric phase of C<M> = A*B over a Semiring (see
+ * KokkosKernels_Semiring.hpp). The mask is not needed: the structure of C
+ * from the symbolic phase already is the filtered structure, and the
+ * terms whose column is not in it are dropped.
+ */
+template <typename Semiring, typename AMatrix, typename BMatrix,
+          typename c_row_view_t, typename c_nnz_view_t, typename c_scalar_view_t>
+void spgemm_masked_numeric_impl(
+    const AMatrix &A, const BMatrix &B,
+    c_row_view_t rowmapC, c_nnz_view_t entriesC, c_scalar_view_t valuesC){
+
+  typedef typename AMatrix::execution_space MyExecSpace;
+  typedef SpgemmProductRowTerms<
+      typename AMatrix::row_map_type, typename AMatrix::index_type, typename AMatrix::values_type,
+      typename BMatrix::row_map_type, typename BMatrix::index_type, typename BMatrix::values_type> terms_t;
+
+  spgemm_rowwise_numeric<MyExecSpace, Semiring>(
+      "KokkosSparse::spgemm_masked::Numeric",
+      terms_t(A.graph.row_map, A.graph.entries, A.values,
+              B.graph.row_map, B.graph.entries, B.values, B.numCols()),
+      A.numRows(), rowmapC, entriesC, valuesC);
+}
+
+}
+}
+
+#endif
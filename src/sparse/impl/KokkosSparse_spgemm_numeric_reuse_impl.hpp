@@ -0,0 +1,291 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_SPGEMM_NUMERIC_REUSE_IMPL_HPP_
+#define KOKKOSSPARSE_SPGEMM_NUMERIC_REUSE_IMPL_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "KokkosKernels_Utils.hpp"
+#include "KokkosKernels_Uniform_Initialized_MemoryPool.hpp"
+
+namespace KokkosSparse{
+namespace Impl{
+
+/**
+ * \brief offsets(i) = number of multiplications in row i of A*B.
+ */
+template <typename a_row_view_t, typename a_nnz_view_t, typename b_row_view_t, typename offset_view_t>
+struct SpgemmReuseRowFlopsFunctor{
+  typedef typename a_row_view_t::non_const_value_type size_type;
+  typedef typename a_nnz_view_t::non_const_value_type nnz_lno_t;
+
+  a_row_view_t row_mapA;
+  a_nnz_view_t entriesA;
+  b_row_view_t row_mapB;
+  offset_view_t offsets;
+
+  SpgemmReuseRowFlopsFunctor(a_row_view_t row_mapA_, a_nnz_view_t entriesA_, b_row_view_t row_mapB_, offset_view_t offsets_):
+    row_mapA(row_mapA_), entriesA(entriesA_), row_mapB(row_mapB_), offsets(offsets_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const nnz_lno_t i) const {
+    size_type flops = 0;
+    for (size_type j = row_mapA(i); j < row_mapA(i + 1); ++j){
+      const nnz_lno_t rowB = entriesA(j);
+      flops += row_mapB(rowB + 1) - row_mapB(rowB);
+    }
+    offsets(i) = flops;
+  }
+};
+
+/**
+ * \brief For every product term A(i,j)*B(j,k), in the order in which row i
+ * visits them, records the position of C(i,k) in entriesC. The columns of
+ * row i of C are put in a chained hash (in a pool chunk) to find the positions.
+ */
+template <typename a_row_view_t, typename a_nnz_view_t,
+          typename b_row_view_t, typename b_nnz_view_t,
+          typename c_row_view_t, typename c_nnz_view_t,
+          typename offset_view_t, typename pool_memory_space>
+struct SpgemmReuseBuildFunctor{
+  typedef typename a_row_view_t::non_const_value_type size_type;
+  typedef typename a_nnz_view_t::non_const_value_type nnz_lno_t;
+
+  a_row_view_t row_mapA;
+  a_nnz_view_t entriesA;
+  b_row_view_t row_mapB;
+  b_nnz_view_t entriesB;
+  c_row_view_t row_mapC;
+  c_nnz_view_t entriesC;
+  offset_view_t offsets;
+  offset_view_t positions;
+  pool_memory_space memory_space;
+  size_type hash_size, max_row_size;
+
+  SpgemmReuseBuildFunctor(
+      a_row_view_t row_mapA_, a_nnz_view_t entriesA_,
+      b_row_view_t row_mapB_, b_nnz_view_t entriesB_,
+      c_row_view_t row_mapC_, c_nnz_view_t entriesC_,
+      offset_view_t offsets_, offset_view_t positions_,
+      pool_memory_space memory_space_, size_type hash_size_, size_type max_row_size_):
+        row_mapA(row_mapA_), entriesA(entriesA_),
+        row_mapB(row_mapB_), entriesB(entriesB_),
+        row_mapC(row_mapC_), entriesC(entriesC_),
+        offsets(offsets_), positions(positions_),
+        memory_space(memory_space_), hash_size(hash_size_), max_row_size(max_row_size_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const nnz_lno_t i) const {
+    size_type *hash_begins = NULL;
+    while (hash_begins == NULL){
+      hash_begins = memory_space.allocate_chunk(i);
+    }
+    size_type *hash_nexts = hash_begins + hash_size;
+    const size_type hash_mask = hash_size - 1;
+    const size_type empty = -1;
+
+    const size_type c_row_begin = row_mapC(i);
+    const size_type c_row_size = row_mapC(i + 1) - c_row_begin;
+    for (size_type k = 0; k < c_row_size; ++k){
+      const size_type hash = size_type(entriesC(c_row_begin + k)) & hash_mask;
+      hash_nexts[k] = hash_begins[hash];
+      hash_begins[hash] = k;
+    }
+
+    size_type term = offsets(i);
+    for (size_type j = row_mapA(i); j < row_mapA(i + 1); ++j){
+      const nnz_lno_t rowB = entriesA(j);
+      for (size_type k = row_mapB(rowB); k < row_mapB(rowB + 1); ++k){
+        const nnz_lno_t col = entriesB(k);
+        size_type p = hash_begins[size_type(col) & hash_mask];
+        while (p != empty && entriesC(c_row_begin + p) != col){
+          p = hash_nexts[p];
+        }
+        positions(term++) = c_row_begin + p;
+      }
+    }
+
+    for (size_type k = 0; k < c_row_size; ++k){
+      hash_begins[size_type(entriesC(c_row_begin + k)) & hash_mask] = empty;
+    }
+    memory_space.release_chunk(hash_begins);
+  }
+};
+
+/**
+ * \brief Numeric phase with a recorded term to position map: no hashing,
+ * only valuesC(positions(t)) += valuesA * valuesB for every term t of a row.
+ */
+template <typename a_row_view_t, typename a_nnz_view_t, typename a_scalar_view_t,
+          typename b_row_view_t, typename b_scalar_view_t,
+          typename c_row_view_t, typename c_scalar_view_t,
+          typename offset_view_t>
+struct SpgemmReuseNumericFunctor{
+  typedef typename a_row_view_t::non_const_value_type size_type;
+  typedef typename a_nnz_view_t::non_const_value_type nnz_lno_t;
+  typedef typename c_scalar_view_t::non_const_value_type scalar_t;
+
+  a_row_view_t row_mapA;
+  a_nnz_view_t entriesA;
+  a_scalar_view_t valuesA;
+  b_row_view_t row_mapB;
+  b_scalar_view_t valuesB;
+  c_row_view_t row_mapC;
+  c_scalar_view_t valuesC;
+  offset_view_t offsets;
+  offset_view_t positions;
+
+  SpgemmReuseNumericFunctor(
+      a_row_view_t row_mapA_, a_nnz_view_t entriesA_, a_scalar_view_t valuesA_,
+      b_row_view_t row_mapB_, b_scalar_view_t valuesB_,
+      c_row_view_t row_mapC_, c_scalar_view_t valuesC_,
+      offset_view_t offsets_, offset_view_t positions_):
+        row_mapA(row_mapA_), entriesA(entriesA_), valuesA(valuesA_),
+        row_mapB(row_mapB_), valuesB(valuesB_),
+        row_mapC(row_mapC_), valuesC(valuesC_),
+        offsets(offsets_), positions(positions_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const nnz_lno_t i) const {
+    for (size_type k = row_mapC(i); k < row_mapC(i + 1); ++k){
+      valuesC(k) = scalar_t();
+    }
+    size_type term = offsets(i);
+    for (size_type j = row_mapA(i); j < row_mapA(i + 1); ++j){
+      const nnz_lno_t rowB = entriesA(j);
+      const scalar_t valA = valuesA(j);
+      for (size_type k = row_mapB(rowB); k < row_mapB(rowB + 1); ++k){
+        valuesC(positions(term++)) += valA * valuesB(k);
+      }
+    }
+  }
+};
+
+/**
+ * \brief Records on the spgemm handle, for every product term of A*B, the
+ * position of its destination in entriesC. Needs the entries of C, so it is
+ * called after a regular numeric phase.
+ */
+template <typename spgemm_handle_t,
+          typename a_row_view_t, typename a_nnz_view_t,
+          typename b_row_view_t, typename b_nnz_view_t,
+          typename c_row_view_t, typename c_nnz_view_t>
+void spgemm_numeric_reuse_build(
+    spgemm_handle_t *sh,
+    typename spgemm_handle_t::nnz_lno_t m,
+    a_row_view_t row_mapA, a_nnz_view_t entriesA,
+    b_row_view_t row_mapB, b_nnz_view_t entriesB,
+    c_row_view_t row_mapC, c_nnz_view_t entriesC){
+
+  typedef typename spgemm_handle_t::HandleExecSpace MyExecSpace;
+  typedef typename spgemm_handle_t::HandleTempMemorySpace MyTempMemorySpace;
+  typedef typename spgemm_handle_t::size_type size_type;
+  typedef typename spgemm_handle_t::row_lno_temp_work_view_t offset_view_t;
+  typedef KokkosKernels::Impl::UniformMemoryPool<MyTempMemorySpace, size_type> pool_memory_space;
+  typedef Kokkos::RangePolicy<MyExecSpace> range_policy_t;
+
+  offset_view_t offsets("spgemm reuse offsets", m + 1);
+  Kokkos::parallel_for("KokkosSparse::spgemm_numeric_reuse::Flops", range_policy_t(0, m),
+      SpgemmReuseRowFlopsFunctor<a_row_view_t, a_nnz_view_t, b_row_view_t, offset_view_t>(
+          row_mapA, entriesA, row_mapB, offsets));
+  KokkosKernels::Impl::kk_exclusive_parallel_prefix_sum<offset_view_t, MyExecSpace>(m + 1, offsets);
+  size_type num_terms = 0;
+  Kokkos::deep_copy(num_terms, Kokkos::subview(offsets, m));
+  offset_view_t positions(Kokkos::ViewAllocateWithoutInitializing("spgemm reuse positions"), num_terms);
+
+  if (m > 0){
+    size_type max_row_size = 0;
+    KokkosKernels::Impl::kk_view_reduce_max_row_size<size_type, MyExecSpace>(
+        m, row_mapC.data(), row_mapC.data() + 1, max_row_size);
+    if (max_row_size == 0) max_row_size = 1;
+    size_type hash_size = 1;
+    while (hash_size < max_row_size) hash_size *= 2;
+
+    size_t num_chunks = MyExecSpace::concurrency();
+    if (num_chunks > size_t(m)) num_chunks = m;
+    pool_memory_space m_space(num_chunks, hash_size + max_row_size, size_type(-1), KokkosKernels::Impl::ManyThread2OneChunk);
+
+    Kokkos::parallel_for("KokkosSparse::spgemm_numeric_reuse::Build", range_policy_t(0, m),
+        SpgemmReuseBuildFunctor<a_row_view_t, a_nnz_view_t, b_row_view_t, b_nnz_view_t,
+                                c_row_view_t, c_nnz_view_t, offset_view_t, pool_memory_space>(
+            row_mapA, entriesA, row_mapB, entriesB, row_mapC, entriesC,
+            offsets, positions, m_space, hash_size, max_row_size));
+  }
+  MyExecSpace().fence();
+  sh->set_numeric_reuse_map(offsets, positions, entriesC.data(), entriesC.extent(0));
+}
+
+/**
+ * \brief Numeric phase from the map recorded by spgemm_numeric_reuse_build.
+ * The caller checks that C is the one the map was recorded for
+ * (is_numeric_reuse_built_for on the handle).
+ */
+template <typename spgemm_handle_t,
+          typename a_row_view_t, typename a_nnz_view_t, typename a_scalar_view_t,
+          typename b_row_view_t, typename b_scalar_view_t,
+          typename c_row_view_t, typename c_scalar_view_t>
+void spgemm_numeric_reuse_apply(
+    spgemm_handle_t *sh,
+    typename spgemm_handle_t::nnz_lno_t m,
+    a_row_view_t row_mapA, a_nnz_view_t entriesA, a_scalar_view_t valuesA,
+    b_row_view_t row_mapB, b_scalar_view_t valuesB,
+    c_row_view_t row_mapC, c_scalar_view_t valuesC){
+
+  typedef typename spgemm_handle_t::HandleExecSpace MyExecSpace;
+  typedef typename spgemm_handle_t::row_lno_temp_work_view_t offset_view_t;
+
+  offset_view_t offsets, positions;
+  sh->get_numeric_reuse_map(offsets, positions);
+  Kokkos::parallel_for("KokkosSparse::spgemm_numeric_reuse::Numeric", Kokkos::RangePolicy<MyExecSpace>(0, m),
+      SpgemmReuseNumericFunctor<a_row_view_t, a_nnz_view_t, a_scalar_view_t,
+                                b_row_view_t, b_scalar_view_t,
+                                c_row_view_t, c_scalar_view_t, offset_view_t>(
+          row_mapA, entriesA, valuesA, row_mapB, valuesB, row_mapC, valuesC, offsets, positions));
+  MyExecSpace().fence();
+}
+
+}
+}
+
+#endif
@@ -309,6 +309,23 @@ struct SPGEMM_NUMERIC<KernelHandle,
           );
       break;
     }
+
+    //the KokkosSPGEMM kernels honor sort_output themselves.
+    switch (sh->get_algorithm_type()){
+    case SPGEMM_CUSPARSE:
+    case SPGEMM_CUSP:
+    case SPGEMM_MKL:
+    case SPGEMM_MKL2PHASE:
+    case SPGEMM_VIENNA:
+    case SPGEMM_SERIAL:
+    case SPGEMM_DEBUG:
+      if (sh->get_sort_output()){
+        KokkosKernels::Impl::sort_crs_matrix<typename KernelHandle::HandleExecSpace>(row_mapC, entriesC, valuesC);
+      }
+      break;
+    default:
+      break;
+    }
 }
 };
 
@@ -0,0 +1,145 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_SPGEMM_RAP_IMPL_HPP_
+#define KOKKOSSPARSE_SPGEMM_RAP_IMPL_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "KokkosSparse_spgemm_rowwise_impl.hpp"
+
+namespace KokkosSparse{
+namespace Impl{
+
+/**
+ * \brief Row-wise terms of the two products of C = R*(A*P). The product
+ * A*P is formed once, so each of its rows is computed once and not for
+ * every row of R that references it.
+ */
+template <typename spgemm_handle_t, typename RMatrix, typename AMatrix, typename PMatrix>
+struct RAPTerms{
+  typedef typename spgemm_handle_t::row_lno_temp_work_view_t ap_row_view_t;
+  typedef typename spgemm_handle_t::nnz_lno_temp_work_view_t ap_nnz_view_t;
+  typedef typename spgemm_handle_t::scalar_temp_work_view_t ap_scalar_view_t;
+
+  typedef SpgemmProductRowTerms<
+      typename AMatrix::row_map_type, typename AMatrix::index_type, typename AMatrix::values_type,
+      typename PMatrix::row_map_type, typename PMatrix::index_type, typename PMatrix::values_type> ap_terms_t;
+  typedef SpgemmProductRowTerms<
+      typename RMatrix::row_map_type, typename RMatrix::index_type, typename RMatrix::values_type,
+      ap_row_view_t, ap_nnz_view_t, ap_scalar_view_t> rap_terms_t;
+
+  static ap_terms_t ap(const AMatrix &A, const PMatrix &P){
+    return ap_terms_t(A.graph.row_map, A.graph.entries, A.values,
+                      P.graph.row_map, P.graph.entries, P.values, P.numCols());
+  }
+
+  static rap_terms_t rap(const RMatrix &R, spgemm_handle_t *sh, const typename rap_terms_t::size_type num_cols){
+    return rap_terms_t(R.graph.row_map, R.graph.entries, R.values,
+                       sh->get_rap_ap_rowmap(), sh->get_rap_ap_entries(), sh->get_rap_ap_values(), num_cols);
+  }
+};
+
+/**
+ * \brief Symbolic phase of C = R*A*P. Forms the structure of A*P, which
+ * is kept on the spgemm handle with room for its values, then fills
+ * rowmapC and the sorted entriesC. The number of entries of C is also
+ * stored on the handle.
+ */
+template <typename spgemm_handle_t,
+          typename RMatrix, typename AMatrix, typename PMatrix,
+          typename c_row_view_t, typename c_nnz_view_t>
+void spgemm_rap_symbolic_impl(
+    spgemm_handle_t *sh,
+    const RMatrix &R, const AMatrix &A, const PMatrix &P,
+    c_row_view_t rowmapC, c_nnz_view_t &entriesC){
+
+  typedef typename spgemm_handle_t::HandleExecSpace MyExecSpace;
+  typedef typename spgemm_handle_t::HandleTempMemorySpace MyTempMemorySpace;
+  typedef RAPTerms<spgemm_handle_t, RMatrix, AMatrix, PMatrix> terms_t;
+  typedef typename terms_t::ap_row_view_t ap_row_view_t;
+  typedef typename terms_t::ap_nnz_view_t ap_nnz_view_t;
+  typedef typename terms_t::ap_scalar_view_t ap_scalar_view_t;
+
+  ap_row_view_t ap_rowmap("RAP AP rowmap", A.numRows() + 1);
+  ap_nnz_view_t ap_entries("RAP AP entries", 0);
+  const typename spgemm_handle_t::size_type ap_nnz = spgemm_rowwise_symbolic<MyExecSpace, MyTempMemorySpace>(
+      "KokkosSparse::spgemm_rap::SymbolicAP", terms_t::ap(A, P), A.numRows(), ap_rowmap, ap_entries);
+  ap_scalar_view_t ap_values(Kokkos::ViewAllocateWithoutInitializing("RAP AP values"), ap_nnz);
+  sh->set_rap_ap(ap_rowmap, ap_entries, ap_values);
+
+  const typename spgemm_handle_t::size_type c_nnz = spgemm_rowwise_symbolic<MyExecSpace, MyTempMemorySpace>(
+      "KokkosSparse::spgemm_rap::Symbolic", terms_t::rap(R, sh, P.numCols()), R.numRows(), rowmapC, entriesC);
+  sh->set_rap_symbolic(c_nnz);
+}
+
+/**
+ * \brief Numeric phase of C = R*A*P: the values of A*P into the structure
+ * kept on the handle, then those of C into the structure of the symbolic
+ * phase. Nothing is hashed.
+ */
+template <typename spgemm_handle_t,
+          typename RMatrix, typename AMatrix, typename PMatrix,
+          typename c_row_view_t, typename c_nnz_view_t, typename c_scalar_view_t>
+void spgemm_rap_numeric_impl(
+    spgemm_handle_t *sh,
+    const RMatrix &R, const AMatrix &A, const PMatrix &P,
+    c_row_view_t rowmapC, c_nnz_view_t entriesC, c_scalar_view_t valuesC){
+
+  typedef typename spgemm_handle_t::HandleExecSpace MyExecSpace;
+  typedef typename spgemm_handle_t::nnz_scalar_t scalar_t;
+  typedef KokkosKernels::Experimental::PlusTimesSemiring<scalar_t> semiring_t;
+  typedef RAPTerms<spgemm_handle_t, RMatrix, AMatrix, PMatrix> terms_t;
+
+  spgemm_rowwise_numeric<MyExecSpace, semiring_t>(
+      "KokkosSparse::spgemm_rap::NumericAP", terms_t::ap(A, P), A.numRows(),
+      sh->get_rap_ap_rowmap(), sh->get_rap_ap_entries(), sh->get_rap_ap_values());
+  spgemm_rowwise_numeric<MyExecSpace, semiring_t>(
+      "KokkosSparse::spgemm_rap::Numeric", terms_t::rap(R, sh, P.numCols()), R.numRows(),
+      rowmapC, entriesC, valuesC);
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,549 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_SPGEMM_ROWWISE_IMPL_HPP_
+#define KOKKOSSPARSE_SPGEMM_ROWWISE_IMPL_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "KokkosKernels_ExecSpaceUtils.hpp"
+#include "KokkosKernels_SimpleUtils.hpp"
+#include "KokkosKernels_SparseUtils.hpp"
+#include "KokkosKernels_HashmapAccumulator.hpp"
+#include "KokkosKernels_Semiring.hpp"
+#include "KokkosKernels_Uniform_Initialized_MemoryPool.hpp"
+#include "KokkosSparse_findRelOffset.hpp"
+
+namespace KokkosSparse{
+namespace Impl{
+
+/*
+ * Row-wise kernels of spgemm_rap, spgemm_add and spgemm_masked.
+ * A RowTerms functor lists the rows whose scaled sum is
+ * row i of C, by calling visitor.row(scale, begin, end, entries, values)
+ * (or with a row filter as last argument) for each of them.
+ * As in KKMEM, each row of C goes to a thread of a team, and the entries
+ * of each visited row to its vector lanes.
+ * The symbolic phase hashes the columns of each row, once to count them
+ * and once to write them; the entries of C come out sorted. The numeric
+ * phase does not hash: each term is combined into the position of its
+ * column, found by binary search in the sorted row of C.
+ */
+
+/**
+ * \brief Layout of a pool chunk of the symbolic kernel, in size_type
+ * units: used_size, used_hash_size, hash_begins[hash_size],
+ * hash_nexts[max_row_size], used_hashes[hash_size], keys[max_row_size].
+ */
+template <typename size_type, typename nnz_lno_t>
+struct SpgemmRowwiseChunkLayout{
+  size_type hash_size, max_row_size;
+  size_type begins_offset, nexts_offset, used_hashes_offset, keys_offset;
+  size_type chunk_size;
+
+  SpgemmRowwiseChunkLayout(size_type max_row_size_):
+    hash_size(1), max_row_size(max_row_size_){
+    while (hash_size < max_row_size) hash_size *= 2;
+    begins_offset = 2;
+    nexts_offset = begins_offset + hash_size;
+    used_hashes_offset = nexts_offset + max_row_size;
+    keys_offset = used_hashes_offset + hash_size;
+    chunk_size = keys_offset + (max_row_size * sizeof(nnz_lno_t) + sizeof(size_type) - 1) / sizeof(size_type);
+  }
+};
+
+/**
+ * \brief Row filter that keeps every column.
+ */
+struct SpgemmNoMaskRow{
+  template <typename nnz_lno_t>
+  KOKKOS_INLINE_FUNCTION
+  bool operator()(const nnz_lno_t /* col */) const { return true; }
+};
+
+/**
+ * \brief Filter of SpgemmProductRowTerms without a mask.
+ */
+struct SpgemmNoMask{
+  typedef SpgemmNoMaskRow row_filter_t;
+
+  template <typename nnz_lno_t>
+  KOKKOS_INLINE_FUNCTION
+  row_filter_t for_row(const nnz_lno_t /* i */) const { return row_filter_t(); }
+
+  template <typename nnz_lno_t, typename size_type>
+  KOKKOS_INLINE_FUNCTION
+  size_type max_row_size(const nnz_lno_t /* i */, const size_type bound) const { return bound; }
+};
+
+/**
+ * \brief Symbolic visitor: inserts the columns of the visited rows into
+ * the hashmap of a pool chunk. The vector lanes insert distinct columns
+ * of one row at a time, which is what the vector_atomic inserts of
+ * HashmapAccumulator assume.
+ */
+template <typename team_member_t, typename size_type, typename nnz_lno_t, typename scalar_t>
+struct SpgemmRowHashVisitor{
+  typedef KokkosKernels::Experimental::HashmapAccumulator<size_type, nnz_lno_t, scalar_t> hashmap_t;
+  typedef SpgemmRowwiseChunkLayout<size_type, nnz_lno_t> layout_t;
+
+  static constexpr bool is_numeric = false;
+
+  const team_member_t &teamMember;
+  const int vector_size;
+  hashmap_t hm;
+  volatile size_type *used_size;
+  size_type *used_hash_size;
+  size_type *used_hashes;
+  size_type hash_mask;
+
+  KOKKOS_INLINE_FUNCTION
+  SpgemmRowHashVisitor(const team_member_t &teamMember_, const int vector_size_,
+                       size_type *chunk, const layout_t &layout):
+    teamMember(teamMember_), vector_size(vector_size_),
+    hm(layout.hash_size, layout.max_row_size,
+       chunk + layout.begins_offset, chunk + layout.nexts_offset,
+       (nnz_lno_t *) (chunk + layout.keys_offset), NULL),
+    used_size(chunk), used_hash_size(chunk + 1),
+    used_hashes(chunk + layout.used_hashes_offset),
+    hash_mask(layout.hash_size - 1){}
+
+  template <typename b_nnz_view_t, typename b_scalar_view_t, typename row_filter_t>
+  KOKKOS_INLINE_FUNCTION
+  void row(const scalar_t /* scale */, const size_type row_begin, const size_type row_end,
+           const b_nnz_view_t &entries, const b_scalar_view_t & /* values */,
+           const row_filter_t &filter){
+    Kokkos::parallel_for(Kokkos::ThreadVectorRange(teamMember, nnz_lno_t(row_end - row_begin)),
+        [&] (const nnz_lno_t k) {
+      const nnz_lno_t col = entries(row_begin + k);
+      if (filter(col)){
+        const size_type hash = size_type(col) & hash_mask;
+        hm.vector_atomic_insert_into_hash_TrackHashes(
+            teamMember, vector_size, hash, col,
+            used_size, hm.max_value_size, used_hash_size, used_hashes);
+      }
+    });
+  }
+
+  template <typename b_nnz_view_t, typename b_scalar_view_t>
+  KOKKOS_INLINE_FUNCTION
+  void row(const scalar_t scale, const size_type row_begin, const size_type row_end,
+           const b_nnz_view_t &entries, const b_scalar_view_t &values){
+    row(scale, row_begin, row_end, entries, values, SpgemmNoMaskRow());
+  }
+
+  //leaves the hashmap of the chunk as it was found.
+  KOKKOS_INLINE_FUNCTION
+  void clear(){
+    Kokkos::parallel_for(Kokkos::ThreadVectorRange(teamMember, nnz_lno_t(*used_hash_size)),
+        [&] (const nnz_lno_t k) {
+      hm.hash_begins[used_hashes[k]] = -1;
+    });
+  }
+};
+
+/**
+ * \brief Numeric visitor: combines each term with Semiring::add into the
+ * position of its column in a row of C holding the sorted entries of the
+ * symbolic phase. Terms whose column is not in the row, i.e. those the
+ * symbolic phase filtered out, are dropped.
+ */
+template <typename team_member_t, typename Semiring, typename size_type, typename nnz_lno_t, typename scalar_t>
+struct SpgemmRowCombineVisitor{
+  static constexpr bool is_numeric = true;
+
+  const team_member_t &teamMember;
+  const nnz_lno_t *c_row;
+  scalar_t *c_row_values;
+  nnz_lno_t c_row_size;
+
+  KOKKOS_INLINE_FUNCTION
+  SpgemmRowCombineVisitor(const team_member_t &teamMember_,
+                          const nnz_lno_t *c_row_, scalar_t *c_row_values_, const nnz_lno_t c_row_size_):
+    teamMember(teamMember_), c_row(c_row_), c_row_values(c_row_values_), c_row_size(c_row_size_){}
+
+  template <typename b_nnz_view_t, typename b_scalar_view_t, typename row_filter_t>
+  KOKKOS_INLINE_FUNCTION
+  void row(const scalar_t scale, const size_type row_begin, const size_type row_end,
+           const b_nnz_view_t &entries, const b_scalar_view_t &values,
+           const row_filter_t & /* filter */){
+    Kokkos::parallel_for(Kokkos::ThreadVectorRange(teamMember, nnz_lno_t(row_end - row_begin)),
+        [&] (const nnz_lno_t k) {
+      const nnz_lno_t pos = KokkosSparse::findRelOffset<nnz_lno_t>(
+          c_row, c_row_size, nnz_lno_t(entries(row_begin + k)), 0, true);
+      if (pos < c_row_size){
+        c_row_values[pos] = Semiring::add(c_row_values[pos],
+                                          Semiring::multiply(scale, values(row_begin + k)));
+      }
+    });
+  }
+
+  template <typename b_nnz_view_t, typename b_scalar_view_t>
+  KOKKOS_INLINE_FUNCTION
+  void row(const scalar_t scale, const size_type row_begin, const size_type row_end,
+           const b_nnz_view_t &entries, const b_scalar_view_t &values){
+    row(scale, row_begin, row_end, entries, values, SpgemmNoMaskRow());
+  }
+};
+
+/**
+ * \brief Terms of row i of A*B: row k of B scaled by A(i,k), for each k
+ * in row i of A. filter.for_row(i) restricts the columns of row i (the
+ * mask of spgemm_masked). max_row_size(i) bounds the size of row i by
+ * min(number of multiplications in row i, number of columns of B), then
+ * by the filter.
+ */
+template <typename a_row_view_t, typename a_nnz_view_t, typename a_scalar_view_t,
+          typename b_row_view_t, typename b_nnz_view_t, typename b_scalar_view_t,
+          typename filter_t = SpgemmNoMask>
+struct SpgemmProductRowTerms{
+  typedef typename a_nnz_view_t::non_const_value_type nnz_lno_t;
+  typedef typename a_row_view_t::non_const_value_type size_type;
+  typedef typename a_scalar_view_t::non_const_value_type scalar_t;
+
+  a_row_view_t rowmapA;
+  a_nnz_view_t entriesA;
+  a_scalar_view_t valuesA;
+  b_row_view_t rowmapB;
+  b_nnz_view_t entriesB;
+  b_scalar_view_t valuesB;
+  size_type num_cols;
+  filter_t filter;
+  size_t inner_rows, inner_nnz;
+
+  SpgemmProductRowTerms(
+      const a_row_view_t &rowmapA_, const a_nnz_view_t &entriesA_, const a_scalar_view_t &valuesA_,
+      const b_row_view_t &rowmapB_, const b_nnz_view_t &entriesB_, const b_scalar_view_t &valuesB_,
+      const size_type num_cols_, const filter_t &filter_ = filter_t()):
+        rowmapA(rowmapA_), entriesA(entriesA_), valuesA(valuesA_),
+        rowmapB(rowmapB_), entriesB(entriesB_), valuesB(valuesB_),
+        num_cols(num_cols_), filter(filter_),
+        inner_rows(rowmapB_.extent(0) ? rowmapB_.extent(0) - 1 : 0),
+        inner_nnz(entriesB_.extent(0)){}
+
+  KOKKOS_INLINE_FUNCTION
+  size_type max_row_size(const nnz_lno_t i) const {
+    size_type flops = 0;
+    for (size_type jj = rowmapA(i); jj < rowmapA(i + 1) && flops < num_cols; ++jj){
+      const nnz_lno_t k = entriesA(jj);
+      flops += rowmapB(k + 1) - rowmapB(k);
+    }
+    return filter.max_row_size(i, flops > num_cols ? num_cols : flops);
+  }
+
+  template <typename visitor_t>
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const nnz_lno_t i, visitor_t &visitor) const {
+    const bool numeric = visitor_t::is_numeric;
+    const typename filter_t::row_filter_t row_filter = filter.for_row(i);
+    for (size_type jj = rowmapA(i); jj < rowmapA(i + 1); ++jj){
+      const nnz_lno_t k = entriesA(jj);
+      visitor.row(numeric ? scalar_t(valuesA(jj)) : scalar_t(),
+                  rowmapB(k), rowmapB(k + 1), entriesB, valuesB, row_filter);
+    }
+  }
+};
+
+/**
+ * \brief Maximum over the rows of RowTerms::max_row_size(i).
+ */
+template <typename RowTerms>
+struct SpgemmRowwiseMaxRowSizeFunctor{
+  typedef typename RowTerms::nnz_lno_t nnz_lno_t;
+  typedef typename RowTerms::size_type size_type;
+
+  RowTerms terms;
+
+  SpgemmRowwiseMaxRowSizeFunctor(const RowTerms &terms_): terms(terms_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const nnz_lno_t i, size_type &max_row_size) const {
+    const size_type row_size = terms.max_row_size(i);
+    if (row_size > max_row_size) max_row_size = row_size;
+  }
+};
+
+template <typename MyExecSpace, typename RowTerms>
+typename RowTerms::size_type spgemm_rowwise_max_row_size(
+    const char *label, const typename RowTerms::nnz_lno_t num_rows, const RowTerms &terms){
+  typedef typename RowTerms::size_type size_type;
+  size_type max_row_size = 0;
+  Kokkos::parallel_reduce(label, Kokkos::RangePolicy<MyExecSpace>(0, num_rows),
+      SpgemmRowwiseMaxRowSizeFunctor<RowTerms>(terms), Kokkos::Max<size_type>(max_row_size));
+  return max_row_size;
+}
+
+/**
+ * \brief Team sizes of the row-wise kernels. The vector size follows the
+ * average length of the visited rows; on CUDA a thread takes one row of
+ * C, on the host a team of one thread takes a block of rows.
+ */
+template <typename MyExecSpace>
+struct SpgemmRowwiseLaunch{
+  typedef Kokkos::TeamPolicy<MyExecSpace, Kokkos::Schedule<Kokkos::Dynamic> > team_policy_t;
+
+  int vector_size, team_size;
+  size_t team_work_size;
+
+  SpgemmRowwiseLaunch(const size_t inner_rows, const size_t inner_nnz){
+    const KokkosKernels::Impl::ExecSpaceType exec = KokkosKernels::Impl::kk_get_exec_space_type<MyExecSpace>();
+    vector_size = KokkosKernels::Impl::kk_get_suggested_vector_size(inner_rows, inner_nnz, exec);
+    team_size = KokkosKernels::Impl::kk_get_suggested_team_size(vector_size, exec);
+    team_work_size = exec == KokkosKernels::Impl::Exec_CUDA ? team_size : 16;
+  }
+
+  team_policy_t policy(const size_t num_rows) const {
+    return team_policy_t((num_rows + team_work_size - 1) / team_work_size, team_size, vector_size);
+  }
+};
+
+/**
+ * \brief Memory pool of the symbolic kernel: one chunk per thread that
+ * can run at once, but no more chunks than rows. On CUDA the pool is cut
+ * to half of the free memory, as for the KKMEM pools; threads then wait
+ * for a free chunk.
+ */
+template <typename MyExecSpace, typename MyTempMemorySpace, typename size_type>
+KokkosKernels::Impl::UniformMemoryPool<MyTempMemorySpace, size_type> spgemm_rowwise_pool(
+    const size_t num_rows, const int vector_size, const size_type chunk_size){
+  size_t num_chunks = MyExecSpace::concurrency() / vector_size;
+#if defined( KOKKOS_ENABLE_CUDA )
+  if (KokkosKernels::Impl::kk_get_exec_space_type<MyExecSpace>() == KokkosKernels::Impl::Exec_CUDA){
+    size_t free_byte, total_byte;
+    cudaMemGetInfo(&free_byte, &total_byte);
+    const size_t max_chunks = (free_byte / 2) / (size_t(chunk_size) * sizeof(size_type));
+    if (num_chunks > max_chunks) num_chunks = max_chunks;
+  }
+#endif
+  if (num_chunks > num_rows) num_chunks = num_rows;
+  if (num_chunks == 0) num_chunks = 1;
+  return KokkosKernels::Impl::UniformMemoryPool<MyTempMemorySpace, size_type>(
+      num_chunks, chunk_size, size_type(-1), KokkosKernels::Impl::ManyThread2OneChunk);
+}
+
+/**
+ * \brief Symbolic row-wise kernel. Without fill, the size of each row of C
+ * is written into rowmapC; with fill, its columns are written at rowmapC.
+ */
+template <typename MyExecSpace, typename RowTerms,
+          typename c_row_view_t, typename c_nnz_view_t, typename pool_memory_space>
+struct SpgemmHashRowFunctor{
+  typedef typename RowTerms::nnz_lno_t nnz_lno_t;
+  typedef typename RowTerms::size_type size_type;
+  typedef typename RowTerms::scalar_t scalar_t;
+  typedef typename Kokkos::TeamPolicy<MyExecSpace>::member_type team_member_t;
+  typedef SpgemmRowHashVisitor<team_member_t, size_type, nnz_lno_t, scalar_t> visitor_t;
+  typedef typename visitor_t::layout_t layout_t;
+
+  RowTerms terms;
+  nnz_lno_t num_rows, team_work_size;
+  int vector_size;
+  bool fill;
+  c_row_view_t rowmapC;
+  c_nnz_view_t entriesC;
+  pool_memory_space memory_space;
+  layout_t layout;
+
+  SpgemmHashRowFunctor(
+      const RowTerms &terms_, nnz_lno_t num_rows_, nnz_lno_t team_work_size_, int vector_size_,
+      bool fill_, c_row_view_t rowmapC_, c_nnz_view_t entriesC_,
+      pool_memory_space memory_space_, const layout_t &layout_):
+        terms(terms_), num_rows(num_rows_), team_work_size(team_work_size_), vector_size(vector_size_),
+        fill(fill_), rowmapC(rowmapC_), entriesC(entriesC_),
+        memory_space(memory_space_), layout(layout_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const team_member_t &teamMember) const {
+    const nnz_lno_t team_row_begin = teamMember.league_rank() * team_work_size;
+    const nnz_lno_t team_row_end = KOKKOSKERNELS_MACRO_MIN(team_row_begin + team_work_size, num_rows);
+
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(teamMember, team_row_begin, team_row_end), [&] (const nnz_lno_t &i) {
+      volatile size_type *tmp = NULL;
+      while (tmp == NULL){
+        Kokkos::single(Kokkos::PerThread(teamMember),[&] (volatile size_type * &memptr) {
+          memptr = (volatile size_type *) (memory_space.allocate_chunk(i));
+        }, tmp);
+      }
+      size_type *chunk = (size_type *) tmp;
+      Kokkos::single(Kokkos::PerThread(teamMember),[&] () {
+        chunk[0] = 0;
+        chunk[1] = 0;
+      });
+
+      visitor_t visitor(teamMember, vector_size, chunk, layout);
+      terms(i, visitor);
+
+      const size_type row_size = *visitor.used_size;
+      if (fill){
+        const size_type c_pos = rowmapC(i);
+        Kokkos::parallel_for(Kokkos::ThreadVectorRange(teamMember, nnz_lno_t(row_size)), [&] (const nnz_lno_t k) {
+          entriesC(c_pos + k) = visitor.hm.keys[k];
+        });
+      }
+      else {
+        //rowmapC holds the row sizes until the prefix sum.
+        Kokkos::single(Kokkos::PerThread(teamMember),[&] () {
+          rowmapC(i) = row_size;
+        });
+      }
+      visitor.clear();
+      Kokkos::single(Kokkos::PerThread(teamMember),[&] () {
+        memory_space.release_chunk(chunk);
+      });
+    });
+  }
+};
+
+/**
+ * \brief Numeric row-wise kernel: sets each row of C to Semiring::zero(),
+ * then combines the terms of RowTerms into it.
+ */
+template <typename MyExecSpace, typename Semiring, typename RowTerms,
+          typename c_row_view_t, typename c_nnz_view_t, typename c_scalar_view_t>
+struct SpgemmCombineRowFunctor{
+  typedef typename RowTerms::nnz_lno_t nnz_lno_t;
+  typedef typename RowTerms::size_type size_type;
+  typedef typename c_scalar_view_t::non_const_value_type scalar_t;
+  typedef typename Kokkos::TeamPolicy<MyExecSpace>::member_type team_member_t;
+  typedef SpgemmRowCombineVisitor<team_member_t, Semiring, size_type, nnz_lno_t, scalar_t> visitor_t;
+
+  RowTerms terms;
+  nnz_lno_t num_rows, team_work_size;
+  c_row_view_t rowmapC;
+  c_nnz_view_t entriesC;
+  c_scalar_view_t valuesC;
+
+  SpgemmCombineRowFunctor(
+      const RowTerms &terms_, nnz_lno_t num_rows_, nnz_lno_t team_work_size_,
+      c_row_view_t rowmapC_, c_nnz_view_t entriesC_, c_scalar_view_t valuesC_):
+        terms(terms_), num_rows(num_rows_), team_work_size(team_work_size_),
+        rowmapC(rowmapC_), entriesC(entriesC_), valuesC(valuesC_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const team_member_t &teamMember) const {
+    const nnz_lno_t team_row_begin = teamMember.league_rank() * team_work_size;
+    const nnz_lno_t team_row_end = KOKKOSKERNELS_MACRO_MIN(team_row_begin + team_work_size, num_rows);
+
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(teamMember, team_row_begin, team_row_end), [&] (const nnz_lno_t &i) {
+      const size_type c_row_begin = rowmapC(i);
+      visitor_t visitor(teamMember, entriesC.data() + c_row_begin, valuesC.data() + c_row_begin,
+                        nnz_lno_t(rowmapC(i + 1) - c_row_begin));
+      Kokkos::parallel_for(Kokkos::ThreadVectorRange(teamMember, visitor.c_row_size), [&] (const nnz_lno_t k) {
+        visitor.c_row_values[k] = Semiring::zero();
+      });
+      terms(i, visitor);
+    });
+  }
+};
+
+/**
+ * \brief Symbolic phase of a row-wise kernel: fills rowmapC, reallocates
+ * entriesC (keeping its label) and writes the sorted columns of each row
+ * of C into it. Returns the number of entries of C.
+ */
+template <typename MyExecSpace, typename MyTempMemorySpace, typename RowTerms,
+          typename c_row_view_t, typename c_nnz_view_t>
+typename RowTerms::size_type spgemm_rowwise_symbolic(
+    const char *label, const RowTerms &terms,
+    const typename RowTerms::nnz_lno_t num_rows,
+    c_row_view_t rowmapC, c_nnz_view_t &entriesC){
+
+  typedef typename RowTerms::size_type size_type;
+  typedef typename RowTerms::nnz_lno_t nnz_lno_t;
+  typedef KokkosKernels::Impl::UniformMemoryPool<MyTempMemorySpace, size_type> pool_memory_space;
+  typedef SpgemmHashRowFunctor<MyExecSpace, RowTerms, c_row_view_t, c_nnz_view_t, pool_memory_space> functor_t;
+
+  if (num_rows == 0){
+    Kokkos::realloc(entriesC, 0);
+    return 0;
+  }
+
+  size_type max_row_size = spgemm_rowwise_max_row_size<MyExecSpace>(label, num_rows, terms);
+  if (max_row_size == 0) max_row_size = 1;
+  const typename functor_t::layout_t layout(max_row_size);
+  const SpgemmRowwiseLaunch<MyExecSpace> launch(terms.inner_rows, terms.inner_nnz);
+  pool_memory_space m_space =
+    spgemm_rowwise_pool<MyExecSpace, MyTempMemorySpace>(num_rows, launch.vector_size, layout.chunk_size);
+
+  Kokkos::parallel_for(label, launch.policy(num_rows),
+      functor_t(terms, num_rows, launch.team_work_size, launch.vector_size, false,
+                rowmapC, entriesC, m_space, layout));
+  KokkosKernels::Impl::kk_exclusive_parallel_prefix_sum<c_row_view_t, MyExecSpace>(num_rows + 1, rowmapC);
+  MyExecSpace().fence();
+
+  size_type c_nnz = 0;
+  Kokkos::deep_copy(c_nnz, Kokkos::subview(rowmapC, num_rows));
+  Kokkos::realloc(entriesC, c_nnz);
+  if (c_nnz > 0){
+    Kokkos::parallel_for(label, launch.policy(num_rows),
+        functor_t(terms, num_rows, launch.team_work_size, launch.vector_size, true,
+                  rowmapC, entriesC, m_space, layout));
+    KokkosKernels::Impl::sort_crs_graph<MyExecSpace>(rowmapC, entriesC);
+    MyExecSpace().fence();
+  }
+  return c_nnz;
+}
+
+/**
+ * \brief Numeric phase of a row-wise kernel, on the structure written by
+ * spgemm_rowwise_symbolic.
+ */
+template <typename MyExecSpace, typename Semiring, typename RowTerms,
+          typename c_row_view_t, typename c_nnz_view_t, typename c_scalar_view_t>
+void spgemm_rowwise_numeric(
+    const char *label, const RowTerms &terms,
+    const typename RowTerms::nnz_lno_t num_rows,
+    c_row_view_t rowmapC, c_nnz_view_t entriesC, c_scalar_view_t valuesC){
+
+  if (num_rows == 0) return;
+  const SpgemmRowwiseLaunch<MyExecSpace> launch(terms.inner_rows, terms.inner_nnz);
+  Kokkos::parallel_for(label, launch.policy(num_rows),
+      SpgemmCombineRowFunctor<MyExecSpace, Semiring, RowTerms, c_row_view_t, c_nnz_view_t, c_scalar_view_t>(
+        terms, num_rows, launch.team_work_size, rowmapC, entriesC, valuesC));
+  MyExecSpace().fence();
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,179 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_SPGEMM_STREAMING_IMPL_HPP_
+#define KOKKOSSPARSE_SPGEMM_STREAMING_IMPL_HPP_
+
+#include <vector>
+#include "Kokkos_Core.hpp"
+
+namespace KokkosSparse{
+namespace Impl{
+
+/**
+ * \brief Upper bound of the number of entries in row i of A*B:
+ * min(number of multiplications in row i, number of columns of B).
+ */
+template <typename a_row_view_t, typename a_nnz_view_t, typename b_row_view_t, typename bound_view_t>
+struct SpgemmRowBoundFunctor{
+  typedef typename a_row_view_t::non_const_value_type size_type;
+  typedef typename a_nnz_view_t::non_const_value_type nnz_lno_t;
+
+  a_row_view_t row_mapA;
+  a_nnz_view_t entriesA;
+  b_row_view_t row_mapB;
+  size_t num_cols;
+  bound_view_t bounds;
+
+  SpgemmRowBoundFunctor(a_row_view_t row_mapA_, a_nnz_view_t entriesA_, b_row_view_t row_mapB_,
+      size_t num_cols_, bound_view_t bounds_):
+    row_mapA(row_mapA_), entriesA(entriesA_), row_mapB(row_mapB_),
+    num_cols(num_cols_), bounds(bounds_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const nnz_lno_t i) const {
+    size_t flops = 0;
+    for (size_type j = row_mapA(i); j < row_mapA(i + 1) && flops < num_cols; ++j){
+      const nnz_lno_t rowB = entriesA(j);
+      flops += row_mapB(rowB + 1) - row_mapB(rowB);
+    }
+    bounds(i) = flops < num_cols ? flops : num_cols;
+  }
+};
+
+/**
+ * \brief out(out_begin + i) = in(in_begin + i) - in(in_begin) + offset,
+ * i.e. copies a range of a rowmap so that it starts at offset.
+ */
+template <typename in_row_view_t, typename out_row_view_t>
+struct SpgemmShiftRowmapFunctor{
+  typedef typename out_row_view_t::non_const_value_type size_type;
+
+  in_row_view_t in;
+  size_t in_begin;
+  out_row_view_t out;
+  size_t out_begin;
+  size_type offset;
+
+  SpgemmShiftRowmapFunctor(in_row_view_t in_, size_t in_begin_, out_row_view_t out_, size_t out_begin_, size_type offset_):
+    in(in_), in_begin(in_begin_), out(out_), out_begin(out_begin_), offset(offset_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const size_t i) const {
+    out(out_begin + i) = in(in_begin + i) - in(in_begin) + offset;
+  }
+};
+
+template <typename MyExecSpace, typename in_row_view_t, typename out_row_view_t>
+void spgemm_shift_rowmap(
+    in_row_view_t in, size_t in_begin, size_t num_rows,
+    out_row_view_t out, size_t out_begin,
+    typename out_row_view_t::non_const_value_type offset){
+  Kokkos::parallel_for("KokkosSparse::spgemm_streaming::ShiftRowmap",
+      Kokkos::RangePolicy<MyExecSpace>(0, num_rows + 1),
+      SpgemmShiftRowmapFunctor<in_row_view_t, out_row_view_t>(in, in_begin, out, out_begin, offset));
+}
+
+/**
+ * \brief Splits the rows of A into batches, so that the estimated memory of
+ * each batch of C (entries, values, rowmaps and the accumulators of its
+ * largest row) stays within budget bytes. A row that alone exceeds the budget
+ * forms its own batch. budget == 0 means a single batch.
+ * Returns batch_offsets, batch b is rows [batch_offsets[b], batch_offsets[b+1]).
+ */
+template <typename MyExecSpace, typename size_type, typename nnz_lno_t, typename scalar_t,
+          typename a_row_view_t, typename a_nnz_view_t, typename b_row_view_t>
+void spgemm_streaming_batches(
+    size_t budget,
+    nnz_lno_t num_rows, nnz_lno_t num_cols_b,
+    a_row_view_t row_mapA, a_nnz_view_t entriesA, b_row_view_t row_mapB,
+    std::vector<nnz_lno_t> &batch_offsets){
+
+  batch_offsets.clear();
+  batch_offsets.push_back(0);
+  if (budget == 0 || num_rows == 0){
+    batch_offsets.push_back(num_rows);
+    return;
+  }
+
+  typedef Kokkos::View<size_t *, MyExecSpace> bound_view_t;
+  bound_view_t bounds(Kokkos::ViewAllocateWithoutInitializing("spgemm row bounds"), num_rows);
+  Kokkos::parallel_for("KokkosSparse::spgemm_streaming::RowBounds",
+      Kokkos::RangePolicy<MyExecSpace>(0, num_rows),
+      SpgemmRowBoundFunctor<a_row_view_t, a_nnz_view_t, b_row_view_t, bound_view_t>(
+          row_mapA, entriesA, row_mapB, num_cols_b, bounds));
+  auto h_bounds = Kokkos::create_mirror_view(bounds);
+  Kokkos::deep_copy(h_bounds, bounds);
+
+  const size_t entry_bytes = sizeof(nnz_lno_t) + sizeof(scalar_t);
+  const size_t row_bytes = 2 * sizeof(size_type);
+  const size_t concurrency = MyExecSpace::concurrency();
+
+  size_t batch_entries = 0, batch_max_row = 0;
+  nnz_lno_t batch_rows = 0;
+  for (nnz_lno_t i = 0; i < num_rows; ++i){
+    const size_t entries = batch_entries + h_bounds(i);
+    const size_t max_row = h_bounds(i) > batch_max_row ? h_bounds(i) : batch_max_row;
+    const size_t threads = size_t(batch_rows + 1) < concurrency ? size_t(batch_rows + 1) : concurrency;
+    const size_t bytes = entries * entry_bytes + (batch_rows + 2) * row_bytes +
+        threads * max_row * (entry_bytes + sizeof(size_type));
+    if (batch_rows > 0 && bytes > budget){
+      batch_offsets.push_back(i);
+      batch_entries = h_bounds(i);
+      batch_max_row = h_bounds(i);
+      batch_rows = 1;
+    }
+    else {
+      batch_entries = entries;
+      batch_max_row = max_row;
+      ++batch_rows;
+    }
+  }
+  batch_offsets.push_back(num_rows);
+}
+
+}
+}
+
+#endif
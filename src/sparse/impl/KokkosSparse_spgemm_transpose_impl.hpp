@@ -0,0 +1,488 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_SPGEMM_TRANSPOSE_IMPL_HPP_
+#define KOKKOSSPARSE_SPGEMM_TRANSPOSE_IMPL_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "KokkosKernels_SparseUtils.hpp"
+#include "KokkosSparse_findRelOffset.hpp"
+#include "KokkosSparse_spgemm_rowwise_impl.hpp"
+
+namespace KokkosSparse{
+namespace Impl{
+
+template <typename perm_view_t>
+struct SpgemmTransposeIotaFunctor{
+  typedef typename perm_view_t::non_const_value_type size_type;
+  perm_view_t perm;
+
+  SpgemmTransposeIotaFunctor(perm_view_t perm_): perm(perm_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const size_type i) const {
+    perm(i) = i;
+  }
+};
+
+template <typename perm_view_t, typename in_scalar_view_t, typename out_scalar_view_t>
+struct SpgemmTransposeGatherFunctor{
+  typedef typename perm_view_t::non_const_value_type size_type;
+  perm_view_t perm;
+  in_scalar_view_t vals;
+  out_scalar_view_t t_vals;
+
+  SpgemmTransposeGatherFunctor(perm_view_t perm_, in_scalar_view_t vals_, out_scalar_view_t t_vals_):
+    perm(perm_), vals(vals_), t_vals(t_vals_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const size_type i) const {
+    t_vals(i) = vals(perm(i));
+  }
+};
+
+/**
+ * \brief Builds the graph of the transpose of a num_rows x num_cols operand,
+ * together with the position of every transposed entry in the original
+ * entries array. Rows of the result are sorted, so the permutation does not
+ * depend on the order in which the fill atomics were served.
+ * t_xadj must be zero initialized with num_cols + 1 entries, t_adj and t_perm
+ * must have as many entries as adj.
+ */
+template <typename MyExecSpace,
+          typename in_row_view_t, typename in_nnz_view_t,
+          typename out_row_view_t, typename out_nnz_view_t>
+void spgemm_transpose_structure(
+    typename in_nnz_view_t::non_const_value_type num_rows,
+    typename in_nnz_view_t::non_const_value_type num_cols,
+    in_row_view_t xadj,
+    in_nnz_view_t adj,
+    out_row_view_t t_xadj,
+    out_nnz_view_t t_adj,
+    out_row_view_t t_perm){
+
+  typedef typename out_row_view_t::non_const_value_type size_type;
+  typedef Kokkos::RangePolicy<MyExecSpace> range_policy_t;
+
+  const size_type nnz = adj.extent(0);
+  out_row_view_t positions(Kokkos::ViewAllocateWithoutInitializing("spgemm transpose positions"), nnz);
+  Kokkos::parallel_for("KokkosSparse::spgemm_transpose::Iota", range_policy_t(0, nnz),
+      SpgemmTransposeIotaFunctor<out_row_view_t>(positions));
+
+  KokkosKernels::Impl::transpose_matrix<
+    in_row_view_t, in_nnz_view_t, out_row_view_t,
+    out_row_view_t, out_nnz_view_t, out_row_view_t,
+    out_row_view_t, MyExecSpace>(
+        num_rows, num_cols, xadj, adj, positions, t_xadj, t_adj, t_perm);
+
+  KokkosKernels::Impl::sort_crs_matrix<MyExecSpace, out_row_view_t, out_nnz_view_t, out_row_view_t>(
+      t_xadj, t_adj, t_perm);
+  MyExecSpace().fence();
+}
+
+/**
+ * \brief Gathers the values of a transposed operand, t_vals(i) = vals(t_perm(i)),
+ * using the permutation built by spgemm_transpose_structure.
+ */
+template <typename MyExecSpace, typename perm_view_t, typename in_scalar_view_t, typename out_scalar_view_t>
+void spgemm_transpose_values(
+    perm_view_t t_perm,
+    in_scalar_view_t vals,
+    out_scalar_view_t t_vals){
+  typedef typename perm_view_t::non_const_value_type size_type;
+  const size_type nnz = t_perm.extent(0);
+  Kokkos::parallel_for("KokkosSparse::spgemm_transpose::Gather", Kokkos::RangePolicy<MyExecSpace>(0, nnz),
+      SpgemmTransposeGatherFunctor<perm_view_t, in_scalar_view_t, out_scalar_view_t>(t_perm, vals, t_vals));
+  MyExecSpace().fence();
+}
+
+/*
+ * SpGEMM with a transposed operand, C = op(A)*op(B), where the stored A is
+ * n x m when transposeA is set and the stored B is k x n when transposeB
+ * is set, so that op(A) is m x n and op(B) is n x k.
+ * The numeric phase reads A and B as they are stored:
+ *  - A^T*B: row l of A and row l of B add their outer product into C,
+ *    C(i,j) += A(l,i)*B(l,j) (column-driven accumulation).
+ *  - A^T*B^T: row j of B times A is column j of C,
+ *    C(i,j) += B(j,l)*A(l,i).
+ *  - A*B^T: C(i,j) is the sparse dot product of row i of A and row j of B,
+ *    for each (i,j) of the structure of C.
+ * The first two scatter into rows of C with atomics, at the position of
+ * the column found by binary search in the sorted row.
+ * The structure of C needs the columns of the transposed operand, so the
+ * symbolic phase transposes its graph (no values, no permutation) for the
+ * time of the call, and keeps only the sorted entries of C on the handle.
+ */
+
+/**
+ * \brief Numeric kernel of C = A^T*B, one stored row l of A and B per thread.
+ */
+template <typename MyExecSpace,
+          typename a_row_view_t, typename a_nnz_view_t, typename a_scalar_view_t,
+          typename b_row_view_t, typename b_nnz_view_t, typename b_scalar_view_t,
+          typename c_row_view_t, typename c_nnz_view_t, typename c_scalar_view_t>
+struct SpgemmTransposeANumericFunctor{
+  typedef typename a_nnz_view_t::non_const_value_type nnz_lno_t;
+  typedef typename a_row_view_t::non_const_value_type size_type;
+  typedef typename Kokkos::TeamPolicy<MyExecSpace>::member_type team_member_t;
+
+  nnz_lno_t num_rows, team_work_size;
+  a_row_view_t rowmapA;
+  a_nnz_view_t entriesA;
+  a_scalar_view_t valuesA;
+  b_row_view_t rowmapB;
+  b_nnz_view_t entriesB;
+  b_scalar_view_t valuesB;
+  c_row_view_t rowmapC;
+  c_nnz_view_t entriesC;
+  c_scalar_view_t valuesC;
+
+  SpgemmTransposeANumericFunctor(
+      nnz_lno_t num_rows_, nnz_lno_t team_work_size_,
+      a_row_view_t rowmapA_, a_nnz_view_t entriesA_, a_scalar_view_t valuesA_,
+      b_row_view_t rowmapB_, b_nnz_view_t entriesB_, b_scalar_view_t valuesB_,
+      c_row_view_t rowmapC_, c_nnz_view_t entriesC_, c_scalar_view_t valuesC_):
+        num_rows(num_rows_), team_work_size(team_work_size_),
+        rowmapA(rowmapA_), entriesA(entriesA_), valuesA(valuesA_),
+        rowmapB(rowmapB_), entriesB(entriesB_), valuesB(valuesB_),
+        rowmapC(rowmapC_), entriesC(entriesC_), valuesC(valuesC_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const team_member_t &teamMember) const {
+    const nnz_lno_t team_row_begin = teamMember.league_rank() * team_work_size;
+    const nnz_lno_t team_row_end = KOKKOSKERNELS_MACRO_MIN(team_row_begin + team_work_size, num_rows);
+
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(teamMember, team_row_begin, team_row_end), [&] (const nnz_lno_t &l) {
+      const size_type b_row_begin = rowmapB(l);
+      const nnz_lno_t b_row_size = rowmapB(l + 1) - b_row_begin;
+      for (size_type jj = rowmapA(l); jj < rowmapA(l + 1); ++jj){
+        const nnz_lno_t i = entriesA(jj);
+        const typename a_scalar_view_t::non_const_value_type a_val = valuesA(jj);
+        const size_type c_row_begin = rowmapC(i);
+        const nnz_lno_t c_row_size = rowmapC(i + 1) - c_row_begin;
+        Kokkos::parallel_for(Kokkos::ThreadVectorRange(teamMember, b_row_size), [&] (const nnz_lno_t k) {
+          const nnz_lno_t pos = KokkosSparse::findRelOffset<nnz_lno_t>(
+              entriesC.data() + c_row_begin, c_row_size, nnz_lno_t(entriesB(b_row_begin + k)), 0, true);
+          Kokkos::atomic_add(&valuesC(c_row_begin + pos), a_val * valuesB(b_row_begin + k));
+        });
+      }
+    });
+  }
+};
+
+/**
+ * \brief Numeric kernel of C = A^T*B^T, one stored row j of B per thread.
+ */
+template <typename MyExecSpace,
+          typename a_row_view_t, typename a_nnz_view_t, typename a_scalar_view_t,
+          typename b_row_view_t, typename b_nnz_view_t, typename b_scalar_view_t,
+          typename c_row_view_t, typename c_nnz_view_t, typename c_scalar_view_t>
+struct SpgemmTransposeABNumericFunctor{
+  typedef typename a_nnz_view_t::non_const_value_type nnz_lno_t;
+  typedef typename a_row_view_t::non_const_value_type size_type;
+  typedef typename Kokkos::TeamPolicy<MyExecSpace>::member_type team_member_t;
+
+  nnz_lno_t num_rows, team_work_size;
+  a_row_view_t rowmapA;
+  a_nnz_view_t entriesA;
+  a_scalar_view_t valuesA;
+  b_row_view_t rowmapB;
+  b_nnz_view_t entriesB;
+  b_scalar_view_t valuesB;
+  c_row_view_t rowmapC;
+  c_nnz_view_t entriesC;
+  c_scalar_view_t valuesC;
+
+  SpgemmTransposeABNumericFunctor(
+      nnz_lno_t num_rows_, nnz_lno_t team_work_size_,
+      a_row_view_t rowmapA_, a_nnz_view_t entriesA_, a_scalar_view_t valuesA_,
+      b_row_view_t rowmapB_, b_nnz_view_t entriesB_, b_scalar_view_t valuesB_,
+      c_row_view_t rowmapC_, c_nnz_view_t entriesC_, c_scalar_view_t valuesC_):
+        num_rows(num_rows_), team_work_size(team_work_size_),
+        rowmapA(rowmapA_), entriesA(entriesA_), valuesA(valuesA_),
+        rowmapB(rowmapB_), entriesB(entriesB_), valuesB(valuesB_),
+        rowmapC(rowmapC_), entriesC(entriesC_), valuesC(valuesC_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const team_member_t &teamMember) const {
+    const nnz_lno_t team_row_begin = teamMember.league_rank() * team_work_size;
+    const nnz_lno_t team_row_end = KOKKOSKERNELS_MACRO_MIN(team_row_begin + team_work_size, num_rows);
+
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(teamMember, team_row_begin, team_row_end), [&] (const nnz_lno_t &j) {
+      for (size_type jj = rowmapB(j); jj < rowmapB(j + 1); ++jj){
+        const nnz_lno_t l = entriesB(jj);
+        const typename b_scalar_view_t::non_const_value_type b_val = valuesB(jj);
+        const size_type a_row_begin = rowmapA(l);
+        Kokkos::parallel_for(Kokkos::ThreadVectorRange(teamMember, nnz_lno_t(rowmapA(l + 1) - a_row_begin)),
+            [&] (const nnz_lno_t k) {
+          const nnz_lno_t i = entriesA(a_row_begin + k);
+          const size_type c_row_begin = rowmapC(i);
+          const nnz_lno_t pos = KokkosSparse::findRelOffset<nnz_lno_t>(
+              entriesC.data() + c_row_begin, nnz_lno_t(rowmapC(i + 1) - c_row_begin), j, 0, true);
+          Kokkos::atomic_add(&valuesC(c_row_begin + pos), valuesA(a_row_begin + k) * b_val);
+        });
+      }
+    });
+  }
+};
+
+/**
+ * \brief Numeric kernel of C = A*B^T, one row i of C per thread. Each
+ * entry of the row is the dot product of row i of A and a row of B; the
+ * columns of B are searched in row i of A, by binary search when that row
+ * is sorted.
+ */
+template <typename MyExecSpace,
+          typename a_row_view_t, typename a_nnz_view_t, typename a_scalar_view_t,
+          typename b_row_view_t, typename b_nnz_view_t, typename b_scalar_view_t,
+          typename c_row_view_t, typename c_nnz_view_t, typename c_scalar_view_t>
+struct SpgemmTransposeBNumericFunctor{
+  typedef typename a_nnz_view_t::non_const_value_type nnz_lno_t;
+  typedef typename a_row_view_t::non_const_value_type size_type;
+  typedef typename c_scalar_view_t::non_const_value_type scalar_t;
+  typedef typename Kokkos::TeamPolicy<MyExecSpace>::member_type team_member_t;
+
+  nnz_lno_t num_rows, team_work_size;
+  a_row_view_t rowmapA;
+  a_nnz_view_t entriesA;
+  a_scalar_view_t valuesA;
+  b_row_view_t rowmapB;
+  b_nnz_view_t entriesB;
+  b_scalar_view_t valuesB;
+  c_row_view_t rowmapC;
+  c_nnz_view_t entriesC;
+  c_scalar_view_t valuesC;
+
+  SpgemmTransposeBNumericFunctor(
+      nnz_lno_t num_rows_, nnz_lno_t team_work_size_,
+      a_row_view_t rowmapA_, a_nnz_view_t entriesA_, a_scalar_view_t valuesA_,
+      b_row_view_t rowmapB_, b_nnz_view_t entriesB_, b_scalar_view_t valuesB_,
+      c_row_view_t rowmapC_, c_nnz_view_t entriesC_, c_scalar_view_t valuesC_):
+        num_rows(num_rows_), team_work_size(team_work_size_),
+        rowmapA(rowmapA_), entriesA(entriesA_), valuesA(valuesA_),
+        rowmapB(rowmapB_), entriesB(entriesB_), valuesB(valuesB_),
+        rowmapC(rowmapC_), entriesC(entriesC_), valuesC(valuesC_){}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const team_member_t &teamMember) const {
+    const nnz_lno_t team_row_begin = teamMember.league_rank() * team_work_size;
+    const nnz_lno_t team_row_end = KOKKOSKERNELS_MACRO_MIN(team_row_begin + team_work_size, num_rows);
+
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(teamMember, team_row_begin, team_row_end), [&] (const nnz_lno_t &i) {
+      const size_type a_row_begin = rowmapA(i);
+      const nnz_lno_t a_row_size = rowmapA(i + 1) - a_row_begin;
+      bool a_sorted = true;
+      for (nnz_lno_t k = 1; k < a_row_size && a_sorted; ++k){
+        a_sorted = entriesA(a_row_begin + k - 1) < entriesA(a_row_begin + k);
+      }
+      const size_type c_row_begin = rowmapC(i);
+      Kokkos::parallel_for(Kokkos::ThreadVectorRange(teamMember, nnz_lno_t(rowmapC(i + 1) - c_row_begin)),
+          [&] (const nnz_lno_t k) {
+        const nnz_lno_t j = entriesC(c_row_begin + k);
+        scalar_t sum = scalar_t();
+        for (size_type jj = rowmapB(j); jj < rowmapB(j + 1); ++jj){
+          const nnz_lno_t pos = KokkosSparse::findRelOffset<nnz_lno_t>(
+              entriesA.data() + a_row_begin, a_row_size, nnz_lno_t(entriesB(jj)), 0, a_sorted);
+          if (pos < a_row_size){
+            sum += valuesA(a_row_begin + pos) * valuesB(jj);
+          }
+        }
+        valuesC(c_row_begin + k) = sum;
+      });
+    });
+  }
+};
+
+/**
+ * \brief Symbolic phase of C = op(A)*op(B) with a transposed operand:
+ * fills rowmapC, then keeps the sorted entries of C on the handle together
+ * with their number. The graph of each transposed operand is transposed
+ * for this call only.
+ */
+template <typename spgemm_handle_t,
+          typename a_row_view_t, typename a_nnz_view_t,
+          typename b_row_view_t, typename b_nnz_view_t,
+          typename c_row_view_t>
+void spgemm_transposed_symbolic(
+    spgemm_handle_t *sh,
+    typename spgemm_handle_t::nnz_lno_t m,
+    typename spgemm_handle_t::nnz_lno_t n,
+    typename spgemm_handle_t::nnz_lno_t k,
+    a_row_view_t rowmapA, a_nnz_view_t entriesA, bool transposeA,
+    b_row_view_t rowmapB, b_nnz_view_t entriesB, bool transposeB,
+    c_row_view_t rowmapC){
+
+  typedef typename spgemm_handle_t::HandleExecSpace MyExecSpace;
+  typedef typename spgemm_handle_t::HandleTempMemorySpace MyTempMemorySpace;
+  typedef typename spgemm_handle_t::row_lno_temp_work_view_t row_view_t;
+  typedef typename spgemm_handle_t::nnz_lno_temp_work_view_t nnz_view_t;
+  typedef typename spgemm_handle_t::scalar_temp_work_view_t scalar_view_t;
+  typedef typename spgemm_handle_t::size_type size_type;
+  const char *label = "KokkosSparse::spgemm_transposed::Symbolic";
+
+  //only the structure is hashed, the values are never read.
+  row_view_t t_xadj;
+  nnz_view_t t_adj;
+  nnz_view_t entriesC("transposed product entries", 0);
+  size_type c_nnz = 0;
+  if (transposeA && !transposeB){
+    t_xadj = row_view_t("transpose A rowmap", m + 1);
+    t_adj = nnz_view_t(Kokkos::ViewAllocateWithoutInitializing("transpose A entries"), entriesA.extent(0));
+    KokkosKernels::Impl::transpose_graph<a_row_view_t, a_nnz_view_t, row_view_t, nnz_view_t, row_view_t, MyExecSpace>(
+        n, m, rowmapA, entriesA, t_xadj, t_adj);
+  }
+  else if (!transposeA){
+    t_xadj = row_view_t("transpose B rowmap", n + 1);
+    t_adj = nnz_view_t(Kokkos::ViewAllocateWithoutInitializing("transpose B entries"), entriesB.extent(0));
+    KokkosKernels::Impl::transpose_graph<b_row_view_t, b_nnz_view_t, row_view_t, nnz_view_t, row_view_t, MyExecSpace>(
+        k, n, rowmapB, entriesB, t_xadj, t_adj);
+  }
+
+  if (transposeA && transposeB){
+    //C = (B*A)^T: the structure of B*A, transposed and sorted.
+    typedef SpgemmProductRowTerms<b_row_view_t, b_nnz_view_t, scalar_view_t,
+                                  a_row_view_t, a_nnz_view_t, scalar_view_t> terms_t;
+    row_view_t ba_rowmap("transposed product B*A rowmap", k + 1);
+    nnz_view_t ba_entries("transposed product B*A entries", 0);
+    c_nnz = spgemm_rowwise_symbolic<MyExecSpace, MyTempMemorySpace>(
+        label, terms_t(rowmapB, entriesB, scalar_view_t(), rowmapA, entriesA, scalar_view_t(), m),
+        k, ba_rowmap, ba_entries);
+    Kokkos::deep_copy(rowmapC, size_type(0));
+    Kokkos::realloc(entriesC, c_nnz);
+    KokkosKernels::Impl::transpose_graph<row_view_t, nnz_view_t, c_row_view_t, nnz_view_t, row_view_t, MyExecSpace>(
+        k, m, ba_rowmap, ba_entries, rowmapC, entriesC);
+    KokkosKernels::Impl::sort_crs_graph<MyExecSpace>(rowmapC, entriesC);
+    MyExecSpace().fence();
+  }
+  else if (transposeA){
+    typedef SpgemmProductRowTerms<row_view_t, nnz_view_t, scalar_view_t,
+                                  b_row_view_t, b_nnz_view_t, scalar_view_t> terms_t;
+    c_nnz = spgemm_rowwise_symbolic<MyExecSpace, MyTempMemorySpace>(
+        label, terms_t(t_xadj, t_adj, scalar_view_t(), rowmapB, entriesB, scalar_view_t(), k),
+        m, rowmapC, entriesC);
+  }
+  else {
+    typedef SpgemmProductRowTerms<a_row_view_t, a_nnz_view_t, scalar_view_t,
+                                  row_view_t, nnz_view_t, scalar_view_t> terms_t;
+    c_nnz = spgemm_rowwise_symbolic<MyExecSpace, MyTempMemorySpace>(
+        label, terms_t(rowmapA, entriesA, scalar_view_t(), t_xadj, t_adj, scalar_view_t(), k),
+        m, rowmapC, entriesC);
+  }
+
+  sh->set_transposed_product(entriesC);
+  sh->set_c_nnz(c_nnz);
+  sh->set_call_symbolic();
+}
+
+/**
+ * \brief Numeric phase of C = op(A)*op(B) with a transposed operand:
+ * copies the entries kept by spgemm_transposed_symbolic into entriesC and
+ * computes the values, reading A and B as they are stored.
+ */
+template <typename spgemm_handle_t,
+          typename a_row_view_t, typename a_nnz_view_t, typename a_scalar_view_t,
+          typename b_row_view_t, typename b_nnz_view_t, typename b_scalar_view_t,
+          typename c_row_view_t, typename c_nnz_view_t, typename c_scalar_view_t>
+void spgemm_transposed_numeric(
+    spgemm_handle_t *sh,
+    typename spgemm_handle_t::nnz_lno_t m,
+    a_row_view_t rowmapA, a_nnz_view_t entriesA, a_scalar_view_t valuesA, bool transposeA,
+    b_row_view_t rowmapB, b_nnz_view_t entriesB, b_scalar_view_t valuesB, bool transposeB,
+    c_row_view_t rowmapC, c_nnz_view_t entriesC, c_scalar_view_t valuesC){
+
+  typedef typename spgemm_handle_t::HandleExecSpace MyExecSpace;
+  typedef typename spgemm_handle_t::nnz_lno_t nnz_lno_t;
+  typedef typename c_scalar_view_t::non_const_value_type scalar_t;
+
+  if (!sh->is_transposed_product()){
+    throw std::runtime_error("KokkosSparse::spgemm_numeric: transposed operands need "
+                             "spgemm_symbolic to be called with the same transpose flags.");
+  }
+  const size_t c_nnz = sh->get_c_nnz();
+  if (entriesC.extent(0) < c_nnz || valuesC.extent(0) < c_nnz){
+    throw std::runtime_error("KokkosSparse::spgemm_numeric: entriesC and valuesC need "
+                             "room for the number of entries of the symbolic phase.");
+  }
+  Kokkos::deep_copy(Kokkos::subview(entriesC, Kokkos::make_pair(size_t(0), c_nnz)),
+                    sh->get_transposed_c_entries());
+
+  const nnz_lno_t a_rows = rowmapA.extent(0) ? rowmapA.extent(0) - 1 : 0;
+  const nnz_lno_t b_rows = rowmapB.extent(0) ? rowmapB.extent(0) - 1 : 0;
+
+  if (transposeA && transposeB){
+    typedef SpgemmTransposeABNumericFunctor<MyExecSpace,
+        a_row_view_t, a_nnz_view_t, a_scalar_view_t, b_row_view_t, b_nnz_view_t, b_scalar_view_t,
+        c_row_view_t, c_nnz_view_t, c_scalar_view_t> functor_t;
+    Kokkos::deep_copy(Kokkos::subview(valuesC, Kokkos::make_pair(size_t(0), c_nnz)), scalar_t());
+    const SpgemmRowwiseLaunch<MyExecSpace> launch(a_rows, entriesA.extent(0));
+    Kokkos::parallel_for("KokkosSparse::spgemm_transposed::NumericAB", launch.policy(b_rows),
+        functor_t(b_rows, launch.team_work_size, rowmapA, entriesA, valuesA, rowmapB, entriesB, valuesB,
+                  rowmapC, entriesC, valuesC));
+  }
+  else if (transposeA){
+    typedef SpgemmTransposeANumericFunctor<MyExecSpace,
+        a_row_view_t, a_nnz_view_t, a_scalar_view_t, b_row_view_t, b_nnz_view_t, b_scalar_view_t,
+        c_row_view_t, c_nnz_view_t, c_scalar_view_t> functor_t;
+    Kokkos::deep_copy(Kokkos::subview(valuesC, Kokkos::make_pair(size_t(0), c_nnz)), scalar_t());
+    const SpgemmRowwiseLaunch<MyExecSpace> launch(b_rows, entriesB.extent(0));
+    Kokkos::parallel_for("KokkosSparse::spgemm_transposed::NumericA", launch.policy(a_rows),
+        functor_t(a_rows, launch.team_work_size, rowmapA, entriesA, valuesA, rowmapB, entriesB, valuesB,
+                  rowmapC, entriesC, valuesC));
+  }
+  else {
+    typedef SpgemmTransposeBNumericFunctor<MyExecSpace,
+        a_row_view_t, a_nnz_view_t, a_scalar_view_t, b_row_view_t, b_nnz_view_t, b_scalar_view_t,
+        c_row_view_t, c_nnz_view_t, c_scalar_view_t> functor_t;
+    const SpgemmRowwiseLaunch<MyExecSpace> launch(m, c_nnz);
+    Kokkos::parallel_for("KokkosSparse::spgemm_transposed::NumericB", launch.policy(m),
+        functor_t(m, launch.team_work_size, rowmapA, entriesA, valuesA, rowmapB, entriesB, valuesB,
+                  rowmapC, entriesC, valuesC));
+  }
+  MyExecSpace().fence();
+}
+
+}
+}
+
+#endif
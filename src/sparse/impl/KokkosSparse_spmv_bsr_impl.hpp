@@ -0,0 +1,299 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_IMPL_SPMV_BSR_HPP_
+#define KOKKOSSPARSE_IMPL_SPMV_BSR_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+#include "KokkosSparse_BlockCrsMatrix.hpp"
+#include "KokkosSparse_spmv_impl.hpp"
+#include <sstream>
+
+namespace KokkosSparse {
+namespace Impl {
+
+/// \brief y = beta*y + alpha*A*x for a BlockCrsMatrix A, one block
+///   row per work item.
+///
+/// BlockCrsMatrix stores point row i of a block row contiguously,
+/// with the blockDim() entries of each block one after the other.
+/// With BlockSize > 0 (which must equal A.blockDim()), the block
+/// product is unrolled: the x entries of each block and the
+/// BlockSize sums stay in registers.  BlockSize = 0 handles any
+/// block size with runtime loop bounds.
+///
+/// XVector and YVector are rank 1 (numVecs = 1) or rank 2; for rank
+/// 2 each block row is applied to every column of x in turn, while
+/// the block row is in cache.
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int dobeta,
+         bool conjugate,
+         int BlockSize>
+struct BSR_SPMV_Functor {
+  typedef typename AMatrix::execution_space            execution_space;
+  typedef typename AMatrix::non_const_ordinal_type     ordinal_type;
+  typedef typename AMatrix::non_const_size_type        size_type;
+  typedef typename AMatrix::non_const_value_type       value_type;
+  typedef typename YVector::non_const_value_type       y_value_type;
+  typedef Kokkos::Details::ArithTraits<value_type>     ATV;
+
+  const value_type alpha;
+  AMatrix  m_A;
+  XVector m_x;
+  const value_type beta;
+  YVector m_y;
+
+  BSR_SPMV_Functor (const value_type alpha_,
+                    const AMatrix m_A_,
+                    const XVector m_x_,
+                    const value_type beta_,
+                    const YVector m_y_) :
+     alpha (alpha_), m_A (m_A_), m_x (m_x_),
+     beta (beta_), m_y (m_y_)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  ordinal_type num_vectors () const {
+    return XVector::rank == 1 ? 1 : static_cast<ordinal_type> (m_x.extent (XVector::rank - 1));
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  typename XVector::reference_type x (const ordinal_type i, const ordinal_type v) const {
+    return m_x.access (i, v);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  typename YVector::reference_type y (const ordinal_type i, const ordinal_type v) const {
+    return m_y.access (i, v);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void update (const ordinal_type iRow, const ordinal_type v, y_value_type sum) const {
+    sum *= alpha;
+    if (dobeta == 0) {
+      y(iRow, v) = sum;
+    } else {
+      y(iRow, v) = beta * y(iRow, v) + sum;
+    }
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ordinal_type iBlockRow) const
+  {
+    const ordinal_type block_dim = BlockSize > 0 ? BlockSize : m_A.blockDim ();
+    const size_type start = m_A.graph.row_map(iBlockRow);
+    const ordinal_type num_blocks = static_cast<ordinal_type> (m_A.graph.row_map(iBlockRow + 1) - start);
+    const value_type* const block_row = m_A.values.data () + start * block_dim * block_dim;
+    const size_type point_row_stride = static_cast<size_type> (num_blocks) * block_dim;
+    const ordinal_type first_row = iBlockRow * block_dim;
+    const ordinal_type nv = num_vectors ();
+
+    for (ordinal_type v = 0; v < nv; ++v) {
+      if (BlockSize > 0) {
+        y_value_type sum[BlockSize > 0 ? BlockSize : 1];
+        for (int i = 0; i < BlockSize; ++i) {
+          sum[i] = 0;
+        }
+        for (ordinal_type K = 0; K < num_blocks; ++K) {
+          const ordinal_type first_col = m_A.graph.entries(start + K) * BlockSize;
+          y_value_type x_block[BlockSize > 0 ? BlockSize : 1];
+          for (int j = 0; j < BlockSize; ++j) {
+            x_block[j] = x(first_col + j, v);
+          }
+          const value_type* const block = block_row + K * BlockSize;
+          for (int i = 0; i < BlockSize; ++i) {
+            for (int j = 0; j < BlockSize; ++j) {
+              const value_type val = conjugate ?
+                ATV::conj (block[i * point_row_stride + j]) :
+                block[i * point_row_stride + j];
+              sum[i] += val * x_block[j];
+            }
+          }
+        }
+        for (int i = 0; i < BlockSize; ++i) {
+          update (first_row + i, v, sum[i]);
+        }
+      }
+      else {
+        for (ordinal_type i = 0; i < block_dim; ++i) {
+          const value_type* const point_row = block_row + i * point_row_stride;
+          y_value_type sum = 0;
+          for (ordinal_type K = 0; K < num_blocks; ++K) {
+            const ordinal_type first_col = m_A.graph.entries(start + K) * block_dim;
+            for (ordinal_type j = 0; j < block_dim; ++j) {
+              const value_type val = conjugate ?
+                ATV::conj (point_row[K * block_dim + j]) :
+                point_row[K * block_dim + j];
+              sum += val * x(first_col + j, v);
+            }
+          }
+          update (first_row + i, v, sum);
+        }
+      }
+    }
+  }
+};
+
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int dobeta,
+         bool conjugate,
+         int BlockSize>
+void
+spmv_bsr_launch (typename YVector::const_value_type& alpha,
+                 const AMatrix& A,
+                 const XVector& x,
+                 typename YVector::const_value_type& beta,
+                 const YVector& y)
+{
+  typedef typename AMatrix::execution_space execution_space;
+  typedef BSR_SPMV_Functor<AMatrix, XVector, YVector, dobeta, conjugate, BlockSize> functor_type;
+
+  if (A.nnz () > 10000000) {
+    Kokkos::parallel_for ("KokkosSparse::spmv<NoTranspose,BlockCrs,Dynamic>",
+                          Kokkos::RangePolicy<execution_space, Kokkos::Schedule<Kokkos::Dynamic> > (0, A.numRows ()),
+                          functor_type (alpha, A, x, beta, y));
+  } else {
+    Kokkos::parallel_for ("KokkosSparse::spmv<NoTranspose,BlockCrs,Static>",
+                          Kokkos::RangePolicy<execution_space, Kokkos::Schedule<Kokkos::Static> > (0, A.numRows ()),
+                          functor_type (alpha, A, x, beta, y));
+  }
+}
+
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int dobeta,
+         bool conjugate>
+void
+spmv_bsr_no_transpose (typename YVector::const_value_type& alpha,
+                       const AMatrix& A,
+                       const XVector& x,
+                       typename YVector::const_value_type& beta,
+                       const YVector& y)
+{
+  if (A.numRows () <= 0) {
+    return;
+  }
+
+  switch (A.blockDim ()) {
+  case 2:
+    spmv_bsr_launch<AMatrix, XVector, YVector, dobeta, conjugate, 2> (alpha, A, x, beta, y);
+    return;
+  case 3:
+    spmv_bsr_launch<AMatrix, XVector, YVector, dobeta, conjugate, 3> (alpha, A, x, beta, y);
+    return;
+  case 4:
+    spmv_bsr_launch<AMatrix, XVector, YVector, dobeta, conjugate, 4> (alpha, A, x, beta, y);
+    return;
+  case 5:
+    spmv_bsr_launch<AMatrix, XVector, YVector, dobeta, conjugate, 5> (alpha, A, x, beta, y);
+    return;
+  case 6:
+    spmv_bsr_launch<AMatrix, XVector, YVector, dobeta, conjugate, 6> (alpha, A, x, beta, y);
+    return;
+  case 7:
+    spmv_bsr_launch<AMatrix, XVector, YVector, dobeta, conjugate, 7> (alpha, A, x, beta, y);
+    return;
+  case 8:
+    spmv_bsr_launch<AMatrix, XVector, YVector, dobeta, conjugate, 8> (alpha, A, x, beta, y);
+    return;
+  default:
+    spmv_bsr_launch<AMatrix, XVector, YVector, dobeta, conjugate, 0> (alpha, A, x, beta, y);
+    return;
+  }
+}
+
+/// \brief y = beta*y + alpha*Op(A)*x for a BlockCrsMatrix A, where x
+///   and y are both rank 1 or both rank 2.
+template<class AMatrix,
+         class XVector,
+         class YVector>
+void
+spmv_bsr (const char mode[],
+          typename YVector::const_value_type& alpha,
+          const AMatrix& A,
+          const XVector& x,
+          typename YVector::const_value_type& beta,
+          const YVector& y)
+{
+  typedef Kokkos::Details::ArithTraits<typename YVector::non_const_value_type> KAT;
+
+  const bool conjugate = (mode[0] == 'C' || mode[0] == 'c');
+  if (mode[0] != 'N' && mode[0] != 'n' && !conjugate) {
+    std::ostringstream os;
+    os << "KokkosSparse::spmv: BlockCrsMatrix only supports modes "
+       << "\"N\" and \"C\", but mode = \"" << mode << "\".";
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+
+  if (alpha == KAT::zero ()) {
+    if (beta != KAT::one ()) {
+      KokkosBlas::scal (y, beta, y);
+    }
+    return;
+  }
+
+  if (beta == KAT::zero ()) {
+    if (conjugate)
+      spmv_bsr_no_transpose<AMatrix, XVector, YVector, 0, true> (alpha, A, x, beta, y);
+    else
+      spmv_bsr_no_transpose<AMatrix, XVector, YVector, 0, false> (alpha, A, x, beta, y);
+  }
+  else {
+    if (conjugate)
+      spmv_bsr_no_transpose<AMatrix, XVector, YVector, 2, true> (alpha, A, x, beta, y);
+    else
+      spmv_bsr_no_transpose<AMatrix, XVector, YVector, 2, false> (alpha, A, x, beta, y);
+  }
+}
+
+} // namespace Impl
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_IMPL_SPMV_BSR_HPP_
@@ -0,0 +1,118 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_IMPL_SPMV_COLORING_HPP_
+#define KOKKOSSPARSE_IMPL_SPMV_COLORING_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "KokkosKernels_Handle.hpp"
+#include "KokkosGraph_Distance2Color.hpp"
+#include <vector>
+
+namespace KokkosSparse {
+namespace Impl {
+
+/// \brief Group the rows of a graph into colors such that no two rows
+///   of a color share a column.
+///
+/// Kernels that scatter row i into the entries of an output vector
+/// given by the columns of row i (transpose or symmetric SpMV) can then
+/// process one color at a time without atomic updates.
+///
+/// \param color_rows [out] Device view of length num_rows: the rows,
+///   grouped by color.
+/// \param color_offsets [out] Host view of length num_colors + 1: the
+///   rows of color c are color_rows(color_offsets(c) : color_offsets(c+1)).
+template<class ExecutionSpace, class RowMapType, class EntriesType,
+         class ColorRowsType, class ColorOffsetsType>
+void
+spmv_scatter_coloring (const typename EntriesType::non_const_value_type num_rows,
+                       const typename EntriesType::non_const_value_type num_cols,
+                       const RowMapType& row_map,
+                       const EntriesType& entries,
+                       ColorRowsType& color_rows,
+                       ColorOffsetsType& color_offsets)
+{
+  typedef typename RowMapType::non_const_value_type size_type;
+  typedef typename EntriesType::non_const_value_type ordinal_type;
+  typedef typename ColorOffsetsType::non_const_value_type offset_type;
+  typedef typename EntriesType::memory_space memory_space;
+  typedef KokkosKernels::Experimental::KokkosKernelsHandle
+    <size_type, ordinal_type, double, ExecutionSpace, memory_space, memory_space> handle_type;
+
+  color_rows = ColorRowsType ("KokkosSparse::spmv::color_rows", num_rows);
+  if (num_rows == 0) {
+    color_offsets = ColorOffsetsType ("KokkosSparse::spmv::color_offsets", 1);
+    return;
+  }
+
+  handle_type kh;
+  kh.create_distance2_graph_coloring_handle ();
+  KokkosGraph::Experimental::bipartite_color_rows (&kh, num_rows, num_cols, row_map, entries, false);
+  auto colors = Kokkos::create_mirror_view_and_copy
+    (Kokkos::HostSpace (), kh.get_distance2_graph_coloring_handle ()->get_vertex_colors ());
+  const ordinal_type num_colors =
+    static_cast<ordinal_type> (kh.get_distance2_graph_coloring_handle ()->get_num_colors ());
+  kh.destroy_distance2_graph_coloring_handle ();
+
+  // Counting sort of the rows by color (colors are 1-based).
+  color_offsets = ColorOffsetsType ("KokkosSparse::spmv::color_offsets", num_colors + 1);
+  for (ordinal_type i = 0; i < num_rows; ++i) {
+    ++color_offsets(colors(i));
+  }
+  for (ordinal_type c = 0; c < num_colors; ++c) {
+    color_offsets(c + 1) += color_offsets(c);
+  }
+  auto h_color_rows = Kokkos::create_mirror_view (color_rows);
+  std::vector<offset_type> next (color_offsets.data (), color_offsets.data () + num_colors);
+  for (ordinal_type i = 0; i < num_rows; ++i) {
+    h_color_rows(next[colors(i) - 1]++) = i;
+  }
+  Kokkos::deep_copy (color_rows, h_color_rows);
+}
+
+} // namespace Impl
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_IMPL_SPMV_COLORING_HPP_
@@ -0,0 +1,144 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_IMPL_SPMV_COMPRESSED_HPP_
+#define KOKKOSSPARSE_IMPL_SPMV_COMPRESSED_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+#include "KokkosSparse_CompressedCrsMatrix.hpp"
+#include "KokkosSparse_spmv_impl.hpp"
+#include <sstream>
+
+namespace KokkosSparse {
+namespace Impl {
+
+/// \brief SpMV, y = beta*y + alpha*A*x, for a CompressedCrsMatrix.
+///
+/// Reuses SPMV_Functor: the row view of CompressedCrsMatrix widens
+/// each stored value to AMatrix::value_type and rebuilds the column
+/// index from the row base, so products are formed and accumulated
+/// in full precision while only the compressed data is streamed.
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int dobeta,
+         bool conjugate>
+void
+spmv_compressed_no_transpose (typename YVector::const_value_type& alpha,
+                              const AMatrix& A,
+                              const XVector& x,
+                              typename YVector::const_value_type& beta,
+                              const YVector& y)
+{
+  typedef typename AMatrix::execution_space execution_space;
+  typedef Kokkos::TeamPolicy<execution_space, Kokkos::Schedule<Kokkos::Static> > policy_type;
+
+  if (A.numRows () <= 0) {
+    return;
+  }
+
+  int team_size = -1;
+  int vector_length = -1;
+  int64_t rows_per_thread = -1;
+  const int64_t rows_per_team =
+    spmv_launch_parameters<execution_space> (A.numRows (), A.nnz (), rows_per_thread, team_size, vector_length);
+  const int64_t worksets = (y.extent (0) + rows_per_team - 1) / rows_per_team;
+
+  SPMV_Functor<AMatrix, XVector, YVector, dobeta, conjugate> func (alpha, A, x, beta, y, rows_per_team);
+
+  policy_type policy (1, 1);
+  if (team_size < 0)
+    policy = policy_type (worksets, Kokkos::AUTO, vector_length);
+  else
+    policy = policy_type (worksets, team_size, vector_length);
+  Kokkos::parallel_for ("KokkosSparse::spmv<NoTranspose,Compressed>", policy, func);
+}
+
+template<class AMatrix,
+         class XVector,
+         class YVector>
+void
+spmv_compressed (const char mode[],
+                 typename YVector::const_value_type& alpha,
+                 const AMatrix& A,
+                 const XVector& x,
+                 typename YVector::const_value_type& beta,
+                 const YVector& y)
+{
+  typedef Kokkos::Details::ArithTraits<typename YVector::non_const_value_type> KAT;
+
+  const bool conjugate = (mode[0] == 'C' || mode[0] == 'c');
+  if (mode[0] != 'N' && mode[0] != 'n' && !conjugate) {
+    std::ostringstream os;
+    os << "KokkosSparse::spmv: CompressedCrsMatrix only supports modes "
+       << "\"N\" and \"C\", but mode = \"" << mode << "\".";
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+
+  if (alpha == KAT::zero ()) {
+    if (beta != KAT::one ()) {
+      KokkosBlas::scal (y, beta, y);
+    }
+    return;
+  }
+
+  if (beta == KAT::zero ()) {
+    if (conjugate)
+      spmv_compressed_no_transpose<AMatrix, XVector, YVector, 0, true> (alpha, A, x, beta, y);
+    else
+      spmv_compressed_no_transpose<AMatrix, XVector, YVector, 0, false> (alpha, A, x, beta, y);
+  }
+  else {
+    if (conjugate)
+      spmv_compressed_no_transpose<AMatrix, XVector, YVector, 2, true> (alpha, A, x, beta, y);
+    else
+      spmv_compressed_no_transpose<AMatrix, XVector, YVector, 2, false> (alpha, A, x, beta, y);
+  }
+}
+
+} // namespace Impl
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_IMPL_SPMV_COMPRESSED_HPP_
@@ -0,0 +1,463 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_IMPL_SPMV_FUSED_HPP_
+#define KOKKOSSPARSE_IMPL_SPMV_FUSED_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+#include "KokkosSparse_spmv_impl.hpp"
+#include <sstream>
+#include <type_traits>
+
+namespace KokkosSparse {
+namespace Impl {
+
+/// \brief Reduction carried along with a fused SpMV.
+///
+/// With do_nrm2 = false, accumulates the dot product conj(x_i)*y_i;
+/// with do_nrm2 = true, accumulates |y_i|^2 and takes the square
+/// root at the end.  y_i is the updated entry of y.
+template<class ScalarType, bool do_nrm2>
+struct SPMV_Fused_Reduction {
+  typedef Kokkos::Details::ArithTraits<ScalarType> AT;
+  typedef typename std::conditional<do_nrm2, typename AT::mag_type, ScalarType>::type value_type;
+
+  KOKKOS_INLINE_FUNCTION
+  static value_type contribution (const ScalarType& x_i, const ScalarType& y_i) {
+    return contribution (x_i, y_i, std::integral_constant<bool, do_nrm2> ());
+  }
+
+  static value_type finalize (const value_type& sum) {
+    return finalize (sum, std::integral_constant<bool, do_nrm2> ());
+  }
+
+private:
+  KOKKOS_INLINE_FUNCTION
+  static value_type contribution (const ScalarType& x_i, const ScalarType& y_i, std::false_type) {
+    return AT::conj (x_i) * y_i;
+  }
+  KOKKOS_INLINE_FUNCTION
+  static value_type contribution (const ScalarType& /* x_i */, const ScalarType& y_i, std::true_type) {
+    const value_type a = AT::abs (y_i);
+    return a * a;
+  }
+  static value_type finalize (const value_type& sum, std::false_type) {
+    return sum;
+  }
+  static value_type finalize (const value_type& sum, std::true_type) {
+    return Kokkos::Details::ArithTraits<value_type>::sqrt (sum);
+  }
+};
+
+/// \brief y = beta*y + alpha*A*x for a CrsMatrix, and reduce over
+///   the new entries of y in the same pass.
+///
+/// Same thread layout as SPMV_Functor.  Each thread adds the
+/// contribution of the rows it owns, and one thread per team adds
+/// the team's sum to the reduction result.
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int dobeta,
+         bool conjugate,
+         bool do_nrm2>
+struct SPMV_Fused_Functor {
+  typedef typename AMatrix::execution_space            execution_space;
+  typedef typename AMatrix::non_const_ordinal_type     ordinal_type;
+  typedef typename AMatrix::non_const_value_type       scalar_type;
+  typedef typename YVector::non_const_value_type       y_value_type;
+  typedef typename Kokkos::TeamPolicy<execution_space> team_policy;
+  typedef typename team_policy::member_type            team_member;
+  typedef Kokkos::Details::ArithTraits<scalar_type>    ATV;
+  typedef SPMV_Fused_Reduction<y_value_type, do_nrm2>  reduction_type;
+  typedef typename reduction_type::value_type          value_type;
+
+  const scalar_type alpha;
+  AMatrix  m_A;
+  XVector m_x;
+  const scalar_type beta;
+  YVector m_y;
+
+  const ordinal_type rows_per_team;
+
+  SPMV_Fused_Functor (const scalar_type alpha_,
+                      const AMatrix m_A_,
+                      const XVector m_x_,
+                      const scalar_type beta_,
+                      const YVector m_y_,
+                      const int rows_per_team_) :
+     alpha (alpha_), m_A (m_A_), m_x (m_x_),
+     beta (beta_), m_y (m_y_),
+     rows_per_team (rows_per_team_)
+  {
+    static_assert (static_cast<int> (XVector::rank) == 1,
+                   "XVector must be a rank 1 View.");
+    static_assert (static_cast<int> (YVector::rank) == 1,
+                   "YVector must be a rank 1 View.");
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const team_member& dev, value_type& update) const
+  {
+    value_type team_sum = value_type ();
+
+    Kokkos::parallel_reduce(Kokkos::TeamThreadRange(dev,0,rows_per_team), [&] (const ordinal_type& loop, value_type& tsum) {
+
+      const ordinal_type iRow = static_cast<ordinal_type> ( dev.league_rank() ) * rows_per_team + loop;
+      if (iRow >= m_A.numRows ()) {
+        return;
+      }
+      const auto row = m_A.rowConst(iRow);
+      const ordinal_type row_length = static_cast<ordinal_type> (row.length);
+      y_value_type sum = 0;
+
+      Kokkos::parallel_reduce(Kokkos::ThreadVectorRange(dev,row_length), [&] (const ordinal_type& iEntry, y_value_type& lsum) {
+        const scalar_type val = conjugate ?
+                ATV::conj (row.value(iEntry)) :
+                row.value(iEntry);
+        lsum += val * m_x(row.colidx(iEntry));
+      },sum);
+
+      value_type contrib = value_type ();
+      Kokkos::single(Kokkos::PerThread(dev), [&] (value_type& c) {
+        sum *= alpha;
+        if (dobeta != 0) {
+          sum += beta * m_y(iRow);
+        }
+        m_y(iRow) = sum;
+        c = reduction_type::contribution (m_x(iRow), sum);
+      }, contrib);
+      tsum += contrib;
+    }, team_sum);
+
+    Kokkos::single(Kokkos::PerTeam(dev), [&] () {
+      update += team_sum;
+    });
+  }
+};
+
+/// \brief Fused SpMV and reduction for a BlockCrsMatrix.
+///
+/// Each thread handles one block row; its vector lanes split the
+/// blockDim() point rows of the block row.
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int dobeta,
+         bool conjugate,
+         bool do_nrm2>
+struct SPMV_Fused_BlockCrs_Functor {
+  typedef typename AMatrix::execution_space            execution_space;
+  typedef typename AMatrix::non_const_ordinal_type     ordinal_type;
+  typedef typename AMatrix::non_const_size_type        size_type;
+  typedef typename AMatrix::non_const_value_type       scalar_type;
+  typedef typename YVector::non_const_value_type       y_value_type;
+  typedef typename Kokkos::TeamPolicy<execution_space> team_policy;
+  typedef typename team_policy::member_type            team_member;
+  typedef Kokkos::Details::ArithTraits<scalar_type>    ATV;
+  typedef SPMV_Fused_Reduction<y_value_type, do_nrm2>  reduction_type;
+  typedef typename reduction_type::value_type          value_type;
+
+  const scalar_type alpha;
+  AMatrix  m_A;
+  XVector m_x;
+  const scalar_type beta;
+  YVector m_y;
+
+  const ordinal_type rows_per_team;
+
+  SPMV_Fused_BlockCrs_Functor (const scalar_type alpha_,
+                               const AMatrix m_A_,
+                               const XVector m_x_,
+                               const scalar_type beta_,
+                               const YVector m_y_,
+                               const int rows_per_team_) :
+     alpha (alpha_), m_A (m_A_), m_x (m_x_),
+     beta (beta_), m_y (m_y_),
+     rows_per_team (rows_per_team_)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const team_member& dev, value_type& update) const
+  {
+    const ordinal_type block_dim = m_A.blockDim ();
+    value_type team_sum = value_type ();
+
+    Kokkos::parallel_reduce(Kokkos::TeamThreadRange(dev,0,rows_per_team), [&] (const ordinal_type& loop, value_type& tsum) {
+
+      const ordinal_type iBlockRow = static_cast<ordinal_type> ( dev.league_rank() ) * rows_per_team + loop;
+      if (iBlockRow >= m_A.numRows ()) {
+        return;
+      }
+      const size_type start = m_A.graph.row_map(iBlockRow);
+      const ordinal_type num_blocks = static_cast<ordinal_type> (m_A.graph.row_map(iBlockRow + 1) - start);
+      // Point row i of the block row is contiguous in values, with
+      // num_blocks*block_dim entries.
+      const size_type values_start = start * block_dim * block_dim;
+      value_type row_sum = value_type ();
+
+      Kokkos::parallel_reduce(Kokkos::ThreadVectorRange(dev,block_dim), [&] (const ordinal_type& i, value_type& vsum) {
+        const size_type row_start = values_start + static_cast<size_type> (i) * num_blocks * block_dim;
+        y_value_type sum = 0;
+        for (ordinal_type K = 0; K < num_blocks; ++K) {
+          const ordinal_type col = m_A.graph.entries(start + K) * block_dim;
+          for (ordinal_type j = 0; j < block_dim; ++j) {
+            const scalar_type val = conjugate ?
+              ATV::conj (m_A.values(row_start + K * block_dim + j)) :
+              m_A.values(row_start + K * block_dim + j);
+            sum += val * m_x(col + j);
+          }
+        }
+        const ordinal_type iRow = iBlockRow * block_dim + i;
+        sum *= alpha;
+        if (dobeta != 0) {
+          sum += beta * m_y(iRow);
+        }
+        m_y(iRow) = sum;
+        vsum += reduction_type::contribution (m_x(iRow), sum);
+      }, row_sum);
+      tsum += row_sum;
+    }, team_sum);
+
+    Kokkos::single(Kokkos::PerTeam(dev), [&] () {
+      update += team_sum;
+    });
+  }
+};
+
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int dobeta,
+         bool conjugate,
+         bool do_nrm2>
+typename SPMV_Fused_Reduction<typename YVector::non_const_value_type, do_nrm2>::value_type
+spmv_fused_no_transpose (typename YVector::const_value_type& alpha,
+                         const AMatrix& A,
+                         const XVector& x,
+                         typename YVector::const_value_type& beta,
+                         const YVector& y)
+{
+  typedef typename AMatrix::execution_space execution_space;
+  typedef SPMV_Fused_Reduction<typename YVector::non_const_value_type, do_nrm2> reduction_type;
+  typedef typename reduction_type::value_type value_type;
+
+  value_type result = value_type ();
+  if (A.numRows () <= 0) {
+    return result;
+  }
+
+  #ifdef KOKKOS_ENABLE_OPENMP
+  if((std::is_same<execution_space,Kokkos::OpenMP>::value) &&
+     (std::is_same<typename std::remove_cv<typename AMatrix::value_type>::type,double>::value) &&
+     (std::is_same<typename XVector::non_const_value_type,double>::value) &&
+     (std::is_same<typename YVector::non_const_value_type,double>::value) &&
+     ((int) A.graph.row_block_offsets.extent(0) == (int) omp_get_max_threads()+1) &&
+     (((uintptr_t)(const void*)(x.data())%64)==0) && (((uintptr_t)(const void*)(y.data())%64)==0)
+     ) {
+    result = spmv_raw_openmp_fused_no_transpose<AMatrix,XVector,YVector,do_nrm2>(alpha,A,x,beta,y);
+    return reduction_type::finalize (result);
+  }
+  #endif
+
+  int team_size = -1;
+  int vector_length = -1;
+  int64_t rows_per_thread = -1;
+  const int64_t rows_per_team =
+    spmv_launch_parameters<execution_space>(A.numRows(),A.nnz(),rows_per_thread,team_size,vector_length);
+  const int64_t worksets = (A.numRows () + rows_per_team - 1) / rows_per_team;
+
+  SPMV_Fused_Functor<AMatrix,XVector,YVector,dobeta,conjugate,do_nrm2> func (alpha,A,x,beta,y,rows_per_team);
+
+  if(A.nnz()>10000000) {
+    typedef Kokkos::TeamPolicy<execution_space, Kokkos::Schedule<Kokkos::Dynamic> > policy_type;
+    policy_type policy (1,1);
+    if(team_size<0)
+      policy = policy_type(worksets,Kokkos::AUTO,vector_length);
+    else
+      policy = policy_type(worksets,team_size,vector_length);
+    Kokkos::parallel_reduce("KokkosSparse::spmv_fused<NoTranspose,Dynamic>",policy,func,result);
+  } else {
+    typedef Kokkos::TeamPolicy<execution_space, Kokkos::Schedule<Kokkos::Static> > policy_type;
+    policy_type policy (1,1);
+    if(team_size<0)
+      policy = policy_type(worksets,Kokkos::AUTO,vector_length);
+    else
+      policy = policy_type(worksets,team_size,vector_length);
+    Kokkos::parallel_reduce("KokkosSparse::spmv_fused<NoTranspose,Static>",policy,func,result);
+  }
+  return reduction_type::finalize (result);
+}
+
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int dobeta,
+         bool conjugate,
+         bool do_nrm2>
+typename SPMV_Fused_Reduction<typename YVector::non_const_value_type, do_nrm2>::value_type
+spmv_block_fused_no_transpose (typename YVector::const_value_type& alpha,
+                               const AMatrix& A,
+                               const XVector& x,
+                               typename YVector::const_value_type& beta,
+                               const YVector& y)
+{
+  typedef typename AMatrix::execution_space execution_space;
+  typedef SPMV_Fused_Reduction<typename YVector::non_const_value_type, do_nrm2> reduction_type;
+  typedef typename reduction_type::value_type value_type;
+
+  value_type result = value_type ();
+  if (A.numRows () <= 0) {
+    return result;
+  }
+
+  #ifdef KOKKOS_ENABLE_OPENMP
+  if((std::is_same<execution_space,Kokkos::OpenMP>::value) &&
+     (std::is_same<typename std::remove_cv<typename AMatrix::value_type>::type,double>::value) &&
+     (std::is_same<typename XVector::non_const_value_type,double>::value) &&
+     (std::is_same<typename YVector::non_const_value_type,double>::value) &&
+     ((int) A.graph.row_block_offsets.extent(0) == (int) omp_get_max_threads()+1) &&
+     (((uintptr_t)(const void*)(x.data())%64)==0) && (((uintptr_t)(const void*)(y.data())%64)==0)
+     ) {
+    result = spmv_block_raw_openmp_fused_no_transpose<AMatrix,XVector,YVector,do_nrm2>(alpha,A,x,beta,y);
+    return reduction_type::finalize (result);
+  }
+  #endif
+
+  const int64_t block_dim = A.blockDim ();
+  int team_size = -1;
+  // One vector lane per point row of a block row.
+  int vector_length = 1;
+  while (vector_length < 32 && vector_length < block_dim)
+    vector_length *= 2;
+  int64_t rows_per_thread = -1;
+  const int64_t rows_per_team =
+    spmv_launch_parameters<execution_space>(A.numRows(),A.nnz()*block_dim*block_dim,rows_per_thread,team_size,vector_length);
+  const int64_t worksets = (A.numRows () + rows_per_team - 1) / rows_per_team;
+
+  SPMV_Fused_BlockCrs_Functor<AMatrix,XVector,YVector,dobeta,conjugate,do_nrm2> func (alpha,A,x,beta,y,rows_per_team);
+
+  typedef Kokkos::TeamPolicy<execution_space, Kokkos::Schedule<Kokkos::Static> > policy_type;
+  policy_type policy (1,1);
+  if(team_size<0)
+    policy = policy_type(worksets,Kokkos::AUTO,vector_length);
+  else
+    policy = policy_type(worksets,team_size,vector_length);
+  Kokkos::parallel_reduce("KokkosSparse::spmv_fused<NoTranspose,BlockCrs>",policy,func,result);
+  return reduction_type::finalize (result);
+}
+
+inline bool
+spmv_fused_check_mode (const char mode[], const char name[])
+{
+  const bool conjugate = (mode[0] == 'C' || mode[0] == 'c');
+  if (mode[0] != 'N' && mode[0] != 'n' && !conjugate) {
+    std::ostringstream os;
+    os << "KokkosSparse::" << name
+       << ": Only modes \"N\" and \"C\" are supported, but mode = \""
+       << mode << "\".";
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+  return conjugate;
+}
+
+/// \brief Computes y = beta*y + alpha*Op(A)*x for a CrsMatrix A and
+///   returns either dot(x, y) or ||y||_2 of the new y.
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         bool do_nrm2>
+typename SPMV_Fused_Reduction<typename YVector::non_const_value_type, do_nrm2>::value_type
+spmv_fused (const char mode[],
+            typename YVector::const_value_type& alpha,
+            const AMatrix& A,
+            const XVector& x,
+            typename YVector::const_value_type& beta,
+            const YVector& y)
+{
+  typedef Kokkos::Details::ArithTraits<typename YVector::non_const_value_type> KAT;
+
+  const bool conjugate = spmv_fused_check_mode (mode, do_nrm2 ? "spmv_axpby_nrm2" : "spmv_dot");
+  if (beta == KAT::zero ()) {
+    return conjugate ?
+      spmv_fused_no_transpose<AMatrix, XVector, YVector, 0, true, do_nrm2> (alpha, A, x, beta, y) :
+      spmv_fused_no_transpose<AMatrix, XVector, YVector, 0, false, do_nrm2> (alpha, A, x, beta, y);
+  }
+  return conjugate ?
+    spmv_fused_no_transpose<AMatrix, XVector, YVector, 2, true, do_nrm2> (alpha, A, x, beta, y) :
+    spmv_fused_no_transpose<AMatrix, XVector, YVector, 2, false, do_nrm2> (alpha, A, x, beta, y);
+}
+
+/// \brief Computes y = beta*y + alpha*Op(A)*x for a BlockCrsMatrix A
+///   and returns either dot(x, y) or ||y||_2 of the new y.
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         bool do_nrm2>
+typename SPMV_Fused_Reduction<typename YVector::non_const_value_type, do_nrm2>::value_type
+spmv_block_fused (const char mode[],
+                  typename YVector::const_value_type& alpha,
+                  const AMatrix& A,
+                  const XVector& x,
+                  typename YVector::const_value_type& beta,
+                  const YVector& y)
+{
+  typedef Kokkos::Details::ArithTraits<typename YVector::non_const_value_type> KAT;
+
+  const bool conjugate = spmv_fused_check_mode (mode, do_nrm2 ? "spmv_axpby_nrm2" : "spmv_dot");
+  if (beta == KAT::zero ()) {
+    return conjugate ?
+      spmv_block_fused_no_transpose<AMatrix, XVector, YVector, 0, true, do_nrm2> (alpha, A, x, beta, y) :
+      spmv_block_fused_no_transpose<AMatrix, XVector, YVector, 0, false, do_nrm2> (alpha, A, x, beta, y);
+  }
+  return conjugate ?
+    spmv_block_fused_no_transpose<AMatrix, XVector, YVector, 2, true, do_nrm2> (alpha, A, x, beta, y) :
+    spmv_block_fused_no_transpose<AMatrix, XVector, YVector, 2, false, do_nrm2> (alpha, A, x, beta, y);
+}
+
+} // namespace Impl
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_IMPL_SPMV_FUSED_HPP_
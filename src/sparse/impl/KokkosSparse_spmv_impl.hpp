@@ -48,7 +48,11 @@
 #include "Kokkos_InnerProductSpaceTraits.hpp"
 #include "KokkosBlas1_scal.hpp"
 #include "KokkosSparse_CrsMatrix.hpp"
+#include "KokkosSparse_spmv_handle.hpp"
 #include "KokkosSparse_spmv_impl_omp.hpp"
+#include "KokkosSparse_spmv_impl_merge.hpp"
+#include "KokkosSparse_spmv_mv_panel_impl.hpp"
+#include "KokkosKernels_Semiring.hpp"
 
 namespace KokkosSparse {
 namespace Impl {
@@ -146,11 +150,14 @@ struct SPMV_Transpose_Functor {
   }
 };
 
+// y(i) = beta*y(i) + alpha*sum_j A(i,j)*x(j), with * and + taken
+// from the Semiring (see KokkosKernels_Semiring.hpp).
 template<class AMatrix,
          class XVector,
          class YVector,
          int dobeta,
-         bool conjugate>
+         bool conjugate,
+         class Semiring = KokkosKernels::Experimental::PlusTimesSemiring<typename YVector::non_const_value_type> >
 struct SPMV_Functor {
   typedef typename AMatrix::execution_space            execution_space;
   typedef typename AMatrix::non_const_ordinal_type     ordinal_type;
@@ -183,37 +190,75 @@ struct SPMV_Functor {
                    "YVector must be a rank 1 View.");
   }
 
+  // The usual arithmetic keeps the plain += reduction.
+  typedef std::integral_constant<bool,
+    std::is_same<Semiring, KokkosKernels::Experimental::PlusTimesSemiring<typename Semiring::value_type> >::value>
+    is_plus_times;
+
   KOKKOS_INLINE_FUNCTION
   void operator() (const team_member& dev) const
   {
-    typedef typename YVector::non_const_value_type y_value_type;
-
     Kokkos::parallel_for(Kokkos::TeamThreadRange(dev,0,rows_per_team), [&] (const ordinal_type& loop) {
 
       const ordinal_type iRow = static_cast<ordinal_type> ( dev.league_rank() ) * rows_per_team + loop;
       if (iRow >= m_A.numRows ()) {
         return;
       }
-      const KokkosSparse::SparseRowViewConst<AMatrix> row = m_A.rowConst(iRow);
-      const ordinal_type row_length = static_cast<ordinal_type> (row.length);
-      y_value_type sum = 0;
+      apply_row (dev, iRow, is_plus_times ());
+    });
+  }
 
-      Kokkos::parallel_reduce(Kokkos::ThreadVectorRange(dev,row_length), [&] (const ordinal_type& iEntry, y_value_type& lsum) {
-        const value_type val = conjugate ?
-                ATV::conj (row.value(iEntry)) :
-                row.value(iEntry);
-        lsum += val * m_x(row.colidx(iEntry));
-      },sum);
+  KOKKOS_INLINE_FUNCTION
+  void apply_row (const team_member& dev, const ordinal_type iRow, std::true_type) const
+  {
+    typedef typename YVector::non_const_value_type y_value_type;
 
-      Kokkos::single(Kokkos::PerThread(dev), [&] () {
-        sum *= alpha;
+    const auto row = m_A.rowConst(iRow);
+    const ordinal_type row_length = static_cast<ordinal_type> (row.length);
+    y_value_type sum = 0;
 
-        if (dobeta == 0) {
-          m_y(iRow) = sum ;
-        } else {
-          m_y(iRow) = beta * m_y(iRow) + sum;
-        }
-      });
+    Kokkos::parallel_reduce(Kokkos::ThreadVectorRange(dev,row_length), [&] (const ordinal_type& iEntry, y_value_type& lsum) {
+      const value_type val = conjugate ?
+              ATV::conj (row.value(iEntry)) :
+              row.value(iEntry);
+      lsum += val * m_x(row.colidx(iEntry));
+    },sum);
+
+    Kokkos::single(Kokkos::PerThread(dev), [&] () {
+      sum *= alpha;
+
+      if (dobeta == 0) {
+        m_y(iRow) = sum ;
+      } else {
+        m_y(iRow) = beta * m_y(iRow) + sum;
+      }
+    });
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void apply_row (const team_member& dev, const ordinal_type iRow, std::false_type) const
+  {
+    typedef typename YVector::non_const_value_type y_value_type;
+
+    const auto row = m_A.rowConst(iRow);
+    const ordinal_type row_length = static_cast<ordinal_type> (row.length);
+    y_value_type sum = Semiring::zero();
+
+    Kokkos::parallel_reduce(Kokkos::ThreadVectorRange(dev,row_length), [&] (const ordinal_type& iEntry, y_value_type& lsum) {
+      const value_type val = conjugate ?
+              ATV::conj (row.value(iEntry)) :
+              row.value(iEntry);
+      lsum = Semiring::add (lsum, Semiring::multiply (val, m_x(row.colidx(iEntry))));
+    }, KokkosKernels::Experimental::SemiringReducer<Semiring, execution_space> (sum));
+
+    Kokkos::single(Kokkos::PerThread(dev), [&] () {
+      sum = Semiring::multiply (sum, alpha);
+
+      if (dobeta == 0) {
+        m_y(iRow) = sum ;
+      } else {
+        m_y(iRow) = Semiring::add (Semiring::multiply (beta, m_y(iRow)), sum);
+      }
     });
   }
 };
@@ -274,7 +319,8 @@ template<class AMatrix,
          int dobeta,
          bool conjugate>
 static void
-spmv_beta_no_transpose (typename YVector::const_value_type& alpha,
+spmv_beta_no_transpose (const SPMVPlan& plan,
+                              typename YVector::const_value_type& alpha,
                               const AMatrix& A,
                               const XVector& x,
                               typename YVector::const_value_type& beta,
@@ -287,6 +333,11 @@ spmv_beta_no_transpose (typename YVector::const_value_type& alpha,
     return;
   }
 
+  if (plan.algo == SPMVAlgorithm::SPMV_MERGE_PATH) {
+    spmv_merge_path_no_transpose<AMatrix,XVector,YVector,dobeta,conjugate>(alpha,A,x,beta,y);
+    return;
+  }
+
   #ifdef KOKKOS_ENABLE_OPENMP
   if((std::is_same<execution_space,Kokkos::OpenMP>::value) &&
      (std::is_same<typename std::remove_cv<typename AMatrix::value_type>::type,double>::value) &&
@@ -299,11 +350,26 @@ spmv_beta_no_transpose (typename YVector::const_value_type& alpha,
     return;
   }
   #endif
+
+  if (plan.algo == SPMVAlgorithm::SPMV_DEFAULT && spmv_merge_path_is_preferred (A)) {
+    spmv_merge_path_no_transpose<AMatrix,XVector,YVector,dobeta,conjugate>(alpha,A,x,beta,y);
+    return;
+  }
+
   int team_size = -1;
   int vector_length = -1;
   int64_t rows_per_thread = -1;
 
-  int64_t rows_per_team = spmv_launch_parameters<execution_space>(A.numRows(),A.nnz(),rows_per_thread,team_size,vector_length);
+  int64_t rows_per_team;
+  if (plan.has_launch_config ()) {
+    // Launch configuration chosen by spmv_symbolic for an SPMVHandle.
+    vector_length = plan.vector_size;
+    team_size = plan.team_size;
+    rows_per_team = (static_cast<int64_t> (A.numRows ()) + plan.num_teams - 1) / plan.num_teams;
+  }
+  else {
+    rows_per_team = spmv_launch_parameters<execution_space>(A.numRows(),A.nnz(),rows_per_thread,team_size,vector_length);
+  }
   int64_t worksets = (y.extent(0)+rows_per_team-1)/rows_per_team;
 
   // std::cout << "worksets=" << worksets
@@ -330,6 +396,48 @@ spmv_beta_no_transpose (typename YVector::const_value_type& alpha,
   }
 }
 
+// y = A*x, or y = y + A*x if accumulate, over a semiring.  Uses the
+// same functor and launch parameters as the team path of
+// spmv_beta_no_transpose, with alpha and beta the semiring one().
+template<class Semiring,
+         class AMatrix,
+         class XVector,
+         class YVector>
+void
+spmv_semiring_no_transpose (const AMatrix& A,
+                            const XVector& x,
+                            const YVector& y,
+                            const bool accumulate)
+{
+  typedef typename AMatrix::ordinal_type ordinal_type;
+  typedef typename AMatrix::execution_space execution_space;
+
+  if (A.numRows () <= static_cast<ordinal_type> (0)) {
+    return;
+  }
+
+  int team_size = -1;
+  int vector_length = -1;
+  int64_t rows_per_thread = -1;
+  const int64_t rows_per_team = spmv_launch_parameters<execution_space>(A.numRows(),A.nnz(),rows_per_thread,team_size,vector_length);
+  const int64_t worksets = (A.numRows()+rows_per_team-1)/rows_per_team;
+
+  Kokkos::TeamPolicy<execution_space, Kokkos::Schedule<Kokkos::Dynamic> > policy(1,1);
+  if(team_size<0)
+    policy = Kokkos::TeamPolicy<execution_space, Kokkos::Schedule<Kokkos::Dynamic> >(worksets,Kokkos::AUTO,vector_length);
+  else
+    policy = Kokkos::TeamPolicy<execution_space, Kokkos::Schedule<Kokkos::Dynamic> >(worksets,team_size,vector_length);
+
+  if (accumulate) {
+    SPMV_Functor<AMatrix,XVector,YVector,1,false,Semiring> func (Semiring::one(),A,x,Semiring::one(),y,rows_per_team);
+    Kokkos::parallel_for("KokkosSparse::spmv_semiring<NoTranspose,Accumulate>",policy,func);
+  }
+  else {
+    SPMV_Functor<AMatrix,XVector,YVector,0,false,Semiring> func (Semiring::one(),A,x,Semiring::one(),y,rows_per_team);
+    Kokkos::parallel_for("KokkosSparse::spmv_semiring<NoTranspose>",policy,func);
+  }
+}
+
 template<class AMatrix,
          class XVector,
          class YVector,
@@ -388,7 +496,8 @@ template<class AMatrix,
          class YVector,
          int dobeta>
 static void
-spmv_beta (const char mode[],
+spmv_beta (const SPMVPlan& plan,
+                 const char mode[],
                  typename YVector::const_value_type& alpha,
                  const AMatrix& A,
                  const XVector& x,
@@ -397,11 +506,11 @@ spmv_beta (const char mode[],
 {
   if (mode[0] == NoTranspose[0]) {
     spmv_beta_no_transpose<AMatrix,XVector,YVector,dobeta,false>
-      (alpha,A,x,beta,y);
+      (plan,alpha,A,x,beta,y);
   }
   else if (mode[0] == Conjugate[0]) {
     spmv_beta_no_transpose<AMatrix,XVector,YVector,dobeta,true>
-      (alpha,A,x,beta,y);
+      (plan,alpha,A,x,beta,y);
   }
   else if (mode[0]==Transpose[0]) {
     spmv_beta_transpose<AMatrix,XVector,YVector,dobeta,false>
@@ -891,7 +1000,8 @@ template<class AMatrix,
          int dobeta,
          bool conjugate>
 static void
-spmv_alpha_beta_mv_no_transpose (const typename YVector::non_const_value_type& alpha,
+spmv_alpha_beta_mv_no_transpose (const SPMVPlan& plan,
+                                 const typename YVector::non_const_value_type& alpha,
                                  const AMatrix& A,
                                  const XVector& x,
                                  const typename YVector::non_const_value_type& beta,
@@ -908,6 +1018,13 @@ spmv_alpha_beta_mv_no_transpose (const typename YVector::non_const_value_type& a
     }
     return;
   }
+  else if (plan.algo == SPMVAlgorithm::SPMV_MERGE_PATH ||
+           (plan.algo == SPMVAlgorithm::SPMV_DEFAULT && spmv_merge_path_is_preferred (A))) {
+    spmv_merge_path_mv_no_transpose<AMatrix, XVector, YVector, doalpha, dobeta, conjugate> (alpha, A, x, beta, y);
+  }
+  else if (plan.algo == SPMVAlgorithm::SPMV_MV_PANEL) {
+    spmv_mv_panel_no_transpose<AMatrix, XVector, YVector, doalpha, dobeta, conjugate> (alpha, A, x, beta, y);
+  }
   else {
     typedef typename AMatrix::size_type size_type;
 
@@ -1067,7 +1184,8 @@ template<class AMatrix,
          int doalpha,
          int dobeta>
 static void
-spmv_alpha_beta_mv (const char mode[],
+spmv_alpha_beta_mv (const SPMVPlan& plan,
+                    const char mode[],
                     const typename YVector::non_const_value_type& alpha,
                     const AMatrix& A,
                     const XVector& x,
@@ -1075,10 +1193,10 @@ spmv_alpha_beta_mv (const char mode[],
                     const YVector& y)
 {
   if (mode[0] == NoTranspose[0]) {
-    spmv_alpha_beta_mv_no_transpose<AMatrix, XVector, YVector, doalpha, dobeta, false> (alpha, A, x, beta, y);
+    spmv_alpha_beta_mv_no_transpose<AMatrix, XVector, YVector, doalpha, dobeta, false> (plan, alpha, A, x, beta, y);
   }
   else if (mode[0] == Conjugate[0]) {
-    spmv_alpha_beta_mv_no_transpose<AMatrix, XVector, YVector, doalpha, dobeta, true> (alpha, A, x, beta, y);
+    spmv_alpha_beta_mv_no_transpose<AMatrix, XVector, YVector, doalpha, dobeta, true> (plan, alpha, A, x, beta, y);
   }
   else if (mode[0] == Transpose[0]) {
     spmv_alpha_beta_mv_transpose<AMatrix, XVector, YVector, doalpha, dobeta, false> (alpha, A, x, beta, y);
@@ -1096,7 +1214,8 @@ template<class AMatrix,
          class YVector,
          int doalpha>
 void
-spmv_alpha_mv (const char mode[],
+spmv_alpha_mv (const SPMVPlan& plan,
+               const char mode[],
                const typename YVector::non_const_value_type& alpha,
                const AMatrix& A,
                const XVector& x,
@@ -1107,16 +1226,16 @@ spmv_alpha_mv (const char mode[],
   typedef Kokkos::Details::ArithTraits<coefficient_type> KAT;
 
   if (beta == KAT::zero ()) {
-    spmv_alpha_beta_mv<AMatrix, XVector, YVector, doalpha, 0> (mode, alpha, A, x, beta, y);
+    spmv_alpha_beta_mv<AMatrix, XVector, YVector, doalpha, 0> (plan, mode, alpha, A, x, beta, y);
   }
   else if (beta == KAT::one ()) {
-    spmv_alpha_beta_mv<AMatrix, XVector, YVector, doalpha, 1> (mode, alpha, A, x, beta, y);
+    spmv_alpha_beta_mv<AMatrix, XVector, YVector, doalpha, 1> (plan, mode, alpha, A, x, beta, y);
   }
   else if (beta == -KAT::one ()) {
-    spmv_alpha_beta_mv<AMatrix, XVector, YVector, doalpha, -1> (mode, alpha, A, x, beta, y);
+    spmv_alpha_beta_mv<AMatrix, XVector, YVector, doalpha, -1> (plan, mode, alpha, A, x, beta, y);
   }
   else {
-    spmv_alpha_beta_mv<AMatrix, XVector, YVector, doalpha, 2> (mode, alpha, A, x, beta, y);
+    spmv_alpha_beta_mv<AMatrix, XVector, YVector, doalpha, 2> (plan, mode, alpha, A, x, beta, y);
   }
 }
 
@@ -0,0 +1,512 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+
+#ifndef KOKKOSSPARSE_IMPL_SPMV_MERGE_HPP_
+#define KOKKOSSPARSE_IMPL_SPMV_MERGE_HPP_
+
+#include <algorithm>
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+#include "KokkosKernels_ExecSpaceUtils.hpp"
+#include "KokkosKernels_Utils.hpp"
+
+namespace KokkosSparse {
+namespace Impl {
+
+/// \brief Find where diagonal \c diagonal of the merge path of a CRS
+///   matrix crosses the list of row ends.
+///
+/// The merge path of a CRS matrix merges the row end offsets
+/// row_map(1), ..., row_map(numRows) with the nonzero indices
+/// 0, ..., nnz-1.  Every point on diagonal d has the form (i, d - i),
+/// where i rows and d - i nonzeros have been consumed.  This returns i.
+template<class RowMapType>
+KOKKOS_INLINE_FUNCTION int64_t
+spmv_merge_path_search (const RowMapType& row_map,
+                        const int64_t numRows,
+                        const int64_t nnz,
+                        const int64_t diagonal)
+{
+  int64_t lo = diagonal > nnz ? diagonal - nnz : 0;
+  int64_t hi = diagonal < numRows ? diagonal : numRows;
+  while (lo < hi) {
+    const int64_t pivot = lo + (hi - lo) / 2;
+    if (static_cast<int64_t> (row_map(pivot + 1)) + pivot + 1 <= diagonal)
+      lo = pivot + 1;
+    else
+      hi = pivot;
+  }
+  return lo;
+}
+
+/// \brief Number of merge path items handled by each work item.
+///
+/// On host execution spaces we give each thread exactly one equal
+/// share of the merge path.  On GPUs every thread gets a short segment.
+template<class execution_space>
+int64_t spmv_merge_path_items_per_part (const int64_t path_length)
+{
+  if (KokkosKernels::Impl::kk_get_exec_space_type<execution_space> () ==
+      KokkosKernels::Impl::Exec_CUDA) {
+    return 128;
+  }
+  const int64_t concurrency = execution_space::concurrency ();
+  const int64_t items = (path_length + concurrency - 1) / concurrency;
+  return items < 1 ? 1 : items;
+}
+
+/// \brief Whether the merge-path kernel should be used for a matrix
+///   with the given shape and longest row.
+///
+/// The native kernels hand whole rows to threads, so a matrix whose
+/// longest row holds a large part of a thread's fair share of the
+/// nonzeros leaves most threads idle.
+template<class execution_space>
+bool spmv_merge_path_is_preferred (const int64_t numRows,
+                                   const int64_t nnz,
+                                   const int64_t max_row_length)
+{
+  if (KokkosKernels::Impl::kk_get_exec_space_type<execution_space> () ==
+      KokkosKernels::Impl::Exec_CUDA) {
+    return false;
+  }
+  const int64_t concurrency = execution_space::concurrency ();
+  if (concurrency < 2 || numRows < concurrency || nnz < 1024 * concurrency) {
+    return false;
+  }
+  const int64_t avg_row_length = (nnz + numRows - 1) / numRows;
+  return (max_row_length > 16 * avg_row_length) &&
+         (8 * concurrency * max_row_length > nnz);
+}
+
+/// \brief Whether SPMV_DEFAULT should use the merge-path kernel for A.
+///
+/// This runs on every SPMV_DEFAULT call, so it does not reduce over
+/// all rows.  Instead it bisects the row offsets for the rows holding
+/// nonzeros 0, s, 2s, ..., with s = nnz / (8*concurrency).  A row that
+/// holds two consecutive samples is at least s long, and every row of
+/// length 2s or more is found this way, at a cost of
+/// O(concurrency * log(numRows)) reads.  Only host execution spaces
+/// get past the first test, so the row offsets are read in place.  An
+/// SPMVHandle uses the exact longest row instead.
+template<class AMatrix>
+bool spmv_merge_path_is_preferred (const AMatrix& A)
+{
+  typedef typename AMatrix::execution_space execution_space;
+  typedef typename AMatrix::row_map_type::memory_space memory_space;
+  typedef typename AMatrix::non_const_size_type size_type;
+
+  const int64_t numRows = A.numRows ();
+  const int64_t nnz = A.nnz ();
+  // Rule out the cases that do not depend on the row lengths first.
+  if (!spmv_merge_path_is_preferred<execution_space> (numRows, nnz, nnz)) {
+    return false;
+  }
+  if (!Kokkos::Impl::SpaceAccessibility<Kokkos::HostSpace, memory_space>::accessible) {
+    return false;
+  }
+
+  const size_type* row_begin = A.graph.row_map.data ();
+  const size_type* row_end = row_begin + numRows + 1;
+  const int64_t num_samples = 8 * execution_space::concurrency ();
+  const int64_t stride = nnz / num_samples;
+
+  int64_t max_row_length = 0;
+  int64_t prev_row = -1;
+  for (int64_t k = 0; k <= num_samples; ++k) {
+    const int64_t offset = k * stride < nnz ? k * stride : nnz - 1;
+    const size_type position = row_begin[0] + static_cast<size_type> (offset);
+    // The last row starting at or before position is the one holding it.
+    const int64_t row = (std::upper_bound (row_begin, row_end, position) - row_begin) - 1;
+    if (row == prev_row) {
+      const int64_t length = static_cast<int64_t> (row_begin[row + 1] - row_begin[row]);
+      max_row_length = length > max_row_length ? length : max_row_length;
+    }
+    prev_row = row;
+  }
+
+  return spmv_merge_path_is_preferred<execution_space>
+    (numRows, nnz, max_row_length);
+}
+
+/// \brief Merge-path SpMV, y = beta*y + alpha*A*x, for single vectors.
+///
+/// Each work item walks an equal-length segment of the merge path.
+/// Rows that end inside the segment are written directly to y.  The
+/// partial sum of the row the segment stops in (if any) is stored in
+/// carry_rows / carry_values and added to y by SPMV_MergePath_FixUp.
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int dobeta,
+         bool conjugate>
+struct SPMV_MergePath_Functor {
+  typedef typename AMatrix::execution_space            execution_space;
+  typedef typename AMatrix::non_const_ordinal_type     ordinal_type;
+  typedef typename AMatrix::non_const_value_type       value_type;
+  typedef typename YVector::non_const_value_type       y_value_type;
+  typedef Kokkos::Details::ArithTraits<value_type>     ATV;
+  typedef Kokkos::View<int64_t*, typename YVector::device_type> carry_row_view_type;
+  typedef Kokkos::View<y_value_type*, typename YVector::device_type> carry_value_view_type;
+
+  const y_value_type alpha;
+  AMatrix m_A;
+  XVector m_x;
+  const y_value_type beta;
+  YVector m_y;
+
+  const int64_t items_per_part;
+  const int64_t path_length;
+  carry_row_view_type carry_rows;
+  carry_value_view_type carry_values;
+
+  SPMV_MergePath_Functor (const y_value_type alpha_,
+                          const AMatrix m_A_,
+                          const XVector m_x_,
+                          const y_value_type beta_,
+                          const YVector m_y_,
+                          const int64_t items_per_part_,
+                          const carry_row_view_type& carry_rows_,
+                          const carry_value_view_type& carry_values_) :
+    alpha (alpha_), m_A (m_A_), m_x (m_x_),
+    beta (beta_), m_y (m_y_),
+    items_per_part (items_per_part_),
+    path_length (static_cast<int64_t> (m_A_.numRows ()) + static_cast<int64_t> (m_A_.nnz ())),
+    carry_rows (carry_rows_), carry_values (carry_values_)
+  {
+    static_assert (static_cast<int> (XVector::rank) == 1,
+                   "XVector must be a rank 1 View.");
+    static_assert (static_cast<int> (YVector::rank) == 1,
+                   "YVector must be a rank 1 View.");
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const int64_t part) const
+  {
+    const int64_t numRows = m_A.numRows ();
+    const int64_t nnz = m_A.nnz ();
+
+    int64_t diag_begin = part * items_per_part;
+    if (diag_begin > path_length) diag_begin = path_length;
+    int64_t diag_end = diag_begin + items_per_part;
+    if (diag_end > path_length) diag_end = path_length;
+
+    int64_t row = spmv_merge_path_search (m_A.graph.row_map, numRows, nnz, diag_begin);
+    const int64_t row_end = spmv_merge_path_search (m_A.graph.row_map, numRows, nnz, diag_end);
+    int64_t k = diag_begin - row;
+    const int64_t k_end = diag_end - row_end;
+
+    // Rows that end inside this segment.
+    for (; row < row_end; ++row) {
+      y_value_type sum = Kokkos::Details::ArithTraits<y_value_type>::zero ();
+      const int64_t row_stop = m_A.graph.row_map(row + 1);
+      for (; k < row_stop; ++k) {
+        const value_type val = conjugate ?
+          ATV::conj (m_A.values(k)) :
+          m_A.values(k);
+        sum += val * m_x(m_A.graph.entries(k));
+      }
+      sum *= alpha;
+      if (dobeta == 0) {
+        m_y(row) = sum;
+      } else {
+        m_y(row) = beta * m_y(row) + sum;
+      }
+    }
+
+    // Partial sum of the row that continues in the next segment.
+    if (k < k_end) {
+      y_value_type sum = Kokkos::Details::ArithTraits<y_value_type>::zero ();
+      for (; k < k_end; ++k) {
+        const value_type val = conjugate ?
+          ATV::conj (m_A.values(k)) :
+          m_A.values(k);
+        sum += val * m_x(m_A.graph.entries(k));
+      }
+      carry_rows(part) = row_end;
+      carry_values(part) = alpha * sum;
+    } else {
+      carry_rows(part) = numRows;
+    }
+  }
+};
+
+template<class YVector, class CarryRowView, class CarryValueView>
+struct SPMV_MergePath_FixUp {
+  YVector m_y;
+  CarryRowView carry_rows;
+  CarryValueView carry_values;
+  const int64_t numRows;
+
+  SPMV_MergePath_FixUp (const YVector& m_y_,
+                        const CarryRowView& carry_rows_,
+                        const CarryValueView& carry_values_,
+                        const int64_t numRows_) :
+    m_y (m_y_), carry_rows (carry_rows_), carry_values (carry_values_),
+    numRows (numRows_)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const int64_t part) const
+  {
+    const int64_t row = carry_rows(part);
+    if (row < numRows) {
+      // Several segments may stop inside the same (long) row.
+      Kokkos::atomic_add (&m_y(row), carry_values(part));
+    }
+  }
+};
+
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int dobeta,
+         bool conjugate>
+static void
+spmv_merge_path_no_transpose (typename YVector::const_value_type& alpha,
+                              const AMatrix& A,
+                              const XVector& x,
+                              typename YVector::const_value_type& beta,
+                              const YVector& y)
+{
+  typedef typename AMatrix::execution_space execution_space;
+  typedef SPMV_MergePath_Functor<AMatrix, XVector, YVector, dobeta, conjugate> functor_type;
+  typedef typename functor_type::carry_row_view_type carry_row_view_type;
+  typedef typename functor_type::carry_value_view_type carry_value_view_type;
+
+  const int64_t path_length = static_cast<int64_t> (A.numRows ()) + static_cast<int64_t> (A.nnz ());
+  const int64_t items_per_part = spmv_merge_path_items_per_part<execution_space> (path_length);
+  const int64_t num_parts = (path_length + items_per_part - 1) / items_per_part;
+
+  carry_row_view_type carry_rows (Kokkos::ViewAllocateWithoutInitializing ("SpMV merge carry rows"), num_parts);
+  carry_value_view_type carry_values (Kokkos::ViewAllocateWithoutInitializing ("SpMV merge carry values"), num_parts);
+
+  functor_type func (alpha, A, x, beta, y, items_per_part, carry_rows, carry_values);
+  Kokkos::parallel_for ("KokkosSparse::spmv<NoTranspose,MergePath>",
+                        Kokkos::RangePolicy<execution_space, Kokkos::Schedule<Kokkos::Static> > (0, num_parts),
+                        func);
+  Kokkos::parallel_for ("KokkosSparse::spmv<NoTranspose,MergePath,FixUp>",
+                        Kokkos::RangePolicy<execution_space> (0, num_parts),
+                        SPMV_MergePath_FixUp<YVector, carry_row_view_type, carry_value_view_type>
+                        (y, carry_rows, carry_values, A.numRows ()));
+}
+
+/// \brief Merge-path SpMV for multivectors (2-D Views).
+///
+/// Same partitioning as SPMV_MergePath_Functor.  Each row is applied
+/// to all columns of x before moving on, so the row's entries are
+/// read from memory once and stay in cache for the other columns.
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int doalpha,
+         int dobeta,
+         bool conjugate>
+struct SPMV_MV_MergePath_Functor {
+  typedef typename AMatrix::execution_space            execution_space;
+  typedef typename AMatrix::non_const_ordinal_type     ordinal_type;
+  typedef typename AMatrix::non_const_value_type       A_value_type;
+  typedef typename YVector::non_const_value_type       y_value_type;
+  typedef typename YVector::non_const_value_type       coefficient_type;
+  typedef Kokkos::View<int64_t*, typename YVector::device_type> carry_row_view_type;
+  typedef Kokkos::View<y_value_type**, Kokkos::LayoutLeft, typename YVector::device_type> carry_value_view_type;
+
+  const coefficient_type alpha;
+  AMatrix m_A;
+  XVector m_x;
+  const coefficient_type beta;
+  YVector m_y;
+  //! The number of columns in the input and output MultiVectors.
+  const ordinal_type n;
+
+  const int64_t items_per_part;
+  const int64_t path_length;
+  carry_row_view_type carry_rows;
+  carry_value_view_type carry_values;
+
+  SPMV_MV_MergePath_Functor (const coefficient_type& alpha_,
+                             const AMatrix& m_A_,
+                             const XVector& m_x_,
+                             const coefficient_type& beta_,
+                             const YVector& m_y_,
+                             const int64_t items_per_part_,
+                             const carry_row_view_type& carry_rows_,
+                             const carry_value_view_type& carry_values_) :
+    alpha (alpha_), m_A (m_A_), m_x (m_x_), beta (beta_), m_y (m_y_),
+    n (m_x_.extent(1)),
+    items_per_part (items_per_part_),
+    path_length (static_cast<int64_t> (m_A_.numRows ()) + static_cast<int64_t> (m_A_.nnz ())),
+    carry_rows (carry_rows_), carry_values (carry_values_)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  y_value_type row_dot (const int64_t row_begin, const int64_t row_end, const ordinal_type j) const
+  {
+    y_value_type sum = Kokkos::Details::ArithTraits<y_value_type>::zero ();
+    for (int64_t k = row_begin; k < row_end; ++k) {
+      const A_value_type val = conjugate ?
+        Kokkos::Details::ArithTraits<A_value_type>::conj (m_A.values(k)) :
+        m_A.values(k);
+      sum += val * m_x(m_A.graph.entries(k), j);
+    }
+    if (doalpha == -1) {
+      sum = -sum;
+    } else if (doalpha * doalpha != 1) {
+      sum *= alpha;
+    }
+    return sum;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const int64_t part) const
+  {
+    const int64_t numRows = m_A.numRows ();
+    const int64_t nnz = m_A.nnz ();
+
+    int64_t diag_begin = part * items_per_part;
+    if (diag_begin > path_length) diag_begin = path_length;
+    int64_t diag_end = diag_begin + items_per_part;
+    if (diag_end > path_length) diag_end = path_length;
+
+    int64_t row = spmv_merge_path_search (m_A.graph.row_map, numRows, nnz, diag_begin);
+    const int64_t row_end = spmv_merge_path_search (m_A.graph.row_map, numRows, nnz, diag_end);
+    int64_t k = diag_begin - row;
+    const int64_t k_end = diag_end - row_end;
+
+    // Rows that end inside this segment.
+    for (; row < row_end; ++row) {
+      const int64_t row_stop = m_A.graph.row_map(row + 1);
+      for (ordinal_type j = 0; j < n; ++j) {
+        const y_value_type sum = row_dot (k, row_stop, j);
+        if (dobeta == 0) {
+          m_y(row, j) = sum;
+        } else if (dobeta == 1) {
+          m_y(row, j) += sum;
+        } else if (dobeta == -1) {
+          m_y(row, j) = -m_y(row, j) + sum;
+        } else {
+          m_y(row, j) = beta * m_y(row, j) + sum;
+        }
+      }
+      k = row_stop;
+    }
+
+    // Partial sums of the row that continues in the next segment.
+    if (k < k_end) {
+      for (ordinal_type j = 0; j < n; ++j) {
+        carry_values(part, j) = row_dot (k, k_end, j);
+      }
+      carry_rows(part) = row_end;
+    } else {
+      carry_rows(part) = numRows;
+    }
+  }
+};
+
+template<class YVector, class CarryRowView, class CarryValueView>
+struct SPMV_MV_MergePath_FixUp {
+  YVector m_y;
+  CarryRowView carry_rows;
+  CarryValueView carry_values;
+  const int64_t numRows;
+
+  SPMV_MV_MergePath_FixUp (const YVector& m_y_,
+                           const CarryRowView& carry_rows_,
+                           const CarryValueView& carry_values_,
+                           const int64_t numRows_) :
+    m_y (m_y_), carry_rows (carry_rows_), carry_values (carry_values_),
+    numRows (numRows_)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const int64_t part) const
+  {
+    const int64_t row = carry_rows(part);
+    if (row < numRows) {
+      const int64_t n = m_y.extent(1);
+      for (int64_t j = 0; j < n; ++j) {
+        Kokkos::atomic_add (&m_y(row, j), carry_values(part, j));
+      }
+    }
+  }
+};
+
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int doalpha,
+         int dobeta,
+         bool conjugate>
+static void
+spmv_merge_path_mv_no_transpose (const typename YVector::non_const_value_type& alpha,
+                                 const AMatrix& A,
+                                 const XVector& x,
+                                 const typename YVector::non_const_value_type& beta,
+                                 const YVector& y)
+{
+  typedef typename AMatrix::execution_space execution_space;
+  typedef SPMV_MV_MergePath_Functor<AMatrix, XVector, YVector, doalpha, dobeta, conjugate> functor_type;
+  typedef typename functor_type::carry_row_view_type carry_row_view_type;
+  typedef typename functor_type::carry_value_view_type carry_value_view_type;
+
+  const int64_t path_length = static_cast<int64_t> (A.numRows ()) + static_cast<int64_t> (A.nnz ());
+  const int64_t items_per_part = spmv_merge_path_items_per_part<execution_space> (path_length);
+  const int64_t num_parts = (path_length + items_per_part - 1) / items_per_part;
+
+  carry_row_view_type carry_rows (Kokkos::ViewAllocateWithoutInitializing ("SpMV merge carry rows"), num_parts);
+  carry_value_view_type carry_values (Kokkos::ViewAllocateWithoutInitializing ("SpMV merge carry values"),
+                                      num_parts, x.extent(1));
+
+  functor_type func (alpha, A, x, beta, y, items_per_part, carry_rows, carry_values);
+  Kokkos::parallel_for ("KokkosSparse::spmv<MV,NoTranspose,MergePath>",
+                        Kokkos::RangePolicy<execution_space, Kokkos::Schedule<Kokkos::Static> > (0, num_parts),
+                        func);
+  Kokkos::parallel_for ("KokkosSparse::spmv<MV,NoTranspose,MergePath,FixUp>",
+                        Kokkos::RangePolicy<execution_space> (0, num_parts),
+                        SPMV_MV_MergePath_FixUp<YVector, carry_row_view_type, carry_value_view_type>
+                        (y, carry_rows, carry_values, A.numRows ()));
+}
+
+}
+}
+
+#endif // KOKKOSSPARSE_IMPL_SPMV_MERGE_HPP_
@@ -106,6 +106,151 @@ void spmv_raw_openmp_no_transpose(typename YVector::const_value_type& s_a, AMatr
 
 }
 
+
+/// \brief Raw OpenMP version of the fused SpMV and reduction (see
+///   spmv_fused_no_transpose).  Returns the sum of the contributions;
+///   the caller takes the square root for the 2-norm.
+template<typename AMatrix, typename XVector, typename YVector, bool do_nrm2>
+typename YVector::non_const_value_type
+spmv_raw_openmp_fused_no_transpose(typename YVector::const_value_type& s_a, AMatrix A, XVector x, typename YVector::const_value_type& s_b, YVector y) {
+
+  typedef typename YVector::non_const_value_type value_type;
+  typedef typename AMatrix::ordinal_type         ordinal_type;
+  typedef typename AMatrix::non_const_size_type            size_type;
+
+  typename XVector::const_value_type* KOKKOS_RESTRICT x_ptr = x.data();
+  typename YVector::non_const_value_type* KOKKOS_RESTRICT y_ptr = y.data();
+
+  const typename AMatrix::value_type* KOKKOS_RESTRICT matrixCoeffs = A.values.data();
+  const ordinal_type* KOKKOS_RESTRICT matrixCols     = A.graph.entries.data();
+  const size_type* KOKKOS_RESTRICT matrixRowOffsets  = A.graph.row_map.data();
+  const size_type* KOKKOS_RESTRICT threadStarts     = A.graph.row_block_offsets.data();
+
+#if defined(KOKKOS_ENABLE_PROFILING)
+    uint64_t kpID = 0;
+     if(Kokkos::Profiling::profileLibraryLoaded()) {
+      Kokkos::Profiling::beginParallelReduce("KokkosSparse::spmv_fused<RawOpenMP,NoTranspose>", 0, &kpID);
+     }
+#endif
+
+  typename YVector::const_value_type zero = 0;
+  value_type result = 0.0;
+  #pragma omp parallel reduction(+:result)
+  {
+#ifdef KOKKOS_COMPILER_INTEL
+    __assume_aligned(x_ptr, 64);
+    __assume_aligned(y_ptr, 64);
+#endif
+
+    const int myID    = omp_get_thread_num();
+    const size_type myStart = threadStarts[myID];
+    const size_type myEnd   = threadStarts[myID + 1];
+
+    for(size_type row = myStart; row < myEnd; ++row) {
+      const size_type rowStart = matrixRowOffsets[row];
+      const size_type rowEnd   = matrixRowOffsets[row + 1];
+
+      value_type sum = 0.0;
+
+      for(size_type i = rowStart; i < rowEnd; ++i) {
+        const ordinal_type x_entry =  matrixCols[i];
+        const value_type alpha_MC  =  s_a * matrixCoeffs[i];
+        sum                    += alpha_MC * x_ptr[x_entry];
+      }
+
+      if(zero != s_b) {
+        sum += s_b * y_ptr[row];
+      }
+      y_ptr[row] = sum;
+      result += do_nrm2 ? sum * sum : x_ptr[row] * sum;
+   }
+  }
+#if defined(KOKKOS_ENABLE_PROFILING)
+     if(Kokkos::Profiling::profileLibraryLoaded()) {
+        Kokkos::Profiling::endParallelReduce(kpID);
+     }
+#endif
+
+  return result;
+}
+
+/// \brief Raw OpenMP version of the fused SpMV and reduction for a
+///   BlockCrsMatrix.  Block rows are split over threads by
+///   A.graph.row_block_offsets, as in the CrsMatrix version.
+template<typename AMatrix, typename XVector, typename YVector, bool do_nrm2>
+typename YVector::non_const_value_type
+spmv_block_raw_openmp_fused_no_transpose(typename YVector::const_value_type& s_a, AMatrix A, XVector x, typename YVector::const_value_type& s_b, YVector y) {
+
+  typedef typename YVector::non_const_value_type value_type;
+  typedef typename AMatrix::ordinal_type         ordinal_type;
+  typedef typename AMatrix::non_const_size_type            size_type;
+
+  typename XVector::const_value_type* KOKKOS_RESTRICT x_ptr = x.data();
+  typename YVector::non_const_value_type* KOKKOS_RESTRICT y_ptr = y.data();
+
+  const typename AMatrix::value_type* KOKKOS_RESTRICT matrixCoeffs = A.values.data();
+  const ordinal_type* KOKKOS_RESTRICT matrixCols     = A.graph.entries.data();
+  const size_type* KOKKOS_RESTRICT matrixRowOffsets  = A.graph.row_map.data();
+  const size_type* KOKKOS_RESTRICT threadStarts     = A.graph.row_block_offsets.data();
+  const ordinal_type blockDim = A.blockDim();
+
+#if defined(KOKKOS_ENABLE_PROFILING)
+    uint64_t kpID = 0;
+     if(Kokkos::Profiling::profileLibraryLoaded()) {
+      Kokkos::Profiling::beginParallelReduce("KokkosSparse::spmv_fused<RawOpenMP,NoTranspose,BlockCrs>", 0, &kpID);
+     }
+#endif
+
+  typename YVector::const_value_type zero = 0;
+  value_type result = 0.0;
+  #pragma omp parallel reduction(+:result)
+  {
+#ifdef KOKKOS_COMPILER_INTEL
+    __assume_aligned(x_ptr, 64);
+    __assume_aligned(y_ptr, 64);
+#endif
+
+    const int myID    = omp_get_thread_num();
+    const size_type myStart = threadStarts[myID];
+    const size_type myEnd   = threadStarts[myID + 1];
+
+    for(size_type blockRow = myStart; blockRow < myEnd; ++blockRow) {
+      const size_type blockStart = matrixRowOffsets[blockRow];
+      const ordinal_type numBlocks = static_cast<ordinal_type>(matrixRowOffsets[blockRow + 1] - blockStart);
+
+      for(ordinal_type i = 0; i < blockDim; ++i) {
+        // Point row i of the block row is contiguous in matrixCoeffs.
+        const typename AMatrix::value_type* KOKKOS_RESTRICT rowCoeffs =
+          matrixCoeffs + (blockStart * blockDim + static_cast<size_type>(i) * numBlocks) * blockDim;
+
+        value_type sum = 0.0;
+
+        for(ordinal_type k = 0; k < numBlocks; ++k) {
+          const ordinal_type x_start = matrixCols[blockStart + k] * blockDim;
+          for(ordinal_type j = 0; j < blockDim; ++j) {
+            sum += rowCoeffs[k * blockDim + j] * x_ptr[x_start + j];
+          }
+        }
+        sum *= s_a;
+
+        const ordinal_type row = static_cast<ordinal_type>(blockRow) * blockDim + i;
+        if(zero != s_b) {
+          sum += s_b * y_ptr[row];
+        }
+        y_ptr[row] = sum;
+        result += do_nrm2 ? sum * sum : x_ptr[row] * sum;
+      }
+    }
+  }
+#if defined(KOKKOS_ENABLE_PROFILING)
+     if(Kokkos::Profiling::profileLibraryLoaded()) {
+        Kokkos::Profiling::endParallelReduce(kpID);
+     }
+#endif
+
+  return result;
+}
+
 #endif
 }
 }
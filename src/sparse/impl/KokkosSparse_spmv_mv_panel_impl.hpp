@@ -0,0 +1,241 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_IMPL_SPMV_MV_PANEL_HPP_
+#define KOKKOSSPARSE_IMPL_SPMV_MV_PANEL_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+
+namespace KokkosSparse {
+namespace Impl {
+
+//! Widest panel of right-hand sides handled in one pass over A.
+//! 16 doubles are two cache lines per row of the packed panel.
+constexpr int spmv_mv_panel_max_width = 16;
+
+/// \brief Y(:,kk:kk+Width) = beta*Y(:,kk:kk+Width) + alpha*A*XP, where
+///   XP holds X(:,kk:kk+Width) packed in LayoutRight.
+///
+/// Each row keeps Width sums in registers.  For each entry of the row,
+/// the Width values of XP's row are contiguous, so the update of the
+/// sums vectorizes across the right-hand sides.
+template<class AMatrix,
+         class XPanel,
+         class YVector,
+         int doalpha,
+         int dobeta,
+         bool conjugate,
+         int Width>
+struct SPMV_MV_Panel_Functor {
+  typedef typename AMatrix::execution_space            execution_space;
+  typedef typename AMatrix::non_const_ordinal_type     ordinal_type;
+  typedef typename AMatrix::non_const_value_type       A_value_type;
+  typedef typename YVector::non_const_value_type       y_value_type;
+  typedef y_value_type                                 coefficient_type;
+
+  const coefficient_type alpha;
+  AMatrix m_A;
+  XPanel m_xp;
+  const coefficient_type beta;
+  YVector m_y;
+  //! First column of Y in this panel.
+  const ordinal_type kk;
+
+  SPMV_MV_Panel_Functor (const coefficient_type& alpha_,
+                         const AMatrix& m_A_,
+                         const XPanel& m_xp_,
+                         const coefficient_type& beta_,
+                         const YVector& m_y_,
+                         const ordinal_type kk_) :
+    alpha (alpha_), m_A (m_A_), m_xp (m_xp_), beta (beta_), m_y (m_y_), kk (kk_)
+  {
+    static_assert (std::is_same<typename XPanel::array_layout, Kokkos::LayoutRight>::value,
+                   "XPanel must be LayoutRight.");
+  }
+
+  KOKKOS_INLINE_FUNCTION void
+  operator() (const ordinal_type iRow) const
+  {
+    y_value_type sum[Width];
+
+#ifdef KOKKOS_ENABLE_PRAGMA_UNROLL
+#pragma unroll
+#endif
+    for (int k = 0; k < Width; ++k) {
+      sum[k] = Kokkos::Details::ArithTraits<y_value_type>::zero ();
+    }
+
+    const auto row = m_A.rowConst (iRow);
+    for (ordinal_type iEntry = 0; iEntry < row.length; ++iEntry) {
+      const A_value_type val = conjugate ?
+        Kokkos::Details::ArithTraits<A_value_type>::conj (row.value(iEntry)) :
+        row.value(iEntry);
+      const typename XPanel::const_value_type* const xrow = &m_xp(row.colidx(iEntry), 0);
+
+#ifdef KOKKOS_ENABLE_PRAGMA_IVDEP
+#pragma ivdep
+#endif
+#ifdef KOKKOS_ENABLE_PRAGMA_UNROLL
+#pragma unroll
+#endif
+      for (int k = 0; k < Width; ++k) {
+        sum[k] += val * xrow[k];
+      }
+    }
+
+#ifdef KOKKOS_ENABLE_PRAGMA_UNROLL
+#pragma unroll
+#endif
+    for (int k = 0; k < Width; ++k) {
+      if (doalpha == -1) {
+        sum[k] = -sum[k];
+      } else if (doalpha * doalpha != 1) {
+        sum[k] *= alpha;
+      }
+      if (dobeta == 0) {
+        m_y(iRow, kk + k) = sum[k];
+      } else if (dobeta == 1) {
+        m_y(iRow, kk + k) += sum[k];
+      } else if (dobeta == -1) {
+        m_y(iRow, kk + k) = -m_y(iRow, kk + k) + sum[k];
+      } else {
+        m_y(iRow, kk + k) = beta * m_y(iRow, kk + k) + sum[k];
+      }
+    }
+  }
+};
+
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         class XPanelBuffer,
+         int doalpha,
+         int dobeta,
+         bool conjugate,
+         int Width>
+void
+spmv_mv_panel_apply (const typename YVector::non_const_value_type& alpha,
+                     const AMatrix& A,
+                     const XVector& x,
+                     const typename YVector::non_const_value_type& beta,
+                     const YVector& y,
+                     const XPanelBuffer& buffer,
+                     const typename AMatrix::non_const_ordinal_type kk)
+{
+  typedef typename AMatrix::execution_space execution_space;
+  typedef Kokkos::View<typename XPanelBuffer::non_const_value_type**, Kokkos::LayoutRight,
+                       typename XPanelBuffer::device_type,
+                       Kokkos::MemoryTraits<Kokkos::Unmanaged> > x_panel_type;
+  typedef Kokkos::View<typename XPanelBuffer::const_value_type**, Kokkos::LayoutRight,
+                       typename XPanelBuffer::device_type,
+                       Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > const_x_panel_type;
+
+  // Pack this panel of X; the buffer is sized for the widest panel.
+  const size_t numCols = x.extent (0);
+  x_panel_type x_panel (buffer.data (), numCols, Width);
+  Kokkos::deep_copy (x_panel, Kokkos::subview (x, Kokkos::ALL (),
+                                               Kokkos::make_pair (kk, kk + Width)));
+
+  typedef SPMV_MV_Panel_Functor<AMatrix, const_x_panel_type, YVector,
+                                doalpha, dobeta, conjugate, Width> functor_type;
+  Kokkos::parallel_for ("KokkosSparse::spmv<MV,NoTranspose,Panel>",
+                        Kokkos::RangePolicy<execution_space> (0, A.numRows ()),
+                        functor_type (alpha, A, const_x_panel_type (x_panel), beta, y, kk));
+}
+
+/// \brief Multivector SpMV that tiles the columns of X into panels.
+///
+/// The columns of X are processed in panels of up to
+/// spmv_mv_panel_max_width columns, packed into a LayoutRight buffer
+/// so that the entries a matrix entry multiplies are contiguous.  A
+/// is read once per panel instead of once per column or per small
+/// group of columns.  The last panel takes the widest power of two
+/// that still fits, down to a single column.
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int doalpha,
+         int dobeta,
+         bool conjugate>
+void
+spmv_mv_panel_no_transpose (const typename YVector::non_const_value_type& alpha,
+                            const AMatrix& A,
+                            const XVector& x,
+                            const typename YVector::non_const_value_type& beta,
+                            const YVector& y)
+{
+  typedef typename AMatrix::non_const_ordinal_type ordinal_type;
+  typedef typename YVector::non_const_value_type y_value_type;
+  typedef Kokkos::View<y_value_type*, typename YVector::device_type> buffer_type;
+
+  const ordinal_type n = static_cast<ordinal_type> (x.extent (1));
+  const ordinal_type max_width = n < spmv_mv_panel_max_width ? n : spmv_mv_panel_max_width;
+  buffer_type buffer (Kokkos::ViewAllocateWithoutInitializing ("KokkosSparse::spmv::x_panel"),
+                      x.extent (0) * max_width);
+
+  ordinal_type kk = 0;
+  for (; kk + spmv_mv_panel_max_width <= n; kk += spmv_mv_panel_max_width)
+    spmv_mv_panel_apply<AMatrix, XVector, YVector, buffer_type, doalpha, dobeta, conjugate, spmv_mv_panel_max_width> (alpha, A, x, beta, y, buffer, kk);
+  if (kk + 8 <= n) {
+    spmv_mv_panel_apply<AMatrix, XVector, YVector, buffer_type, doalpha, dobeta, conjugate, 8> (alpha, A, x, beta, y, buffer, kk);
+    kk += 8;
+  }
+  if (kk + 4 <= n) {
+    spmv_mv_panel_apply<AMatrix, XVector, YVector, buffer_type, doalpha, dobeta, conjugate, 4> (alpha, A, x, beta, y, buffer, kk);
+    kk += 4;
+  }
+  if (kk + 2 <= n) {
+    spmv_mv_panel_apply<AMatrix, XVector, YVector, buffer_type, doalpha, dobeta, conjugate, 2> (alpha, A, x, beta, y, buffer, kk);
+    kk += 2;
+  }
+  if (kk < n) {
+    spmv_mv_panel_apply<AMatrix, XVector, YVector, buffer_type, doalpha, dobeta, conjugate, 1> (alpha, A, x, beta, y, buffer, kk);
+  }
+}
+
+} // namespace Impl
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_IMPL_SPMV_MV_PANEL_HPP_
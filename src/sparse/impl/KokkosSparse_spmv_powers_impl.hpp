@@ -0,0 +1,294 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_IMPL_SPMV_POWERS_HPP_
+#define KOKKOSSPARSE_IMPL_SPMV_POWERS_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+#include "KokkosSparse_spmv_impl.hpp"
+
+namespace KokkosSparse {
+namespace Impl {
+
+//! Target number of entries per row block of spmv_powers, when the
+//! graph does not come with its own row_block_offsets.  A few such
+//! blocks (values and column indices) fit in a last-level cache.
+constexpr int64_t spmv_powers_nnz_per_block = 65536;
+
+/// \brief Index of the row block that contains row.
+///
+/// offsets holds num_blocks+1 row offsets, as in
+/// StaticCrsGraph::row_block_offsets.
+template<class OffsetsView, class ordinal_type>
+KOKKOS_INLINE_FUNCTION
+ordinal_type spmv_powers_find_block (const OffsetsView& offsets, const ordinal_type num_blocks, const ordinal_type row)
+{
+  ordinal_type lo = 0, hi = num_blocks;
+  while (hi - lo > 1) {
+    const ordinal_type mid = lo + (hi - lo) / 2;
+    if (static_cast<ordinal_type> (offsets(mid)) <= row)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+/// \brief Computes the reach of a row blocking: the largest distance,
+///   in blocks, between a row's block and the block of a column it
+///   references.
+template<class AMatrix, class OffsetsView>
+struct SPMV_Powers_ReachFunctor {
+  typedef typename AMatrix::non_const_ordinal_type ordinal_type;
+  typedef typename AMatrix::non_const_size_type size_type;
+
+  AMatrix m_A;
+  OffsetsView m_offsets;
+  ordinal_type m_num_blocks;
+
+  SPMV_Powers_ReachFunctor (const AMatrix& A, const OffsetsView& offsets, const ordinal_type num_blocks) :
+    m_A (A), m_offsets (offsets), m_num_blocks (num_blocks)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ordinal_type i, ordinal_type& reach) const
+  {
+    const size_type begin = m_A.graph.row_map(i);
+    const size_type end = m_A.graph.row_map(i + 1);
+    if (begin == end) {
+      return;
+    }
+    ordinal_type min_col = m_A.graph.entries(begin), max_col = min_col;
+    for (size_type k = begin + 1; k < end; ++k) {
+      const ordinal_type col = m_A.graph.entries(k);
+      if (col < min_col) min_col = col;
+      if (col > max_col) max_col = col;
+    }
+    const ordinal_type p = spmv_powers_find_block (m_offsets, m_num_blocks, i);
+    const ordinal_type lo = spmv_powers_find_block (m_offsets, m_num_blocks, min_col);
+    const ordinal_type hi = spmv_powers_find_block (m_offsets, m_num_blocks, max_col);
+    if (p - lo > reach) reach = p - lo;
+    if (hi - p > reach) reach = hi - p;
+  }
+};
+
+/// \brief One wavefront of the matrix powers kernel.
+///
+/// Computes V(:,k) = A*V(:,k-1) on row block
+/// p = wavefront - (k-1)*(reach+1), for every k in [1, s] for which
+/// that block exists.  All blocks that block p references are at most
+/// reach blocks away, and the skew of reach+1 blocks between
+/// successive powers ensures they were computed for power k-1 by an
+/// earlier wavefront.  A block is thus used for all s powers within
+/// s*(reach+1) wavefronts, while it is still in cache.
+///
+/// League rank r handles power k = r / teams_per_block + 1 and the
+/// (r % teams_per_block)-th group of rows_per_team rows of its block.
+template<class AMatrix, class VMultiVector, class OffsetsView>
+struct SPMV_Powers_Functor {
+  typedef typename AMatrix::execution_space            execution_space;
+  typedef typename AMatrix::non_const_ordinal_type     ordinal_type;
+  typedef typename AMatrix::non_const_size_type        size_type;
+  typedef typename AMatrix::non_const_value_type       value_type;
+  typedef typename VMultiVector::non_const_value_type  v_value_type;
+  typedef typename Kokkos::TeamPolicy<execution_space> team_policy;
+  typedef typename team_policy::member_type            team_member;
+
+  AMatrix m_A;
+  VMultiVector m_V;
+  OffsetsView m_offsets;
+  const ordinal_type num_blocks;
+  const ordinal_type skew;
+  const ordinal_type teams_per_block;
+  const ordinal_type rows_per_team;
+  ordinal_type wavefront;
+
+  SPMV_Powers_Functor (const AMatrix& A,
+                       const VMultiVector& V,
+                       const OffsetsView& offsets,
+                       const ordinal_type num_blocks_,
+                       const ordinal_type reach,
+                       const ordinal_type teams_per_block_,
+                       const ordinal_type rows_per_team_) :
+    m_A (A), m_V (V), m_offsets (offsets),
+    num_blocks (num_blocks_), skew (reach + 1),
+    teams_per_block (teams_per_block_), rows_per_team (rows_per_team_),
+    wavefront (0)
+  {
+    static_assert (static_cast<int> (VMultiVector::rank) == 2,
+                   "VMultiVector must be a rank 2 View.");
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const team_member& dev) const
+  {
+    const ordinal_type task = static_cast<ordinal_type> (dev.league_rank ()) / teams_per_block;
+    const ordinal_type group = static_cast<ordinal_type> (dev.league_rank ()) % teams_per_block;
+    const ordinal_type block = wavefront - task * skew;
+    if (block < 0 || block >= num_blocks) {
+      return;
+    }
+    const ordinal_type k = task + 1;
+    const ordinal_type block_end = static_cast<ordinal_type> (m_offsets(block + 1));
+    const ordinal_type row_begin = static_cast<ordinal_type> (m_offsets(block)) + group * rows_per_team;
+    if (row_begin >= block_end) {
+      return;
+    }
+    const ordinal_type row_count =
+      (block_end - row_begin < rows_per_team) ? block_end - row_begin : rows_per_team;
+
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(dev,0,row_count), [&] (const ordinal_type& loop) {
+      const ordinal_type iRow = row_begin + loop;
+      const auto row = m_A.rowConst(iRow);
+      const ordinal_type row_length = static_cast<ordinal_type> (row.length);
+      v_value_type sum = 0;
+
+      Kokkos::parallel_reduce(Kokkos::ThreadVectorRange(dev,row_length), [&] (const ordinal_type& iEntry, v_value_type& lsum) {
+        lsum += row.value(iEntry) * m_V(row.colidx(iEntry), k - 1);
+      },sum);
+
+      Kokkos::single(Kokkos::PerThread(dev), [&] () {
+        m_V(iRow, k) = sum;
+      });
+    });
+  }
+};
+
+/// \brief Row blocking of A for spmv_powers.
+///
+/// Uses A.graph.row_block_offsets if it is set, otherwise splits A
+/// into blocks of about spmv_powers_nnz_per_block entries.  Returns
+/// the offsets and, through reach, how many blocks away the furthest
+/// column of a block's rows lies, and through max_block_rows the
+/// number of rows of the largest block.
+template<class AMatrix>
+typename AMatrix::staticcrsgraph_type::row_block_type
+spmv_powers_blocking (const AMatrix& A,
+                      typename AMatrix::non_const_ordinal_type& reach,
+                      int64_t& max_block_rows)
+{
+  typedef typename AMatrix::execution_space execution_space;
+  typedef typename AMatrix::non_const_ordinal_type ordinal_type;
+  typedef typename AMatrix::staticcrsgraph_type::row_block_type offsets_type;
+
+  typename AMatrix::staticcrsgraph_type graph = A.graph;
+  if (graph.row_block_offsets.extent (0) < 2) {
+    int64_t num_blocks = static_cast<int64_t> (A.nnz ()) / spmv_powers_nnz_per_block;
+    if (num_blocks < 1) num_blocks = 1;
+    if (num_blocks > static_cast<int64_t> (A.numRows ())) num_blocks = A.numRows ();
+    graph.create_block_partitioning (num_blocks);
+  }
+  offsets_type offsets = graph.row_block_offsets;
+  const ordinal_type num_blocks = static_cast<ordinal_type> (offsets.extent (0)) - 1;
+
+  reach = 0;
+  Kokkos::parallel_reduce ("KokkosSparse::spmv_powers::Reach",
+                           Kokkos::RangePolicy<execution_space> (0, A.numRows ()),
+                           SPMV_Powers_ReachFunctor<AMatrix, offsets_type> (A, offsets, num_blocks),
+                           Kokkos::Max<ordinal_type> (reach));
+  if (reach < 0) {
+    // Every row is empty.
+    reach = 0;
+  }
+
+  auto h_offsets = Kokkos::create_mirror_view (offsets);
+  Kokkos::deep_copy (h_offsets, offsets);
+  max_block_rows = 0;
+  for (ordinal_type p = 0; p < num_blocks; ++p) {
+    const int64_t block_rows = static_cast<int64_t> (h_offsets(p + 1) - h_offsets(p));
+    if (block_rows > max_block_rows) max_block_rows = block_rows;
+  }
+  return offsets;
+}
+
+/// \brief V(:,k) = A*V(:,k-1) for k = 1, ..., s, by wavefronts over
+///   the row blocks in offsets (see SPMV_Powers_Functor), of which the
+///   largest has max_block_rows rows.
+template<class AMatrix, class VMultiVector, class OffsetsView>
+void
+spmv_powers_wavefront (const AMatrix& A,
+                       const int s,
+                       const VMultiVector& V,
+                       const OffsetsView& offsets,
+                       const typename AMatrix::non_const_ordinal_type reach,
+                       const int64_t max_block_rows)
+{
+  typedef typename AMatrix::execution_space execution_space;
+  typedef typename AMatrix::non_const_ordinal_type ordinal_type;
+  typedef Kokkos::TeamPolicy<execution_space> policy_type;
+
+  const ordinal_type num_blocks = static_cast<ordinal_type> (offsets.extent (0)) - 1;
+  if (num_blocks <= 0 || s <= 0 || max_block_rows == 0) {
+    return;
+  }
+
+  int team_size = -1;
+  int vector_length = -1;
+  int64_t rows_per_thread = -1;
+  int64_t rows_per_team =
+    spmv_launch_parameters<execution_space>(A.numRows(),A.nnz(),rows_per_thread,team_size,vector_length);
+  if (rows_per_team > max_block_rows) rows_per_team = max_block_rows;
+  const int64_t teams_per_block = (max_block_rows + rows_per_team - 1) / rows_per_team;
+
+  SPMV_Powers_Functor<AMatrix, VMultiVector, OffsetsView> func
+    (A, V, offsets, num_blocks, reach, teams_per_block, rows_per_team);
+
+  policy_type policy (1,1);
+  if(team_size<0)
+    policy = policy_type(teams_per_block * s,Kokkos::AUTO,vector_length);
+  else
+    policy = policy_type(teams_per_block * s,team_size,vector_length);
+
+  const ordinal_type num_wavefronts = num_blocks + (s - 1) * (reach + 1);
+  for (ordinal_type w = 0; w < num_wavefronts; ++w) {
+    func.wavefront = w;
+    Kokkos::parallel_for ("KokkosSparse::spmv_powers<Wavefront>", policy, func);
+  }
+}
+
+} // namespace Impl
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_IMPL_SPMV_POWERS_HPP_
@@ -0,0 +1,279 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_IMPL_SPMV_SELLCS_HPP_
+#define KOKKOSSPARSE_IMPL_SPMV_SELLCS_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+#include "KokkosBlas1_scal.hpp"
+#include "KokkosKernels_ExecSpaceUtils.hpp"
+#include "KokkosSparse_SellCSigmaMatrix.hpp"
+#include <sstream>
+
+namespace KokkosSparse {
+namespace Impl {
+
+/// \brief SpMV, y = beta*y + alpha*A*x, for a SellCSigmaMatrix.
+///
+/// With ChunkTag, each work item handles one chunk.  The C rows of
+/// the chunk are accumulated in lockstep in a fixed-size array, so
+/// the inner loop over the rows vectorizes; this needs the chunk
+/// height as the compile-time constant \c ChunkHeight.  With RowTag,
+/// each work item handles one row of a chunk, which gives coalesced
+/// loads on GPUs and works for any chunk height.
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int dobeta,
+         bool conjugate,
+         int ChunkHeight = 0>
+struct SPMV_SellCSigma_Functor {
+  typedef typename AMatrix::execution_space            execution_space;
+  typedef typename AMatrix::non_const_ordinal_type     ordinal_type;
+  typedef typename AMatrix::non_const_size_type        size_type;
+  typedef typename AMatrix::non_const_value_type       value_type;
+  typedef typename YVector::non_const_value_type       y_value_type;
+  typedef Kokkos::Details::ArithTraits<value_type>     ATV;
+
+  struct ChunkTag {};
+  struct RowTag {};
+
+  const y_value_type alpha;
+  AMatrix m_A;
+  XVector m_x;
+  const y_value_type beta;
+  YVector m_y;
+
+  SPMV_SellCSigma_Functor (const y_value_type alpha_,
+                           const AMatrix& m_A_,
+                           const XVector& m_x_,
+                           const y_value_type beta_,
+                           const YVector& m_y_) :
+    alpha (alpha_), m_A (m_A_), m_x (m_x_), beta (beta_), m_y (m_y_)
+  {
+    static_assert (static_cast<int> (XVector::rank) == 1,
+                   "XVector must be a rank 1 View.");
+    static_assert (static_cast<int> (YVector::rank) == 1,
+                   "YVector must be a rank 1 View.");
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void store (const ordinal_type row, const y_value_type& sum) const
+  {
+    if (dobeta == 0) {
+      m_y(row) = alpha * sum;
+    } else {
+      m_y(row) = beta * m_y(row) + alpha * sum;
+    }
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ChunkTag&, const ordinal_type chunk) const
+  {
+    y_value_type sum[ChunkHeight > 0 ? ChunkHeight : 1];
+    for (int lane = 0; lane < ChunkHeight; ++lane) {
+      sum[lane] = Kokkos::Details::ArithTraits<y_value_type>::zero ();
+    }
+
+    const size_type offset = m_A.chunk_offsets(chunk);
+    const ordinal_type length = m_A.chunk_lengths(chunk);
+    for (ordinal_type j = 0; j < length; ++j) {
+      const size_type k = offset + static_cast<size_type> (j) * ChunkHeight;
+#ifdef KOKKOS_ENABLE_PRAGMA_IVDEP
+#pragma ivdep
+#endif
+      for (int lane = 0; lane < ChunkHeight; ++lane) {
+        const value_type val = conjugate ?
+          ATV::conj (m_A.values(k + lane)) :
+          m_A.values(k + lane);
+        sum[lane] += val * m_x(m_A.entries(k + lane));
+      }
+    }
+
+    const ordinal_type numRows = m_A.numRows ();
+    for (int lane = 0; lane < ChunkHeight; ++lane) {
+      const ordinal_type row = m_A.row_permutation(chunk * ChunkHeight + lane);
+      if (row < numRows) {
+        store (row, sum[lane]);
+      }
+    }
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const RowTag&, const ordinal_type sorted_row) const
+  {
+    const ordinal_type row = m_A.row_permutation(sorted_row);
+    if (row >= m_A.numRows ()) {
+      return;
+    }
+    const ordinal_type C = m_A.chunkHeight ();
+    const ordinal_type chunk = sorted_row / C;
+    const size_type offset = m_A.chunk_offsets(chunk) + sorted_row % C;
+    const ordinal_type length = m_A.chunk_lengths(chunk);
+
+    y_value_type sum = Kokkos::Details::ArithTraits<y_value_type>::zero ();
+    for (ordinal_type j = 0; j < length; ++j) {
+      const size_type k = offset + static_cast<size_type> (j) * C;
+      const value_type val = conjugate ?
+        ATV::conj (m_A.values(k)) :
+        m_A.values(k);
+      sum += val * m_x(m_A.entries(k));
+    }
+    store (row, sum);
+  }
+};
+
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int dobeta,
+         bool conjugate,
+         int ChunkHeight>
+void
+spmv_sellcs_chunk_launch (typename YVector::const_value_type& alpha,
+                          const AMatrix& A,
+                          const XVector& x,
+                          typename YVector::const_value_type& beta,
+                          const YVector& y)
+{
+  typedef typename AMatrix::execution_space execution_space;
+  typedef SPMV_SellCSigma_Functor<AMatrix, XVector, YVector, dobeta, conjugate, ChunkHeight> functor_type;
+  typedef typename functor_type::ChunkTag tag_type;
+
+  Kokkos::parallel_for ("KokkosSparse::spmv<NoTranspose,SellCSigma>",
+                        Kokkos::RangePolicy<execution_space, tag_type> (0, A.numChunks ()),
+                        functor_type (alpha, A, x, beta, y));
+}
+
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         int dobeta,
+         bool conjugate>
+void
+spmv_sellcs_no_transpose (typename YVector::const_value_type& alpha,
+                          const AMatrix& A,
+                          const XVector& x,
+                          typename YVector::const_value_type& beta,
+                          const YVector& y)
+{
+  typedef typename AMatrix::execution_space execution_space;
+
+  if (KokkosKernels::Impl::kk_get_exec_space_type<execution_space> () !=
+      KokkosKernels::Impl::Exec_CUDA) {
+    // Chunk heights that match a SIMD width get a vectorized kernel.
+    switch (A.chunkHeight ()) {
+    case 2:
+      spmv_sellcs_chunk_launch<AMatrix, XVector, YVector, dobeta, conjugate, 2> (alpha, A, x, beta, y);
+      return;
+    case 4:
+      spmv_sellcs_chunk_launch<AMatrix, XVector, YVector, dobeta, conjugate, 4> (alpha, A, x, beta, y);
+      return;
+    case 8:
+      spmv_sellcs_chunk_launch<AMatrix, XVector, YVector, dobeta, conjugate, 8> (alpha, A, x, beta, y);
+      return;
+    case 16:
+      spmv_sellcs_chunk_launch<AMatrix, XVector, YVector, dobeta, conjugate, 16> (alpha, A, x, beta, y);
+      return;
+    default:
+      break;
+    }
+  }
+
+  typedef SPMV_SellCSigma_Functor<AMatrix, XVector, YVector, dobeta, conjugate> functor_type;
+  typedef typename functor_type::RowTag tag_type;
+  const int64_t num_padded_rows =
+    static_cast<int64_t> (A.numChunks ()) * static_cast<int64_t> (A.chunkHeight ());
+  Kokkos::parallel_for ("KokkosSparse::spmv<NoTranspose,SellCSigma>",
+                        Kokkos::RangePolicy<execution_space, tag_type> (0, num_padded_rows),
+                        functor_type (alpha, A, x, beta, y));
+}
+
+template<class AMatrix,
+         class XVector,
+         class YVector>
+void
+spmv_sellcs (const char mode[],
+             typename YVector::const_value_type& alpha,
+             const AMatrix& A,
+             const XVector& x,
+             typename YVector::const_value_type& beta,
+             const YVector& y)
+{
+  typedef Kokkos::Details::ArithTraits<typename YVector::non_const_value_type> KAT;
+
+  const bool conjugate = (mode[0] == 'C' || mode[0] == 'c');
+  if (mode[0] != 'N' && mode[0] != 'n' && !conjugate) {
+    std::ostringstream os;
+    os << "KokkosSparse::spmv: SellCSigmaMatrix only supports modes "
+       << "\"N\" and \"C\", but mode = \"" << mode << "\".";
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+
+  if (alpha == KAT::zero ()) {
+    if (beta != KAT::one ()) {
+      KokkosBlas::scal (y, beta, y);
+    }
+    return;
+  }
+
+  if (beta == KAT::zero ()) {
+    if (conjugate)
+      spmv_sellcs_no_transpose<AMatrix, XVector, YVector, 0, true> (alpha, A, x, beta, y);
+    else
+      spmv_sellcs_no_transpose<AMatrix, XVector, YVector, 0, false> (alpha, A, x, beta, y);
+  }
+  else {
+    if (conjugate)
+      spmv_sellcs_no_transpose<AMatrix, XVector, YVector, 2, true> (alpha, A, x, beta, y);
+    else
+      spmv_sellcs_no_transpose<AMatrix, XVector, YVector, 2, false> (alpha, A, x, beta, y);
+  }
+}
+
+} // namespace Impl
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_IMPL_SPMV_SELLCS_HPP_
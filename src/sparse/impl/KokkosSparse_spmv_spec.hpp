@@ -49,6 +49,7 @@
 #include <Kokkos_ArithTraits.hpp>
 
 #include "KokkosSparse_CrsMatrix.hpp"
+#include "KokkosSparse_spmv_handle.hpp"
 // Include the actual functors
 #if !defined(KOKKOSKERNELS_ETI_ONLY) || KOKKOSKERNELS_IMPL_COMPILE_LIBRARY 
 #include <KokkosSparse_spmv_impl.hpp>
@@ -155,7 +156,8 @@ struct SPMV{
 
   typedef typename YVector::non_const_value_type coefficient_type;
 
-  static void spmv (const char mode[],
+  static void spmv (const SPMVPlan& plan,
+      const char mode[],
       const coefficient_type& alpha,
       const AMatrix& A,
       const XVector& x,
@@ -221,7 +223,8 @@ struct SPMV_MV{
   typedef typename YVector::non_const_value_type coefficient_type;
 
   static void
-  spmv_mv (const char mode[],
+  spmv_mv (const SPMVPlan& plan,
+           const char mode[],
            const coefficient_type& alpha,
            const AMatrix& A,
            const XVector& x,
@@ -245,7 +248,8 @@ struct SPMV < AT, AO, AD, AM, AS,
   typedef typename YVector::non_const_value_type coefficient_type;
 
   static void
-  spmv (const char mode[],
+  spmv (const SPMVPlan& plan,
+      const char mode[],
       const coefficient_type& alpha,
       const AMatrix& A,
       const XVector& x,
@@ -254,8 +258,6 @@ struct SPMV < AT, AO, AD, AM, AS,
   {
     typedef Kokkos::Details::ArithTraits<coefficient_type> KAT;
 
-    typedef Kokkos::Details::ArithTraits<coefficient_type> KAT;
-
     if (alpha == KAT::zero ()) {
       if (beta != KAT::one ()) {
         KokkosBlas::scal (y, beta, y);
@@ -264,16 +266,16 @@ struct SPMV < AT, AO, AD, AM, AS,
     }
 
     if (beta == KAT::zero ()) {
-      spmv_beta<AMatrix, XVector, YVector, 0> (mode, alpha, A, x, beta, y);
+      spmv_beta<AMatrix, XVector, YVector, 0> (plan, mode, alpha, A, x, beta, y);
     }
     else if (beta == KAT::one ()) {
-      spmv_beta<AMatrix, XVector, YVector, 1> (mode, alpha, A, x, beta, y);
+      spmv_beta<AMatrix, XVector, YVector, 1> (plan, mode, alpha, A, x, beta, y);
     }
     else if (beta == -KAT::one ()) {
-      spmv_beta<AMatrix, XVector, YVector, -1> (mode, alpha, A, x, beta, y);
+      spmv_beta<AMatrix, XVector, YVector, -1> (plan, mode, alpha, A, x, beta, y);
     }
     else {
-      spmv_beta<AMatrix, XVector, YVector, 2> (mode, alpha, A, x, beta, y);
+      spmv_beta<AMatrix, XVector, YVector, 2> (plan, mode, alpha, A, x, beta, y);
     }
   }
 };
@@ -294,7 +296,8 @@ struct SPMV_MV<AT, AO, AD, AM, AS,
   typedef typename YVector::non_const_value_type coefficient_type;
 
   static void
-  spmv_mv (const char mode[],
+  spmv_mv (const SPMVPlan& plan,
+           const char mode[],
            const coefficient_type& alpha,
            const AMatrix& A,
            const XVector& x,
@@ -304,16 +307,16 @@ struct SPMV_MV<AT, AO, AD, AM, AS,
     typedef Kokkos::Details::ArithTraits<coefficient_type> KAT;
 
     if (alpha == KAT::zero ()) {
-      spmv_alpha_mv<AMatrix, XVector, YVector, 0> (mode, alpha, A, x, beta, y);
+      spmv_alpha_mv<AMatrix, XVector, YVector, 0> (plan, mode, alpha, A, x, beta, y);
     }
     else if (alpha == KAT::one ()) {
-      spmv_alpha_mv<AMatrix, XVector, YVector, 1> (mode, alpha, A, x, beta, y);
+      spmv_alpha_mv<AMatrix, XVector, YVector, 1> (plan, mode, alpha, A, x, beta, y);
     }
     else if (alpha == -KAT::one ()) {
-      spmv_alpha_mv<AMatrix, XVector, YVector, -1> (mode, alpha, A, x, beta, y);
+      spmv_alpha_mv<AMatrix, XVector, YVector, -1> (plan, mode, alpha, A, x, beta, y);
     }
     else {
-      spmv_alpha_mv<AMatrix, XVector, YVector, 2> (mode, alpha, A, x, beta, y);
+      spmv_alpha_mv<AMatrix, XVector, YVector, 2> (plan, mode, alpha, A, x, beta, y);
     }
   }
 };
@@ -332,7 +335,8 @@ struct SPMV_MV<AT, AO, AD, AM, AS,
   typedef typename YVector::non_const_value_type coefficient_type;
 
   static void
-  spmv_mv (const char mode[],
+  spmv_mv (const SPMVPlan& plan,
+           const char mode[],
            const coefficient_type& alpha,
            const AMatrix& A,
            const XVector& x,
@@ -347,7 +351,7 @@ struct SPMV_MV<AT, AO, AD, AM, AS,
     for (typename AMatrix::non_const_size_type j = 0; j < x.extent(1); ++j) {
       auto x_j = Kokkos::subview (x, Kokkos::ALL (), j);
       auto y_j = Kokkos::subview (y, Kokkos::ALL (), j);
-      impl_type::spmv (mode, alpha, A, x_j, beta, y_j);
+      impl_type::spmv (plan, mode, alpha, A, x_j, beta, y_j);
     }
   }
 };
@@ -0,0 +1,331 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_IMPL_SPMV_SYMBOLIC_HPP_
+#define KOKKOSSPARSE_IMPL_SPMV_SYMBOLIC_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+#include "KokkosSparse_spmv_handle.hpp"
+#include "KokkosSparse_spmv_impl.hpp"
+
+namespace KokkosSparse {
+namespace Impl {
+
+/// \brief Row length range, bandwidth and row length histogram of a
+///   CRS graph, in one pass over the rows.
+template<class RowMapType, class EntriesType, class HistogramType>
+struct SPMV_InspectFunctor {
+  typedef typename EntriesType::non_const_value_type ordinal_type;
+  typedef typename RowMapType::non_const_value_type size_type;
+
+  struct value_type {
+    ordinal_type min_row_length;
+    ordinal_type max_row_length;
+    ordinal_type bandwidth;
+  };
+
+  RowMapType row_map;
+  EntriesType entries;
+  HistogramType histogram;
+  const int num_buckets;
+
+  SPMV_InspectFunctor (const RowMapType& row_map_,
+                       const EntriesType& entries_,
+                       const HistogramType& histogram_) :
+    row_map (row_map_), entries (entries_), histogram (histogram_),
+    num_buckets (static_cast<int> (histogram_.extent (0)))
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ordinal_type i, value_type& update) const
+  {
+    const size_type begin = row_map(i);
+    const size_type end = row_map(i + 1);
+    const ordinal_type length = static_cast<ordinal_type> (end - begin);
+    if (length < update.min_row_length) update.min_row_length = length;
+    if (length > update.max_row_length) update.max_row_length = length;
+    for (size_type k = begin; k < end; ++k) {
+      const ordinal_type col = entries(k);
+      const ordinal_type distance = col > i ? col - i : i - col;
+      if (distance > update.bandwidth) update.bandwidth = distance;
+    }
+
+    int bucket = 0;
+    for (ordinal_type l = length; l > 0 && bucket < num_buckets - 1; l >>= 1) {
+      ++bucket;
+    }
+    Kokkos::atomic_fetch_add (&histogram(bucket), size_type (1));
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void join (volatile value_type& dst, const volatile value_type& src) const
+  {
+    if (src.min_row_length < dst.min_row_length) dst.min_row_length = src.min_row_length;
+    if (src.max_row_length > dst.max_row_length) dst.max_row_length = src.max_row_length;
+    if (src.bandwidth > dst.bandwidth) dst.bandwidth = src.bandwidth;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void init (value_type& dst) const
+  {
+    dst.min_row_length = Kokkos::Details::ArithTraits<ordinal_type>::max ();
+    dst.max_row_length = 0;
+    dst.bandwidth = 0;
+  }
+};
+
+/// \brief Counts the rows that break a dense block structure with
+///   square blocks of size \c block_size.
+///
+/// All rows of a block row must have the same column pattern, made
+/// of runs of \c block_size consecutive columns that start at a
+/// multiple of \c block_size.
+template<class RowMapType, class EntriesType>
+struct SPMV_BlockCheckFunctor {
+  typedef typename EntriesType::non_const_value_type ordinal_type;
+  typedef typename RowMapType::non_const_value_type size_type;
+
+  RowMapType row_map;
+  EntriesType entries;
+  const ordinal_type block_size;
+
+  SPMV_BlockCheckFunctor (const RowMapType& row_map_,
+                          const EntriesType& entries_,
+                          const ordinal_type block_size_) :
+    row_map (row_map_), entries (entries_), block_size (block_size_)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ordinal_type i, ordinal_type& mismatches) const
+  {
+    const ordinal_type first = (i / block_size) * block_size;
+    const size_type begin = row_map(i);
+    const size_type length = row_map(i + 1) - begin;
+    const size_type first_begin = row_map(first);
+    const size_type first_length = row_map(first + 1) - first_begin;
+    if (length != first_length || length % block_size != 0) {
+      ++mismatches;
+      return;
+    }
+    for (size_type k = 0; k < length; ++k) {
+      const ordinal_type col = entries(begin + k);
+      const size_type lane = k % block_size;
+      const ordinal_type run_start = entries(begin + k - lane);
+      if (col != entries(first_begin + k) ||
+          run_start % block_size != 0 ||
+          col != run_start + static_cast<ordinal_type> (lane)) {
+        ++mismatches;
+        return;
+      }
+    }
+  }
+};
+
+/// \brief Builds the graph of the dense blocks of A, one block row
+///   per index, for a matrix that passed SPMV_BlockCheckFunctor.
+///
+/// The entries of a point row are runs of \c block_size columns, one
+/// per block, and all the point rows of a block row have the same
+/// pattern, so the values of A are already in BlockCrsMatrix order.
+template<class RowMapType, class EntriesType, class BlockRowMapType, class BlockEntriesType>
+struct SPMV_BlockGraphFunctor {
+  typedef typename EntriesType::non_const_value_type ordinal_type;
+  typedef typename RowMapType::non_const_value_type size_type;
+
+  RowMapType row_map;
+  EntriesType entries;
+  BlockRowMapType block_row_map;
+  BlockEntriesType block_entries;
+  const ordinal_type block_size;
+
+  SPMV_BlockGraphFunctor (const RowMapType& row_map_,
+                          const EntriesType& entries_,
+                          const BlockRowMapType& block_row_map_,
+                          const BlockEntriesType& block_entries_,
+                          const ordinal_type block_size_) :
+    row_map (row_map_), entries (entries_),
+    block_row_map (block_row_map_), block_entries (block_entries_),
+    block_size (block_size_)
+  {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator() (const ordinal_type iBlockRow) const
+  {
+    const ordinal_type first = iBlockRow * block_size;
+    const size_type begin = row_map(first);
+    const size_type num_blocks = (row_map(first + 1) - begin) / block_size;
+    const size_type block_begin = (begin - row_map(0)) / (block_size * block_size);
+    if (iBlockRow == 0) {
+      block_row_map(0) = 0;
+    }
+    block_row_map(iBlockRow + 1) = block_begin + num_blocks;
+    for (size_type k = 0; k < num_blocks; ++k) {
+      block_entries(block_begin + k) = entries(begin + k * block_size) / block_size;
+    }
+  }
+};
+
+/// \brief Inspect A and store an SpMV plan in the SPMVHandle of
+///   \c handle.
+template<class KernelHandle, class AMatrix>
+void
+spmv_symbolic (KernelHandle* handle, const AMatrix& A)
+{
+  typedef typename KernelHandle::SPMVHandleType spmv_handle_type;
+  typedef typename AMatrix::execution_space execution_space;
+  typedef typename AMatrix::non_const_ordinal_type ordinal_type;
+  typedef typename AMatrix::non_const_size_type size_type;
+  typedef typename AMatrix::row_map_type row_map_type;
+  typedef typename AMatrix::index_type entries_type;
+  typedef Kokkos::View<size_type*, typename AMatrix::device_type> histogram_type;
+  typedef SPMV_InspectFunctor<row_map_type, entries_type, histogram_type> inspect_functor_type;
+  typedef Kokkos::RangePolicy<execution_space> range_policy_type;
+
+  spmv_handle_type* sh = handle->get_spmv_handle ();
+  const ordinal_type numRows = A.numRows ();
+  const ordinal_type numCols = A.numCols ();
+  const size_type nnz = A.nnz ();
+  sh->set_matrix_dimensions (numRows, numCols, nnz);
+
+  // Row lengths, bandwidth and row length histogram.
+  histogram_type histogram ("SPMV row length histogram", spmv_handle_type::num_histogram_buckets);
+  typename inspect_functor_type::value_type stats;
+  stats.min_row_length = 0;
+  stats.max_row_length = 0;
+  stats.bandwidth = 0;
+  if (numRows > 0) {
+    Kokkos::parallel_reduce ("KokkosSparse::spmv_symbolic::Inspect",
+                             range_policy_type (0, numRows),
+                             inspect_functor_type (A.graph.row_map, A.graph.entries, histogram),
+                             stats);
+  }
+  typename spmv_handle_type::row_length_histogram_t host_histogram
+    ("SPMV row length histogram", spmv_handle_type::num_histogram_buckets);
+  Kokkos::deep_copy (host_histogram, histogram);
+  sh->set_row_length_histogram (host_histogram);
+  sh->set_row_length_range (stats.min_row_length, stats.max_row_length);
+  sh->set_bandwidth (stats.bandwidth);
+
+  // Largest dense block size that tiles the matrix, if any.
+  ordinal_type block_size = 1;
+  for (ordinal_type bs = 8; bs > 1 && numRows > 0; --bs) {
+    if (numRows % bs != 0 || numCols % bs != 0 ||
+        stats.min_row_length % bs != 0 || stats.max_row_length % bs != 0) {
+      continue;
+    }
+    ordinal_type mismatches = 0;
+    Kokkos::parallel_reduce ("KokkosSparse::spmv_symbolic::BlockCheck",
+                             range_policy_type (0, numRows),
+                             SPMV_BlockCheckFunctor<row_map_type, entries_type>
+                             (A.graph.row_map, A.graph.entries, bs),
+                             mismatches);
+    if (mismatches == 0) {
+      block_size = bs;
+      break;
+    }
+  }
+  sh->set_block_size (block_size);
+
+  // Graph of the blocks, if A is to be applied as a BlockCrsMatrix.
+  sh->set_block_graph (typename spmv_handle_type::block_row_map_t (),
+                       typename spmv_handle_type::block_entries_t ());
+  if (block_size > 1 && sh->get_algorithm () == SPMVAlgorithm::SPMV_DEFAULT) {
+    typedef typename spmv_handle_type::block_row_map_t block_row_map_type;
+    typedef typename spmv_handle_type::block_entries_t block_entries_type;
+    const ordinal_type numBlockRows = numRows / block_size;
+    block_row_map_type block_row_map ("SPMV block row map", numBlockRows + 1);
+    block_entries_type block_entries (Kokkos::ViewAllocateWithoutInitializing ("SPMV block entries"),
+                                      nnz / (block_size * block_size));
+    Kokkos::parallel_for ("KokkosSparse::spmv_symbolic::BlockGraph",
+                          range_policy_type (0, numBlockRows),
+                          SPMV_BlockGraphFunctor<row_map_type, entries_type, block_row_map_type, block_entries_type>
+                          (A.graph.row_map, A.graph.entries, block_row_map, block_entries, block_size));
+    sh->set_block_graph (block_row_map, block_entries);
+  }
+
+  // Kernel.
+  SPMVAlgorithm algo = sh->get_algorithm ();
+  if (algo == SPMVAlgorithm::SPMV_DEFAULT) {
+    algo = spmv_merge_path_is_preferred<execution_space> (numRows, nnz, stats.max_row_length) ?
+      SPMVAlgorithm::SPMV_MERGE_PATH : SPMVAlgorithm::SPMV_NATIVE;
+  }
+  sh->set_chosen_algorithm (algo);
+
+  // Launch configuration of the native kernel.
+  int team_size = sh->get_team_size ();
+  int vector_length = sh->get_vector_size ();
+  int64_t rows_per_thread = -1;
+  int64_t num_teams = 0;
+  if (numRows > 0) {
+    const int64_t rows_per_team = spmv_launch_parameters<execution_space>
+      (numRows, nnz, rows_per_thread, team_size, vector_length);
+    num_teams = (static_cast<int64_t> (numRows) + rows_per_team - 1) / rows_per_team;
+  }
+  sh->set_launch_parameters (num_teams, team_size, vector_length);
+
+  // Row partitioning for the raw OpenMP kernel.
+  sh->set_row_block_offsets (typename spmv_handle_type::row_block_offsets_t ());
+#ifdef KOKKOS_ENABLE_OPENMP
+  if (std::is_same<execution_space, Kokkos::OpenMP>::value &&
+      algo == SPMVAlgorithm::SPMV_NATIVE && numRows > 0) {
+    typename AMatrix::staticcrsgraph_type graph = A.graph;
+    graph.create_block_partitioning (omp_get_max_threads ());
+    sh->set_row_block_offsets (graph.row_block_offsets);
+  }
+#endif
+
+  // The transpose and its coloring are built again when needed.
+  sh->reset_transpose ();
+
+  sh->set_inspected ();
+  if (sh->get_verbose ()) {
+    sh->print_plan ();
+  }
+}
+
+} // namespace Impl
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_IMPL_SPMV_SYMBOLIC_HPP_
@@ -0,0 +1,222 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_IMPL_SPMV_SYMMETRIC_HPP_
+#define KOKKOSSPARSE_IMPL_SPMV_SYMMETRIC_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+#include "KokkosBlas1_scal.hpp"
+#include "KokkosSparse_SymmetricCrsMatrix.hpp"
+#include <sstream>
+
+namespace KokkosSparse {
+namespace Impl {
+
+//! Largest number of colors for which spmv on a SymmetricCrsMatrix
+//! launches one kernel per color.  Beyond it (e.g. an arrow matrix,
+//! whose rows all share the first column, needs one color per row)
+//! the launches cost more than atomic updates of y, and all rows are
+//! processed in a single launch with atomics.
+constexpr int64_t spmv_symmetric_max_colors = 64;
+
+/// \brief y += alpha*A*x over the rows of one color of a
+///   SymmetricCrsMatrix, or over all of its rows.
+///
+/// Row i adds (D(i) + L(i,:))*x to y(i), and L(i,j)^T*x(i) (or its
+/// conjugate) to y(j) for every column j of the row.  Rows of the same
+/// color write disjoint entries of y, so no atomics are needed.
+///
+/// \tparam conjLower Whether to conjugate L and D.
+/// \tparam conjUpper Whether to conjugate the entries of L when they
+///   are used as the upper triangle.
+/// \tparam useAtomics Whether to process row k (rather than the k-th
+///   row of the color) and update y with atomics.
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         bool conjLower,
+         bool conjUpper,
+         bool useAtomics>
+struct SPMV_Symmetric_Functor {
+  typedef typename AMatrix::execution_space        execution_space;
+  typedef typename AMatrix::non_const_ordinal_type ordinal_type;
+  typedef typename AMatrix::non_const_size_type    size_type;
+  typedef typename AMatrix::non_const_value_type   A_value_type;
+  typedef typename YVector::non_const_value_type   y_value_type;
+  typedef Kokkos::Details::ArithTraits<A_value_type> ATV;
+
+  const y_value_type alpha;
+  AMatrix m_A;
+  XVector m_x;
+  YVector m_y;
+  //! First entry of this color in m_A.color_rows.
+  const size_type color_begin;
+
+  SPMV_Symmetric_Functor (const y_value_type& alpha_,
+                          const AMatrix& m_A_,
+                          const XVector& m_x_,
+                          const YVector& m_y_,
+                          const size_type color_begin_) :
+    alpha (alpha_), m_A (m_A_), m_x (m_x_), m_y (m_y_), color_begin (color_begin_)
+  {}
+
+  KOKKOS_INLINE_FUNCTION void
+  operator() (const ordinal_type k) const
+  {
+    const ordinal_type iRow = useAtomics ? k : m_A.color_rows(color_begin + k);
+    const auto row = m_A.lower.rowConst (iRow);
+    const A_value_type d = conjLower ? ATV::conj (m_A.diagonal(iRow)) : m_A.diagonal(iRow);
+    const ordinal_type numVecs = static_cast<ordinal_type> (m_x.extent (1));
+
+    for (ordinal_type v = 0; v < numVecs; ++v) {
+      const y_value_type alpha_x_i = alpha * m_x.access(iRow, v);
+      y_value_type sum = d * m_x.access(iRow, v);
+      for (ordinal_type iEntry = 0; iEntry < row.length; ++iEntry) {
+        const ordinal_type col = row.colidx(iEntry);
+        const A_value_type val = row.value(iEntry);
+        sum += (conjLower ? ATV::conj (val) : val) * m_x.access(col, v);
+        const y_value_type upper = (conjUpper ? ATV::conj (val) : val) * alpha_x_i;
+        if (useAtomics)
+          Kokkos::atomic_add (&m_y.access(col, v), upper);
+        else
+          m_y.access(col, v) += upper;
+      }
+      if (useAtomics)
+        Kokkos::atomic_add (&m_y.access(iRow, v), alpha * sum);
+      else
+        m_y.access(iRow, v) += alpha * sum;
+    }
+  }
+};
+
+template<class AMatrix,
+         class XVector,
+         class YVector,
+         bool conjLower,
+         bool conjUpper>
+void
+spmv_symmetric_colored (typename YVector::const_value_type& alpha,
+                        const AMatrix& A,
+                        const XVector& x,
+                        const YVector& y)
+{
+  typedef typename AMatrix::execution_space execution_space;
+  typedef typename AMatrix::non_const_ordinal_type ordinal_type;
+  typedef SPMV_Symmetric_Functor<AMatrix, XVector, YVector, conjLower, conjUpper, false> functor_type;
+  typedef SPMV_Symmetric_Functor<AMatrix, XVector, YVector, conjLower, conjUpper, true> atomic_functor_type;
+
+  if (A.numColors () > spmv_symmetric_max_colors) {
+    Kokkos::parallel_for ("KokkosSparse::spmv<Symmetric,Atomic>",
+                          Kokkos::RangePolicy<execution_space> (0, A.numRows ()),
+                          atomic_functor_type (alpha, A, x, y, 0));
+    return;
+  }
+
+  // One launch per color; a color depends on the updates of the
+  // previous colors, which the in-order execution space guarantees.
+  for (ordinal_type c = 0; c < A.numColors (); ++c) {
+    const auto begin = A.color_offsets(c);
+    const auto end = A.color_offsets(c + 1);
+    Kokkos::parallel_for ("KokkosSparse::spmv<Symmetric>",
+                          Kokkos::RangePolicy<execution_space> (0, end - begin),
+                          functor_type (alpha, A, x, y, begin));
+  }
+}
+
+/// \brief SpMV, y = beta*y + alpha*Op(A)*x, for a SymmetricCrsMatrix.
+///
+/// All four modes are supported.  A^T = A for a symmetric matrix and
+/// A^H = A for a Hermitian one; the remaining modes conjugate the
+/// stored values.
+template<class AMatrix, class XVector, class YVector>
+void
+spmv_symmetric (const char mode[],
+                typename YVector::const_value_type& alpha,
+                const AMatrix& A,
+                const XVector& x,
+                typename YVector::const_value_type& beta,
+                const YVector& y)
+{
+  typedef Kokkos::Details::ArithTraits<typename YVector::non_const_value_type> KAT;
+
+  const char m = mode[0];
+  const bool isN = (m == 'N' || m == 'n');
+  const bool isT = (m == 'T' || m == 't');
+  const bool isC = (m == 'C' || m == 'c');
+  const bool isH = (m == 'H' || m == 'h');
+  if (!isN && !isT && !isC && !isH) {
+    std::ostringstream os;
+    os << "KokkosSparse::spmv: Invalid mode \"" << mode << "\" for a SymmetricCrsMatrix.";
+    Kokkos::Impl::throw_runtime_exception (os.str ());
+  }
+
+  // The updates accumulate into y, so apply beta first.
+  if (beta != KAT::one ()) {
+    KokkosBlas::scal (y, beta, y);
+  }
+  if (alpha == KAT::zero () || A.numRows () <= 0) {
+    return;
+  }
+
+  const bool conjLower = A.isHermitian () ? (isT || isC) : (isC || isH);
+  const bool conjUpper = A.isHermitian () != conjLower;
+  if (conjLower) {
+    if (conjUpper)
+      spmv_symmetric_colored<AMatrix, XVector, YVector, true, true> (alpha, A, x, y);
+    else
+      spmv_symmetric_colored<AMatrix, XVector, YVector, true, false> (alpha, A, x, y);
+  }
+  else {
+    if (conjUpper)
+      spmv_symmetric_colored<AMatrix, XVector, YVector, false, true> (alpha, A, x, y);
+    else
+      spmv_symmetric_colored<AMatrix, XVector, YVector, false, false> (alpha, A, x, y);
+  }
+}
+
+} // namespace Impl
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_IMPL_SPMV_SYMMETRIC_HPP_
@@ -0,0 +1,204 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+
+#ifndef KOKKOSSPARSE_IMPL_SPMV_TRANSPOSE_HPP_
+#define KOKKOSSPARSE_IMPL_SPMV_TRANSPOSE_HPP_
+
+#include "Kokkos_Core.hpp"
+#include "Kokkos_ArithTraits.hpp"
+#include "KokkosBlas1_scal.hpp"
+#include "KokkosKernels_SparseUtils.hpp"
+#include "KokkosSparse_spmv_handle.hpp"
+#include "KokkosSparse_spmv_coloring_impl.hpp"
+#include "KokkosSparse_spgemm_transpose_impl.hpp"
+
+namespace KokkosSparse {
+namespace Impl {
+
+/// \brief Build the pattern of A^T and the position in A of each of
+///   its entries, and cache them in the SPMVHandle, unless they are
+///   already there.  Then gather the current values of A into the
+///   values of A^T, so changes to the values of A since the pattern was
+///   built are seen.
+template<class SPMVHandleType, class AMatrix>
+void
+spmv_transpose_build_explicit (SPMVHandleType* sh, const AMatrix& A)
+{
+  typedef typename SPMVHandleType::transpose_row_map_t row_map_type;
+  typedef typename SPMVHandleType::transpose_entries_t entries_type;
+  typedef typename SPMVHandleType::transpose_perm_t perm_type;
+  typedef typename SPMVHandleType::transpose_values_t values_type;
+  typedef typename AMatrix::execution_space execution_space;
+
+  if (!sh->is_transpose_built ()) {
+    row_map_type t_row_map ("KokkosSparse::spmv::transpose_row_map", A.numCols () + 1);
+    entries_type t_entries (Kokkos::ViewAllocateWithoutInitializing ("KokkosSparse::spmv::transpose_entries"), A.nnz ());
+    perm_type t_perm (Kokkos::ViewAllocateWithoutInitializing ("KokkosSparse::spmv::transpose_perm"), A.nnz ());
+    values_type t_values (Kokkos::ViewAllocateWithoutInitializing ("KokkosSparse::spmv::transpose_values"), A.nnz ());
+    spgemm_transpose_structure<execution_space>
+      (A.numRows (), A.numCols (), A.graph.row_map, A.graph.entries,
+       t_row_map, t_entries, t_perm);
+    sh->set_transpose (t_row_map, t_entries, t_perm, t_values);
+  }
+  spgemm_transpose_values<execution_space>
+    (sh->get_transpose_perm (), A.values, sh->get_transpose_values ());
+}
+
+/// \brief Color the rows of A for the colored transpose and cache the
+///   coloring in the SPMVHandle, unless it is already there.
+template<class SPMVHandleType, class AMatrix>
+void
+spmv_transpose_build_colors (SPMVHandleType* sh, const AMatrix& A)
+{
+  if (sh->are_transpose_colors_built ()) {
+    return;
+  }
+  typename SPMVHandleType::color_rows_t color_rows;
+  typename SPMVHandleType::color_offsets_t color_offsets;
+  spmv_scatter_coloring<typename AMatrix::execution_space>
+    (A.numRows (), A.numCols (), A.graph.row_map, A.graph.entries, color_rows, color_offsets);
+  sh->set_transpose_colors (color_rows, color_offsets);
+}
+
+/// \brief y(j) += alpha*A(i,j)*x(i) (or conj(A(i,j))) for the rows i of
+///   one color.
+///
+/// The rows of a color share no column, so each entry of y is updated
+/// by at most one row of the launch.
+template<class AMatrix,
+         class ColorRowsType,
+         class XVector,
+         class YVector,
+         bool conjugate>
+struct SPMV_Colored_Transpose_Functor {
+  typedef typename AMatrix::execution_space        execution_space;
+  typedef typename AMatrix::non_const_ordinal_type ordinal_type;
+  typedef typename AMatrix::non_const_size_type    size_type;
+  typedef typename AMatrix::non_const_value_type   A_value_type;
+  typedef typename YVector::non_const_value_type   y_value_type;
+
+  const y_value_type alpha;
+  AMatrix m_A;
+  ColorRowsType m_rows;
+  XVector m_x;
+  YVector m_y;
+  //! First entry of this color in m_rows.
+  const size_type color_begin;
+
+  SPMV_Colored_Transpose_Functor (const y_value_type& alpha_,
+                                  const AMatrix& m_A_,
+                                  const ColorRowsType& m_rows_,
+                                  const XVector& m_x_,
+                                  const YVector& m_y_,
+                                  const size_type color_begin_) :
+    alpha (alpha_), m_A (m_A_), m_rows (m_rows_), m_x (m_x_), m_y (m_y_),
+    color_begin (color_begin_)
+  {}
+
+  KOKKOS_INLINE_FUNCTION void
+  operator() (const ordinal_type k) const
+  {
+    const ordinal_type iRow = m_rows(color_begin + k);
+    const auto row = m_A.rowConst (iRow);
+    const ordinal_type numVecs = static_cast<ordinal_type> (m_x.extent (1));
+
+    for (ordinal_type v = 0; v < numVecs; ++v) {
+      const y_value_type alpha_x_i = alpha * m_x.access(iRow, v);
+      for (ordinal_type iEntry = 0; iEntry < row.length; ++iEntry) {
+        const A_value_type val = conjugate ?
+          Kokkos::Details::ArithTraits<A_value_type>::conj (row.value(iEntry)) :
+          row.value(iEntry);
+        m_y.access(row.colidx(iEntry), v) += val * alpha_x_i;
+      }
+    }
+  }
+};
+
+/// \brief y = beta*y + alpha*Op(A)*x for Op = transpose ("T") or
+///   conjugate transpose ("H"), one color of rows at a time.
+template<class AMatrix, class ColorRowsType, class ColorOffsetsType, class XVector, class YVector>
+void
+spmv_transpose_colored (const char mode[],
+                        typename YVector::const_value_type& alpha,
+                        const AMatrix& A,
+                        const ColorRowsType& color_rows,
+                        const ColorOffsetsType& color_offsets,
+                        const XVector& x,
+                        typename YVector::const_value_type& beta,
+                        const YVector& y)
+{
+  typedef typename AMatrix::execution_space execution_space;
+  typedef Kokkos::Details::ArithTraits<typename YVector::non_const_value_type> KAT;
+
+  // The updates accumulate into y, so apply beta first.
+  if (beta != KAT::one ()) {
+    KokkosBlas::scal (y, beta, y);
+  }
+  if (alpha == KAT::zero () || A.numRows () <= 0) {
+    return;
+  }
+
+  const bool conjugate = (mode[0] == 'H' || mode[0] == 'h');
+  for (size_t c = 0; c + 1 < color_offsets.extent (0); ++c) {
+    const auto begin = color_offsets(c);
+    const auto end = color_offsets(c + 1);
+    if (conjugate) {
+      typedef SPMV_Colored_Transpose_Functor<AMatrix, ColorRowsType, XVector, YVector, true> functor_type;
+      Kokkos::parallel_for ("KokkosSparse::spmv<Transpose,Colored>",
+                            Kokkos::RangePolicy<execution_space> (0, end - begin),
+                            functor_type (alpha, A, color_rows, x, y, begin));
+    }
+    else {
+      typedef SPMV_Colored_Transpose_Functor<AMatrix, ColorRowsType, XVector, YVector, false> functor_type;
+      Kokkos::parallel_for ("KokkosSparse::spmv<Transpose,Colored>",
+                            Kokkos::RangePolicy<execution_space> (0, end - begin),
+                            functor_type (alpha, A, color_rows, x, y, begin));
+    }
+  }
+}
+
+} // namespace Impl
+} // namespace KokkosSparse
+
+#endif // KOKKOSSPARSE_IMPL_SPMV_TRANSPOSE_HPP_
@@ -3319,6 +3319,294 @@ cudaProfilerStop();
 
 } // end tri_solve_chain
 
+
+// Sync-free solve of one row: wait until the rows it depends on are
+// solved, then solve it and publish its completion flag. Rows are visited in
+// dependency order (reversed for upper tri) and every thread takes its rows
+// in increasing iteration order, so the smallest unsolved row can always
+// make progress and no barrier between levels is needed.
+template <class RowMapType, class EntriesType, class ValuesType, class LHSType, class RHSType, class DepsType, class ReadyType>
+struct TriSyncFreeSolverFunctor
+{
+  typedef typename EntriesType::non_const_value_type lno_t;
+  typedef typename ValuesType::non_const_value_type scalar_t;
+
+  RowMapType row_map;
+  EntriesType entries;
+  ValuesType values;
+  LHSType lhs;
+  RHSType rhs;
+  DepsType dependencies;
+  ReadyType ready;
+  lno_t nrows;
+  bool is_lowertri;
+
+  TriSyncFreeSolverFunctor( const RowMapType &row_map_, const EntriesType &entries_, const ValuesType &values_, LHSType &lhs_, const RHSType &rhs_, const DepsType &dependencies_, const ReadyType &ready_, const lno_t nrows_, const bool is_lowertri_ ) :
+    row_map(row_map_), entries(entries_), values(values_), lhs(lhs_), rhs(rhs_), dependencies(dependencies_), ready(ready_), nrows(nrows_), is_lowertri(is_lowertri_) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const lno_t i) const {
+    const lno_t rowid = is_lowertri ? i : nrows - 1 - i;
+    const auto soffset = row_map(rowid);
+    const auto eoffset = row_map(rowid+1);
+
+    if ( dependencies(rowid) != 0 ) {
+      for ( auto ptr = soffset; ptr < eoffset; ++ptr ) {
+        const lno_t colid = entries(ptr);
+        if ( colid != rowid ) {
+          while ( Kokkos::volatile_load(&ready(colid)) == 0 ) {}
+        }
+      }
+      // lhs of the dependencies is read only after all flags were seen
+      Kokkos::memory_fence();
+    }
+
+    scalar_t rhs_rowid = rhs(rowid);
+    scalar_t diag = Kokkos::Details::ArithTraits<scalar_t>::one();
+    for ( auto ptr = soffset; ptr < eoffset; ++ptr ) {
+      const lno_t colid = entries(ptr);
+      if ( colid != rowid ) {
+        rhs_rowid = rhs_rowid - values(ptr)*lhs(colid);
+      }
+      else {
+        diag = values(ptr);
+      }
+    }
+    lhs(rowid) = rhs_rowid/diag;
+
+    // lhs(rowid) must be visible before its flag
+    Kokkos::memory_fence();
+    Kokkos::atomic_assign(&ready(rowid), 1);
+  }
+};
+
+
+template < class TriSolveHandle, class RowMapType, class EntriesType, class ValuesType, class RHSType, class LHSType >
+void tri_solve_syncfree(TriSolveHandle & thandle, const RowMapType row_map, const EntriesType entries, const ValuesType values, const RHSType & rhs, LHSType &lhs, const bool is_lowertri) {
+
+  typedef typename TriSolveHandle::execution_space execution_space;
+  typedef typename TriSolveHandle::nnz_lno_t lno_t;
+  typedef typename TriSolveHandle::nnz_lno_view_t DepsType;
+  typedef typename TriSolveHandle::int_view_t ReadyType;
+
+  const lno_t nrows = row_map.extent(0)-1;
+  DepsType dependencies = thandle.get_syncfree_dependencies();
+  ReadyType ready = thandle.get_syncfree_ready();
+  Kokkos::deep_copy(ready, 0);
+
+  // Static schedule: each thread owns its rows for the whole solve
+  Kokkos::parallel_for( "parfor_syncfree", Kokkos::RangePolicy<execution_space, Kokkos::Schedule<Kokkos::Static> >(0, nrows),
+      TriSyncFreeSolverFunctor<RowMapType, EntriesType, ValuesType, LHSType, RHSType, DepsType, ReadyType> (row_map, entries, values, lhs, rhs, dependencies, ready, nrows, is_lowertri) );
+
+} // end tri_solve_syncfree
+
+
+// Initial iterate of the Jacobi sweeps, fused with the inverse diagonal:
+// dinv(i) = 1/a_ii, x(i) = dinv(i)*b(i)
+template <class ValuesType, class OffsetsType, class DinvType, class RHSType, class XType>
+struct TriJacobiInitFunctor
+{
+  typedef typename OffsetsType::non_const_value_type size_type;
+  typedef typename DinvType::non_const_value_type scalar_t;
+
+  ValuesType values;
+  OffsetsType diagonal_offsets;
+  DinvType dinv;
+  RHSType rhs;
+  XType x;
+
+  TriJacobiInitFunctor( const ValuesType &values_, const OffsetsType &diagonal_offsets_, const DinvType &dinv_, const RHSType &rhs_, const XType &x_ ) :
+    values(values_), diagonal_offsets(diagonal_offsets_), dinv(dinv_), rhs(rhs_), x(x_) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const size_type rowid) const {
+    const scalar_t dinv_rowid = Kokkos::Details::ArithTraits<scalar_t>::one() / values(diagonal_offsets(rowid));
+    dinv(rowid) = dinv_rowid;
+    x(rowid) = dinv_rowid*rhs(rowid);
+  }
+};
+
+// One Jacobi sweep: xnew(i) = dinv(i)*(b(i) - sum_{j != i} a_ij*xold(j))
+template <class RowMapType, class EntriesType, class ValuesType, class DinvType, class RHSType, class XOldType, class XNewType>
+struct TriJacobiSweepFunctor
+{
+  typedef typename EntriesType::non_const_value_type lno_t;
+  typedef typename DinvType::non_const_value_type scalar_t;
+
+  RowMapType row_map;
+  EntriesType entries;
+  ValuesType values;
+  DinvType dinv;
+  RHSType rhs;
+  XOldType xold;
+  XNewType xnew;
+
+  TriJacobiSweepFunctor( const RowMapType &row_map_, const EntriesType &entries_, const ValuesType &values_, const DinvType &dinv_, const RHSType &rhs_, const XOldType &xold_, const XNewType &xnew_ ) :
+    row_map(row_map_), entries(entries_), values(values_), dinv(dinv_), rhs(rhs_), xold(xold_), xnew(xnew_) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const lno_t rowid) const {
+    scalar_t rhs_rowid = rhs(rowid);
+    for ( auto ptr = row_map(rowid); ptr < row_map(rowid+1); ++ptr ) {
+      const lno_t colid = entries(ptr);
+      if ( colid != rowid ) {
+        rhs_rowid = rhs_rowid - values(ptr)*xold(colid);
+      }
+    }
+    xnew(rowid) = dinv(rowid)*rhs_rowid;
+  }
+};
+
+
+// Approximate solve by a fixed number of Jacobi sweeps. Every sweep is a
+// single SpMV-like pass without dependencies between rows; for a triangular
+// matrix the iteration is exact after as many sweeps as there are levels
+// minus one. The iterates alternate between lhs and the handle's work view,
+// starting so that the last one lands in lhs.
+template < class TriSolveHandle, class RowMapType, class EntriesType, class ValuesType, class RHSType, class LHSType >
+void tri_solve_jacobi_sweeps(TriSolveHandle & thandle, const RowMapType row_map, const EntriesType entries, const ValuesType values, const RHSType & rhs, LHSType &lhs) {
+
+  typedef typename TriSolveHandle::execution_space execution_space;
+  typedef typename TriSolveHandle::nnz_lno_t lno_t;
+  typedef typename TriSolveHandle::nnz_row_view_t OffsetsType;
+  typedef typename TriSolveHandle::nnz_scalar_view_t ScalarType;
+
+  typedef TriJacobiSweepFunctor<RowMapType, EntriesType, ValuesType, ScalarType, RHSType, LHSType, ScalarType> SweepToWorkFunctor;
+  typedef TriJacobiSweepFunctor<RowMapType, EntriesType, ValuesType, ScalarType, RHSType, ScalarType, LHSType> SweepToLHSFunctor;
+
+  const lno_t nrows = row_map.extent(0)-1;
+  const int num_sweeps = thandle.get_num_jacobi_sweeps();
+  OffsetsType diagonal_offsets = thandle.get_jacobi_diagonal_offsets();
+  ScalarType dinv = thandle.get_jacobi_inverse_diagonal();
+  ScalarType work = thandle.get_jacobi_work();
+
+  Kokkos::RangePolicy<execution_space> policy(0, nrows);
+  if ( num_sweeps % 2 == 0 ) {
+    Kokkos::parallel_for( "parfor_jacobi_init", policy,
+        TriJacobiInitFunctor<ValuesType, OffsetsType, ScalarType, RHSType, LHSType> (values, diagonal_offsets, dinv, rhs, lhs) );
+  }
+  else {
+    Kokkos::parallel_for( "parfor_jacobi_init", policy,
+        TriJacobiInitFunctor<ValuesType, OffsetsType, ScalarType, RHSType, ScalarType> (values, diagonal_offsets, dinv, rhs, work) );
+  }
+
+  for ( int sweep = num_sweeps; sweep > 0; --sweep ) {
+    if ( sweep % 2 == 0 ) {
+      Kokkos::parallel_for( "parfor_jacobi_sweep", policy,
+          SweepToWorkFunctor (row_map, entries, values, dinv, rhs, lhs, work) );
+    }
+    else {
+      Kokkos::parallel_for( "parfor_jacobi_sweep", policy,
+          SweepToLHSFunctor (row_map, entries, values, dinv, rhs, work, lhs) );
+    }
+  }
+
+} // end tri_solve_jacobi_sweeps
+
+// Every sweep re-reads rhs, so an rhs sharing its storage with lhs is
+// copied once before the first iterate overwrites it.
+template < class TriSolveHandle, class RowMapType, class EntriesType, class ValuesType, class RHSType, class LHSType >
+void tri_solve_jacobi(TriSolveHandle & thandle, const RowMapType row_map, const EntriesType entries, const ValuesType values, const RHSType & rhs, LHSType &lhs) {
+
+  typedef typename TriSolveHandle::nnz_scalar_view_t ScalarType;
+
+  if ( rhs.extent(0) != 0 && rhs.data() == lhs.data() ) {
+    ScalarType rhs_copy( Kokkos::ViewAllocateWithoutInitializing("jacobi_rhs_copy"), rhs.extent(0) );
+    Kokkos::deep_copy( rhs_copy, rhs );
+    tri_solve_jacobi_sweeps( thandle, row_map, entries, values, rhs_copy, lhs );
+  }
+  else {
+    tri_solve_jacobi_sweeps( thandle, row_map, entries, values, rhs, lhs );
+  }
+
+} // end tri_solve_jacobi
+
+
+// dst(i) = src(map(i))
+template <class DstType, class SrcType, class MapType>
+struct TriReorderGatherFunctor
+{
+  typedef typename MapType::non_const_value_type ordinal_t;
+  DstType dst;
+  SrcType src;
+  MapType map;
+
+  TriReorderGatherFunctor( const DstType &dst_, const SrcType &src_, const MapType &map_ ) :
+    dst(dst_), src(src_), map(map_) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const ordinal_t i) const {
+    dst(i) = src(map(i));
+  }
+};
+
+// dst(map(i)) = src(i)
+template <class DstType, class SrcType, class MapType>
+struct TriReorderScatterFunctor
+{
+  typedef typename MapType::non_const_value_type ordinal_t;
+  DstType dst;
+  SrcType src;
+  MapType map;
+
+  TriReorderScatterFunctor( const DstType &dst_, const SrcType &src_, const MapType &map_ ) :
+    dst(dst_), src(src_), map(map_) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const ordinal_t i) const {
+    dst(map(i)) = src(i);
+  }
+};
+
+
+// Level scheduled solve on the matrix reordered by tri_reorder_by_level:
+// values and rhs are gathered into the level ordering, the rows of each
+// level (or chain of levels) are then a contiguous range, and the solution
+// is scattered back to the original ordering.  The values are gathered only
+// on the first solve, or after set_values_changed on the handle.
+template < class TriSolveHandle, class ValuesType, class RHSType, class LHSType >
+void tri_solve_reordered(TriSolveHandle & thandle, const ValuesType values, const RHSType & rhs, LHSType &lhs, const bool is_lowertri) {
+
+  typedef typename TriSolveHandle::execution_space execution_space;
+  typedef typename TriSolveHandle::nnz_lno_view_t PermType;
+  typedef typename TriSolveHandle::nnz_row_view_t RowMapType;
+  typedef typename TriSolveHandle::nnz_lno_view_t EntriesType;
+  typedef typename TriSolveHandle::nnz_scalar_view_t ScalarType;
+
+  PermType perm = thandle.get_reorder_perm();
+  RowMapType row_map = thandle.get_reorder_row_map();
+  EntriesType entries = thandle.get_reorder_entries();
+  RowMapType value_map = thandle.get_reorder_value_map();
+  ScalarType rvalues = thandle.get_reorder_values();
+  ScalarType rrhs = thandle.get_reorder_rhs();
+  ScalarType rlhs = thandle.get_reorder_lhs();
+
+  const size_t nrows = perm.extent(0);
+  const size_t nnz = entries.extent(0);
+
+  if ( !thandle.is_reorder_values_gathered(values.data()) ) {
+    Kokkos::parallel_for( "sptrsv_reorder_values", Kokkos::RangePolicy<execution_space>(0, nnz),
+        TriReorderGatherFunctor<ScalarType, ValuesType, RowMapType>(rvalues, values, value_map) );
+    thandle.set_reorder_values_gathered(values.data());
+  }
+  Kokkos::parallel_for( "sptrsv_reorder_rhs", Kokkos::RangePolicy<execution_space>(0, nrows),
+      TriReorderGatherFunctor<ScalarType, RHSType, PermType>(rrhs, rhs, perm) );
+
+  if ( thandle.get_algorithm() == KokkosSparse::Experimental::SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN ) {
+    tri_solve_chain( thandle, row_map, entries, rvalues, rrhs, rlhs, is_lowertri );
+  }
+  else if ( is_lowertri ) {
+    lower_tri_solve( thandle, row_map, entries, rvalues, rrhs, rlhs );
+  }
+  else {
+    upper_tri_solve( thandle, row_map, entries, rvalues, rrhs, rlhs );
+  }
+
+  Kokkos::parallel_for( "sptrsv_reorder_lhs", Kokkos::RangePolicy<execution_space>(0, nrows),
+      TriReorderScatterFunctor<LHSType, ScalarType, PermType>(lhs, rlhs, perm) );
+
+} // end tri_solve_reordered
+
 } // namespace Experimental
 } // namespace Impl
 } // namespace KokkosSparse
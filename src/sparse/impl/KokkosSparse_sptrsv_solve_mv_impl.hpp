@@ -0,0 +1,1026 @@
+/*
+//@HEADER
+// ************************************************************************
+//
+//                        Kokkos v. 3.0
+//       Copyright (2020) National Technology & Engineering
+//               Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Siva Rajamanickam (srajama@sandia.gov)
+//
+// ************************************************************************
+//@HEADER
+*/
+#ifndef KOKKOSSPARSE_IMPL_SPTRSV_SOLVE_MV_HPP_
+#define KOKKOSSPARSE_IMPL_SPTRSV_SOLVE_MV_HPP_
+
+/// \file KokkosSparse_sptrsv_solve_mv_impl.hpp
+/// \brief Level scheduled and supernodal sparse triangular solves with
+///   multiple right-hand sides.
+///
+/// These kernels do not go through ETI, so this header is included
+/// whether or not KOKKOSKERNELS_ETI_ONLY is defined.
+
+#include <KokkosKernels_config.h>
+#include <Kokkos_Core.hpp>
+#include <Kokkos_ArithTraits.hpp>
+#include <KokkosSparse_sptrsv_handle.hpp>
+
+#ifdef KOKKOSKERNELS_ENABLE_SUPERNODAL_SPTRSV
+ #include "KokkosBlas3_gemm.hpp"
+ #include "KokkosSparse_spmv.hpp"
+
+ #include "KokkosBatched_Util.hpp"
+
+ #include "KokkosBatched_Gemm_Decl.hpp"
+ #include "KokkosBatched_Gemm_Team_Impl.hpp"
+#endif
+
+namespace KokkosSparse {
+namespace Impl {
+namespace Experimental {
+
+// Tag for the chained levels of SEQLVLSCHD_TP1CHAIN, run by a single team
+struct ChainMVTag {};
+
+// Multivector level scheduled solve of one row for all right-hand sides:
+// the row of the matrix is read once per tile of columns (RangePolicy) or
+// once per column spread across the team (TeamPolicy), so the barriers
+// between levels are shared by all right-hand sides.
+template <class RowMapType, class EntriesType, class ValuesType, class LHSType, class RHSType, class NGBLType>
+struct TriLvlSchedMVSolverFunctor
+{
+  typedef typename RowMapType::execution_space execution_space;
+  typedef Kokkos::TeamPolicy<execution_space> policy_type;
+  typedef typename policy_type::member_type member_type;
+  typedef typename EntriesType::non_const_value_type lno_t;
+  typedef typename ValuesType::non_const_value_type scalar_t;
+
+  // Number of right-hand sides whose partial sums one thread keeps in
+  // registers in the RangePolicy kernel
+  enum : int { num_tile_columns = 8 };
+
+  RowMapType row_map;
+  EntriesType entries;
+  ValuesType values;
+  LHSType lhs;
+  RHSType rhs;
+  NGBLType nodes_grouped_by_level;
+  NGBLType nodes_per_level;
+  long node_count;
+  long lvl_start;
+  long lvl_end;
+
+  TriLvlSchedMVSolverFunctor( const RowMapType &row_map_, const EntriesType &entries_, const ValuesType &values_, LHSType &lhs_, const RHSType &rhs_, const NGBLType &nodes_grouped_by_level_, long node_count_ = 0 ) :
+    row_map(row_map_), entries(entries_), values(values_), lhs(lhs_), rhs(rhs_), nodes_grouped_by_level(nodes_grouped_by_level_), node_count(node_count_), lvl_start(0), lvl_end(0) {}
+
+  // Chained levels [lvl_start, lvl_end), starting at node_count
+  TriLvlSchedMVSolverFunctor( const RowMapType &row_map_, const EntriesType &entries_, const ValuesType &values_, LHSType &lhs_, const RHSType &rhs_, const NGBLType &nodes_grouped_by_level_, const NGBLType &nodes_per_level_, long node_count_, long lvl_start_, long lvl_end_ ) :
+    row_map(row_map_), entries(entries_), values(values_), lhs(lhs_), rhs(rhs_), nodes_grouped_by_level(nodes_grouped_by_level_), nodes_per_level(nodes_per_level_), node_count(node_count_), lvl_start(lvl_start_), lvl_end(lvl_end_) {}
+
+  // Solves row rowid of the k-th right-hand side
+  KOKKOS_INLINE_FUNCTION
+  void solve_entry( const lno_t rowid, const lno_t k ) const {
+    const auto soffset = row_map(rowid);
+    const auto eoffset = row_map(rowid+1);
+
+    scalar_t rhs_rowid = rhs(rowid, k);
+    scalar_t diag = Kokkos::Details::ArithTraits<scalar_t>::one();
+    for ( auto ptr = soffset; ptr < eoffset; ++ptr ) {
+      const lno_t colid = entries(ptr);
+      if ( colid != rowid ) {
+        rhs_rowid = rhs_rowid - values(ptr)*lhs(colid, k);
+      }
+      else {
+        diag = values(ptr);
+      }
+    }
+    lhs(rowid, k) = rhs_rowid/diag;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const lno_t i) const {
+    const lno_t rowid = nodes_grouped_by_level(i);
+    const lno_t nrhs = static_cast<lno_t>(lhs.extent(1));
+    const auto soffset = row_map(rowid);
+    const auto eoffset = row_map(rowid+1);
+
+    // rhs is read into the sums before lhs is written, as in the rank-1
+    // solve they may alias
+    for ( lno_t k0 = 0; k0 < nrhs; k0 += num_tile_columns ) {
+      const lno_t ncols = ( nrhs - k0 < num_tile_columns ) ? nrhs - k0 : static_cast<lno_t>(num_tile_columns);
+
+      scalar_t sum[num_tile_columns];
+      for ( lno_t k = 0; k < ncols; ++k ) {
+        sum[k] = rhs(rowid, k0+k);
+      }
+
+      scalar_t diag = Kokkos::Details::ArithTraits<scalar_t>::one();
+      for ( auto ptr = soffset; ptr < eoffset; ++ptr ) {
+        const lno_t colid = entries(ptr);
+        const scalar_t val = values(ptr);
+        if ( colid != rowid ) {
+          for ( lno_t k = 0; k < ncols; ++k ) {
+            sum[k] -= val*lhs(colid, k0+k);
+          }
+        }
+        else {
+          diag = val;
+        }
+      }
+
+      for ( lno_t k = 0; k < ncols; ++k ) {
+        lhs(rowid, k0+k) = sum[k]/diag;
+      }
+    }
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()( const member_type & team ) const {
+    const lno_t rowid = nodes_grouped_by_level(team.league_rank() + node_count);
+
+    Kokkos::parallel_for( Kokkos::TeamThreadRange( team, static_cast<lno_t>(lhs.extent(1)) ), [&] ( const lno_t k ) {
+      solve_entry(rowid, k);
+    });
+  }
+
+  // One team walks the chained levels, with a barrier between levels; the
+  // (row, right-hand side) pairs of a level are spread across the team.
+  KOKKOS_INLINE_FUNCTION
+  void operator()( const ChainMVTag&, const member_type & team ) const {
+    const lno_t nrhs = static_cast<lno_t>(lhs.extent(1));
+    long lvl_node_count = node_count;
+
+    for ( long lvl = lvl_start; lvl < lvl_end; ++lvl ) {
+      const lno_t nodes_this_lvl = nodes_per_level(lvl);
+
+      Kokkos::parallel_for( Kokkos::TeamThreadRange( team, nodes_this_lvl*nrhs ), [&] ( const lno_t ik ) {
+        const lno_t rowid = nodes_grouped_by_level(lvl_node_count + ik/nrhs);
+        solve_entry(rowid, ik%nrhs);
+      });
+      lvl_node_count += nodes_this_lvl;
+      team.team_barrier();
+    }
+  }
+};
+
+
+// Multivector solve for SEQLVLSCHD_RP (one thread per row),
+// SEQLVLSCHD_TP1 (one team per row, threads over the right-hand sides) and
+// SEQLVLSCHD_TP1CHAIN (as TP1, but each chain of levels is run by a single
+// team in one launch); rhs and lhs are rank-2 views with one column per
+// right-hand side.
+template < class TriSolveHandle, class RowMapType, class EntriesType, class ValuesType, class RHSType, class LHSType >
+void tri_solve_mv(TriSolveHandle & thandle, const RowMapType row_map, const EntriesType entries, const ValuesType values, const RHSType & rhs, LHSType &lhs) {
+
+  typedef typename TriSolveHandle::execution_space execution_space;
+  typedef typename TriSolveHandle::size_type size_type;
+  typedef typename TriSolveHandle::nnz_lno_view_t NGBLType;
+  typedef TriLvlSchedMVSolverFunctor<RowMapType, EntriesType, ValuesType, LHSType, RHSType, NGBLType> functor_type;
+  typedef Kokkos::TeamPolicy<execution_space> policy_type;
+
+  auto nlevels = thandle.get_num_levels();
+  auto hnodes_per_level = thandle.get_host_nodes_per_level();
+  auto nodes_grouped_by_level = thandle.get_nodes_grouped_by_level();
+  int team_size = thandle.get_team_size();
+
+  size_type node_count = 0;
+  if ( thandle.get_algorithm() == KokkosSparse::Experimental::SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN ) {
+    typedef Kokkos::TeamPolicy<ChainMVTag, execution_space> chain_policy_type;
+
+    auto h_chain_ptr = thandle.get_host_chain_ptr();
+    size_type num_chain_entries = thandle.get_num_chain_entries();
+    auto nodes_per_level = thandle.get_nodes_per_level();
+
+    for ( size_type chainlink = 0; chainlink < num_chain_entries; ++chainlink ) {
+      size_type schain = h_chain_ptr(chainlink);
+      size_type echain = h_chain_ptr(chainlink+1);
+
+      if ( echain - schain == 1 ) {
+        size_type lvl_nodes = hnodes_per_level(schain);
+        functor_type tstf (row_map, entries, values, lhs, rhs, nodes_grouped_by_level, node_count);
+        if ( team_size == -1 )
+          Kokkos::parallel_for("parfor_team_chain1_mv", policy_type( lvl_nodes , Kokkos::AUTO ), tstf);
+        else
+          Kokkos::parallel_for("parfor_team_chain1_mv", policy_type( lvl_nodes , team_size ), tstf);
+        node_count += lvl_nodes;
+      }
+      else {
+        functor_type tstf (row_map, entries, values, lhs, rhs, nodes_grouped_by_level, nodes_per_level, node_count, schain, echain);
+        if ( team_size == -1 )
+          Kokkos::parallel_for("parfor_team_chainmulti_mv", chain_policy_type( 1 , Kokkos::AUTO ), tstf);
+        else
+          Kokkos::parallel_for("parfor_team_chainmulti_mv", chain_policy_type( 1 , team_size ), tstf);
+        for ( size_type i = schain; i < echain; ++i ) {
+          node_count += hnodes_per_level(i);
+        }
+      }
+    }
+    return;
+  }
+
+  for ( size_type lvl = 0; lvl < nlevels; ++lvl ) {
+    size_type lvl_nodes = hnodes_per_level(lvl);
+
+    if ( lvl_nodes != 0 ) {
+      if ( thandle.get_algorithm() == KokkosSparse::Experimental::SPTRSVAlgorithm::SEQLVLSCHD_RP ) {
+        Kokkos::parallel_for( "parfor_fixed_lvl_mv", Kokkos::RangePolicy<execution_space>( node_count, node_count+lvl_nodes ),
+            functor_type (row_map, entries, values, lhs, rhs, nodes_grouped_by_level) );
+      }
+      else {
+        functor_type tstf (row_map, entries, values, lhs, rhs, nodes_grouped_by_level, node_count);
+        if ( team_size == -1 )
+          Kokkos::parallel_for("parfor_team_mv", policy_type( lvl_nodes , Kokkos::AUTO ), tstf);
+        else
+          Kokkos::parallel_for("parfor_team_mv", policy_type( lvl_nodes , team_size ), tstf);
+      }
+      node_count += lvl_nodes;
+    }
+  }
+
+} // end tri_solve_mv
+
+
+#if defined(KOKKOSKERNELS_ENABLE_SUPERNODAL_SPTRSV)
+// -----------------------------------------------------------
+// Supernodal solves with multiple right-hand sides.  These follow the
+// rank-1 supernodal functors in KokkosSparse_sptrsv_solve_impl.hpp, with the
+// GEMV on each supernodal block replaced by a GEMM on all right-hand sides.
+// The workspace is rank-2, with one column per right-hand side and the same
+// row offsets as the workspace in the handle.
+
+// Copies between X and the workspace for the diagonal blocks (SpMV variants)
+template <class LHSType, class WorkType, class NGBLType>
+struct SparseTriSupernodalMVSpMVFunctor
+{
+  using execution_space = typename LHSType::execution_space;
+
+  using policy_type = Kokkos::TeamPolicy<execution_space>;
+  using member_type = typename policy_type::member_type;
+
+  using scalar_t = typename LHSType::non_const_value_type;
+
+  int flag;
+  long node_count;
+  NGBLType nodes_grouped_by_level;
+
+  const int *supercols;
+
+  LHSType X;
+  WorkType work;
+
+  // constructor
+  SparseTriSupernodalMVSpMVFunctor (int flag_,
+                                    long  node_count_,
+                                    const NGBLType &nodes_grouped_by_level_,
+                                    const int *supercols_,
+                                    LHSType &X_,
+                                    WorkType work_) :
+    flag(flag_), node_count(node_count_), nodes_grouped_by_level(nodes_grouped_by_level_), supercols(supercols_),
+    X(X_), work(work_) {
+  }
+
+  // operator
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const member_type & team) const {
+    const int league_rank = team.league_rank(); // batch id
+    const int team_size = team.team_size ();
+    const int team_rank = team.team_rank ();
+    const scalar_t zero (0.0);
+
+    auto s = nodes_grouped_by_level (node_count + league_rank);
+
+    int j1 = supercols[s];
+    int j2 = supercols[s+1];
+    int nscol = j2 - j1 ;       // number of columns in the s-th supernode column
+    int nrhs = X.extent (1);
+    if (flag == -1) {
+      // copy work to X
+      for (int jk = team_rank; jk < nscol*nrhs; jk += team_size) {
+        X (j1 + jk%nscol, jk/nscol) = work (j1 + jk%nscol, jk/nscol);
+      }
+    } else if (flag == 1) {
+      // copy X to work, and zero out X
+      for (int jk = team_rank; jk < nscol*nrhs; jk += team_size) {
+        work (j1 + jk%nscol, jk/nscol) = X (j1 + jk%nscol, jk/nscol);
+        X (j1 + jk%nscol, jk/nscol) = zero;
+      }
+    } else {
+      // reinitialize work to zero
+      for (int jk = team_rank; jk < nscol*nrhs; jk += team_size) {
+        work (j1 + jk%nscol, jk/nscol) = zero;
+      }
+    }
+    team.team_barrier ();
+  }
+};
+
+
+// -----------------------------------------------------------
+// Functor for Lower-triangular solve
+template <class ColptrView, class RowindType, class ValuesType, class LHSType, class WorkType, class NGBLType>
+struct LowerTriSupernodalMVFunctor
+{
+  using execution_space = typename LHSType::execution_space;
+  using memory_space = typename execution_space::memory_space;
+
+  using policy_type =  Kokkos::TeamPolicy<execution_space>;
+  using member_type = typename policy_type::member_type;
+
+  using scalar_t = typename ValuesType::non_const_value_type;
+
+  using integer_view_t = Kokkos::View<int*, memory_space>;
+
+  using SupernodeView = typename Kokkos::View<scalar_t**, Kokkos::LayoutLeft,
+                                              memory_space, Kokkos::MemoryUnmanaged>;
+
+  using range_type = Kokkos::pair<int, int>;
+
+  bool invert_offdiagonal;
+  const int *supercols;
+  ColptrView colptr;
+  RowindType rowind;
+  ValuesType values;
+
+  int level;
+  integer_view_t diag_kernel_type;
+
+  LHSType X;
+
+  WorkType work; // needed with gemm for update&scatter
+  integer_view_t work_offset;
+
+  NGBLType nodes_grouped_by_level;
+
+  long node_count;
+
+  // constructor
+  LowerTriSupernodalMVFunctor (// supernode info
+                               const bool invert_offdiagonal_,
+                               const int *supercols_,
+                               // L in CSC
+                               const ColptrView  &colptr_,
+                               const RowindType &rowind_,
+                               const ValuesType &values_,
+                               // option to pick kernel type
+                               int level_,
+                               integer_view_t &diag_kernel_type_,
+                               // right-hand-sides (input), solutions (output)
+                               LHSType &X_,
+                               // workspace
+                               WorkType work_,
+                               integer_view_t &work_offset_,
+                               //
+                               const NGBLType &nodes_grouped_by_level_,
+                               long  node_count_) :
+    invert_offdiagonal(invert_offdiagonal_), supercols(supercols_),
+    colptr(colptr_), rowind(rowind_), values(values_),
+    level(level_), diag_kernel_type(diag_kernel_type_),
+    X(X_), work(work_), work_offset(work_offset_),
+    nodes_grouped_by_level(nodes_grouped_by_level_), node_count(node_count_) {
+  }
+
+  // operator
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const member_type & team) const {
+    const int league_rank = team.league_rank(); // batch id
+    const int team_size = team.team_size ();
+    const int team_rank = team.team_rank ();
+    const scalar_t zero (0.0);
+    const scalar_t one (1.0);
+
+    auto s = nodes_grouped_by_level (node_count + league_rank);
+
+    // supernodal column size
+    int j1 = supercols[s];
+    int j2 = supercols[s+1];
+    int nscol = j2 - j1 ;       // number of columns in the s-th supernode column
+
+    int i1 = colptr (j1);
+    int i2 = colptr (j1+1);
+    int nsrow  = i2 - i1;       // "total" number of rows in all the supernodes (diagonal+off-diagonal)
+    int nsrow2 = nsrow - nscol; // "total" number of rows in all the off-diagonal supernodes
+    int nrhs = X.extent (1);
+
+    // create a view for the s-th supernocal column
+    scalar_t *dataL = const_cast<scalar_t*> (values.data ());
+    SupernodeView viewL (&dataL[i1], nsrow, nscol);
+
+    // extract part of the solutions, corresponding to the diagonal block
+    auto Xj = Kokkos::subview (X, range_type(j1, j2), Kokkos::ALL ());
+
+    // workspace
+    int workoffset = work_offset (s);
+    auto Z = Kokkos::subview (work, range_type(workoffset+nscol, workoffset+nsrow), Kokkos::ALL ());
+
+    if (diag_kernel_type (level) != 3) { // not a device-level TRSM-solve
+      if (invert_offdiagonal) {
+        // combined TRSM solve with diagonal + GEMM update with off-diagonal
+        auto Y = Kokkos::subview (work, range_type(workoffset, workoffset+nsrow), Kokkos::ALL ());
+        auto Ljj = Kokkos::subview (viewL, range_type (0, nsrow), Kokkos::ALL ());
+        KokkosBatched::TeamGemm<member_type,
+                                KokkosBatched::Trans::NoTranspose,
+                                KokkosBatched::Trans::NoTranspose,
+                                KokkosBatched::Algo::Gemm::Unblocked>
+          ::invoke(team, one, Ljj, Xj, zero, Y);
+        team.team_barrier ();
+        for (int jk = team_rank; jk < nscol*nrhs; jk += team_size) {
+          Xj (jk%nscol, jk/nscol) = Y (jk%nscol, jk/nscol);
+        }
+        team.team_barrier ();
+      } else {
+        /* TRSM with diagonal block */
+        auto Ljj = Kokkos::subview (viewL, range_type (0, nscol), Kokkos::ALL ());
+        auto Y = Kokkos::subview (work, range_type(workoffset, workoffset+nscol), Kokkos::ALL ());
+        for (int jk = team_rank; jk < nscol*nrhs; jk += team_size) {
+          Y (jk%nscol, jk/nscol) = Xj (jk%nscol, jk/nscol);
+        }
+        team.team_barrier ();
+        KokkosBatched::TeamGemm<member_type,
+                                KokkosBatched::Trans::NoTranspose,
+                                KokkosBatched::Trans::NoTranspose,
+                                KokkosBatched::Algo::Gemm::Unblocked>
+          ::invoke(team, one, Ljj, Y, zero, Xj);
+        team.team_barrier ();
+
+        /* GEMM to update with off diagonal blocks */
+        auto Lij = Kokkos::subview (viewL, range_type (nscol, nsrow), Kokkos::ALL ());
+        KokkosBatched::TeamGemm<member_type,
+                                KokkosBatched::Trans::NoTranspose,
+                                KokkosBatched::Trans::NoTranspose,
+                                KokkosBatched::Algo::Gemm::Unblocked>
+          ::invoke(team, one, Lij, Xj, zero, Z);
+        team.team_barrier ();
+      }
+    }
+
+    /* scatter vectors back into X */
+    int ps2 = i1 + nscol ;     // offset into rowind
+    for (int ik = team_rank; ik < nsrow2*nrhs; ik += team_size) {
+      int i = rowind (ps2 + ik%nsrow2);
+      Kokkos::atomic_add (&X (i, ik/nsrow2), -Z (ik%nsrow2, ik/nsrow2));
+    }
+    team.team_barrier ();
+  }
+};
+
+
+// -----------------------------------------------------------
+// Functor for Upper-triangular solve in CSR
+template <class ColptrType, class RowindType, class ValuesType, class LHSType, class WorkType, class NGBLType>
+struct UpperTriSupernodalMVFunctor
+{
+  using execution_space = typename LHSType::execution_space;
+  using memory_space = typename execution_space::memory_space;
+
+  using policy_type = Kokkos::TeamPolicy<execution_space>;
+  using member_type = typename policy_type::member_type;
+
+  using scalar_t = typename ValuesType::non_const_value_type;
+
+  using integer_view_t = Kokkos::View<int*, memory_space>;
+
+  using SupernodeView = typename Kokkos::View<scalar_t**, Kokkos::LayoutLeft,
+                                              memory_space, Kokkos::MemoryUnmanaged>;
+
+  using range_type = Kokkos::pair<int, int>;
+
+  const int *supercols;
+  ColptrType colptr;
+  RowindType rowind;
+  ValuesType values;
+
+  int level;
+  integer_view_t diag_kernel_type;
+
+  LHSType X;
+
+  WorkType work; // needed with gemm for update&scatter
+  integer_view_t work_offset;
+
+  NGBLType nodes_grouped_by_level;
+
+  long node_count;
+
+  // constructor
+  UpperTriSupernodalMVFunctor (// supernode info
+                               const int *supercols_,
+                               // U in CSR
+                               const ColptrType &colptr_,
+                               const RowindType &rowind_,
+                               const ValuesType &values_,
+                               // option to pick kernel type
+                               int level_,
+                               integer_view_t &diag_kernel_type_,
+                               // right-hand-sides (input), solutions (output)
+                               LHSType &X_,
+                               // workspace
+                               WorkType work_,
+                               integer_view_t &work_offset_,
+                               //
+                               const NGBLType &nodes_grouped_by_level_,
+                               long  node_count_) :
+    supercols(supercols_),
+    colptr(colptr_), rowind(rowind_), values(values_),
+    level(level_), diag_kernel_type(diag_kernel_type_),
+    X(X_), work(work_), work_offset(work_offset_),
+    nodes_grouped_by_level(nodes_grouped_by_level_), node_count(node_count_) {
+  }
+
+  // operator
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const member_type & team) const {
+    const int league_rank = team.league_rank(); // batch id
+    const int team_size = team.team_size ();
+    const int team_rank = team.team_rank ();
+    const scalar_t zero (0.0);
+    const scalar_t one (1.0);
+
+    auto s = nodes_grouped_by_level (node_count + league_rank);
+
+    int j1 = supercols[s];
+    int j2 = supercols[s+1];
+    int nscol = j2 - j1;         // number of columns in the s-th supernode column
+
+    int i1 = colptr (j1);
+    int i2 = colptr (j1+1);
+    int nsrow = i2 - i1 ;        // "total" number of rows in all the supernodes (diagonal+off-diagonal)
+    int nsrow2 = nsrow - nscol;  // "total" number of rows in all the off-diagonal supernodes
+    int nrhs = X.extent (1);
+
+    // create a view of the s-th supernocal row of U
+    scalar_t *dataU = const_cast<scalar_t*> (values.data ());
+    SupernodeView viewU (&dataU[i1], nsrow, nscol);
+
+    // extract part of solutions, corresponding to the diagonal block U(s, s)
+    auto Xj = Kokkos::subview (X, range_type(j1, j2), Kokkos::ALL ());
+
+    // workspaces
+    int workoffset = work_offset (s);
+
+    if (nsrow2 > 0) {
+      /* gather vectors into Z */
+      int ps2 = i1 + nscol;     // offset into rowind
+      auto Z = Kokkos::subview (work, range_type(workoffset+nscol, workoffset+nsrow), Kokkos::ALL ());
+      for (int ik = team_rank; ik < nsrow2*nrhs; ik += team_size) {
+        int i = rowind (ps2 + ik%nsrow2);
+        Z (ik%nsrow2, ik/nsrow2) = X (i, ik/nsrow2);
+      }
+      team.team_barrier ();
+      /* GEMM to update with off diagonal blocks, Xj = -Uij^T * Z */
+      if (diag_kernel_type (level) != 3) {
+        // not device-level GEMM-udpate
+        auto Uij = Kokkos::subview (viewU, range_type (nscol, nsrow), Kokkos::ALL ());
+        KokkosBatched::TeamGemm<member_type,
+                                KokkosBatched::Trans::Transpose,
+                                KokkosBatched::Trans::NoTranspose,
+                                KokkosBatched::Algo::Gemm::Unblocked>
+          ::invoke(team, -one, Uij, Z, one, Xj);
+        team.team_barrier ();
+      }
+    }
+
+    /* TRSM with diagonal block */
+    if (diag_kernel_type (level) != 3) {
+      // not device-level TRSM-solve
+      auto Ujj = Kokkos::subview (viewU, range_type (0, nscol), Kokkos::ALL ());
+      auto Y = Kokkos::subview (work, range_type(workoffset, workoffset+nscol), Kokkos::ALL ());
+      for (int jk = team_rank; jk < nscol*nrhs; jk += team_size) {
+        Y (jk%nscol, jk/nscol) = Xj (jk%nscol, jk/nscol);
+      }
+      team.team_barrier ();
+      KokkosBatched::TeamGemm<member_type,
+                              KokkosBatched::Trans::Transpose,
+                              KokkosBatched::Trans::NoTranspose,
+                              KokkosBatched::Algo::Gemm::Unblocked>
+        ::invoke(team, one, Ujj, Y, zero, Xj);
+      team.team_barrier ();
+    }
+  }
+};
+
+
+// -----------------------------------------------------------
+// Functor for Upper-triangular solve in CSC
+template <class ColptrType, class RowindType, class ValuesType, class LHSType, class WorkType, class NGBLType>
+struct UpperTriTranSupernodalMVFunctor
+{
+  using execution_space = typename LHSType::execution_space;
+  using memory_space = typename execution_space::memory_space;
+
+  using policy_type = Kokkos::TeamPolicy<execution_space>;
+  using member_type = typename policy_type::member_type;
+
+  using scalar_t = typename ValuesType::non_const_value_type;
+
+  using integer_view_t = Kokkos::View<int*, memory_space>;
+
+  using SupernodeView = typename Kokkos::View<scalar_t**, Kokkos::LayoutLeft,
+                                              memory_space, Kokkos::MemoryUnmanaged>;
+
+  using range_type =  Kokkos::pair<int, int>;
+
+  const bool invert_offdiagonal;
+  const int *supercols;
+  ColptrType colptr;
+  RowindType rowind;
+  ValuesType values;
+
+  int level;
+  integer_view_t diag_kernel_type;
+
+  LHSType X;
+
+  WorkType work; // needed with gemm for update&scatter
+  integer_view_t work_offset;
+
+  NGBLType nodes_grouped_by_level;
+
+  long node_count;
+
+  // constructor
+  UpperTriTranSupernodalMVFunctor (// supernode info
+                                   const bool invert_offdiagonal_,
+                                   const int *supercols_,
+                                   // U in CSC
+                                   const ColptrType &colptr_,
+                                   const RowindType &rowind_,
+                                   const ValuesType &values_,
+                                   // option to pick kernel type
+                                   int level_,
+                                   integer_view_t &diag_kernel_type_,
+                                   // right-hand-sides (input), solutions (output)
+                                   LHSType &X_,
+                                   // workspace
+                                   WorkType work_,
+                                   integer_view_t &work_offset_,
+                                   //
+                                   const NGBLType &nodes_grouped_by_level_,
+                                   long  node_count_) :
+    invert_offdiagonal(invert_offdiagonal_), supercols(supercols_),
+    colptr(colptr_), rowind(rowind_), values(values_),
+    level(level_), diag_kernel_type(diag_kernel_type_),
+    X(X_), work(work_), work_offset(work_offset_),
+    nodes_grouped_by_level(nodes_grouped_by_level_), node_count(node_count_) {
+  }
+
+  // operator
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const member_type & team) const {
+    const int league_rank = team.league_rank(); // batch id
+    const int team_size = team.team_size ();
+    const int team_rank = team.team_rank ();
+    const scalar_t zero (0.0);
+    const scalar_t one (1.0);
+
+    auto s = nodes_grouped_by_level (node_count + league_rank);
+
+    int j1 = supercols[s];
+    int j2 = supercols[s+1];
+    int nscol = j2 - j1;         // number of columns in the s-th supernode column
+
+    int i1 = colptr (j1);
+    int i2 = colptr (j1+1);
+    int nsrow = i2 - i1 ;        // "total" number of rows in all the supernodes (diagonal+off-diagonal)
+    int nsrow2 = nsrow - nscol;  // "total" number of rows in all the off-diagonal supernodes
+    int nrhs = X.extent (1);
+
+    // create a view of the s-th supernocal column of U
+    scalar_t *dataU = const_cast<scalar_t*> (values.data ());
+    SupernodeView viewU (&dataU[i1], nsrow, nscol);
+
+    // extract part of solutions, corresponding to the diagonal block U(s, s)
+    auto Xj = Kokkos::subview (X, range_type(j1, j2), Kokkos::ALL ());
+
+    // workspaces
+    int workoffset = work_offset (s);
+
+    /* TRSM with diagonal block */
+    if (diag_kernel_type (level) != 3) {
+      // not device-level TRSM-solve
+      team.team_barrier ();
+      if (invert_offdiagonal) {
+        // extract diagonal + off-diagonal blocks of U
+        auto Y = Kokkos::subview (work, range_type(workoffset, workoffset+nsrow), Kokkos::ALL ());
+        auto Uij = Kokkos::subview (viewU, range_type (0, nsrow), Kokkos::ALL ());
+        KokkosBatched::TeamGemm<member_type,
+                                KokkosBatched::Trans::NoTranspose,
+                                KokkosBatched::Trans::NoTranspose,
+                                KokkosBatched::Algo::Gemm::Unblocked>
+          ::invoke(team, one, Uij, Xj, zero, Y);
+        team.team_barrier ();
+        // copy the diagonal back to output
+        for (int jk = team_rank; jk < nscol*nrhs; jk += team_size) {
+          Xj (jk%nscol, jk/nscol) = Y (jk%nscol, jk/nscol);
+        }
+      } else {
+        // extract diagonal block of U (stored on top)
+        auto Y = Kokkos::subview (work, range_type(workoffset, workoffset+nscol), Kokkos::ALL ());
+        auto Ujj = Kokkos::subview (viewU, range_type (0, nscol), Kokkos::ALL ());
+        for (int jk = team_rank; jk < nscol*nrhs; jk += team_size) {
+          Y (jk%nscol, jk/nscol) = Xj (jk%nscol, jk/nscol);
+        }
+        team.team_barrier ();
+        KokkosBatched::TeamGemm<member_type,
+                                KokkosBatched::Trans::NoTranspose,
+                                KokkosBatched::Trans::NoTranspose,
+                                KokkosBatched::Algo::Gemm::Unblocked>
+          ::invoke(team, one, Ujj, Y, zero, Xj);
+      }
+      team.team_barrier ();
+    }
+
+    if (nsrow2 > 0) {
+      /* GEMM to update off diagonal blocks, Z = Uij * Xj */
+      auto Z = Kokkos::subview (work, range_type(workoffset+nscol, workoffset+nsrow), Kokkos::ALL ());
+      if (!invert_offdiagonal && diag_kernel_type (level) != 3) {
+        // not device-level GEMM-udpate
+        auto Uij = Kokkos::subview (viewU, range_type (nscol, nsrow), Kokkos::ALL ());
+        KokkosBatched::TeamGemm<member_type,
+                                KokkosBatched::Trans::NoTranspose,
+                                KokkosBatched::Trans::NoTranspose,
+                                KokkosBatched::Algo::Gemm::Unblocked>
+          ::invoke(team, one, Uij, Xj, zero, Z);
+        team.team_barrier ();
+      }
+      /* scatter vectors from Z */
+      int ps2 = i1 + nscol;     // offset into rowind
+      for (int ik = team_rank; ik < nsrow2*nrhs; ik += team_size) {
+        int i = rowind (ps2 + ik%nsrow2);
+        Kokkos::atomic_add (&X (i, ik/nsrow2), -Z (ik%nsrow2, ik/nsrow2));
+      }
+      team.team_barrier ();
+    }
+  }
+};
+
+
+// Supernodal solve with multiple right-hand sides, for all the supernodal
+// algorithms: as for the rank-1 solve, lhs holds the right-hand sides on
+// input and is overwritten with the solutions.  Each level is one launch
+// (plus the device-level GEMMs for large supernodes), whatever the number
+// of right-hand sides.
+template < class TriSolveHandle, class RowMapType, class EntriesType, class ValuesType, class LHSType >
+void tri_solve_supernodal_mv(TriSolveHandle & thandle, const RowMapType row_map, const EntriesType entries, const ValuesType values, LHSType &lhs) {
+
+  using namespace KokkosSparse::Experimental;
+  using execution_space     = typename TriSolveHandle::execution_space;
+  using memory_space        = typename execution_space::memory_space;
+  using size_type           = typename TriSolveHandle::size_type;
+  using NGBLType            = typename TriSolveHandle::nnz_lno_view_t;
+  using integer_view_t      = typename TriSolveHandle::integer_view_t;
+  using integer_view_host_t = typename TriSolveHandle::integer_view_host_t;
+  using scalar_t            = typename ValuesType::non_const_value_type;
+  using work_view_t         = Kokkos::View<scalar_t**, Kokkos::LayoutLeft, memory_space>;
+  using SupernodeView       = Kokkos::View<scalar_t**, Kokkos::LayoutLeft, memory_space, Kokkos::MemoryUnmanaged>;
+  using team_policy_type    = Kokkos::TeamPolicy<execution_space>;
+  using range_type = Kokkos::pair<int, int>;
+
+  using SpMVFunctor = SparseTriSupernodalMVSpMVFunctor<LHSType, work_view_t, NGBLType>;
+
+  const scalar_t zero (0.0);
+  const scalar_t one (1.0);
+
+  auto nlevels = thandle.get_num_levels();
+  auto hnodes_per_level = thandle.get_host_nodes_per_level();
+  auto nodes_grouped_by_level = thandle.get_nodes_grouped_by_level();
+  auto nodes_grouped_by_level_host = thandle.get_host_nodes_grouped_by_level();
+  Kokkos::deep_copy (nodes_grouped_by_level_host, nodes_grouped_by_level);
+
+  Kokkos::View<size_type*, Kokkos::HostSpace> row_map_host(
+      Kokkos::ViewAllocateWithoutInitializing("host rowmap"), row_map.extent(0));
+  Kokkos::deep_copy (row_map_host, row_map);
+
+  const bool is_lowertri = thandle.is_lower_tri ();
+  const bool is_column_major = thandle.is_column_major ();
+  const SPTRSVAlgorithm algm = thandle.get_algorithm ();
+  const bool use_spmv = (algm == SPTRSVAlgorithm::SUPERNODAL_SPMV ||
+                         algm == SPTRSVAlgorithm::SUPERNODAL_SPMV_DAG);
+
+  // inversion options
+  const bool invert_offdiagonal = thandle.get_invert_offdiagonal ();
+
+  // supernode sizes
+  const int* supercols = thandle.get_supercols ();
+  const int* supercols_host = thandle.get_supercols_host ();
+
+  // kernel types
+  integer_view_t diag_kernel_type = thandle.get_diag_kernel_type ();
+  integer_view_host_t diag_kernel_type_host = thandle.get_diag_kernel_type_host ();
+
+  // workspace, with the offsets of the rank-1 workspace and one column per
+  // right-hand side; the SpMV variants rely on it being zero on entry
+  integer_view_t work_offset = thandle.get_work_offset ();
+  integer_view_host_t work_offset_host = thandle.get_work_offset_host ();
+  work_view_t work ("sptrsv_supernodal_mv_work", thandle.get_workspace ().extent (0), lhs.extent (1));
+
+  scalar_t *dataA = const_cast<scalar_t*> (values.data ());
+
+  size_type node_count = 0;
+  for ( size_type lvl = 0; lvl < nlevels; ++lvl ) {
+    size_type lvl_nodes = hnodes_per_level(lvl);
+    if ( lvl_nodes == 0 ) {
+      continue;
+    }
+
+    if (use_spmv) {
+      bool transpose_spmv = ((!thandle.transpose_spmv() &&  is_column_major) ||
+                             ( thandle.transpose_spmv() && !is_column_major));
+      const char *tran = (transpose_spmv ? "T" : "N");
+      if (is_lowertri || !transpose_spmv) {
+        if (!invert_offdiagonal) {
+          // solve with diagonals, and copy from work to lhs corresponding to diagonal blocks
+          auto digmat = thandle.get_diagblock (lvl);
+          KokkosSparse::
+          spmv(tran, one, digmat,
+                          lhs,
+                     one, work);
+          Kokkos::parallel_for ("parfor_solve_supernode_mv", team_policy_type(lvl_nodes , Kokkos::AUTO),
+                                SpMVFunctor (-1, node_count, nodes_grouped_by_level, supercols, lhs, work));
+        } else {
+          // copy lhs corresponding to diagonal blocks to work and zero out in lhs
+          Kokkos::parallel_for ("parfor_solve_supernode_mv", team_policy_type(lvl_nodes , Kokkos::AUTO),
+                                SpMVFunctor (1, node_count, nodes_grouped_by_level, supercols, lhs, work));
+        }
+        // update off-diagonals (potentially combined with solve with diagonals)
+        auto submat = thandle.get_submatrix (lvl);
+        KokkosSparse::
+        spmv(tran, one, submat,
+                        work,
+                   one, lhs);
+      } else {
+        if (!invert_offdiagonal) {
+          // zero out lhs corresponding to diagonal blocks in lhs, and copy to work
+          Kokkos::parallel_for ("parfor_solve_supernode_mv", team_policy_type(lvl_nodes , Kokkos::AUTO),
+                                SpMVFunctor (1, node_count, nodes_grouped_by_level, supercols, lhs, work));
+
+          // update with off-diagonals
+          auto submat = thandle.get_submatrix (lvl);
+          KokkosSparse::
+          spmv(tran, one, submat,
+                          lhs,
+                     one, work);
+
+          // solve with diagonals
+          auto digmat = thandle.get_diagblock (lvl);
+          KokkosSparse::
+          spmv(tran, one, digmat,
+                          work,
+                     one, lhs);
+        } else {
+          printf( " ** invert_offdiag with U in CSR not supported **\n" );
+        }
+      }
+      // reinitialize workspace
+      Kokkos::parallel_for ("parfor_solve_supernode_mv", team_policy_type(lvl_nodes , Kokkos::AUTO),
+                            SpMVFunctor (0, node_count, nodes_grouped_by_level, supercols, lhs, work));
+      node_count += lvl_nodes;
+      continue;
+    }
+
+    // the CSR upper solve gathers the input in its functor before the
+    // device-level update, the others run the device-level kernels first
+    const bool device_level = (diag_kernel_type_host (lvl) == 3);
+    if (is_lowertri || is_column_major) {
+      if (device_level) {
+        for (size_type league_rank = 0; league_rank < lvl_nodes; league_rank++) {
+          auto s = nodes_grouped_by_level_host (node_count + league_rank);
+
+          int j1 = supercols_host[s];
+          int j2 = supercols_host[s+1];
+          int nscol = j2 - j1 ;        // number of columns in the s-th supernode column
+
+          int i1 = row_map_host (j1);
+          int i2 = row_map_host (j1+1);
+          int nsrow = i2 - i1;         // "total" number of rows in all the supernodes (diagonal+off-diagonal)
+          int nsrow2 = nsrow - nscol;  // "total" number of rows in all the off-diagonal supernodes
+
+          int workoffset = work_offset_host (s);
+
+          SupernodeView viewA (&dataA[i1], nsrow, nscol);
+          auto Xj = Kokkos::subview (lhs, range_type (j1, j2), Kokkos::ALL ());
+          if (invert_offdiagonal) {
+            auto Y = Kokkos::subview (work, range_type(workoffset, workoffset+nsrow), Kokkos::ALL ());
+            auto Ajj = Kokkos::subview (viewA, range_type (0, nsrow), Kokkos::ALL ());
+            KokkosBlas::
+            gemm("N", "N", one,  Ajj,
+                                 Xj,
+                           zero, Y);
+            Kokkos::deep_copy (Xj, Kokkos::subview (Y, range_type (0, nscol), Kokkos::ALL ()));
+          } else {
+            auto Y = Kokkos::subview (work, range_type(workoffset, workoffset+nscol), Kokkos::ALL ());
+            auto Ajj = Kokkos::subview (viewA, range_type (0, nscol), Kokkos::ALL ());
+            Kokkos::deep_copy (Y, Xj);
+            KokkosBlas::
+            gemm("N", "N", one,  Ajj,
+                                 Y,
+                           zero, Xj);
+            if (nsrow2 > 0) {
+              auto Z = Kokkos::subview (work, range_type(workoffset+nscol, workoffset+nsrow), Kokkos::ALL ());
+              auto Aij = Kokkos::subview (viewA, range_type (nscol, nsrow), Kokkos::ALL ());
+              KokkosBlas::
+              gemm("N", "N", one,  Aij,
+                                   Xj,
+                             zero, Z);
+            }
+          }
+        }
+      }
+
+      if (is_lowertri) {
+        LowerTriSupernodalMVFunctor<RowMapType, EntriesType, ValuesType, LHSType, work_view_t, NGBLType>
+          sptrsv_functor (invert_offdiagonal, supercols, row_map, entries, values, lvl, diag_kernel_type, lhs,
+                          work, work_offset, nodes_grouped_by_level, node_count);
+        Kokkos::parallel_for ("parfor_lsolve_supernode_mv", team_policy_type (lvl_nodes , Kokkos::AUTO), sptrsv_functor);
+      } else {
+        UpperTriTranSupernodalMVFunctor<RowMapType, EntriesType, ValuesType, LHSType, work_view_t, NGBLType>
+          sptrsv_functor (invert_offdiagonal, supercols, row_map, entries, values, lvl, diag_kernel_type, lhs,
+                          work, work_offset, nodes_grouped_by_level, node_count);
+        Kokkos::parallel_for ("parfor_usolve_tran_supernode_mv", team_policy_type (lvl_nodes , Kokkos::AUTO), sptrsv_functor);
+      }
+    } else {
+      UpperTriSupernodalMVFunctor<RowMapType, EntriesType, ValuesType, LHSType, work_view_t, NGBLType>
+        sptrsv_functor (supercols, row_map, entries, values, lvl, diag_kernel_type, lhs,
+                        work, work_offset, nodes_grouped_by_level, node_count);
+      Kokkos::parallel_for ("parfor_usolve_supernode_mv", team_policy_type (lvl_nodes , Kokkos::AUTO), sptrsv_functor);
+
+      if (device_level) {
+        for (size_type league_rank = 0; league_rank < lvl_nodes; league_rank++) {
+          auto s = nodes_grouped_by_level_host (node_count + league_rank);
+
+          int j1 = supercols_host[s];
+          int j2 = supercols_host[s+1];
+          int nscol = j2 - j1 ;        // number of columns in the s-th supernode column
+
+          int i1 = row_map_host (j1);
+          int i2 = row_map_host (j1+1);
+          int nsrow = i2 - i1;         // "total" number of rows in all the supernodes (diagonal+off-diagonal)
+          int nsrow2 = nsrow - nscol;  // "total" number of rows in all the off-diagonal supernodes
+
+          int workoffset = work_offset_host (s);
+
+          SupernodeView viewU (&dataA[i1], nsrow, nscol);
+          auto Xj = Kokkos::subview (lhs, range_type (j1, j2), Kokkos::ALL ());
+          auto Y = Kokkos::subview (work, range_type(workoffset, workoffset+nscol), Kokkos::ALL ());
+
+          // update with off-diagonal blocks
+          if (nsrow2 > 0) {
+            auto Uij = Kokkos::subview (viewU, range_type (nscol, nsrow), Kokkos::ALL ());
+            auto Z = Kokkos::subview (work, range_type(workoffset+nscol, workoffset+nsrow), Kokkos::ALL ());
+            KokkosBlas::
+            gemm("T", "N", -one, Uij,
+                                 Z,
+                            one, Xj);
+          }
+
+          // "triangular-solve" to compute Xj
+          auto Ujj = Kokkos::subview (viewU, range_type (0, nscol), Kokkos::ALL ());
+          Kokkos::deep_copy (Y, Xj);
+          KokkosBlas::
+          gemm("T", "N", one,  Ujj,
+                               Y,
+                         zero, Xj);
+        }
+      }
+    }
+    node_count += lvl_nodes;
+  }
+
+} // end tri_solve_supernodal_mv
+#endif
+
+} // namespace Experimental
+} // namespace Impl
+} // namespace KokkosSparse
+
+#endif
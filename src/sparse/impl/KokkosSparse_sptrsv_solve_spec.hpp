@@ -49,6 +49,8 @@
 #include <Kokkos_ArithTraits.hpp>
 #include "KokkosSparse_CrsMatrix.hpp"
 #include "KokkosKernels_Handle.hpp"
+#include "KokkosSparse_sptrsv_symbolic_spec.hpp"
+#include <KokkosSparse_sptrsv_solve_mv_impl.hpp>
 
 // Include the actual functors
 #if !defined(KOKKOSKERNELS_ETI_ONLY) || KOKKOSKERNELS_IMPL_COMPILE_LIBRARY 
@@ -140,6 +142,99 @@ struct SPTRSV_SOLVE{
                 XType x);
 };
 
+/// \brief Implementation of KokkosSparse::sptrsv_solve for rank-2 b and x
+///   (one column per right-hand side).
+///
+/// This layer has no ETI specializations and is defined in the header:
+/// the multivector kernels are header-only, and the other algorithms
+/// solve one column at a time through SPTRSV_SOLVE, whose LayoutLeft
+/// specializations are instantiated in the library.  The level scheduled
+/// (SEQLVLSCHD_RP, TP1 and TP1CHAIN) and supernodal algorithms have
+/// multivector kernels; the sync-free, Jacobi and reordered solves go
+/// column by column.
+template<class KernelHandle,
+         class RowMapType,
+         class EntriesType,
+         class ValuesType,
+         class BType,
+         class XType>
+struct SPTRSV_SOLVE_MV{
+  static void
+  sptrsv_solve (KernelHandle *handle,
+                const RowMapType row_map,
+                const EntriesType entries,
+                const ValuesType values,
+                BType b,
+                XType x)
+  {
+    auto sptrsv_handle = handle->get_sptrsv_handle();
+    Kokkos::Profiling::pushRegion(sptrsv_handle->is_lower_tri() ? "KokkosSparse_sptrsv[lower,mv]" : "KokkosSparse_sptrsv[upper,mv]");
+    if ( sptrsv_handle->is_symbolic_complete() == false ) {
+      SPTRSV_SYMBOLIC<KernelHandle, RowMapType, EntriesType>::sptrsv_symbolic (handle, row_map, entries);
+    }
+
+    const auto algm = sptrsv_handle->get_algorithm();
+    if ( !sptrsv_handle->is_reordered() &&
+         ( algm == KokkosSparse::Experimental::SPTRSVAlgorithm::SEQLVLSCHD_RP ||
+           algm == KokkosSparse::Experimental::SPTRSVAlgorithm::SEQLVLSCHD_TP1 ||
+           algm == KokkosSparse::Experimental::SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN ) ) {
+      Experimental::tri_solve_mv( *sptrsv_handle, row_map, entries, values, b, x);
+    }
+#ifdef KOKKOSKERNELS_ENABLE_SUPERNODAL_SPTRSV
+    else if ( algm == KokkosSparse::Experimental::SPTRSVAlgorithm::SUPERNODAL_NAIVE ||
+              algm == KokkosSparse::Experimental::SPTRSVAlgorithm::SUPERNODAL_ETREE ||
+              algm == KokkosSparse::Experimental::SPTRSVAlgorithm::SUPERNODAL_DAG ||
+              algm == KokkosSparse::Experimental::SPTRSVAlgorithm::SUPERNODAL_SPMV ||
+              algm == KokkosSparse::Experimental::SPTRSVAlgorithm::SUPERNODAL_SPMV_DAG ) {
+      // as for rank-1, the supernodal solve works in place on x
+      Experimental::tri_solve_supernodal_mv( *sptrsv_handle, row_map, entries, values, x);
+    }
+#endif
+    else {
+      // The other algorithms solve one right-hand side at a time.  With
+      // LayoutLeft the columns of b and x are contiguous and are passed as
+      // they are; otherwise each column is copied to and from a contiguous
+      // work vector.
+      typedef typename XType::device_type device_type;
+      typedef Kokkos::View<typename BType::const_value_type*, Kokkos::LayoutLeft, device_type,
+                           Kokkos::MemoryTraits<Kokkos::Unmanaged|Kokkos::RandomAccess> > BType_Column;
+      typedef Kokkos::View<typename XType::non_const_value_type*, Kokkos::LayoutLeft, device_type,
+                           Kokkos::MemoryTraits<Kokkos::Unmanaged> > XType_Column;
+      typedef Kokkos::View<typename XType::non_const_value_type*, Kokkos::LayoutLeft, device_type> work_view_t;
+
+      const bool is_contiguous =
+        std::is_same<typename BType::array_layout, Kokkos::LayoutLeft>::value &&
+        std::is_same<typename XType::array_layout, Kokkos::LayoutLeft>::value;
+      const size_t nrows = x.extent(0);
+
+      work_view_t b_work, x_work;
+      if ( !is_contiguous ) {
+        b_work = work_view_t (Kokkos::ViewAllocateWithoutInitializing("sptrsv_mv_b_column"), nrows);
+        x_work = work_view_t (Kokkos::ViewAllocateWithoutInitializing("sptrsv_mv_x_column"), nrows);
+      }
+
+      for ( size_t j = 0; j < x.extent(1); ++j ) {
+        BType_Column b_j;
+        XType_Column x_j;
+        if ( is_contiguous ) {
+          b_j = BType_Column (b.data() + j*b.stride(1), nrows);
+          x_j = XType_Column (x.data() + j*x.stride(1), nrows);
+        }
+        else {
+          Kokkos::deep_copy (b_work, Kokkos::subview (b, Kokkos::ALL (), j));
+          b_j = b_work;
+          x_j = x_work;
+        }
+        SPTRSV_SOLVE<KernelHandle, RowMapType, EntriesType, ValuesType, BType_Column, XType_Column>::sptrsv_solve (handle, row_map, entries, values, b_j, x_j);
+        if ( !is_contiguous ) {
+          Kokkos::deep_copy (Kokkos::subview (x, Kokkos::ALL (), j), x_work);
+        }
+      }
+    }
+    Kokkos::Profiling::popRegion();
+  }
+};
+
 
 #if !defined(KOKKOSKERNELS_ETI_ONLY) || KOKKOSKERNELS_IMPL_COMPILE_LIBRARY
 //! Full specialization of sptrsv_solve
@@ -166,9 +261,18 @@ struct SPTRSV_SOLVE<KernelHandle, RowMapType, EntriesType, ValuesType, BType, XT
       if ( sptrsv_handle->is_symbolic_complete() == false ) {
         Experimental::lower_tri_symbolic(*sptrsv_handle, row_map, entries);
       }
-      if ( sptrsv_handle->get_algorithm() == KokkosSparse::Experimental::SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN ) {
+      if ( sptrsv_handle->is_reordered() ) {
+        Experimental::tri_solve_reordered( *sptrsv_handle, values, b, x, true);
+      }
+      else if ( sptrsv_handle->get_algorithm() == KokkosSparse::Experimental::SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN ) {
         Experimental::tri_solve_chain( *sptrsv_handle, row_map, entries, values, b, x, true);
       }
+      else if ( sptrsv_handle->get_algorithm() == KokkosSparse::Experimental::SPTRSVAlgorithm::SYNCFREE ) {
+        Experimental::tri_solve_syncfree( *sptrsv_handle, row_map, entries, values, b, x, true);
+      }
+      else if ( sptrsv_handle->get_algorithm() == KokkosSparse::Experimental::SPTRSVAlgorithm::JACOBI_SWEEPS ) {
+        Experimental::tri_solve_jacobi( *sptrsv_handle, row_map, entries, values, b, x);
+      }
       else {
 #ifdef KOKKOSKERNELS_SPTRSV_CUDAGRAPHSUPPORT
         using ExecSpace = typename RowMapType::memory_space::execution_space;
@@ -183,9 +287,18 @@ struct SPTRSV_SOLVE<KernelHandle, RowMapType, EntriesType, ValuesType, BType, XT
       if ( sptrsv_handle->is_symbolic_complete() == false ) {
         Experimental::upper_tri_symbolic(*sptrsv_handle, row_map, entries);
       }
-      if ( sptrsv_handle->get_algorithm() == KokkosSparse::Experimental::SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN ) {
+      if ( sptrsv_handle->is_reordered() ) {
+        Experimental::tri_solve_reordered( *sptrsv_handle, values, b, x, false);
+      }
+      else if ( sptrsv_handle->get_algorithm() == KokkosSparse::Experimental::SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN ) {
         Experimental::tri_solve_chain( *sptrsv_handle, row_map, entries, values, b, x, false);
       }
+      else if ( sptrsv_handle->get_algorithm() == KokkosSparse::Experimental::SPTRSVAlgorithm::SYNCFREE ) {
+        Experimental::tri_solve_syncfree( *sptrsv_handle, row_map, entries, values, b, x, false);
+      }
+      else if ( sptrsv_handle->get_algorithm() == KokkosSparse::Experimental::SPTRSVAlgorithm::JACOBI_SWEEPS ) {
+        Experimental::tri_solve_jacobi( *sptrsv_handle, row_map, entries, values, b, x);
+      }
       else {
 #ifdef KOKKOSKERNELS_SPTRSV_CUDAGRAPHSUPPORT
         using ExecSpace = typename RowMapType::memory_space::execution_space;
@@ -50,6 +50,8 @@
 #include <KokkosKernels_config.h>
 #include <Kokkos_ArithTraits.hpp>
 #include <KokkosSparse_sptrsv_handle.hpp>
+#include <KokkosKernels_ExecSpaceUtils.hpp>
+#include <vector>
 
 //#define TRISOLVE_SYMB_TIMERS
 //#define LVL_OUTPUT_INFO
@@ -163,6 +165,189 @@ void symbolic_chain_phase(TriSolveHandle &thandle, const NPLViewType &nodes_per_
 } // end symbolic_chain_phase
 
 
+// Renumbers the rows so that each level is a contiguous range of rows and
+// stores the permuted graph in the handle; the values are gathered through
+// reorder_value_map by the solve. Levels are a topological order of the
+// dependencies, so the permuted lower triangle stays lower triangular; the
+// upper triangle numbers the levels from the back to stay upper triangular.
+// Entries keep their position in the row, so a diagonal stored last (lower)
+// or first (upper) stays there. nodes_grouped_by_level, level_list and the
+// diagonal offsets are rewritten for the permuted matrix.
+template < class TriSolveHandle, class HostRowMapType, class HostEntriesType, class HostNGBLType, class HostLevelListType >
+void tri_reorder_by_level (TriSolveHandle &thandle, const HostRowMapType row_map, const HostEntriesType entries, HostNGBLType nodes_grouped_by_level, HostLevelListType level_list, const bool is_lowertri) {
+  typedef typename TriSolveHandle::size_type size_type;
+  typedef typename TriSolveHandle::nnz_lno_t lno_t;
+  typedef typename TriSolveHandle::nnz_lno_view_t DeviceEntriesType;
+  typedef typename TriSolveHandle::nnz_row_view_t DeviceRowMapType;
+
+  const lno_t nrows = row_map.extent(0)-1;
+  const size_type nnz = row_map(nrows);
+
+  DeviceEntriesType dperm(Kokkos::ViewAllocateWithoutInitializing("reorder_perm"), nrows);
+  DeviceRowMapType drow_map(Kokkos::ViewAllocateWithoutInitializing("reorder_row_map"), nrows+1);
+  DeviceEntriesType dentries(Kokkos::ViewAllocateWithoutInitializing("reorder_entries"), nnz);
+  DeviceRowMapType dvalue_map(Kokkos::ViewAllocateWithoutInitializing("reorder_value_map"), nnz);
+  auto perm = Kokkos::create_mirror_view(dperm);
+  auto new_row_map = Kokkos::create_mirror_view(drow_map);
+  auto new_entries = Kokkos::create_mirror_view(dentries);
+  auto value_map = Kokkos::create_mirror_view(dvalue_map);
+
+  std::vector<lno_t> iperm(nrows);
+  for ( lno_t pos = 0; pos < nrows; ++pos ) {
+    const lno_t k = is_lowertri ? pos : nrows - 1 - pos;
+    perm(k) = nodes_grouped_by_level(pos);
+    iperm[perm(k)] = k;
+  }
+
+  const bool stored_diagonal = thandle.is_stored_diagonal();
+  auto hdiagonal_offsets = thandle.get_host_diagonal_offsets();
+  std::vector<lno_t> new_diagonal_offsets(stored_diagonal ? nrows : 0);
+  std::vector<typename HostLevelListType::non_const_value_type> old_level_list(nrows);
+
+  size_type new_offset = 0;
+  new_row_map(0) = 0;
+  for ( lno_t k = 0; k < nrows; ++k ) {
+    const lno_t row = perm(k);
+    for ( size_type offset = row_map(row); offset < size_type(row_map(row+1)); ++offset, ++new_offset ) {
+      new_entries(new_offset) = iperm[entries(offset)];
+      value_map(new_offset) = offset;
+      if ( stored_diagonal && lno_t(entries(offset)) == row )
+        new_diagonal_offsets[k] = new_offset;
+    }
+    new_row_map(k+1) = new_offset;
+    old_level_list[row] = level_list(row);
+  }
+
+  for ( lno_t k = 0; k < nrows; ++k ) {
+    level_list(k) = old_level_list[perm(k)];
+    if ( stored_diagonal )
+      hdiagonal_offsets(k) = new_diagonal_offsets[k];
+  }
+  for ( lno_t pos = 0; pos < nrows; ++pos ) {
+    nodes_grouped_by_level(pos) = is_lowertri ? pos : nrows - 1 - pos;
+  }
+
+  Kokkos::deep_copy(dperm, perm);
+  Kokkos::deep_copy(drow_map, new_row_map);
+  Kokkos::deep_copy(dentries, new_entries);
+  Kokkos::deep_copy(dvalue_map, value_map);
+  thandle.set_reordered_matrix(dperm, drow_map, dentries, dvalue_map);
+}
+
+
+// Counts the off-diagonal entries of each row, i.e. the rows the
+// sync-free solve of that row waits for, and the entries on the wrong side
+// of the diagonal.
+template <class RowMapType, class EntriesType, class DepsType>
+struct TriSyncFreeSymbolicFunctor
+{
+  typedef typename EntriesType::non_const_value_type lno_t;
+  typedef lno_t value_type;
+
+  RowMapType row_map;
+  EntriesType entries;
+  DepsType dependencies;
+  bool is_lowertri;
+
+  TriSyncFreeSymbolicFunctor( const RowMapType &row_map_, const EntriesType &entries_, const DepsType &dependencies_, const bool is_lowertri_ ) :
+    row_map(row_map_), entries(entries_), dependencies(dependencies_), is_lowertri(is_lowertri_) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const lno_t rowid, lno_t &num_invalid) const {
+    lno_t deps = 0;
+    for ( auto ptr = row_map(rowid); ptr < row_map(rowid+1); ++ptr ) {
+      const lno_t colid = entries(ptr);
+      if ( colid == rowid ) continue;
+      if ( (colid < rowid) == is_lowertri ) ++deps;
+      else ++num_invalid;
+    }
+    dependencies(rowid) = deps;
+  }
+};
+
+
+// Symbolic phase of the sync-free solve: no level sets are built, only the
+// per-row dependency counts. Each row of the solve waits on the completion
+// flags of the rows it depends on, which needs all threads of the execution
+// space to run concurrently, so this algorithm is restricted to host spaces.
+template < class TriSolveHandle, class RowMapType, class EntriesType >
+void tri_syncfree_symbolic (TriSolveHandle &thandle, const RowMapType row_map, const EntriesType entries, const bool is_lowertri) {
+  typedef typename TriSolveHandle::execution_space execution_space;
+  typedef typename TriSolveHandle::nnz_lno_t lno_t;
+  typedef typename TriSolveHandle::nnz_lno_view_t DepsType;
+
+  if (KokkosKernels::Impl::kk_get_exec_space_type<execution_space>() == KokkosKernels::Impl::Exec_CUDA) {
+    throw(std::runtime_error("SYMB ERROR: SYNCFREE requires a host execution space"));
+  }
+
+  const lno_t nrows = row_map.extent(0)-1;
+  DepsType dependencies = thandle.get_syncfree_dependencies();
+
+  lno_t num_invalid = 0;
+  Kokkos::parallel_reduce( "syncfree_symbolic", Kokkos::RangePolicy<execution_space>(0, nrows),
+      TriSyncFreeSymbolicFunctor<RowMapType, EntriesType, DepsType> (row_map, entries, dependencies, is_lowertri), num_invalid );
+  if (num_invalid != 0) {
+    throw(std::runtime_error(is_lowertri ?
+          "SYMB ERROR: Lower tri with colid > rowid" :
+          "SYMB ERROR: Upper tri with colid < rowid"));
+  }
+
+  thandle.set_num_levels(0);
+  thandle.set_symbolic_complete();
+}
+
+
+// Finds the offset of the diagonal entry of each row and counts the rows
+// without one.
+template <class RowMapType, class EntriesType, class OffsetsType>
+struct TriJacobiSymbolicFunctor
+{
+  typedef typename EntriesType::non_const_value_type lno_t;
+  typedef lno_t value_type;
+
+  RowMapType row_map;
+  EntriesType entries;
+  OffsetsType diagonal_offsets;
+
+  TriJacobiSymbolicFunctor( const RowMapType &row_map_, const EntriesType &entries_, const OffsetsType &diagonal_offsets_ ) :
+    row_map(row_map_), entries(entries_), diagonal_offsets(diagonal_offsets_) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const lno_t rowid, lno_t &num_missing) const {
+    for ( auto ptr = row_map(rowid); ptr < row_map(rowid+1); ++ptr ) {
+      if ( entries(ptr) == rowid ) {
+        diagonal_offsets(rowid) = ptr;
+        return;
+      }
+    }
+    ++num_missing;
+  }
+};
+
+
+// Symbolic phase of the Jacobi sweeps solve: only the diagonal offsets are
+// needed, the sweeps themselves have no dependencies between rows.
+template < class TriSolveHandle, class RowMapType, class EntriesType >
+void tri_jacobi_symbolic (TriSolveHandle &thandle, const RowMapType row_map, const EntriesType entries) {
+  typedef typename TriSolveHandle::execution_space execution_space;
+  typedef typename TriSolveHandle::nnz_lno_t lno_t;
+  typedef typename TriSolveHandle::nnz_row_view_t OffsetsType;
+
+  const lno_t nrows = row_map.extent(0)-1;
+  OffsetsType diagonal_offsets = thandle.get_jacobi_diagonal_offsets();
+
+  lno_t num_missing = 0;
+  Kokkos::parallel_reduce( "jacobi_symbolic", Kokkos::RangePolicy<execution_space>(0, nrows),
+      TriJacobiSymbolicFunctor<RowMapType, EntriesType, OffsetsType> (row_map, entries, diagonal_offsets), num_missing );
+  if (num_missing != 0) {
+    throw(std::runtime_error("SYMB ERROR: JACOBI_SWEEPS requires a stored diagonal entry in every row"));
+  }
+
+  thandle.set_num_levels(0);
+  thandle.set_symbolic_complete();
+}
+
+
 template < class TriSolveHandle, class RowMapType, class EntriesType >
 void lower_tri_symbolic (TriSolveHandle &thandle, const RowMapType drow_map, const EntriesType dentries) {
 #ifdef TRISOLVE_SYMB_TIMERS
@@ -291,6 +476,10 @@ void lower_tri_symbolic (TriSolveHandle &thandle, const RowMapType drow_map, con
   { std::cout << "i: " << i << "  nodes_grouped_by_level = " << nodes_grouped_by_level(i) << std::endl; }
 #endif
 
+  if ( thandle.is_reorder_by_level() ) {
+    tri_reorder_by_level(thandle, row_map, entries, nodes_grouped_by_level, level_list, true);
+  }
+
   // Deep copy to device views
   Kokkos::deep_copy(dnodes_grouped_by_level, nodes_grouped_by_level);
   Kokkos::deep_copy(dnodes_per_level, nodes_per_level);
@@ -321,6 +510,12 @@ void lower_tri_symbolic (TriSolveHandle &thandle, const RowMapType drow_map, con
   }
 #endif
  }
+ else if (thandle.get_algorithm () == SPTRSVAlgorithm::SYNCFREE) {
+  tri_syncfree_symbolic (thandle, drow_map, dentries, true);
+ }
+ else if (thandle.get_algorithm () == SPTRSVAlgorithm::JACOBI_SWEEPS) {
+  tri_jacobi_symbolic (thandle, drow_map, dentries);
+ }
 #ifdef KOKKOSKERNELS_ENABLE_SUPERNODAL_SPTRSV
  else if (thandle.get_algorithm () == SPTRSVAlgorithm::SUPERNODAL_NAIVE ||
           thandle.get_algorithm () == SPTRSVAlgorithm::SUPERNODAL_ETREE ||
@@ -731,6 +926,10 @@ void upper_tri_symbolic ( TriSolveHandle &thandle, const RowMapType drow_map, co
   { std::cout << "i: " << i << "  nodes_grouped_by_level = " << nodes_grouped_by_level(i) << std::endl; }
 #endif
 
+  if ( thandle.is_reorder_by_level() ) {
+    tri_reorder_by_level(thandle, row_map, entries, nodes_grouped_by_level, level_list, false);
+  }
+
   // Deep copy to device views
   Kokkos::deep_copy(dnodes_grouped_by_level, nodes_grouped_by_level);
   Kokkos::deep_copy(dnodes_per_level, nodes_per_level);
@@ -761,6 +960,12 @@ void upper_tri_symbolic ( TriSolveHandle &thandle, const RowMapType drow_map, co
   }
 #endif
  }
+ else if (thandle.get_algorithm () == SPTRSVAlgorithm::SYNCFREE) {
+  tri_syncfree_symbolic (thandle, drow_map, dentries, false);
+ }
+ else if (thandle.get_algorithm () == SPTRSVAlgorithm::JACOBI_SWEEPS) {
+  tri_jacobi_symbolic (thandle, drow_map, dentries);
+ }
 #ifdef KOKKOSKERNELS_ENABLE_SUPERNODAL_SPTRSV
  else if (thandle.get_algorithm () == SPTRSVAlgorithm::SUPERNODAL_NAIVE ||
           thandle.get_algorithm () == SPTRSVAlgorithm::SUPERNODAL_ETREE ||
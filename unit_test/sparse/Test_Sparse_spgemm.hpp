@@ -49,6 +49,7 @@
 #include "KokkosKernels_SparseUtils.hpp"
 #include <Kokkos_Concepts.hpp>
 #include <string>
+#include <vector>
 #include <stdexcept>
 
 #include "KokkosSparse_spgemm.hpp"
@@ -159,6 +160,81 @@ int run_spgemm(crsMat_t input_mat, crsMat_t input_mat2, KokkosSparse::SPGEMMAlgo
 
   return 0;
 }
+
+//Symbolic phase of A*B on a handle set up by the caller; returns C with its
+//row map computed and its entries and values allocated.
+template <typename crsMat_t, typename KernelHandle>
+crsMat_t run_spgemm_symbolic(KernelHandle &kh, const crsMat_t &A, const crsMat_t &B) {
+  typedef typename crsMat_t::StaticCrsGraphType graph_t;
+  typedef typename graph_t::row_map_type::non_const_type lno_view_t;
+  typedef typename graph_t::entries_type::non_const_type lno_nnz_view_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+
+  lno_view_t row_mapC("row_mapC", A.numRows() + 1);
+  spgemm_symbolic(&kh, A.numRows(), B.numRows(), B.numCols(),
+      A.graph.row_map, A.graph.entries, false,
+      B.graph.row_map, B.graph.entries, false, row_mapC);
+  size_t c_nnz = kh.get_spgemm_handle()->get_c_nnz();
+  lno_nnz_view_t entriesC(Kokkos::ViewAllocateWithoutInitializing("entriesC"), c_nnz);
+  scalar_view_t valuesC(Kokkos::ViewAllocateWithoutInitializing("valuesC"), c_nnz);
+  return crsMat_t("C", B.numCols(), valuesC, graph_t(entriesC, row_mapC));
+}
+
+//Numeric phase of A*B into C from run_spgemm_symbolic.
+template <typename crsMat_t, typename KernelHandle>
+void run_spgemm_numeric(KernelHandle &kh, const crsMat_t &A, const crsMat_t &B, crsMat_t &C) {
+  spgemm_numeric(&kh, A.numRows(), B.numRows(), B.numCols(),
+      A.graph.row_map, A.graph.entries, A.values, false,
+      B.graph.row_map, B.graph.entries, B.values, false,
+      C.graph.row_map, C.graph.entries, C.values);
+}
+
+template <typename crsMat_t, typename device>
+void run_spgemm_transposed(
+    crsMat_t A, bool transposeA, crsMat_t B, bool transposeB,
+    KokkosSparse::SPGEMMAlgorithm spgemm_algorithm, crsMat_t &result) {
+  typedef typename crsMat_t::StaticCrsGraphType graph_t;
+  typedef typename graph_t::row_map_type::non_const_type lno_view_t;
+  typedef typename graph_t::entries_type::non_const_type   lno_nnz_view_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+
+  typedef typename lno_view_t::value_type size_type;
+  typedef typename lno_nnz_view_t::value_type lno_t;
+  typedef typename scalar_view_t::value_type scalar_t;
+
+  typedef KokkosKernels::Experimental::KokkosKernelsHandle
+      <size_type,lno_t, scalar_t,
+      typename device::execution_space, typename device::memory_space,typename device::memory_space > KernelHandle;
+
+  KernelHandle kh;
+  kh.set_team_work_size(16);
+  kh.set_dynamic_scheduling(true);
+  kh.create_spgemm_handle(spgemm_algorithm);
+
+  //op(A) is m x n, op(B) is n x k.
+  const lno_t m = transposeA ? A.numCols() : A.numRows();
+  const lno_t n = transposeA ? A.numRows() : A.numCols();
+  const lno_t k = transposeB ? B.numRows() : B.numCols();
+
+  lno_view_t row_mapC ("non_const_lnow_row", m + 1);
+  spgemm_symbolic (&kh, m, n, k,
+      A.graph.row_map, A.graph.entries, transposeA,
+      B.graph.row_map, B.graph.entries, transposeB,
+      row_mapC);
+
+  size_t c_nnz_size = kh.get_spgemm_handle()->get_c_nnz();
+  lno_nnz_view_t entriesC (Kokkos::ViewAllocateWithoutInitializing("entriesC"), c_nnz_size);
+  scalar_view_t valuesC (Kokkos::ViewAllocateWithoutInitializing("valuesC"), c_nnz_size);
+  spgemm_numeric(&kh, m, n, k,
+      A.graph.row_map, A.graph.entries, A.values, transposeA,
+      B.graph.row_map, B.graph.entries, B.values, transposeB,
+      row_mapC, entriesC, valuesC);
+
+  graph_t static_graph (entriesC, row_mapC);
+  result = crsMat_t("CrsMatrix", k, valuesC, static_graph);
+  kh.destroy_spgemm_handle();
+}
+
 template <typename crsMat_t, typename device>
 bool is_same_matrix(crsMat_t output_mat1, crsMat_t output_mat2){
 
@@ -284,7 +360,7 @@ void test_spgemm(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_v
   crsMat_t output_mat2;
   run_spgemm<crsMat_t, device>(input_mat, input_mat, SPGEMM_DEBUG, output_mat2);
 
-  std::vector<SPGEMMAlgorithm> algorithms = {SPGEMM_KK_MEMORY, SPGEMM_KK_SPEED, SPGEMM_KK_MEMSPEED};
+  std::vector<SPGEMMAlgorithm> algorithms = {SPGEMM_KK_MEMORY, SPGEMM_KK_SPEED, SPGEMM_KK_MEMSPEED, SPGEMM_KK_AUTO};
 
 #ifdef HAVE_KOKKOSKERNELS_MKL
   algorithms.push_back(SPGEMM_MKL);
@@ -335,6 +411,9 @@ void test_spgemm(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_v
     case SPGEMM_KK_MEMORY:
       algo = "SPGEMM_KK_MEMORY";
       break;
+    case SPGEMM_KK_AUTO:
+      algo = "SPGEMM_KK_AUTO";
+      break;
     default:
       algo = "!!! UNKNOWN ALGO !!!";
     }
@@ -447,11 +526,559 @@ void test_issue402()
   EXPECT_TRUE(correctResult) << "KKMEM still has issue 402 bug; C=AA' is incorrect!\n";
 }
 
+template <typename scalar_t, typename lno_t, typename size_type, typename device>
+void test_spgemm_transpose(lno_t numRows, lno_t numCols, size_type nnz, lno_t bandwidth, lno_t row_size_variance) {
+  using namespace Test;
+  typedef CrsMatrix<scalar_t, lno_t, device, void, size_type> crsMat_t;
+
+  crsMat_t A = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numCols, nnz, row_size_variance, bandwidth);
+  crsMat_t B = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numCols, nnz, row_size_variance, bandwidth);
+  crsMat_t C = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numCols, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t At = KokkosKernels::Impl::transpose_matrix(A);
+  crsMat_t Bt = KokkosKernels::Impl::transpose_matrix(B);
+  crsMat_t Ct = KokkosKernels::Impl::transpose_matrix(C);
+
+  //A^T * B, A * B^T and A^T * C^T against the explicitly transposed products.
+  crsMat_t goldTN, goldNT, goldTT;
+  run_spgemm<crsMat_t, device>(At, B, SPGEMM_DEBUG, goldTN);
+  run_spgemm<crsMat_t, device>(A, Bt, SPGEMM_DEBUG, goldNT);
+  run_spgemm<crsMat_t, device>(At, Ct, SPGEMM_DEBUG, goldTT);
+
+  std::vector<SPGEMMAlgorithm> algorithms = {SPGEMM_KK_MEMORY, SPGEMM_KK_SPEED, SPGEMM_KK_MEMSPEED};
+  for (auto spgemm_algorithm : algorithms)
+  {
+    crsMat_t result;
+    run_spgemm_transposed<crsMat_t, device>(A, true, B, false, spgemm_algorithm, result);
+    EXPECT_TRUE(is_same_matrix<crsMat_t, device>(result, goldTN)) << "A^T*B algo:" << spgemm_algorithm;
+    run_spgemm_transposed<crsMat_t, device>(A, false, B, true, spgemm_algorithm, result);
+    EXPECT_TRUE(is_same_matrix<crsMat_t, device>(result, goldNT)) << "A*B^T algo:" << spgemm_algorithm;
+    run_spgemm_transposed<crsMat_t, device>(A, true, C, true, spgemm_algorithm, result);
+    EXPECT_TRUE(is_same_matrix<crsMat_t, device>(result, goldTT)) << "A^T*C^T algo:" << spgemm_algorithm;
+  }
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, typename device>
+void test_spgemm_rap(lno_t numRows, lno_t numCoarse, size_type nnz, lno_t bandwidth, lno_t row_size_variance) {
+  using namespace Test;
+  typedef CrsMatrix<scalar_t, lno_t, device, void, size_type> crsMat_t;
+  typedef typename device::execution_space::memory_space memory_space;
+  typedef KokkosKernels::Experimental::KokkosKernelsHandle
+      <size_type, lno_t, scalar_t, typename device::execution_space, memory_space, memory_space> KernelHandle;
+
+  crsMat_t A = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t P = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numCoarse, numRows * 2, 1, bandwidth);
+  crsMat_t R = KokkosKernels::Impl::transpose_matrix(P);
+
+  crsMat_t AP, gold;
+  run_spgemm<crsMat_t, device>(A, P, SPGEMM_DEBUG, AP);
+  run_spgemm<crsMat_t, device>(R, AP, SPGEMM_DEBUG, gold);
+
+  KernelHandle kh;
+  kh.create_spgemm_handle(SPGEMM_KK_MEMORY);
+  crsMat_t C;
+  KokkosSparse::spgemm_rap(&kh, R, A, P, C);
+  EXPECT_TRUE(is_same_matrix<crsMat_t, device>(C, gold)) << "spgemm_rap";
+
+  //new values of A, same structure: numeric phase only.
+  auto hvals = Kokkos::create_mirror_view(A.values);
+  Kokkos::deep_copy(hvals, A.values);
+  for (size_t i = 0; i < hvals.extent(0); ++i)
+    hvals(i) = hvals(i) * scalar_t(2) + scalar_t(1);
+  Kokkos::deep_copy(A.values, hvals);
+  run_spgemm<crsMat_t, device>(A, P, SPGEMM_DEBUG, AP);
+  run_spgemm<crsMat_t, device>(R, AP, SPGEMM_DEBUG, gold);
+
+  EXPECT_TRUE(kh.get_spgemm_handle()->is_rap_symbolic_called());
+  KokkosSparse::spgemm_rap(&kh, R, A, P, C);
+  EXPECT_TRUE(is_same_matrix<crsMat_t, device>(C, gold)) << "spgemm_rap numeric reuse";
+  kh.destroy_spgemm_handle();
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, typename device>
+void test_spgemm_streaming(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance) {
+  using namespace Test;
+  typedef CrsMatrix<scalar_t, lno_t, device, void, size_type> crsMat_t;
+  typedef typename device::execution_space::memory_space memory_space;
+  typedef KokkosKernels::Experimental::KokkosKernelsHandle
+      <size_type, lno_t, scalar_t, typename device::execution_space, memory_space, memory_space> KernelHandle;
+
+  crsMat_t A = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t gold;
+  run_spgemm<crsMat_t, device>(A, A, SPGEMM_DEBUG, gold);
+
+  //a budget far below the size of C forces many batches.
+  const size_t budget = gold.nnz() * (sizeof(lno_t) + sizeof(scalar_t)) / 8;
+  for (auto spgemm_algorithm : {SPGEMM_KK_MEMORY, SPGEMM_KK_SPEED})
+  {
+    KernelHandle kh;
+    kh.create_spgemm_handle(spgemm_algorithm);
+    kh.get_spgemm_handle()->set_memory_budget(budget);
+
+    int num_batches = 0;
+    lno_t next_row = 0;
+    KokkosSparse::spgemm_streaming(&kh, A, A,
+      [&] (lno_t row_begin, lno_t row_end,
+           const typename crsMat_t::row_map_type::non_const_type&,
+           const typename crsMat_t::index_type::non_const_type&,
+           const typename crsMat_t::values_type::non_const_type&) {
+        EXPECT_EQ(row_begin, next_row);
+        next_row = row_end;
+        ++num_batches;
+      });
+    EXPECT_EQ(next_row, numRows);
+    EXPECT_GT(num_batches, 1);
+    //the batches compress B once; the handle gets its setting back.
+    EXPECT_FALSE(kh.get_spgemm_handle()->get_reuse_compressed_b());
+
+    crsMat_t C;
+    KokkosSparse::spgemm_streaming_append(&kh, A, A, C);
+    EXPECT_TRUE(is_same_matrix<crsMat_t, device>(C, gold)) << "spgemm_streaming algo:" << spgemm_algorithm;
+    kh.destroy_spgemm_handle();
+  }
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, typename device>
+void test_spgemm_numeric_reuse(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance) {
+  using namespace Test;
+  typedef CrsMatrix<scalar_t, lno_t, device, void, size_type> crsMat_t;
+  typedef typename crsMat_t::StaticCrsGraphType graph_t;
+  typedef typename graph_t::entries_type::non_const_type lno_nnz_view_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+  typedef typename device::execution_space::memory_space memory_space;
+  typedef KokkosKernels::Experimental::KokkosKernelsHandle
+      <size_type, lno_t, scalar_t, typename device::execution_space, memory_space, memory_space> KernelHandle;
+
+  crsMat_t A = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t B = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+
+  for (auto spgemm_algorithm : {SPGEMM_KK_MEMORY, SPGEMM_KK_SPEED})
+  {
+    KernelHandle kh;
+    kh.create_spgemm_handle(spgemm_algorithm);
+    kh.get_spgemm_handle()->set_numeric_reuse(true);
+    crsMat_t C = run_spgemm_symbolic(kh, A, B);
+
+    //first numeric records the map, the following ones reuse it with new values.
+    for (int iter = 0; iter < 3; ++iter){
+      if (iter > 0){
+        auto hvals = Kokkos::create_mirror_view(A.values);
+        Kokkos::deep_copy(hvals, A.values);
+        for (size_t i = 0; i < hvals.extent(0); ++i)
+          hvals(i) = hvals(i) * scalar_t(0.5) + scalar_t(iter);
+        Kokkos::deep_copy(A.values, hvals);
+      }
+      run_spgemm_numeric(kh, A, B, C);
+      EXPECT_TRUE(kh.get_spgemm_handle()->is_numeric_reuse_built());
+
+      crsMat_t gold;
+      run_spgemm<crsMat_t, device>(A, B, SPGEMM_DEBUG, gold);
+      EXPECT_TRUE(is_same_matrix<crsMat_t, device>(C, gold)) << "numeric reuse iter:" << iter << " algo:" << spgemm_algorithm;
+    }
+
+    //the map is not applied to a C it was not recorded for.
+    crsMat_t C2("C2", C.numCols(), scalar_view_t("valuesC2", C.nnz()),
+        graph_t(lno_nnz_view_t("entriesC2", C.nnz()), C.graph.row_map));
+    run_spgemm_numeric(kh, A, B, C2);
+    crsMat_t gold;
+    run_spgemm<crsMat_t, device>(A, B, SPGEMM_DEBUG, gold);
+    EXPECT_TRUE(is_same_matrix<crsMat_t, device>(C2, gold)) << "numeric reuse, other C algo:" << spgemm_algorithm;
+    kh.destroy_spgemm_handle();
+  }
+}
+
+namespace Test {
+
+//keeps the entries of C that are (or, with complement, are not) in the structure of M.
+template <typename crsMat_t>
+crsMat_t filter_by_mask(crsMat_t C, crsMat_t M, bool complement) {
+  typedef typename crsMat_t::StaticCrsGraphType graph_t;
+  typedef typename graph_t::row_map_type::non_const_type lno_view_t;
+  typedef typename graph_t::entries_type::non_const_type lno_nnz_view_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+
+  auto hrmC = Kokkos::create_mirror_view(C.graph.row_map);
+  auto heC = Kokkos::create_mirror_view(C.graph.entries);
+  auto hvC = Kokkos::create_mirror_view(C.values);
+  auto hrmM = Kokkos::create_mirror_view(M.graph.row_map);
+  auto heM = Kokkos::create_mirror_view(M.graph.entries);
+  Kokkos::deep_copy(hrmC, C.graph.row_map);
+  Kokkos::deep_copy(heC, C.graph.entries);
+  Kokkos::deep_copy(hvC, C.values);
+  Kokkos::deep_copy(hrmM, M.graph.row_map);
+  Kokkos::deep_copy(heM, M.graph.entries);
+
+  const size_t num_rows = C.numRows();
+  std::vector<char> in_mask(C.numCols(), 0);
+  std::vector<size_t> rowmap(num_rows + 1, 0);
+  std::vector<typename lno_nnz_view_t::non_const_value_type> entries;
+  std::vector<typename scalar_view_t::non_const_value_type> values;
+  for (size_t i = 0; i < num_rows; ++i) {
+    for (size_t j = hrmM(i); j < size_t(hrmM(i + 1)); ++j) in_mask[heM(j)] = 1;
+    for (size_t j = hrmC(i); j < size_t(hrmC(i + 1)); ++j) {
+      if (bool(in_mask[heC(j)]) != complement) {
+        entries.push_back(heC(j));
+        values.push_back(hvC(j));
+      }
+    }
+    for (size_t j = hrmM(i); j < size_t(hrmM(i + 1)); ++j) in_mask[heM(j)] = 0;
+    rowmap[i + 1] = entries.size();
+  }
+
+  lno_view_t row_map("filtered rowmap", num_rows + 1);
+  lno_nnz_view_t ents("filtered entries", entries.size());
+  scalar_view_t vals("filtered values", values.size());
+  auto hrm = Kokkos::create_mirror_view(row_map);
+  auto he = Kokkos::create_mirror_view(ents);
+  auto hv = Kokkos::create_mirror_view(vals);
+  for (size_t i = 0; i <= num_rows; ++i) hrm(i) = rowmap[i];
+  for (size_t j = 0; j < entries.size(); ++j) { he(j) = entries[j]; hv(j) = values[j]; }
+  Kokkos::deep_copy(row_map, hrm);
+  Kokkos::deep_copy(ents, he);
+  Kokkos::deep_copy(vals, hv);
+  return crsMat_t("filtered", C.numCols(), vals, graph_t(ents, row_map));
+}
+
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, typename device>
+void test_spgemm_masked(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance) {
+  using namespace Test;
+  typedef CrsMatrix<scalar_t, lno_t, device, void, size_type> crsMat_t;
+
+  crsMat_t A = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t B = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t M = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz * 2, row_size_variance, bandwidth);
+
+  crsMat_t AB;
+  run_spgemm<crsMat_t, device>(A, B, SPGEMM_DEBUG, AB);
+
+  for (int complement = 0; complement < 2; ++complement) {
+    crsMat_t gold = filter_by_mask(AB, M, complement != 0);
+    crsMat_t C;
+    KokkosSparse::spgemm_masked(M, A, B, C, complement != 0);
+    EXPECT_TRUE(is_same_matrix<crsMat_t, device>(C, gold)) << "spgemm_masked complement:" << complement;
+
+    //numeric phase again with new values of A.
+    auto hvals = Kokkos::create_mirror_view(A.values);
+    Kokkos::deep_copy(hvals, A.values);
+    for (size_t i = 0; i < hvals.extent(0); ++i)
+      hvals(i) = hvals(i) * scalar_t(2) + scalar_t(1);
+    Kokkos::deep_copy(A.values, hvals);
+    run_spgemm<crsMat_t, device>(A, B, SPGEMM_DEBUG, AB);
+    gold = filter_by_mask(AB, M, complement != 0);
+    KokkosSparse::spgemm_masked_numeric(M, A, B, C, complement != 0);
+    EXPECT_TRUE(is_same_matrix<crsMat_t, device>(C, gold)) << "spgemm_masked numeric complement:" << complement;
+  }
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, typename device>
+void test_spgemm_semiring(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance) {
+  using namespace Test;
+  //min-plus needs ordered values, so this runs on the magnitude type of
+  //scalar_t (scalar_t itself unless it is complex).
+  typedef typename Kokkos::Details::ArithTraits<scalar_t>::mag_type value_t;
+  typedef CrsMatrix<value_t, lno_t, device, void, size_type> crsMat_t;
+  typedef KokkosKernels::Experimental::MinPlusSemiring<value_t> min_plus_t;
+
+  crsMat_t A = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t B = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t C;
+  KokkosSparse::spgemm_semiring(A, B, C, min_plus_t());
+
+  auto hrmA = Kokkos::create_mirror_view(A.graph.row_map);
+  auto heA = Kokkos::create_mirror_view(A.graph.entries);
+  auto hvA = Kokkos::create_mirror_view(A.values);
+  auto hrmB = Kokkos::create_mirror_view(B.graph.row_map);
+  auto heB = Kokkos::create_mirror_view(B.graph.entries);
+  auto hvB = Kokkos::create_mirror_view(B.values);
+  auto hrmC = Kokkos::create_mirror_view(C.graph.row_map);
+  auto heC = Kokkos::create_mirror_view(C.graph.entries);
+  auto hvC = Kokkos::create_mirror_view(C.values);
+  Kokkos::deep_copy(hrmA, A.graph.row_map);
+  Kokkos::deep_copy(heA, A.graph.entries);
+  Kokkos::deep_copy(hvA, A.values);
+  Kokkos::deep_copy(hrmB, B.graph.row_map);
+  Kokkos::deep_copy(heB, B.graph.entries);
+  Kokkos::deep_copy(hvB, B.values);
+  Kokkos::deep_copy(hrmC, C.graph.row_map);
+  Kokkos::deep_copy(heC, C.graph.entries);
+  Kokkos::deep_copy(hvC, C.values);
+
+  //min is exact and order independent, so compare exactly.
+  int num_errors = 0;
+  std::vector<value_t> row(numRows, 0);
+  std::vector<char> stored(numRows, 0);
+  for (lno_t i = 0; i < numRows; ++i) {
+    size_t row_nnz = 0;
+    for (size_type j = hrmA(i); j < hrmA(i + 1); ++j) {
+      const lno_t k = heA(j);
+      for (size_type l = hrmB(k); l < hrmB(k + 1); ++l) {
+        const lno_t col = heB(l);
+        const value_t v = min_plus_t::multiply(hvA(j), hvB(l));
+        if (!stored[col]) { stored[col] = 1; row[col] = v; ++row_nnz; }
+        else row[col] = min_plus_t::add(row[col], v);
+      }
+    }
+    if (row_nnz != size_t(hrmC(i + 1) - hrmC(i))) ++num_errors;
+    for (size_type j = hrmC(i); j < hrmC(i + 1); ++j) {
+      const lno_t col = heC(j);
+      if (!stored[col] || row[col] != hvC(j)) ++num_errors;
+    }
+    for (size_type j = hrmA(i); j < hrmA(i + 1); ++j) {
+      const lno_t k = heA(j);
+      for (size_type l = hrmB(k); l < hrmB(k + 1); ++l) stored[heB(l)] = 0;
+    }
+  }
+  EXPECT_EQ(num_errors, 0) << "spgemm_semiring min-plus";
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, typename device>
+void test_spgemm_sorted_output(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance) {
+  using namespace Test;
+  typedef CrsMatrix<scalar_t, lno_t, device, void, size_type> crsMat_t;
+  typedef typename device::execution_space::memory_space memory_space;
+  typedef KokkosKernels::Experimental::KokkosKernelsHandle
+      <size_type, lno_t, scalar_t, typename device::execution_space, memory_space, memory_space> KernelHandle;
+
+  crsMat_t A = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t B = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t gold;
+  run_spgemm<crsMat_t, device>(A, B, SPGEMM_DEBUG, gold);
+
+  for (auto spgemm_algorithm : {SPGEMM_KK_MEMORY, SPGEMM_KK_SPEED, SPGEMM_KK_LP})
+  {
+    KernelHandle kh;
+    kh.create_spgemm_handle(spgemm_algorithm);
+    kh.get_spgemm_handle()->set_sort_output(true);
+    crsMat_t C = run_spgemm_symbolic(kh, A, B);
+    run_spgemm_numeric(kh, A, B, C);
+    kh.destroy_spgemm_handle();
+
+    auto h_rowmap = Kokkos::create_mirror_view(C.graph.row_map);
+    auto h_entries = Kokkos::create_mirror_view(C.graph.entries);
+    Kokkos::deep_copy(h_rowmap, C.graph.row_map);
+    Kokkos::deep_copy(h_entries, C.graph.entries);
+    lno_t num_unsorted_rows = 0;
+    for (lno_t i = 0; i < numRows; ++i){
+      for (size_type j = h_rowmap(i) + 1; j < h_rowmap(i + 1); ++j){
+        if (!(h_entries(j - 1) < h_entries(j))) { ++num_unsorted_rows; break; }
+      }
+    }
+    EXPECT_EQ(num_unsorted_rows, 0) << "sorted output algo:" << spgemm_algorithm;
+
+    EXPECT_TRUE(is_same_matrix<crsMat_t, device>(C, gold)) << "sorted output algo:" << spgemm_algorithm;
+  }
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, typename device>
+void test_spgemm_numa_first_touch(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance) {
+  using namespace Test;
+  typedef CrsMatrix<scalar_t, lno_t, device, void, size_type> crsMat_t;
+  typedef typename device::execution_space::memory_space memory_space;
+  typedef KokkosKernels::Experimental::KokkosKernelsHandle
+      <size_type, lno_t, scalar_t, typename device::execution_space, memory_space, memory_space> KernelHandle;
+
+  crsMat_t A = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t B = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t gold;
+  run_spgemm<crsMat_t, device>(A, B, SPGEMM_DEBUG, gold);
+
+  for (auto spgemm_algorithm : {SPGEMM_KK_MEMORY, SPGEMM_KK_SPEED})
+  {
+    KernelHandle kh;
+    kh.set_dynamic_scheduling(true);
+    kh.create_spgemm_handle(spgemm_algorithm);
+    kh.get_spgemm_handle()->set_numa_first_touch(true);
+    crsMat_t C = run_spgemm_symbolic(kh, A, B);
+    run_spgemm_numeric(kh, A, B, C);
+    kh.destroy_spgemm_handle();
+
+    EXPECT_TRUE(is_same_matrix<crsMat_t, device>(C, gold)) << "numa first touch algo:" << spgemm_algorithm;
+  }
+}
+
+namespace Test {
+
+//alpha*X + beta*Y, computed on the host.
+template <typename crsMat_t>
+crsMat_t add_matrices(typename crsMat_t::non_const_value_type alpha, crsMat_t X,
+                      typename crsMat_t::non_const_value_type beta, crsMat_t Y) {
+  typedef typename crsMat_t::StaticCrsGraphType graph_t;
+  typedef typename graph_t::row_map_type::non_const_type lno_view_t;
+  typedef typename graph_t::entries_type::non_const_type lno_nnz_view_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+  typedef typename crsMat_t::non_const_value_type scalar_t;
+
+  auto hrmX = Kokkos::create_mirror_view(X.graph.row_map);
+  auto heX = Kokkos::create_mirror_view(X.graph.entries);
+  auto hvX = Kokkos::create_mirror_view(X.values);
+  auto hrmY = Kokkos::create_mirror_view(Y.graph.row_map);
+  auto heY = Kokkos::create_mirror_view(Y.graph.entries);
+  auto hvY = Kokkos::create_mirror_view(Y.values);
+  Kokkos::deep_copy(hrmX, X.graph.row_map);
+  Kokkos::deep_copy(heX, X.graph.entries);
+  Kokkos::deep_copy(hvX, X.values);
+  Kokkos::deep_copy(hrmY, Y.graph.row_map);
+  Kokkos::deep_copy(heY, Y.graph.entries);
+  Kokkos::deep_copy(hvY, Y.values);
+
+  const size_t num_rows = X.numRows();
+  std::vector<scalar_t> row(X.numCols(), scalar_t());
+  std::vector<char> stored(X.numCols(), 0);
+  std::vector<size_t> rowmap(num_rows + 1, 0);
+  std::vector<typename lno_nnz_view_t::non_const_value_type> entries;
+  for (size_t i = 0; i < num_rows; ++i) {
+    const size_t row_begin = entries.size();
+    for (size_t j = hrmY(i); j < size_t(hrmY(i + 1)); ++j) {
+      if (!stored[heY(j)]) { stored[heY(j)] = 1; entries.push_back(heY(j)); }
+      row[heY(j)] += beta * hvY(j);
+    }
+    for (size_t j = hrmX(i); j < size_t(hrmX(i + 1)); ++j) {
+      if (!stored[heX(j)]) { stored[heX(j)] = 1; entries.push_back(heX(j)); }
+      row[heX(j)] += alpha * hvX(j);
+    }
+    for (size_t j = row_begin; j < entries.size(); ++j) stored[entries[j]] = 0;
+    rowmap[i + 1] = entries.size();
+  }
+
+  lno_view_t row_map("sum rowmap", num_rows + 1);
+  lno_nnz_view_t ents("sum entries", entries.size());
+  scalar_view_t vals("sum values", entries.size());
+  auto hrm = Kokkos::create_mirror_view(row_map);
+  auto he = Kokkos::create_mirror_view(ents);
+  auto hv = Kokkos::create_mirror_view(vals);
+  for (size_t i = 0; i <= num_rows; ++i) hrm(i) = rowmap[i];
+  for (size_t j = 0; j < entries.size(); ++j) {
+    he(j) = entries[j];
+    hv(j) = row[entries[j]];
+    row[entries[j]] = scalar_t();
+  }
+  Kokkos::deep_copy(row_map, hrm);
+  Kokkos::deep_copy(ents, he);
+  Kokkos::deep_copy(vals, hv);
+  return crsMat_t("sum", X.numCols(), vals, graph_t(ents, row_map));
+}
+
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, typename device>
+void test_spgemm_add(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance) {
+  using namespace Test;
+  typedef CrsMatrix<scalar_t, lno_t, device, void, size_type> crsMat_t;
+  typedef typename device::execution_space::memory_space memory_space;
+  typedef KokkosKernels::Experimental::KokkosKernelsHandle
+      <size_type, lno_t, scalar_t, typename device::execution_space, memory_space, memory_space> KernelHandle;
+
+  crsMat_t A = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t B = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t D = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  const scalar_t alpha = scalar_t(2), beta = scalar_t(-0.5);
+
+  crsMat_t AB;
+  run_spgemm<crsMat_t, device>(A, B, SPGEMM_DEBUG, AB);
+  crsMat_t gold = add_matrices(alpha, AB, beta, D);
+
+  KernelHandle kh;
+  kh.create_spgemm_handle(SPGEMM_KK_MEMORY);
+  crsMat_t C;
+  KokkosSparse::spgemm_add(&kh, alpha, A, B, beta, D, C);
+  EXPECT_TRUE(is_same_matrix<crsMat_t, device>(C, gold)) << "spgemm_add";
+
+  //new values of D, same structure: numeric phase only.
+  auto hvals = Kokkos::create_mirror_view(D.values);
+  Kokkos::deep_copy(hvals, D.values);
+  for (size_t i = 0; i < hvals.extent(0); ++i)
+    hvals(i) = hvals(i) * scalar_t(3) + scalar_t(1);
+  Kokkos::deep_copy(D.values, hvals);
+  gold = add_matrices(alpha, AB, beta, D);
+
+  //a plain spgemm_symbolic on the same handle keeps the state of spgemm_add.
+  typename crsMat_t::row_map_type::non_const_type row_mapAB("row_mapAB", numRows + 1);
+  spgemm_symbolic(&kh, numRows, numRows, numRows,
+      A.graph.row_map, A.graph.entries, false,
+      B.graph.row_map, B.graph.entries, false, row_mapAB);
+  EXPECT_EQ(size_t(kh.get_spgemm_handle()->get_c_nnz()), size_t(AB.nnz()));
+  EXPECT_EQ(size_t(kh.get_spgemm_handle()->get_add_c_nnz()), size_t(C.nnz()));
+
+  EXPECT_TRUE(kh.get_spgemm_handle()->is_add_symbolic_called());
+  KokkosSparse::spgemm_add(&kh, alpha, A, B, beta, D, C);
+  EXPECT_TRUE(is_same_matrix<crsMat_t, device>(C, gold)) << "spgemm_add numeric reuse";
+  kh.destroy_spgemm_handle();
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, typename device>
+void test_spgemm_auto_choice(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance) {
+  using namespace Test;
+  typedef CrsMatrix<scalar_t, lno_t, device, void, size_type> crsMat_t;
+  typedef typename device::execution_space::memory_space memory_space;
+  typedef KokkosKernels::Experimental::KokkosKernelsHandle
+      <size_type, lno_t, scalar_t, typename device::execution_space, memory_space, memory_space> KernelHandle;
+
+  const size_t num_rows = 1000, cache_size = 1 << 20, shmem_size = 48 * 1024;
+  const int vector_size = 8;
+  {
+    KernelHandle kh;
+    kh.create_spgemm_handle(SPGEMM_KK_AUTO);
+    auto sh = kh.get_spgemm_handle();
+    sh->set_auto_cache_size(cache_size);
+    EXPECT_TRUE(sh->is_auto_algorithm());
+    EXPECT_FALSE(sh->is_auto_selected());
+
+    //host, clearly sparse: 16 flops per row against 10^8 columns of B, a dense
+    //accumulator would be far larger than the cache and the hash.
+    sh->choose_auto_algorithm(16, 16 * num_rows, num_rows, 100000000, false, shmem_size, vector_size);
+    EXPECT_TRUE(sh->is_auto_selected());
+    EXPECT_EQ(sh->get_algorithm_type(), SPGEMM_KK_MEMORY);
+    EXPECT_EQ(sh->get_accumulator_type(), SPGEMM_ACC_SPARSE);
+
+    //host, clearly dense: 50000 flops per row into 1000 columns of B.
+    sh->choose_auto_algorithm(50000, 50000 * num_rows, num_rows, 1000, false, shmem_size, vector_size);
+    EXPECT_EQ(sh->get_algorithm_type(), SPGEMM_KK_SPEED);
+    EXPECT_EQ(sh->get_accumulator_type(), SPGEMM_ACC_DENSE);
+
+    //cuda, clearly sparse: the hash of a 16 flop row fits the shared memory of a thread.
+    sh->choose_auto_algorithm(16, 16 * num_rows, num_rows, 100000000, true, shmem_size, vector_size);
+    EXPECT_EQ(sh->get_algorithm_type(), SPGEMM_KK_MEMORY);
+    EXPECT_EQ(sh->get_auto_vector_size(), vector_size);
+
+    //cuda, clearly dense: the hash of a 2^20 flop row does not fit a team.
+    sh->choose_auto_algorithm(1 << 20, size_t(1 << 20) * num_rows, num_rows, 1 << 20, true, shmem_size, vector_size);
+    EXPECT_EQ(sh->get_algorithm_type(), SPGEMM_KK_MEMORY_BIGSPREADTEAM);
+    EXPECT_EQ(sh->get_accumulator_type(), SPGEMM_ACC_SPARSE);
+    kh.destroy_spgemm_handle();
+  }
+
+  //the symbolic phase records its choice in the handle.
+  crsMat_t A = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows, numRows, nnz, row_size_variance, bandwidth);
+  crsMat_t gold;
+  run_spgemm<crsMat_t, device>(A, A, SPGEMM_DEBUG, gold);
+
+  KernelHandle kh;
+  kh.create_spgemm_handle(SPGEMM_KK_AUTO);
+  crsMat_t C = run_spgemm_symbolic(kh, A, A);
+  auto sh = kh.get_spgemm_handle();
+  EXPECT_TRUE(sh->is_auto_selected());
+  EXPECT_NE(sh->get_algorithm_type(), SPGEMM_KK_AUTO);
+  run_spgemm_numeric(kh, A, A, C);
+  EXPECT_TRUE(is_same_matrix<crsMat_t, device>(C, gold)) << "spgemm auto choice";
+  kh.destroy_spgemm_handle();
+}
+
 #define EXECUTE_TEST(SCALAR, ORDINAL, OFFSET, DEVICE) \
 TEST_F( TestCategory, sparse ## _ ## spgemm ## _ ## SCALAR ## _ ## ORDINAL ## _ ## OFFSET ## _ ## DEVICE ) { \
   test_spgemm<SCALAR,ORDINAL,OFFSET,DEVICE>(10000, 10000 * 30, 500, 10); \
   test_spgemm<SCALAR,ORDINAL,OFFSET,DEVICE>(0, 0, 10, 10); \
   test_issue402<SCALAR,ORDINAL,OFFSET,DEVICE>(); \
+  test_spgemm_transpose<SCALAR,ORDINAL,OFFSET,DEVICE>(3000, 2000, 3000 * 10, 200, 5); \
+  test_spgemm_rap<SCALAR,ORDINAL,OFFSET,DEVICE>(4000, 1000, 4000 * 8, 200, 4); \
+  test_spgemm_streaming<SCALAR,ORDINAL,OFFSET,DEVICE>(5000, 5000 * 10, 200, 5); \
+  test_spgemm_numeric_reuse<SCALAR,ORDINAL,OFFSET,DEVICE>(5000, 5000 * 10, 200, 5); \
+  test_spgemm_masked<SCALAR,ORDINAL,OFFSET,DEVICE>(5000, 5000 * 10, 200, 5); \
+  test_spgemm_semiring<SCALAR,ORDINAL,OFFSET,DEVICE>(3000, 3000 * 10, 200, 5); \
+  test_spgemm_sorted_output<SCALAR,ORDINAL,OFFSET,DEVICE>(5000, 5000 * 10, 200, 5); \
+  test_spgemm_numa_first_touch<SCALAR,ORDINAL,OFFSET,DEVICE>(5000, 5000 * 10, 200, 5); \
+  test_spgemm_add<SCALAR,ORDINAL,OFFSET,DEVICE>(5000, 5000 * 10, 200, 5); \
+  test_spgemm_auto_choice<SCALAR,ORDINAL,OFFSET,DEVICE>(2000, 2000 * 10, 200, 5); \
 }
 
 //test_spgemm<SCALAR,ORDINAL,OFFSET,DEVICE>(50000, 50000 * 30, 100, 10);
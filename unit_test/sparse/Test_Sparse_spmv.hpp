@@ -1,12 +1,23 @@
 #include<gtest/gtest.h>
 #include<Kokkos_Core.hpp>
 #include<Kokkos_Random.hpp>
+#include<map>
+#include<string>
+#include<vector>
 
 #include<KokkosSparse_spmv.hpp>
+#include<KokkosSparse_spmv_fused.hpp>
+#include<KokkosSparse_spmv_powers.hpp>
+#include<KokkosSparse_BlockCrsMatrix.hpp>
+#include<KokkosSparse_SellCSigmaMatrix.hpp>
+#include<KokkosSparse_CompressedCrsMatrix.hpp>
+#include<KokkosSparse_SymmetricCrsMatrix.hpp>
+#include<KokkosKernels_Handle.hpp>
 #include<KokkosKernels_TestUtils.hpp>
 #include<KokkosKernels_Test_Structured_Matrix.hpp>
 #include<KokkosKernels_IOUtils.hpp>
 #include<KokkosKernels_Utils.hpp>
+#include<KokkosKernels_Semiring.hpp>
 
 #ifndef kokkos_complex_double
 #define kokkos_complex_double Kokkos::complex<double>
@@ -38,7 +49,8 @@ struct fSPMV {
     const mag_type error = AT::abs(expected_y(i)-y(i))
       / (AT::abs(expected_y(i)) > ATM::zero() ? AT::abs(expected_y(i)) : ATM::one());
 
-    if(error > eps) {
+    // a NaN in y is an error as well
+    if(!(error <= eps)) {
       err++;
       printf("expected_y(%d)=%f, y(%d)=%f\n", i, AT::abs(expected_y(i)), i, AT::abs(y(i)));
     }
@@ -100,7 +112,8 @@ void sequential_spmv(crsMat_t input_mat, x_vector_type x, y_vector_type y,
 template <typename crsMat_t, typename x_vector_type, typename y_vector_type>
 void check_spmv(crsMat_t input_mat, x_vector_type x, y_vector_type y,
                 typename y_vector_type::non_const_value_type alpha,
-                typename y_vector_type::non_const_value_type beta) {
+                typename y_vector_type::non_const_value_type beta,
+                KokkosSparse::SPMVAlgorithm algo = KokkosSparse::SPMVAlgorithm::SPMV_DEFAULT) {
   //typedef typename crsMat_t::StaticCrsGraphType graph_t;
   using ExecSpace = typename crsMat_t::execution_space;
   using my_exec_space    = Kokkos::RangePolicy<ExecSpace>;
@@ -119,7 +132,7 @@ void check_spmv(crsMat_t input_mat, x_vector_type x, y_vector_type y,
 
   sequential_spmv(input_mat, x, expected_y, alpha, beta);
   //KokkosKernels::Impl::print_1Dview(expected_y);
-  KokkosSparse::spmv("N", alpha, input_mat, x, beta, y);
+  KokkosSparse::spmv(algo, "N", alpha, input_mat, x, beta, y);
   //KokkosKernels::Impl::print_1Dview(y);
   int num_errors = 0;
   Kokkos::parallel_reduce("KokkosSparse::Test::spmv",
@@ -135,7 +148,8 @@ void check_spmv(crsMat_t input_mat, x_vector_type x, y_vector_type y,
 template <typename crsMat_t, typename x_vector_type, typename y_vector_type>
 void check_spmv_mv(crsMat_t input_mat, x_vector_type x, y_vector_type y, y_vector_type expected_y,
                    typename y_vector_type::non_const_value_type alpha,
-                   typename y_vector_type::non_const_value_type beta, int numMV) {
+                   typename y_vector_type::non_const_value_type beta, int numMV,
+                   KokkosSparse::SPMVAlgorithm algo = KokkosSparse::SPMVAlgorithm::SPMV_DEFAULT) {
   using ExecSpace = typename crsMat_t::execution_space;
   using my_exec_space = Kokkos::RangePolicy<ExecSpace>;
   using y_value_type     = typename y_vector_type::non_const_value_type;
@@ -151,7 +165,7 @@ void check_spmv_mv(crsMat_t input_mat, x_vector_type x, y_vector_type y, y_vecto
 
   Kokkos::fence();
 
-  KokkosSparse::spmv("N", alpha, input_mat, x, beta, y);
+  KokkosSparse::spmv(algo, "N", alpha, input_mat, x, beta, y);
 
 
   for (int i = 0; i < numMV; ++i){
@@ -262,6 +276,92 @@ void check_spmv_mv_struct(const crsMat_t input_mat,
   }
 } // check_spmv_mv_struct
 
+/// Compare y with expected_y, with the tolerance of check_spmv.
+template <typename expected_vector_type, typename y_vector_type>
+typename std::enable_if<static_cast<int> (y_vector_type::rank) == 1>::type
+check_spmv_result(const std::string& label, expected_vector_type expected_y, y_vector_type y) {
+  using ExecSpace        = typename y_vector_type::execution_space;
+  using my_exec_space    = Kokkos::RangePolicy<ExecSpace>;
+  using y_value_mag_type = typename Kokkos::ArithTraits<typename y_vector_type::non_const_value_type>::mag_type;
+
+  const y_value_mag_type eps = std::is_same<y_value_mag_type, float>::value ? 2*1e-3 : 1e-7;
+  int num_errors = 0;
+  Kokkos::parallel_reduce("KokkosSparse::Test::spmv_result",
+                          my_exec_space(0, y.extent(0)),
+                          fSPMV<expected_vector_type, y_vector_type>(expected_y, y, eps),
+                          num_errors);
+  if(num_errors>0) printf("KokkosSparse::Test::%s: %i errors of %i\n",
+                          label.c_str(), num_errors, y.extent_int(0));
+  EXPECT_TRUE(num_errors==0);
+}
+
+/// Same as above for multivectors, one column at a time.
+template <typename expected_vector_type, typename y_vector_type>
+typename std::enable_if<static_cast<int> (y_vector_type::rank) == 2>::type
+check_spmv_result(const std::string& label, expected_vector_type expected_y, y_vector_type y) {
+  typedef Kokkos::View<typename y_vector_type::non_const_value_type*, typename y_vector_type::device_type> vector_t;
+  for (int v = 0; v < y.extent_int(1); ++v) {
+    vector_t expected_v ("expected_v", y.extent(0));
+    vector_t y_v ("y_v", y.extent(0));
+    Kokkos::deep_copy(expected_v, Kokkos::subview(expected_y, Kokkos::ALL(), v));
+    Kokkos::deep_copy(y_v, Kokkos::subview(y, Kokkos::ALL(), v));
+    check_spmv_result(label + ", vector " + std::to_string(v), expected_v, y_v);
+  }
+}
+
+/// sequential_spmv applied to each column of the multivectors x and y.
+template <typename crsMat_t, typename x_vector_type, typename y_vector_type>
+void sequential_spmv_mv(crsMat_t input_mat, x_vector_type x, y_vector_type y,
+                        typename y_vector_type::non_const_value_type alpha,
+                        typename y_vector_type::non_const_value_type beta) {
+  typedef Kokkos::View<typename y_vector_type::non_const_value_type*, typename y_vector_type::device_type> vector_t;
+  for (int v = 0; v < y.extent_int(1); ++v) {
+    vector_t x_v ("x_v", x.extent(0));
+    vector_t y_v ("y_v", y.extent(0));
+    Kokkos::deep_copy(x_v, Kokkos::subview(x, Kokkos::ALL(), v));
+    Kokkos::deep_copy(y_v, Kokkos::subview(y, Kokkos::ALL(), v));
+    sequential_spmv(input_mat, x_v, y_v, alpha, beta);
+    Kokkos::deep_copy(Kokkos::subview(y, Kokkos::ALL(), v), y_v);
+  }
+}
+
+/// For (alpha, beta) = (1, 0), (0, 1) and (1, 1), run apply(alpha, beta),
+/// which updates y, and compare y with reference(alpha, beta, expected_y),
+/// where expected_y starts as a copy of y.
+template <typename y_vector_type, typename reference_t, typename apply_t>
+void check_spmv_alpha_beta(const std::string& label, y_vector_type y,
+                           const reference_t& reference, const apply_t& apply) {
+  typedef typename y_vector_type::non_const_value_type scalar_t;
+  const scalar_t alphas[3] = {1.0, 0.0, 1.0};
+  const scalar_t betas[3] = {0.0, 1.0, 1.0};
+  y_vector_type expected_y ("expected", y.layout());
+  for (int i = 0; i < 3; ++i) {
+    Kokkos::deep_copy(expected_y, y);
+    reference(alphas[i], betas[i], expected_y);
+    apply(alphas[i], betas[i]);
+    check_spmv_result(label, expected_y, y);
+  }
+}
+
+/// With alpha = 0, A and x must not be read: x is filled with NaN for
+/// the call of apply(alpha, beta), then restored, and y must come out
+/// as beta*y.
+template <typename x_vector_type, typename y_vector_type, typename apply_t>
+void check_spmv_alpha_zero(const std::string& label, x_vector_type x, y_vector_type y,
+                           const apply_t& apply) {
+  typedef typename y_vector_type::non_const_value_type scalar_t;
+  typedef Kokkos::ArithTraits<typename x_vector_type::non_const_value_type> KAT;
+  x_vector_type saved_x ("saved_x", x.layout());
+  y_vector_type expected_y ("expected", y.layout());
+  Kokkos::deep_copy(saved_x, x);
+  Kokkos::deep_copy(x, KAT::nan());
+  Kokkos::deep_copy(expected_y, y);
+  KokkosBlas::scal(expected_y, scalar_t(0.5), expected_y);
+  apply(scalar_t(0), scalar_t(0.5));
+  check_spmv_result(label + " with alpha = 0", expected_y, y);
+  Kokkos::deep_copy(x, saved_x);
+}
+
 } // namespace Test
 
 template <typename scalar_t, typename lno_t, typename size_type, class Device>
@@ -295,6 +395,729 @@ void test_spmv(lno_t numRows,size_type nnz, lno_t bandwidth, lno_t row_size_vari
   Test::check_spmv(input_mat, input_x, output_y, 1.0, 0.0);
   Test::check_spmv(input_mat, input_x, output_y, 0.0, 1.0);
   Test::check_spmv(input_mat, input_x, output_y, 1.0, 1.0);
+
+  const KokkosSparse::SPMVAlgorithm merge = KokkosSparse::SPMVAlgorithm::SPMV_MERGE_PATH;
+  Test::check_spmv(input_mat, input_x, output_y, 1.0, 0.0, merge);
+  Test::check_spmv(input_mat, input_x, output_y, 0.0, 1.0, merge);
+  Test::check_spmv(input_mat, input_x, output_y, 1.0, 1.0, merge);
+}
+
+// A matrix whose first few rows are dense and the rest have one
+// entry, so that the merge-path kernel splits single rows across
+// several threads.
+template <typename scalar_t, typename lno_t, typename size_type, class Device>
+void test_spmv_long_rows(lno_t numRows, lno_t numLongRows){
+
+  typedef typename KokkosSparse::CrsMatrix<scalar_t, lno_t, Device, void, size_type> crsMat_t;
+  typedef typename crsMat_t::StaticCrsGraphType graph_t;
+  typedef typename graph_t::row_map_type::non_const_type row_map_t;
+  typedef typename graph_t::entries_type::non_const_type entries_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+
+  const size_type nnz = static_cast<size_type> (numLongRows) * numRows + (numRows - numLongRows);
+  row_map_t row_map ("row_map", numRows + 1);
+  entries_t entries ("entries", nnz);
+  scalar_view_t values ("values", nnz);
+
+  auto h_row_map = Kokkos::create_mirror_view (row_map);
+  auto h_entries = Kokkos::create_mirror_view (entries);
+  size_type pos = 0;
+  h_row_map(0) = 0;
+  for (lno_t i = 0; i < numRows; ++i) {
+    if (i < numLongRows) {
+      for (lno_t j = 0; j < numRows; ++j) h_entries(pos++) = j;
+    } else {
+      h_entries(pos++) = i;
+    }
+    h_row_map(i + 1) = pos;
+  }
+  Kokkos::deep_copy (row_map, h_row_map);
+  Kokkos::deep_copy (entries, h_entries);
+
+  Kokkos::Random_XorShift64_Pool<typename Device::execution_space> rand_pool(13718);
+  Kokkos::fill_random(values, rand_pool, scalar_t(10));
+  crsMat_t input_mat ("A", numRows, numRows, nnz, values, row_map, entries);
+
+  scalar_view_t input_x ("x", numRows);
+  scalar_view_t output_y ("y", numRows);
+  Kokkos::fill_random(input_x, rand_pool, scalar_t(10));
+  Kokkos::fill_random(output_y, rand_pool, scalar_t(10));
+
+  const KokkosSparse::SPMVAlgorithm merge = KokkosSparse::SPMVAlgorithm::SPMV_MERGE_PATH;
+  Test::check_spmv(input_mat, input_x, output_y, 1.0, 0.0, merge);
+  Test::check_spmv(input_mat, input_x, output_y, 1.0, 1.0, merge);
+  Test::check_spmv(input_mat, input_x, output_y, 1.0, 1.0);
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, class Device>
+void test_spmv_sellcs(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance,
+                      lno_t chunkHeight, lno_t sigma){
+
+  typedef typename KokkosSparse::CrsMatrix<scalar_t, lno_t, Device, void, size_type> crsMat_t;
+  typedef typename KokkosSparse::Experimental::SellCSigmaMatrix<scalar_t, lno_t, Device, void, size_type> sellMat_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+
+  crsMat_t input_mat = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows,numRows,nnz,row_size_variance, bandwidth);
+  sellMat_t sell_mat ("A_sell", input_mat, chunkHeight, sigma);
+  EXPECT_EQ(sell_mat.numRows(), input_mat.numRows());
+  EXPECT_EQ(sell_mat.nnz(), input_mat.nnz());
+  EXPECT_GE(sell_mat.numStoredEntries(), input_mat.nnz());
+
+  scalar_view_t input_x ("x", input_mat.numCols());
+  scalar_view_t output_y ("y", input_mat.numRows());
+
+  Kokkos::Random_XorShift64_Pool<typename Device::execution_space> rand_pool(13718);
+  Kokkos::fill_random(input_x,rand_pool,scalar_t(10));
+  Kokkos::fill_random(output_y,rand_pool,scalar_t(10));
+
+  const std::string label = "spmv_sellcs with C = " + std::to_string(chunkHeight) + ", sigma = " + std::to_string(sigma);
+  Test::check_spmv_alpha_beta(label, output_y,
+      [&] (scalar_t alpha, scalar_t beta, scalar_view_t expected_y) {
+        Test::sequential_spmv(input_mat, input_x, expected_y, alpha, beta);
+      },
+      [&] (scalar_t alpha, scalar_t beta) {
+        KokkosSparse::spmv("N", alpha, sell_mat, input_x, beta, output_y);
+      });
+  Test::check_spmv_alpha_zero(label, input_x, output_y,
+      [&] (scalar_t alpha, scalar_t beta) {
+        KokkosSparse::spmv("N", alpha, sell_mat, input_x, beta, output_y);
+      });
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, class Device>
+void test_spmv_compressed(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance){
+
+  typedef typename KokkosSparse::CrsMatrix<scalar_t, lno_t, Device, void, size_type> crsMat_t;
+  typedef typename KokkosSparse::Experimental::CompressedCrsMatrix<scalar_t, lno_t, Device, void, size_type> compMat_t;
+  typedef typename compMat_t::storage_value_type storage_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+  typedef Kokkos::RangePolicy<typename Device::execution_space> range_t;
+
+  crsMat_t input_mat = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows,numRows,nnz,row_size_variance, bandwidth);
+  // Round the values to the storage precision, so that the reference
+  // result only differs from the compressed one by summation order.
+  scalar_view_t values = input_mat.values;
+  Kokkos::parallel_for("KokkosSparse::Test::round_values", range_t(0, values.extent(0)),
+                       KOKKOS_LAMBDA(const size_t k) {
+                         values(k) = static_cast<scalar_t>(static_cast<storage_t>(values(k)));
+                       });
+  compMat_t comp_mat ("A_comp", input_mat);
+  EXPECT_EQ(comp_mat.numRows(), input_mat.numRows());
+  EXPECT_EQ(comp_mat.nnz(), input_mat.nnz());
+  if (bandwidth <= 65535) {
+    EXPECT_EQ(comp_mat.numWideEntries(), size_type(0));
+  }
+
+  scalar_view_t input_x ("x", input_mat.numCols());
+  scalar_view_t output_y ("y", input_mat.numRows());
+
+  Kokkos::Random_XorShift64_Pool<typename Device::execution_space> rand_pool(13718);
+  Kokkos::fill_random(input_x,rand_pool,scalar_t(10));
+  Kokkos::fill_random(output_y,rand_pool,scalar_t(10));
+
+  const std::string label = "spmv_compressed with bandwidth = " + std::to_string(bandwidth);
+  Test::check_spmv_alpha_beta(label, output_y,
+      [&] (scalar_t alpha, scalar_t beta, scalar_view_t expected_y) {
+        Test::sequential_spmv(input_mat, input_x, expected_y, alpha, beta);
+      },
+      [&] (scalar_t alpha, scalar_t beta) {
+        KokkosSparse::spmv("N", alpha, comp_mat, input_x, beta, output_y);
+      });
+  Test::check_spmv_alpha_zero(label, input_x, output_y,
+      [&] (scalar_t alpha, scalar_t beta) {
+        KokkosSparse::spmv("N", alpha, comp_mat, input_x, beta, output_y);
+      });
+}
+
+namespace Test {
+
+/// Expand the pattern of block_mat into a point matrix made of dense
+/// blockSize x blockSize blocks, with random values.  Each point row
+/// stores the entries of all the blocks of its block row one after
+/// the other, which is the value layout of BlockCrsMatrix.
+template <typename crsMat_t>
+crsMat_t expand_block_pattern(const crsMat_t& block_mat, typename crsMat_t::ordinal_type blockSize) {
+  typedef typename crsMat_t::StaticCrsGraphType graph_t;
+  typedef typename graph_t::row_map_type::non_const_type row_map_t;
+  typedef typename graph_t::entries_type::non_const_type entries_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+  typedef typename crsMat_t::ordinal_type lno_t;
+  typedef typename crsMat_t::size_type size_type;
+  typedef typename crsMat_t::value_type scalar_t;
+
+  auto h_block_rowmap = Kokkos::create_mirror_view(block_mat.graph.row_map);
+  auto h_block_entries = Kokkos::create_mirror_view(block_mat.graph.entries);
+  Kokkos::deep_copy(h_block_rowmap, block_mat.graph.row_map);
+  Kokkos::deep_copy(h_block_entries, block_mat.graph.entries);
+
+  const lno_t numBlockRows = block_mat.numRows();
+  const lno_t numRows = numBlockRows * blockSize;
+  const lno_t numCols = block_mat.numCols() * blockSize;
+  const size_type point_nnz = block_mat.nnz() * blockSize * blockSize;
+  row_map_t row_map ("row_map", numRows + 1);
+  entries_t entries ("entries", point_nnz);
+  scalar_view_t values ("values", point_nnz);
+  auto h_row_map = Kokkos::create_mirror_view (row_map);
+  auto h_entries = Kokkos::create_mirror_view (entries);
+  size_type pos = 0;
+  h_row_map(0) = 0;
+  for (lno_t i = 0; i < numBlockRows; ++i) {
+    for (lno_t r = 0; r < blockSize; ++r) {
+      for (size_type k = h_block_rowmap(i); k < h_block_rowmap(i + 1); ++k) {
+        for (lno_t c = 0; c < blockSize; ++c) {
+          h_entries(pos++) = h_block_entries(k) * blockSize + c;
+        }
+      }
+      h_row_map(i * blockSize + r + 1) = pos;
+    }
+  }
+  Kokkos::deep_copy (row_map, h_row_map);
+  Kokkos::deep_copy (entries, h_entries);
+
+  Kokkos::Random_XorShift64_Pool<typename crsMat_t::execution_space> rand_pool(4224);
+  Kokkos::fill_random(values, rand_pool, scalar_t(10));
+  return crsMat_t ("A", numRows, numCols, point_nnz, values, row_map, entries);
+}
+
+} // namespace Test
+
+template <typename scalar_t, typename lno_t, typename size_type, class Device>
+void test_spmv_semiring(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance){
+
+  // min-plus needs ordered values, so this runs on the magnitude type of
+  // scalar_t (scalar_t itself unless it is complex).
+  typedef typename Kokkos::Details::ArithTraits<scalar_t>::mag_type value_t;
+  typedef typename KokkosSparse::CrsMatrix<value_t, lno_t, Device, void, size_type> crsMat_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+  typedef KokkosKernels::Experimental::MinPlusSemiring<value_t> min_plus_t;
+  typedef KokkosKernels::Experimental::OrAndSemiring<value_t> or_and_t;
+
+  crsMat_t A = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows,numRows,nnz,row_size_variance, bandwidth);
+  scalar_view_t x ("x", A.numCols());
+  scalar_view_t y ("y", A.numRows());
+  Kokkos::Random_XorShift64_Pool<typename Device::execution_space> rand_pool(13718);
+  Kokkos::fill_random(x,rand_pool,10.0);
+  Kokkos::fill_random(y,rand_pool,10.0);
+
+  auto h_rowmap = Kokkos::create_mirror_view(A.graph.row_map);
+  auto h_entries = Kokkos::create_mirror_view(A.graph.entries);
+  auto h_values = Kokkos::create_mirror_view(A.values);
+  auto h_x = Kokkos::create_mirror_view(x);
+  auto h_y0 = Kokkos::create_mirror_view(y);
+  Kokkos::deep_copy(h_rowmap, A.graph.row_map);
+  Kokkos::deep_copy(h_entries, A.graph.entries);
+  Kokkos::deep_copy(h_values, A.values);
+  Kokkos::deep_copy(h_x, x);
+  Kokkos::deep_copy(h_y0, y);
+
+  // y = y (min) min_j (A(i,j) + x(j)); min is exact, so compare exactly.
+  KokkosSparse::Experimental::spmv_semiring(min_plus_t(), A, x, y, true);
+  auto h_y = Kokkos::create_mirror_view(y);
+  Kokkos::deep_copy(h_y, y);
+  int num_errors = 0;
+  for (lno_t i = 0; i < numRows; ++i) {
+    value_t expected = h_y0(i);
+    for (size_type j = h_rowmap(i); j < h_rowmap(i + 1); ++j)
+      expected = min_plus_t::add(expected, min_plus_t::multiply(h_values(j), h_x(h_entries(j))));
+    if (h_y(i) != expected) ++num_errors;
+  }
+  EXPECT_EQ(num_errors, 0) << "spmv_semiring min-plus";
+
+  // one BFS step: y(i) = 1 if row i has a stored entry in a column of the frontier.
+  for (lno_t i = 0; i < numRows; ++i) h_x(i) = (i % 7 == 0) ? value_t(1) : value_t(0);
+  Kokkos::deep_copy(x, h_x);
+  KokkosSparse::Experimental::spmv_semiring(or_and_t(), A, x, y);
+  Kokkos::deep_copy(h_y, y);
+  num_errors = 0;
+  for (lno_t i = 0; i < numRows; ++i) {
+    value_t expected = 0;
+    for (size_type j = h_rowmap(i); j < h_rowmap(i + 1); ++j)
+      if (h_values(j) != value_t(0) && h_x(h_entries(j)) != value_t(0)) expected = 1;
+    if (h_y(i) != expected) ++num_errors;
+  }
+  EXPECT_EQ(num_errors, 0) << "spmv_semiring or-and";
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, class Device>
+void test_spmv_powers(lno_t numRows, lno_t halfBandwidth, bool periodic, int s, int numBlocks){
+
+  typedef typename KokkosSparse::CrsMatrix<scalar_t, lno_t, Device, void, size_type> crsMat_t;
+  typedef typename crsMat_t::StaticCrsGraphType graph_t;
+  typedef typename graph_t::row_map_type::non_const_type row_map_t;
+  typedef typename graph_t::entries_type::non_const_type entries_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+  typedef Kokkos::View<scalar_t**, Kokkos::LayoutLeft, Device> mv_t;
+
+  // Banded matrix; with periodic, the band wraps around, so the first
+  // rows reference the last columns.
+  row_map_t row_map ("row_map", numRows + 1);
+  auto h_row_map = Kokkos::create_mirror_view (row_map);
+  std::vector<lno_t> cols;
+  h_row_map(0) = 0;
+  for (lno_t i = 0; i < numRows; ++i) {
+    for (lno_t j = i - halfBandwidth; j <= i + halfBandwidth; ++j) {
+      if (j >= 0 && j < numRows)
+        cols.push_back(j);
+      else if (periodic)
+        cols.push_back((j + numRows) % numRows);
+    }
+    h_row_map(i + 1) = cols.size();
+  }
+  const size_type nnz = cols.size();
+  entries_t entries ("entries", nnz);
+  auto h_entries = Kokkos::create_mirror_view (entries);
+  for (size_type k = 0; k < nnz; ++k) h_entries(k) = cols[k];
+  Kokkos::deep_copy (row_map, h_row_map);
+  Kokkos::deep_copy (entries, h_entries);
+
+  // Positive values, scaled so that the powers stay bounded.
+  scalar_view_t values ("values", nnz);
+  Kokkos::Random_XorShift64_Pool<typename Device::execution_space> rand_pool(13718);
+  Kokkos::fill_random(values, rand_pool, scalar_t(2.0 / (2 * halfBandwidth + 1)));
+  crsMat_t input_mat ("A", numRows, numRows, nnz, values, row_map, entries);
+  // numBlocks > 0 asks for an explicit row blocking, as in
+  // StaticCrsGraph::row_block_offsets.
+  if (numBlocks > 0)
+    input_mat.graph.create_block_partitioning(numBlocks);
+
+  // The first pass builds the blocking inside spmv_powers, the others
+  // reuse one plan with a new x each time.
+  const auto plan = KokkosSparse::spmv_powers_plan(input_mat);
+  for (int pass = 0; pass < 3; ++pass) {
+    scalar_view_t input_x ("x", numRows);
+    Kokkos::fill_random(input_x, rand_pool, scalar_t(1));
+
+    mv_t V ("V", numRows, s + 1);
+    if (pass == 0)
+      KokkosSparse::spmv_powers(input_mat, input_x, s, V);
+    else
+      KokkosSparse::spmv_powers(plan, input_mat, input_x, s, V);
+
+    scalar_view_t expected_y ("expected", numRows);
+    Kokkos::deep_copy(expected_y, input_x);
+    for (int k = 0; k <= s; ++k) {
+      if (k > 0) {
+        scalar_view_t previous_y ("previous", numRows);
+        Kokkos::deep_copy(previous_y, expected_y);
+        Test::sequential_spmv(input_mat, previous_y, expected_y, 1.0, 0.0);
+      }
+      scalar_view_t output_y ("y", numRows);
+      Kokkos::deep_copy(output_y, Kokkos::subview(V, Kokkos::ALL(), k));
+      Test::check_spmv_result("spmv_powers pass " + std::to_string(pass) + " for power " + std::to_string(k), expected_y, output_y);
+    }
+  }
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, class Device>
+void test_spmv_bsr(lno_t numBlockRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance,
+                   lno_t blockSize, int numVecs){
+
+  typedef typename KokkosSparse::CrsMatrix<scalar_t, lno_t, Device, void, size_type> crsMat_t;
+  typedef typename KokkosSparse::Experimental::BlockCrsMatrix<scalar_t, lno_t, Device, void, size_type> blockMat_t;
+  typedef Kokkos::View<scalar_t**, Kokkos::LayoutLeft, Device> mv_t;
+
+  crsMat_t block_mat = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numBlockRows,numBlockRows,nnz,row_size_variance, bandwidth);
+  crsMat_t input_mat = Test::expand_block_pattern(block_mat, blockSize);
+  blockMat_t input_block_mat ("A_block", block_mat.numRows(), block_mat.numCols(), input_mat.nnz(),
+                              input_mat.values, block_mat.graph.row_map, block_mat.graph.entries, blockSize);
+  const lno_t numRows = input_mat.numRows();
+
+  mv_t input_x ("x", numRows, numVecs);
+  mv_t output_y ("y", numRows, numVecs);
+  Kokkos::Random_XorShift64_Pool<typename Device::execution_space> rand_pool(13718);
+  Kokkos::fill_random(input_x, rand_pool, scalar_t(10));
+  Kokkos::fill_random(output_y, rand_pool, scalar_t(10));
+
+  Test::check_spmv_alpha_beta("spmv_bsr with block size " + std::to_string(blockSize), output_y,
+      [&] (scalar_t alpha, scalar_t beta, mv_t expected_y) {
+        Test::sequential_spmv_mv(input_mat, input_x, expected_y, alpha, beta);
+      },
+      [&] (scalar_t alpha, scalar_t beta) {
+        if (numVecs == 1) {
+          auto x_1 = Kokkos::subview(input_x, Kokkos::ALL(), 0);
+          auto y_1 = Kokkos::subview(output_y, Kokkos::ALL(), 0);
+          KokkosSparse::spmv("N", alpha, input_block_mat, x_1, beta, y_1);
+        }
+        else {
+          KokkosSparse::spmv("N", alpha, input_block_mat, input_x, beta, output_y);
+        }
+      });
+}
+
+namespace Test {
+
+/// A + A^T (or A + A^H), assembled on the host.
+template <typename crsMat_t>
+crsMat_t symmetrize_matrix(const crsMat_t& A, bool hermitian) {
+  typedef typename crsMat_t::non_const_value_type scalar_t;
+  typedef typename crsMat_t::non_const_ordinal_type lno_t;
+  typedef typename crsMat_t::non_const_size_type size_type;
+  typedef typename crsMat_t::row_map_type::non_const_type row_map_t;
+  typedef typename crsMat_t::index_type::non_const_type entries_t;
+  typedef typename crsMat_t::values_type::non_const_type values_t;
+  typedef Kokkos::ArithTraits<scalar_t> KAT;
+
+  auto rowmap = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), A.graph.row_map);
+  auto entries = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), A.graph.entries);
+  auto values = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), A.values);
+  const lno_t n = A.numRows();
+
+  std::vector<std::map<lno_t, scalar_t> > rows(n);
+  for (lno_t i = 0; i < n; ++i) {
+    for (size_type k = rowmap(i); k < rowmap(i + 1); ++k) {
+      const lno_t j = entries(k);
+      const scalar_t v = values(k);
+      const scalar_t vt = hermitian ? KAT::conj(v) : v;
+      rows[i][j] += v;
+      rows[j][i] += vt;
+    }
+  }
+
+  size_type nnz = 0;
+  for (lno_t i = 0; i < n; ++i) nnz += rows[i].size();
+  row_map_t sym_rowmap("sym_rowmap", n + 1);
+  entries_t sym_entries("sym_entries", nnz);
+  values_t sym_values("sym_values", nnz);
+  auto h_rowmap = Kokkos::create_mirror_view(sym_rowmap);
+  auto h_entries = Kokkos::create_mirror_view(sym_entries);
+  auto h_values = Kokkos::create_mirror_view(sym_values);
+  size_type pos = 0;
+  for (lno_t i = 0; i < n; ++i) {
+    h_rowmap(i) = pos;
+    for (const auto& e : rows[i]) {
+      h_entries(pos) = e.first;
+      h_values(pos) = e.second;
+      ++pos;
+    }
+  }
+  h_rowmap(n) = pos;
+  Kokkos::deep_copy(sym_rowmap, h_rowmap);
+  Kokkos::deep_copy(sym_entries, h_entries);
+  Kokkos::deep_copy(sym_values, h_values);
+  return crsMat_t("A_sym", n, n, nnz, sym_values, sym_rowmap, sym_entries);
+}
+
+} // namespace Test
+
+template <typename scalar_t, typename lno_t, typename size_type, class Device>
+void test_spmv_symmetric(lno_t numRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance, int numVecs){
+
+  typedef typename KokkosSparse::CrsMatrix<scalar_t, lno_t, Device, void, size_type> crsMat_t;
+  typedef typename KokkosSparse::Experimental::SymmetricCrsMatrix<scalar_t, lno_t, Device, void, size_type> symMat_t;
+  typedef Kokkos::View<scalar_t**, Kokkos::LayoutLeft, Device> mv_t;
+
+  crsMat_t base_mat = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows,numRows,nnz,row_size_variance, bandwidth);
+
+  mv_t input_x ("x", numRows, numVecs);
+  mv_t output_y ("y", numRows, numVecs);
+  Kokkos::Random_XorShift64_Pool<typename Device::execution_space> rand_pool(13718);
+  Kokkos::fill_random(input_x, rand_pool, scalar_t(10));
+  Kokkos::fill_random(output_y, rand_pool, scalar_t(10));
+
+  const char* modes[4] = {"N", "T", "C", "H"};
+  for (int h = 0; h < 2; ++h) {
+    const bool hermitian = (h == 1);
+    crsMat_t input_mat = Test::symmetrize_matrix(base_mat, hermitian);
+    symMat_t input_sym_mat ("A_sym", input_mat, hermitian);
+    EXPECT_EQ(input_sym_mat.numRows(), numRows);
+    EXPECT_TRUE(input_sym_mat.numColors() > 0);
+    EXPECT_TRUE(input_sym_mat.lower.nnz() < input_mat.nnz());
+
+    for (int m = 0; m < 4; ++m) {
+      Test::check_spmv_alpha_beta(std::string("spmv_symmetric with mode ") + modes[m] + ", hermitian " + std::to_string(h), output_y,
+          [&] (scalar_t alpha, scalar_t beta, mv_t expected_y) {
+            if (numVecs == 1) {
+              auto x_1 = Kokkos::subview(input_x, Kokkos::ALL(), 0);
+              auto e_1 = Kokkos::subview(expected_y, Kokkos::ALL(), 0);
+              KokkosSparse::spmv(modes[m], alpha, input_mat, x_1, beta, e_1);
+            }
+            else {
+              KokkosSparse::spmv(modes[m], alpha, input_mat, input_x, beta, expected_y);
+            }
+          },
+          [&] (scalar_t alpha, scalar_t beta) {
+            if (numVecs == 1) {
+              auto x_1 = Kokkos::subview(input_x, Kokkos::ALL(), 0);
+              auto y_1 = Kokkos::subview(output_y, Kokkos::ALL(), 0);
+              KokkosSparse::spmv(modes[m], alpha, input_sym_mat, x_1, beta, y_1);
+            }
+            else {
+              KokkosSparse::spmv(modes[m], alpha, input_sym_mat, input_x, beta, output_y);
+            }
+          });
+    }
+  }
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, class Device>
+void test_spmv_symmetric_arrow(lno_t numRows, int numVecs){
+
+  typedef typename KokkosSparse::CrsMatrix<scalar_t, lno_t, Device, void, size_type> crsMat_t;
+  typedef typename crsMat_t::StaticCrsGraphType graph_t;
+  typedef typename graph_t::row_map_type::non_const_type row_map_t;
+  typedef typename graph_t::entries_type::non_const_type entries_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+  typedef typename KokkosSparse::Experimental::SymmetricCrsMatrix<scalar_t, lno_t, Device, void, size_type> symMat_t;
+  typedef Kokkos::View<scalar_t**, Kokkos::LayoutLeft, Device> mv_t;
+
+  // Arrow matrix: a diagonal plus a full first row and column.  Every
+  // row of L + I holds column 0, so each row gets its own color and
+  // spmv takes the atomic path.
+  const size_type nnz = 3 * static_cast<size_type>(numRows) - 2;
+  row_map_t row_map ("row_map", numRows + 1);
+  entries_t entries ("entries", nnz);
+  scalar_view_t values ("values", nnz);
+  auto h_row_map = Kokkos::create_mirror_view (row_map);
+  auto h_entries = Kokkos::create_mirror_view (entries);
+  size_type pos = 0;
+  h_row_map(0) = 0;
+  for (lno_t i = 0; i < numRows; ++i) {
+    if (i == 0) {
+      for (lno_t j = 0; j < numRows; ++j) h_entries(pos++) = j;
+    }
+    else {
+      h_entries(pos++) = 0;
+      h_entries(pos++) = i;
+    }
+    h_row_map(i + 1) = pos;
+  }
+  Kokkos::deep_copy (row_map, h_row_map);
+  Kokkos::deep_copy (entries, h_entries);
+  Kokkos::Random_XorShift64_Pool<typename Device::execution_space> rand_pool(13718);
+  Kokkos::fill_random(values, rand_pool, scalar_t(10));
+  crsMat_t base_mat ("A", numRows, numRows, nnz, values, row_map, entries);
+  crsMat_t input_mat = Test::symmetrize_matrix(base_mat, false);
+
+  symMat_t input_sym_mat ("A_sym", input_mat);
+  EXPECT_TRUE(input_sym_mat.numColors() > KokkosSparse::Impl::spmv_symmetric_max_colors);
+
+  mv_t input_x ("x", numRows, numVecs);
+  mv_t output_y ("y", numRows, numVecs);
+  Kokkos::fill_random(input_x, rand_pool, scalar_t(10));
+  Kokkos::fill_random(output_y, rand_pool, scalar_t(10));
+
+  const char* modes[2] = {"N", "T"};
+  for (int m = 0; m < 2; ++m) {
+    Test::check_spmv_alpha_beta(std::string("spmv_symmetric arrow with mode ") + modes[m], output_y,
+        [&] (scalar_t alpha, scalar_t beta, mv_t expected_y) {
+          KokkosSparse::spmv(modes[m], alpha, input_mat, input_x, beta, expected_y);
+        },
+        [&] (scalar_t alpha, scalar_t beta) {
+          KokkosSparse::spmv(modes[m], alpha, input_sym_mat, input_x, beta, output_y);
+        });
+  }
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, class Device>
+void test_spmv_handle(lno_t numBlockRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance, lno_t blockSize){
+
+  typedef typename KokkosSparse::CrsMatrix<scalar_t, lno_t, Device, void, size_type> crsMat_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+  typedef KokkosKernels::Experimental::KokkosKernelsHandle
+      <size_type, lno_t, scalar_t,
+       typename Device::execution_space, typename Device::memory_space, typename Device::memory_space> KernelHandle;
+
+  // Expand a random matrix into one made of dense blockSize x blockSize
+  // blocks, so that the handle can detect the block structure.
+  crsMat_t block_mat = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numBlockRows,numBlockRows,nnz,row_size_variance, bandwidth);
+  crsMat_t input_mat = Test::expand_block_pattern(block_mat, blockSize);
+  const lno_t numRows = input_mat.numRows();
+  const size_type point_nnz = input_mat.nnz();
+
+  Kokkos::Random_XorShift64_Pool<typename Device::execution_space> rand_pool(13718);
+  scalar_view_t input_x ("x", numRows);
+  scalar_view_t output_y ("y", numRows);
+  Kokkos::fill_random(input_x, rand_pool, scalar_t(10));
+  Kokkos::fill_random(output_y, rand_pool, scalar_t(10));
+
+  KernelHandle kh;
+  kh.create_spmv_handle();
+  KokkosSparse::spmv_symbolic(&kh, input_mat);
+  auto sh = kh.get_spmv_handle();
+  EXPECT_TRUE(sh->is_inspected());
+  EXPECT_EQ(sh->get_num_rows(), numRows);
+  EXPECT_EQ(sh->get_nnz(), point_nnz);
+  EXPECT_EQ(sh->get_block_size() % blockSize, 0);
+  // Dense blocks are applied with the BlockCrsMatrix kernel.
+  EXPECT_EQ(sh->has_block_graph(), sh->get_block_size() > 1);
+  EXPECT_TRUE(sh->get_chosen_algorithm() != KokkosSparse::SPMVAlgorithm::SPMV_DEFAULT);
+
+  size_type histogram_rows = 0;
+  auto histogram = sh->get_row_length_histogram();
+  for (size_t b = 0; b < histogram.extent(0); ++b) histogram_rows += histogram(b);
+  EXPECT_EQ(histogram_rows, size_type(numRows));
+
+  Test::check_spmv_alpha_beta("spmv_handle", output_y,
+      [&] (scalar_t alpha, scalar_t beta, scalar_view_t expected_y) {
+        Test::sequential_spmv(input_mat, input_x, expected_y, alpha, beta);
+      },
+      [&] (scalar_t alpha, scalar_t beta) {
+        KokkosSparse::spmv(&kh, "N", alpha, input_mat, input_x, beta, output_y);
+      });
+  kh.destroy_spmv_handle();
+}
+
+template <typename scalar_t, typename lno_t, typename size_type, class Device>
+void test_spmv_transpose(lno_t numRows, lno_t numCols, size_type nnz, lno_t bandwidth, lno_t row_size_variance, int numVecs){
+
+  typedef typename KokkosSparse::CrsMatrix<scalar_t, lno_t, Device, void, size_type> crsMat_t;
+  typedef Kokkos::View<scalar_t**, Kokkos::LayoutLeft, Device> mv_t;
+  typedef KokkosKernels::Experimental::KokkosKernelsHandle
+      <size_type, lno_t, scalar_t,
+       typename Device::execution_space, typename Device::memory_space, typename Device::memory_space> KernelHandle;
+
+  crsMat_t input_mat = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numRows,numCols,nnz,row_size_variance, bandwidth);
+
+  mv_t input_x ("x", numRows, numVecs);
+  mv_t output_y ("y", numCols, numVecs);
+  mv_t expected_y ("expected", numCols, numVecs);
+  Kokkos::Random_XorShift64_Pool<typename Device::execution_space> rand_pool(13718);
+  Kokkos::fill_random(input_x, rand_pool, scalar_t(10));
+  Kokkos::fill_random(output_y, rand_pool, scalar_t(10));
+
+  KernelHandle kh;
+  kh.create_spmv_handle();
+  auto sh = kh.get_spmv_handle();
+  sh->set_transpose_algorithm(KokkosSparse::SPMVTransposeAlgorithm::SPMV_TRANSPOSE_COLORED);
+
+  const char* modes[2] = {"T", "H"};
+  const KokkosSparse::SPMVTransposeAlgorithm algos[2] =
+    {KokkosSparse::SPMVTransposeAlgorithm::SPMV_TRANSPOSE_EXPLICIT,
+     KokkosSparse::SPMVTransposeAlgorithm::SPMV_TRANSPOSE_COLORED};
+  for (int a = 0; a < 3; ++a) {
+    for (int m = 0; m < 2; ++m) {
+      // a == 2 uses the algorithm stored in the handle (colored).
+      Test::check_spmv_alpha_beta(std::string("spmv_transpose with mode ") + modes[m] + ", algorithm " + std::to_string(a), output_y,
+          [&] (scalar_t alpha, scalar_t beta, mv_t reference_y) {
+            if (numVecs == 1) {
+              auto x_1 = Kokkos::subview(input_x, Kokkos::ALL(), 0);
+              auto e_1 = Kokkos::subview(reference_y, Kokkos::ALL(), 0);
+              KokkosSparse::spmv(modes[m], alpha, input_mat, x_1, beta, e_1);
+            }
+            else {
+              KokkosSparse::spmv(modes[m], alpha, input_mat, input_x, beta, reference_y);
+            }
+          },
+          [&] (scalar_t alpha, scalar_t beta) {
+            if (numVecs == 1) {
+              auto x_1 = Kokkos::subview(input_x, Kokkos::ALL(), 0);
+              auto y_1 = Kokkos::subview(output_y, Kokkos::ALL(), 0);
+              if (a < 2)
+                KokkosSparse::spmv(&kh, algos[a], modes[m], alpha, input_mat, x_1, beta, y_1);
+              else
+                KokkosSparse::spmv(&kh, modes[m], alpha, input_mat, x_1, beta, y_1);
+            }
+            else {
+              if (a < 2)
+                KokkosSparse::spmv(&kh, algos[a], modes[m], alpha, input_mat, input_x, beta, output_y);
+              else
+                KokkosSparse::spmv(&kh, modes[m], alpha, input_mat, input_x, beta, output_y);
+            }
+          });
+    }
+  }
+  EXPECT_TRUE(sh->is_transpose_built());
+  EXPECT_TRUE(sh->are_transpose_colors_built());
+
+  // Only the pattern of A^T is cached: new values of A are used on the
+  // next call without spmv_symbolic.
+  KokkosBlas::scal(input_mat.values, scalar_t(2), input_mat.values);
+  KokkosSparse::spmv("T", scalar_t(1), input_mat, input_x, scalar_t(0), expected_y);
+  KokkosSparse::spmv(&kh, KokkosSparse::SPMVTransposeAlgorithm::SPMV_TRANSPOSE_EXPLICIT,
+                     "T", scalar_t(1), input_mat, input_x, scalar_t(0), output_y);
+  Test::check_spmv_result("spmv_transpose after new values of A", expected_y, output_y);
+  kh.destroy_spmv_handle();
+}
+
+namespace Test {
+
+/// Check y and the reduction returned by spmv_dot / spmv_axpby_nrm2
+/// against spmv followed by a dot product or 2-norm on the host.
+template <typename crsMat_t, typename fusedMat_t, typename scalar_view_t>
+void check_spmv_fused(const crsMat_t& input_mat, const fusedMat_t& fused_mat,
+                      scalar_view_t input_x, scalar_view_t output_y,
+                      typename scalar_view_t::non_const_value_type alpha,
+                      typename scalar_view_t::non_const_value_type beta,
+                      bool do_nrm2) {
+  typedef typename scalar_view_t::non_const_value_type scalar_t;
+  typedef Kokkos::ArithTraits<scalar_t> KAT;
+  typedef typename KAT::mag_type mag_t;
+  typedef Kokkos::RangePolicy<typename scalar_view_t::execution_space> range_t;
+
+  const mag_t eps = std::is_same<mag_t, float>::value ? 2*1e-3 : 1e-7;
+  const mag_t reduce_eps = std::is_same<mag_t, float>::value ? 1e-2 : 1e-7;
+
+  scalar_view_t expected_y ("expected", output_y.extent(0));
+  Kokkos::deep_copy(expected_y, output_y);
+  Test::sequential_spmv(input_mat, input_x, expected_y, alpha, beta);
+
+  scalar_t result;
+  if (do_nrm2)
+    result = KokkosSparse::spmv_axpby_nrm2("N", alpha, fused_mat, input_x, beta, output_y);
+  else
+    result = KokkosSparse::spmv_dot("N", alpha, fused_mat, input_x, beta, output_y);
+
+  int num_errors = 0;
+  Kokkos::parallel_reduce("KokkosSparse::Test::spmv_fused",
+                          range_t(0, output_y.extent(0)),
+                          Test::fSPMV<scalar_view_t, scalar_view_t>(expected_y, output_y, eps),
+                          num_errors);
+  if(num_errors>0) printf("KokkosSparse::Test::spmv_fused: %i errors of %i\n",
+                          num_errors, output_y.extent_int(0));
+  EXPECT_TRUE(num_errors==0);
+
+  auto h_x = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), input_x);
+  auto h_y = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), expected_y);
+  scalar_t expected = KAT::zero();
+  for (size_t i = 0; i < h_y.extent(0); ++i) {
+    if (do_nrm2)
+      expected += KAT::abs(h_y(i)) * KAT::abs(h_y(i));
+    else
+      expected += KAT::conj(h_x(i)) * h_y(i);
+  }
+  if (do_nrm2)
+    expected = KAT::sqrt(expected);
+  const mag_t scale = KAT::abs(expected) > 0 ? KAT::abs(expected) : Kokkos::ArithTraits<mag_t>::one();
+  EXPECT_LE(KAT::abs(result - expected) / scale, reduce_eps);
+}
+
+} // namespace Test
+
+template <typename scalar_t, typename lno_t, typename size_type, class Device>
+void test_spmv_fused(lno_t numBlockRows, size_type nnz, lno_t bandwidth, lno_t row_size_variance, lno_t blockSize){
+
+  typedef typename KokkosSparse::CrsMatrix<scalar_t, lno_t, Device, void, size_type> crsMat_t;
+  typedef typename KokkosSparse::Experimental::BlockCrsMatrix<scalar_t, lno_t, Device, void, size_type> blockMat_t;
+  typedef typename crsMat_t::values_type::non_const_type scalar_view_t;
+
+  crsMat_t block_mat = KokkosKernels::Impl::kk_generate_sparse_matrix<crsMat_t>(numBlockRows,numBlockRows,nnz,row_size_variance, bandwidth);
+  crsMat_t input_mat = Test::expand_block_pattern(block_mat, blockSize);
+  blockMat_t input_block_mat ("A_block", block_mat.numRows(), block_mat.numCols(), input_mat.nnz(),
+                              input_mat.values, block_mat.graph.row_map, block_mat.graph.entries, blockSize);
+
+  // Same matrix, with the row partitioning that enables the raw OpenMP path.
+  crsMat_t partitioned_mat = input_mat;
+#ifdef KOKKOS_ENABLE_OPENMP
+  if (std::is_same<typename Device::execution_space, Kokkos::OpenMP>::value)
+    partitioned_mat.graph.create_block_partitioning(omp_get_max_threads());
+#endif
+
+  const lno_t numRows = input_mat.numRows();
+  scalar_view_t input_x ("x", numRows);
+  scalar_view_t output_y ("y", numRows);
+  Kokkos::Random_XorShift64_Pool<typename Device::execution_space> rand_pool(13718);
+  Kokkos::fill_random(input_x, rand_pool, scalar_t(10));
+  Kokkos::fill_random(output_y, rand_pool, scalar_t(10));
+
+  const scalar_t alphas[3] = {1.0, 0.0, -1.0};
+  const scalar_t betas[3] = {0.0, 1.0, 1.0};
+  for (int i = 0; i < 3; ++i) {
+    for (int do_nrm2 = 0; do_nrm2 < 2; ++do_nrm2) {
+      Test::check_spmv_fused(input_mat, input_mat, input_x, output_y, alphas[i], betas[i], do_nrm2);
+      Test::check_spmv_fused(input_mat, partitioned_mat, input_x, output_y, alphas[i], betas[i], do_nrm2);
+      Test::check_spmv_fused(input_mat, input_block_mat, input_x, output_y, alphas[i], betas[i], do_nrm2);
+    }
+  }
 }
 
 template <typename scalar_t, typename lno_t, typename size_type, typename layout, class Device>
@@ -324,7 +1147,14 @@ void test_spmv_mv(lno_t numRows,size_type nnz, lno_t bandwidth, lno_t row_size_v
   Test::check_spmv_mv(input_mat, b_x, b_y, b_y_copy, 0.0, 1.0, numMV);
   Test::check_spmv_mv(input_mat, b_x, b_y, b_y_copy, 1.0, 1.0, numMV);
 
+  const KokkosSparse::SPMVAlgorithm merge = KokkosSparse::SPMVAlgorithm::SPMV_MERGE_PATH;
+  Test::check_spmv_mv(input_mat, b_x, b_y, b_y_copy, 1.0, 0.0, numMV, merge);
+  Test::check_spmv_mv(input_mat, b_x, b_y, b_y_copy, 1.0, 1.0, numMV, merge);
 
+  const KokkosSparse::SPMVAlgorithm panel = KokkosSparse::SPMVAlgorithm::SPMV_MV_PANEL;
+  Test::check_spmv_mv(input_mat, b_x, b_y, b_y_copy, 1.0, 0.0, numMV, panel);
+  Test::check_spmv_mv(input_mat, b_x, b_y, b_y_copy, 1.0, 1.0, numMV, panel);
+  Test::check_spmv_mv(input_mat, b_x, b_y, b_y_copy, -1.0, 2.0, numMV, panel);
 }
 
 template <typename scalar_t, typename lno_t, typename size_type, class Device>
@@ -650,6 +1480,37 @@ TEST_F( TestCategory,sparse ## _ ## spmv ## _ ## SCALAR ## _ ## ORDINAL ## _ ##
   test_spmv<SCALAR,ORDINAL,OFFSET,DEVICE> (50000, 50000 * 30, 200, 10); \
   test_spmv<SCALAR,ORDINAL,OFFSET,DEVICE> (50000, 50000 * 30, 100, 10); \
   test_spmv<SCALAR,ORDINAL,OFFSET,DEVICE> (10000, 10000 * 20, 100, 5); \
+  test_spmv_long_rows<SCALAR,ORDINAL,OFFSET,DEVICE> (5000, 3); \
+  test_spmv_handle<SCALAR,ORDINAL,OFFSET,DEVICE> (2000, 2000 * 10, 100, 5, 1); \
+  test_spmv_handle<SCALAR,ORDINAL,OFFSET,DEVICE> (2000, 2000 * 10, 100, 5, 3); \
+  test_spmv_sellcs<SCALAR,ORDINAL,OFFSET,DEVICE> (10000, 10000 * 20, 100, 5, 4, 1); \
+  test_spmv_sellcs<SCALAR,ORDINAL,OFFSET,DEVICE> (10000, 10000 * 20, 100, 5, 8, 64); \
+  test_spmv_sellcs<SCALAR,ORDINAL,OFFSET,DEVICE> (10001, 10001 * 20, 100, 5, 7, 70); \
+  test_spmv_sellcs<SCALAR,ORDINAL,OFFSET,DEVICE> (10001, 10001 * 20, 100, 5, 32, 10001); \
+  test_spmv_compressed<SCALAR,ORDINAL,OFFSET,DEVICE> (10000, 10000 * 20, 100, 5); \
+  test_spmv_compressed<SCALAR,ORDINAL,OFFSET,DEVICE> (70000, 70000 * 5, 70000, 3); \
+  test_spmv_semiring<SCALAR,ORDINAL,OFFSET,DEVICE> (10000, 10000 * 20, 100, 5); \
+  test_spmv_fused<SCALAR,ORDINAL,OFFSET,DEVICE> (2000, 2000 * 10, 100, 5, 1); \
+  test_spmv_fused<SCALAR,ORDINAL,OFFSET,DEVICE> (2000, 2000 * 10, 100, 5, 4); \
+  test_spmv_powers<SCALAR,ORDINAL,OFFSET,DEVICE> (10000, 5, false, 3, 0); \
+  test_spmv_powers<SCALAR,ORDINAL,OFFSET,DEVICE> (10000, 5, false, 4, 64); \
+  test_spmv_powers<SCALAR,ORDINAL,OFFSET,DEVICE> (10000, 200, false, 3, 64); \
+  test_spmv_powers<SCALAR,ORDINAL,OFFSET,DEVICE> (10000, 5, true, 3, 64); \
+  test_spmv_bsr<SCALAR,ORDINAL,OFFSET,DEVICE> (1000, 1000 * 8, 50, 3, 1, 1); \
+  test_spmv_bsr<SCALAR,ORDINAL,OFFSET,DEVICE> (1000, 1000 * 8, 50, 3, 2, 1); \
+  test_spmv_bsr<SCALAR,ORDINAL,OFFSET,DEVICE> (1000, 1000 * 8, 50, 3, 3, 1); \
+  test_spmv_bsr<SCALAR,ORDINAL,OFFSET,DEVICE> (1000, 1000 * 8, 50, 3, 4, 3); \
+  test_spmv_bsr<SCALAR,ORDINAL,OFFSET,DEVICE> (1000, 1000 * 8, 50, 3, 5, 1); \
+  test_spmv_bsr<SCALAR,ORDINAL,OFFSET,DEVICE> (1000, 1000 * 8, 50, 3, 6, 1); \
+  test_spmv_bsr<SCALAR,ORDINAL,OFFSET,DEVICE> (1000, 1000 * 8, 50, 3, 7, 1); \
+  test_spmv_bsr<SCALAR,ORDINAL,OFFSET,DEVICE> (1000, 1000 * 8, 50, 3, 8, 3); \
+  test_spmv_bsr<SCALAR,ORDINAL,OFFSET,DEVICE> (1000, 1000 * 8, 50, 3, 11, 1); \
+  test_spmv_bsr<SCALAR,ORDINAL,OFFSET,DEVICE> (1000, 1000 * 8, 50, 3, 11, 3); \
+  test_spmv_symmetric<SCALAR,ORDINAL,OFFSET,DEVICE> (2000, 2000 * 5, 100, 3, 1); \
+  test_spmv_symmetric<SCALAR,ORDINAL,OFFSET,DEVICE> (2000, 2000 * 5, 100, 3, 3); \
+  test_spmv_symmetric_arrow<SCALAR,ORDINAL,OFFSET,DEVICE> (500, 2); \
+  test_spmv_transpose<SCALAR,ORDINAL,OFFSET,DEVICE> (3000, 2000, 3000 * 8, 200, 3, 1); \
+  test_spmv_transpose<SCALAR,ORDINAL,OFFSET,DEVICE> (3000, 2000, 3000 * 8, 200, 3, 3); \
 }
 
 #define EXECUTE_TEST_MV(SCALAR, ORDINAL, OFFSET, LAYOUT, DEVICE) \
@@ -657,6 +1518,7 @@ TEST_F( TestCategory,sparse ## _ ## spmv_mv ## _ ## SCALAR ## _ ## ORDINAL ## _
   test_spmv_mv<SCALAR,ORDINAL,OFFSET,Kokkos::LAYOUT,DEVICE> (50000, 50000 * 30, 100, 10, 5); \
   test_spmv_mv<SCALAR,ORDINAL,OFFSET,Kokkos::LAYOUT,DEVICE> (50000, 50000 * 30, 200, 10, 1); \
   test_spmv_mv<SCALAR,ORDINAL,OFFSET,Kokkos::LAYOUT,DEVICE> (10000, 10000 * 20, 100, 5, 10); \
+  test_spmv_mv<SCALAR,ORDINAL,OFFSET,Kokkos::LAYOUT,DEVICE> (5000, 5000 * 10, 100, 5, 31); \
 }
 
 #define EXECUTE_TEST_STRUCT(SCALAR, ORDINAL, OFFSET, DEVICE) \
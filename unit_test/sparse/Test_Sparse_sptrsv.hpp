@@ -56,6 +56,7 @@
 #include <KokkosKernels_IOUtils.hpp>
 
 #include "KokkosSparse_sptrsv.hpp"
+#include "KokkosSparse_sptrsv_supernode.hpp"
 
 #include<gtest/gtest.h>
 
@@ -483,6 +484,196 @@ void run_test_sptrsv() {
       kh.destroy_sptrsv_handle();
     }
 
+    // rows reordered so that each level is contiguous
+    {
+      Kokkos::deep_copy(lhs, 0);
+      KernelHandle kh;
+      bool is_lower_tri = true;
+      kh.create_sptrsv_handle(SPTRSVAlgorithm::SEQLVLSCHD_RP, nrows, is_lower_tri);
+      kh.get_sptrsv_handle()->set_reorder_by_level(true);
+
+      sptrsv_symbolic( &kh, row_map, entries );
+      Kokkos::fence();
+      EXPECT_TRUE( kh.get_sptrsv_handle()->is_reordered() );
+
+      sptrsv_solve( &kh, row_map, entries, values, rhs, lhs );
+      Kokkos::fence();
+
+      scalar_t sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      if ( sum != lhs.extent(0) ) {
+        std::cout << "Lower Tri Solve FAILURE" << std::endl;
+        kh.get_sptrsv_handle()->print_algorithm();
+      }
+      EXPECT_TRUE( sum == scalar_t(lhs.extent(0)) );
+
+      Kokkos::deep_copy(lhs, 0);
+      kh.get_sptrsv_handle()->set_algorithm(SPTRSVAlgorithm::SEQLVLSCHD_TP1);
+      sptrsv_solve( &kh, row_map, entries, values, rhs, lhs );
+      Kokkos::fence();
+
+      sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      if ( sum != lhs.extent(0) ) {
+        std::cout << "Lower Tri Solve FAILURE" << std::endl;
+        kh.get_sptrsv_handle()->print_algorithm();
+      }
+      EXPECT_TRUE( sum == scalar_t(lhs.extent(0)) );
+
+      // the reordered values are gathered once; doubling the values in
+      // place needs set_values_changed, and halves the solution
+      auto hvalues = Kokkos::create_mirror_view(values);
+      Kokkos::deep_copy(hvalues, values);
+      for ( size_t k = 0; k < hvalues.extent(0); ++k ) hvalues(k) *= scalar_t(2);
+      Kokkos::deep_copy(values, hvalues);
+      kh.get_sptrsv_handle()->set_values_changed();
+
+      Kokkos::deep_copy(lhs, 0);
+      sptrsv_solve( &kh, row_map, entries, values, rhs, lhs );
+      Kokkos::fence();
+
+      sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      EXPECT_TRUE( sum == scalar_t(0.5)*scalar_t(lhs.extent(0)) );
+
+      for ( size_t k = 0; k < hvalues.extent(0); ++k ) hvalues(k) /= scalar_t(2);
+      Kokkos::deep_copy(values, hvalues);
+
+      kh.destroy_sptrsv_handle();
+    }
+
+    // sync-free solve spins on completion flags, host execution spaces only
+    if (KokkosKernels::Impl::kk_get_exec_space_type<typename device::execution_space>() != KokkosKernels::Impl::Exec_CUDA)
+    {
+      Kokkos::deep_copy(lhs, 0);
+      KernelHandle kh;
+      bool is_lower_tri = true;
+      kh.create_sptrsv_handle(SPTRSVAlgorithm::SYNCFREE, nrows, is_lower_tri);
+
+      sptrsv_symbolic( &kh, row_map, entries );
+      Kokkos::fence();
+
+      sptrsv_solve( &kh, row_map, entries, values, rhs, lhs );
+      Kokkos::fence();
+
+      scalar_t sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      if ( sum != lhs.extent(0) ) {
+        std::cout << "Lower Tri Solve FAILURE" << std::endl;
+        kh.get_sptrsv_handle()->print_algorithm();
+      }
+      EXPECT_TRUE( sum == scalar_t(lhs.extent(0)) );
+
+      // second solve with the same handle resets the completion flags
+      Kokkos::deep_copy(lhs, 0);
+      sptrsv_solve( &kh, row_map, entries, values, rhs, lhs );
+      Kokkos::fence();
+
+      sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      EXPECT_TRUE( sum == scalar_t(lhs.extent(0)) );
+
+      kh.destroy_sptrsv_handle();
+    }
+
+    // Jacobi sweeps are exact once the sweeps cover all levels
+    {
+      Kokkos::deep_copy(lhs, 0);
+      KernelHandle kh;
+      bool is_lower_tri = true;
+      kh.create_sptrsv_handle(SPTRSVAlgorithm::JACOBI_SWEEPS, nrows, is_lower_tri);
+      kh.get_sptrsv_handle()->set_num_jacobi_sweeps(nrows);
+
+      sptrsv_symbolic( &kh, row_map, entries );
+      Kokkos::fence();
+
+      sptrsv_solve( &kh, row_map, entries, values, rhs, lhs );
+      Kokkos::fence();
+
+      scalar_t sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      if ( sum != lhs.extent(0) ) {
+        std::cout << "Lower Tri Solve FAILURE" << std::endl;
+        kh.get_sptrsv_handle()->print_algorithm();
+      }
+      EXPECT_TRUE( sum == scalar_t(lhs.extent(0)) );
+
+      // without sweeps only the first level is solved
+      Kokkos::deep_copy(lhs, 0);
+      kh.get_sptrsv_handle()->set_num_jacobi_sweeps(0);
+      sptrsv_solve( &kh, row_map, entries, values, rhs, lhs );
+      Kokkos::fence();
+
+      sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      EXPECT_TRUE( sum != scalar_t(lhs.extent(0)) );
+
+      // in-place solve, rhs and lhs share their storage
+      kh.get_sptrsv_handle()->set_num_jacobi_sweeps(nrows);
+      Kokkos::deep_copy(lhs, rhs);
+      sptrsv_solve( &kh, row_map, entries, values, lhs, lhs );
+      Kokkos::fence();
+
+      sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      EXPECT_TRUE( sum == scalar_t(lhs.extent(0)) );
+
+      EXPECT_THROW( kh.get_sptrsv_handle()->set_num_jacobi_sweeps(-1), std::runtime_error );
+
+      kh.destroy_sptrsv_handle();
+    }
+
+    // multiple right-hand sides, column j of the solution is j+1; more
+    // columns than the RangePolicy kernel keeps in registers at a time
+    {
+      typedef Kokkos::View< scalar_t**, Kokkos::LayoutLeft, device > MultiVectorType;
+      const int nrhs = 10;
+
+      MultiVectorType known_lhs_mv("known_lhs_mv", nrows, nrhs);
+      auto hknown_lhs_mv = Kokkos::create_mirror_view(known_lhs_mv);
+      for ( size_type i = 0; i < nrows; ++i ) {
+        for ( int j = 0; j < nrhs; ++j ) {
+          hknown_lhs_mv(i, j) = scalar_t(j+1);
+        }
+      }
+      Kokkos::deep_copy(known_lhs_mv, hknown_lhs_mv);
+
+      MultiVectorType rhs_mv("rhs_mv", nrows, nrhs);
+      MultiVectorType lhs_mv("lhs_mv", nrows, nrhs);
+      KokkosSparse::spmv( "N", ONE, triMtx, known_lhs_mv, ZERO, rhs_mv);
+
+      SPTRSVAlgorithm algms[] = {SPTRSVAlgorithm::SEQLVLSCHD_RP, SPTRSVAlgorithm::SEQLVLSCHD_TP1, SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN};
+      for ( auto algm : algms ) {
+        Kokkos::deep_copy(lhs_mv, 0);
+        KernelHandle kh;
+        bool is_lower_tri = true;
+        kh.create_sptrsv_handle(algm, nrows, is_lower_tri);
+        if ( algm == SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN ) {
+          // chain the single-row levels, so the single-team kernel is used
+          kh.get_sptrsv_handle()->reset_chain_threshold(1);
+        }
+
+        sptrsv_symbolic( &kh, row_map, entries );
+        Kokkos::fence();
+
+        sptrsv_solve( &kh, row_map, entries, values, rhs_mv, lhs_mv );
+        Kokkos::fence();
+
+        for ( int j = 0; j < nrhs; ++j ) {
+          auto lhs_j = Kokkos::subview(lhs_mv, Kokkos::ALL(), j);
+          scalar_t sum = 0.0;
+          Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs_j.extent(0)), ReductionCheck<decltype(lhs_j), scalar_t, lno_t>(lhs_j), sum);
+          if ( sum != scalar_t((j+1)*lhs_j.extent(0)) ) {
+            std::cout << "Lower Tri Solve FAILURE (rhs " << j << ")" << std::endl;
+            kh.get_sptrsv_handle()->print_algorithm();
+          }
+          EXPECT_TRUE( sum == scalar_t((j+1)*lhs_j.extent(0)) );
+        }
+
+        kh.destroy_sptrsv_handle();
+      }
+    }
+
 #ifdef KOKKOSKERNELS_ENABLE_TPL_CUSPARSE
     if (std::is_same<size_type,int>::value && std::is_same<lno_t,int>::value && std::is_same<typename device::execution_space, Kokkos::Cuda>::value)
     {
@@ -646,6 +837,162 @@ void run_test_sptrsv() {
       kh.destroy_sptrsv_handle();
     }
 
+    // rows reordered so that each level is contiguous
+    {
+      Kokkos::deep_copy(lhs, 0);
+      KernelHandle kh;
+      bool is_lower_tri = false;
+      kh.create_sptrsv_handle(SPTRSVAlgorithm::SEQLVLSCHD_RP, nrows, is_lower_tri);
+      kh.get_sptrsv_handle()->set_reorder_by_level(true);
+
+      sptrsv_symbolic( &kh, row_map, entries );
+      Kokkos::fence();
+      EXPECT_TRUE( kh.get_sptrsv_handle()->is_reordered() );
+
+      sptrsv_solve( &kh, row_map, entries, values, rhs, lhs );
+      Kokkos::fence();
+
+      scalar_t sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      if ( sum != lhs.extent(0) ) {
+        std::cout << "Upper Tri Solve FAILURE" << std::endl;
+        kh.get_sptrsv_handle()->print_algorithm();
+      }
+      EXPECT_TRUE( sum == scalar_t(lhs.extent(0)) );
+
+      Kokkos::deep_copy(lhs, 0);
+      kh.get_sptrsv_handle()->set_algorithm(SPTRSVAlgorithm::SEQLVLSCHD_TP1);
+      sptrsv_solve( &kh, row_map, entries, values, rhs, lhs );
+      Kokkos::fence();
+
+      sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      if ( sum != lhs.extent(0) ) {
+        std::cout << "Upper Tri Solve FAILURE" << std::endl;
+        kh.get_sptrsv_handle()->print_algorithm();
+      }
+      EXPECT_TRUE( sum == scalar_t(lhs.extent(0)) );
+
+      kh.destroy_sptrsv_handle();
+    }
+
+    // sync-free solve spins on completion flags, host execution spaces only
+    if (KokkosKernels::Impl::kk_get_exec_space_type<typename device::execution_space>() != KokkosKernels::Impl::Exec_CUDA)
+    {
+      Kokkos::deep_copy(lhs, 0);
+      KernelHandle kh;
+      bool is_lower_tri = false;
+      kh.create_sptrsv_handle(SPTRSVAlgorithm::SYNCFREE, nrows, is_lower_tri);
+
+      sptrsv_symbolic( &kh, row_map, entries );
+      Kokkos::fence();
+
+      sptrsv_solve( &kh, row_map, entries, values, rhs, lhs );
+      Kokkos::fence();
+
+      scalar_t sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      if ( sum != lhs.extent(0) ) {
+        std::cout << "Upper Tri Solve FAILURE" << std::endl;
+        kh.get_sptrsv_handle()->print_algorithm();
+      }
+      EXPECT_TRUE( sum == scalar_t(lhs.extent(0)) );
+
+      // second solve with the same handle resets the completion flags
+      Kokkos::deep_copy(lhs, 0);
+      sptrsv_solve( &kh, row_map, entries, values, rhs, lhs );
+      Kokkos::fence();
+
+      sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      EXPECT_TRUE( sum == scalar_t(lhs.extent(0)) );
+
+      kh.destroy_sptrsv_handle();
+    }
+
+    // Jacobi sweeps are exact once the sweeps cover all levels
+    {
+      Kokkos::deep_copy(lhs, 0);
+      KernelHandle kh;
+      bool is_lower_tri = false;
+      kh.create_sptrsv_handle(SPTRSVAlgorithm::JACOBI_SWEEPS, nrows, is_lower_tri);
+      kh.get_sptrsv_handle()->set_num_jacobi_sweeps(nrows);
+
+      sptrsv_symbolic( &kh, row_map, entries );
+      Kokkos::fence();
+
+      sptrsv_solve( &kh, row_map, entries, values, rhs, lhs );
+      Kokkos::fence();
+
+      scalar_t sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      if ( sum != lhs.extent(0) ) {
+        std::cout << "Upper Tri Solve FAILURE" << std::endl;
+        kh.get_sptrsv_handle()->print_algorithm();
+      }
+      EXPECT_TRUE( sum == scalar_t(lhs.extent(0)) );
+
+      // without sweeps only the first level is solved
+      Kokkos::deep_copy(lhs, 0);
+      kh.get_sptrsv_handle()->set_num_jacobi_sweeps(0);
+      sptrsv_solve( &kh, row_map, entries, values, rhs, lhs );
+      Kokkos::fence();
+
+      sum = 0.0;
+      Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs.extent(0)), ReductionCheck<ValuesType, scalar_t, lno_t>(lhs), sum);
+      EXPECT_TRUE( sum != scalar_t(lhs.extent(0)) );
+
+      kh.destroy_sptrsv_handle();
+    }
+
+    // multiple right-hand sides, column j of the solution is j+1; more
+    // columns than the RangePolicy kernel keeps in registers at a time
+    {
+      typedef Kokkos::View< scalar_t**, Kokkos::LayoutLeft, device > MultiVectorType;
+      const int nrhs = 10;
+
+      MultiVectorType known_lhs_mv("known_lhs_mv", nrows, nrhs);
+      auto hknown_lhs_mv = Kokkos::create_mirror_view(known_lhs_mv);
+      for ( size_type i = 0; i < nrows; ++i ) {
+        for ( int j = 0; j < nrhs; ++j ) {
+          hknown_lhs_mv(i, j) = scalar_t(j+1);
+        }
+      }
+      Kokkos::deep_copy(known_lhs_mv, hknown_lhs_mv);
+
+      MultiVectorType rhs_mv("rhs_mv", nrows, nrhs);
+      MultiVectorType lhs_mv("lhs_mv", nrows, nrhs);
+      KokkosSparse::spmv( "N", ONE, triMtx, known_lhs_mv, ZERO, rhs_mv);
+
+      // TP1CHAIN has no multivector kernel and solves column by column
+      SPTRSVAlgorithm algms[] = {SPTRSVAlgorithm::SEQLVLSCHD_RP, SPTRSVAlgorithm::SEQLVLSCHD_TP1, SPTRSVAlgorithm::SEQLVLSCHD_TP1CHAIN};
+      for ( auto algm : algms ) {
+        Kokkos::deep_copy(lhs_mv, 0);
+        KernelHandle kh;
+        bool is_lower_tri = false;
+        kh.create_sptrsv_handle(algm, nrows, is_lower_tri);
+
+        sptrsv_symbolic( &kh, row_map, entries );
+        Kokkos::fence();
+
+        sptrsv_solve( &kh, row_map, entries, values, rhs_mv, lhs_mv );
+        Kokkos::fence();
+
+        for ( int j = 0; j < nrhs; ++j ) {
+          auto lhs_j = Kokkos::subview(lhs_mv, Kokkos::ALL(), j);
+          scalar_t sum = 0.0;
+          Kokkos::parallel_reduce( Kokkos::RangePolicy<typename device::execution_space>(0, lhs_j.extent(0)), ReductionCheck<decltype(lhs_j), scalar_t, lno_t>(lhs_j), sum);
+          if ( sum != scalar_t((j+1)*lhs_j.extent(0)) ) {
+            std::cout << "Upper Tri Solve FAILURE (rhs " << j << ")" << std::endl;
+            kh.get_sptrsv_handle()->print_algorithm();
+          }
+          EXPECT_TRUE( sum == scalar_t((j+1)*lhs_j.extent(0)) );
+        }
+
+        kh.destroy_sptrsv_handle();
+      }
+    }
+
 #ifdef KOKKOSKERNELS_ENABLE_TPL_CUSPARSE
     if (std::is_same<size_type,int>::value && std::is_same<lno_t,int>::value && std::is_same<typename device::execution_space, Kokkos::Cuda>::value)
     {
@@ -675,11 +1022,152 @@ void run_test_sptrsv() {
 
 }
 
+#if defined(KOKKOSKERNELS_ENABLE_SUPERNODAL_SPTRSV)
+// Native supernode detection on a small factor, then a supernodal solve
+// compared with a level-scheduled solve of the same factor.
+template <typename device>
+void run_test_sptrsv_supernode_detect() {
+
+  typedef double scalar_t;
+  typedef int    lno_t;
+  typedef int    size_type;
+  typedef typename device::execution_space execution_space;
+  typedef typename device::memory_space    memory_space;
+  typedef Kokkos::DefaultHostExecutionSpace host_execution_space;
+
+  typedef CrsMatrix<scalar_t, lno_t, host_execution_space, void, size_type> host_crsmat_t;
+  typedef typename host_crsmat_t::StaticCrsGraphType host_graph_t;
+  typedef CrsMatrix<scalar_t, lno_t, device, void, size_type> crsmat_t;
+  typedef Kokkos::View< scalar_t*, device > ValuesType;
+  typedef Kokkos::View< int*, Kokkos::HostSpace > integer_view_host_t;
+  typedef KokkosKernels::Experimental::KokkosKernelsHandle <size_type, lno_t, scalar_t,
+    execution_space, memory_space, memory_space > KernelHandle;
+
+  // L in CSR:
+  //   row 0: 0
+  //   row 1: 0 1
+  //   row 2: 0 1 2
+  //   row 3: 3
+  //   row 4: 0 1 2 3 4
+  //   row 5: 4 5
+  // etree parents 1 2 4 4 5 -1, fundamental supernodes {0,1,2}, {3}, {4,5}
+  const int nrows = 6;
+  const int nnz   = 14;
+  const int row_ptr[] = {0, 1, 3, 6, 7, 12, 14};
+  const int cols[]    = {0, 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 4, 5};
+
+  typename host_graph_t::row_map_type::non_const_type hrow_map ("hrow_map", nrows+1);
+  typename host_graph_t::entries_type::non_const_type hentries ("hentries", nnz);
+  typename host_crsmat_t::values_type::non_const_type hvalues  ("hvalues", nnz);
+  for (int i = 0; i <= nrows; i++) {
+    hrow_map (i) = row_ptr[i];
+  }
+  for (int i = 0; i < nrows; i++) {
+    for (int k = row_ptr[i]; k < row_ptr[i+1]; k++) {
+      hentries (k) = cols[k];
+      hvalues (k) = (cols[k] == i ? scalar_t(2 + i) : scalar_t(-0.5));
+    }
+  }
+  host_crsmat_t A ("A", nrows, hvalues, host_graph_t (hentries, hrow_map));
+
+  // etree and supernodes
+  integer_view_host_t parent ("parent", nrows);
+  compute_etree_crs (A.graph, parent.data ());
+  const int gold_parent[] = {1, 2, 4, 4, 5, -1};
+  for (int i = 0; i < nrows; i++) {
+    EXPECT_EQ (parent (i), gold_parent[i]) << "etree, column " << i;
+  }
+
+  // rhs = A * ones on the device
+  typename crsmat_t::row_map_type::non_const_type row_map ("row_map", nrows+1);
+  typename crsmat_t::index_type::non_const_type   entries ("entries", nnz);
+  typename crsmat_t::values_type::non_const_type  values  ("values", nnz);
+  Kokkos::deep_copy (row_map, hrow_map);
+  Kokkos::deep_copy (entries, hentries);
+  Kokkos::deep_copy (values,  hvalues);
+  crsmat_t triMtx ("triMtx", nrows, nrows, nnz, values, row_map, entries);
+
+  ValuesType known_lhs ("known_lhs", nrows);
+  ValuesType rhs ("rhs", nrows);
+  Kokkos::deep_copy (known_lhs, scalar_t(1));
+  KokkosSparse::spmv ("N", scalar_t(1), triMtx, known_lhs, scalar_t(0), rhs);
+
+  // level-scheduled solve
+  ValuesType lhs_lvl ("lhs_lvl", nrows);
+  {
+    KernelHandle kh;
+    kh.create_sptrsv_handle (SPTRSVAlgorithm::SEQLVLSCHD_TP1, nrows, true);
+    sptrsv_symbolic (&kh, row_map, entries);
+    sptrsv_solve (&kh, row_map, entries, values, rhs, lhs_lvl);
+    Kokkos::fence ();
+    kh.destroy_sptrsv_handle ();
+  }
+
+  // supernodal solves with the detected supernodes and etree:
+  //  - fundamental supernodes (relax_size = 1, relax_ratio = 0)
+  //  - {3,4,5} amalgamated with one explicit zero L(5,3) out of six entries (relax_ratio = 0.2)
+  struct detect_case {
+    int relax_size;
+    double relax_ratio;
+    int nsuper;
+    int supercols[4];
+    int etree[3];
+  };
+  const detect_case cases[] = {
+    {1, 0.0, 3, {0, 3, 4, 6}, {2, 2, -1}},
+    {1, 0.2, 2, {0, 3, 6},    {1, -1}},
+  };
+  auto h_lvl = Kokkos::create_mirror_view (lhs_lvl);
+  Kokkos::deep_copy (h_lvl, lhs_lvl);
+  for (const detect_case &c : cases) {
+    int nsuper = 0;
+    integer_view_host_t supercols, etree;
+    host_crsmat_t L = detect_supernodes (A, nsuper, supercols, etree, c.relax_size, c.relax_ratio);
+    ASSERT_EQ (nsuper, c.nsuper) << "relax_ratio " << c.relax_ratio;
+    for (int s = 0; s <= nsuper; s++) {
+      EXPECT_EQ (supercols (s), c.supercols[s]) << "supercols, supernode " << s << ", relax_ratio " << c.relax_ratio;
+    }
+    for (int s = 0; s < nsuper; s++) {
+      EXPECT_EQ (etree (s), c.etree[s]) << "etree, supernode " << s << ", relax_ratio " << c.relax_ratio;
+    }
+
+    ValuesType lhs_super ("lhs_super", nrows);
+    KernelHandle khL, khU;
+    khL.create_sptrsv_handle (SPTRSVAlgorithm::SUPERNODAL_ETREE, nrows, true);
+    khU.create_sptrsv_handle (SPTRSVAlgorithm::SUPERNODAL_ETREE, nrows, true);
+    khU.get_sptrsv_handle ()->set_column_major (!khL.get_sptrsv_handle ()->is_column_major ());
+    sptrsv_supernodal_symbolic<scalar_t, lno_t, size_type, host_graph_t, KernelHandle, execution_space, host_execution_space>
+      (nsuper, supercols.data (), etree.data (), L.graph, &khL, L.graph, &khU);
+    sptrsv_compute (&khL, L);
+    sptrsv_solve (&khL, lhs_super, rhs);
+    Kokkos::fence ();
+    khL.destroy_sptrsv_handle ();
+    khU.destroy_sptrsv_handle ();
+
+    auto h_super = Kokkos::create_mirror_view (lhs_super);
+    Kokkos::deep_copy (h_super, lhs_super);
+    for (int i = 0; i < nrows; i++) {
+      EXPECT_NEAR (h_super (i), h_lvl (i), 1e-12) << "supernodal vs level-scheduled, row " << i << ", relax_ratio " << c.relax_ratio;
+    }
+  }
+  for (int i = 0; i < nrows; i++) {
+    EXPECT_NEAR (h_lvl (i), 1.0, 1e-12) << "level-scheduled, row " << i;
+  }
+}
+#endif
+
 } // namespace Test
 
 template <typename scalar_t, typename lno_t, typename size_type, typename device>
 void test_sptrsv() {
   Test::run_test_sptrsv<scalar_t, lno_t, size_type, device>();
+#if defined(KOKKOSKERNELS_ENABLE_SUPERNODAL_SPTRSV)
+  // the supernodal path is int/int/double only, so it runs once per device.
+  if (std::is_same<scalar_t, double>::value && std::is_same<lno_t, int>::value &&
+      std::is_same<size_type, int>::value) {
+    Test::run_test_sptrsv_supernode_detect<device>();
+  }
+#endif
 //  Test::run_test_sptrsv_mtx<scalar_t, lno_t, size_type, device>();
 }
 